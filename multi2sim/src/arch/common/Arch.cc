@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <chrono>
+
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/Terminal.h>
 
@@ -29,6 +31,29 @@ namespace comm
 {
 
 
+//
+// Class Arch
+//
+
+void Arch::addHostTime(long long time)
+{
+	// Register the profile entry the first time, in the frequency domain
+	// of the timing simulator if there is one
+	if (!profile_entry)
+	{
+		esim::Engine *engine = esim::Engine::getInstance();
+		profile_entry = engine->RegisterProfileEntry(
+				name + (timing ? ".Timing" : ".Emulator"),
+				timing ? timing->getFrequencyDomain() : nullptr);
+	}
+
+	// Record iteration
+	profile_entry->addExecution(time);
+}
+
+
+
+
 //
 // Class ArchPool
 //
@@ -99,6 +124,9 @@ void ArchPool::Run(int &num_active_emulators, int &num_active_timing_simulators)
 	num_active_emulators = 0;
 	num_active_timing_simulators = 0;
 
+	// Whether the host time of each iteration is measured
+	bool profile = esim::Engine::getInstance()->isProfiling();
+
 	// Run one iteration for each architecture
 	for (auto &arch : arch_list)
 	{
@@ -113,8 +141,22 @@ void ArchPool::Run(int &num_active_emulators, int &num_active_timing_simulators)
 			if (!emulator)
 				continue;
 
-			// Run
-			bool active = emulator->Run();
+			// Run, measuring the host time of the iteration if the
+			// profiler is active
+			bool active;
+			if (profile)
+			{
+				auto start = std::chrono::steady_clock::now();
+				active = emulator->Run();
+				auto end = std::chrono::steady_clock::now();
+				arch->addHostTime(std::chrono::duration_cast<
+						std::chrono::nanoseconds>(
+						end - start).count());
+			}
+			else
+			{
+				active = emulator->Run();
+			}
 			arch->setActive(active);
                            
 			// Increase number of active emulatorlations if the architecture
@@ -154,8 +196,22 @@ void ArchPool::Run(int &num_active_emulators, int &num_active_timing_simulators)
 				continue;
 			}
 
-			// Run
-			bool active = timing->Run();
+			// Run, measuring the host time of the iteration if the
+			// profiler is active
+			bool active;
+			if (profile)
+			{
+				auto start = std::chrono::steady_clock::now();
+				active = timing->Run();
+				auto end = std::chrono::steady_clock::now();
+				arch->addHostTime(std::chrono::duration_cast<
+						std::chrono::nanoseconds>(
+						end - start).count());
+			}
+			else
+			{
+				active = timing->Run();
+			}
 			arch->setActive(active);
 
 			// ... but only update the last timing simulation cycle
@@ -225,6 +281,19 @@ void ArchPool::DumpReports()
 }
 
 
+void ArchPool::DumpJsonReports(misc::JsonWriter &json)
+{
+	for (auto it = getTimingBegin(), end = getTimingEnd(); it != end; it++)
+	{
+		Arch *arch = *it;
+		json.Key(arch->getName());
+		json.BeginObject();
+		arch->getTiming()->DumpJsonReport(json);
+		json.EndObject();
+	}
+}
+
+
 //
 // Class Arch
 //
@@ -24,7 +24,9 @@
 #include <map>
 #include <memory>
 
+#include <lib/cpp/Json.h>
 #include <lib/cpp/String.h>
+#include <lib/esim/Event.h>
 
 
 namespace comm
@@ -73,6 +75,10 @@ private:
 	// True if last iteration had an active simulation
 	bool active = false;
 
+	// Entry of the event-driven engine profiler for the host time spent in
+	// the emulator or timing simulator loop, registered on first use
+	esim::Event *profile_entry = nullptr;
+
 public:
 
 	/// Constructor of a new architecture. New architectures should be
@@ -134,6 +140,12 @@ public:
 	/// active. This is done only internally in the architecture pool (call
 	/// ArchPool::Run()).
 	void setActive(bool active) { this->active = active; }
+
+	/// Record one iteration of the emulator or timing simulator loop that
+	/// took \a time nanoseconds of host time in the profiler of the
+	/// event-driven engine. This is done only internally in the
+	/// architecture pool when profiling is active.
+	void addHostTime(long long time);
 };
 
 
@@ -228,6 +240,11 @@ public:
 	/// Dump a report for all architectures in the pool.
 	void DumpReports();
 
+	/// Dump the statistics of all architectures with an active timing
+	/// simulation as members of the current JSON object, one object per
+	/// architecture.
+	void DumpJsonReports(misc::JsonWriter &json);
+
 	/// Return an iterator to the first architecture in the architecture
 	/// list.
 	std::list<std::unique_ptr<Arch>>::iterator begin()
@@ -159,6 +159,9 @@ public:
 		return os;
 	}
 
+	/// Return the number of entries in the table, including free entries
+	int getSize() const { return descriptors.size(); }
+
 	/// Return file descriptor \a index, or \c nullptr is no file descriptor
 	/// exists with that identifier.
 	FileDescriptor *getFileDescriptor(int index) const
@@ -23,6 +23,7 @@
 #include <fstream>
 
 #include <lib/cpp/IniFile.h>
+#include <lib/cpp/Json.h>
 #include <lib/esim/FrequencyDomain.h>
 #include <lib/esim/Engine.h>
 
@@ -113,6 +114,10 @@ public:
 	/// Dump report for the timing simulator.
 	virtual void DumpReport() const { }
 
+	/// Dump the statistics of the timing simulator as members of the
+	/// current object of the JSON report.
+	virtual void DumpJsonReport(misc::JsonWriter &json) const { }
+
 	/// Return the cycle when a timing simulation last happened for this
 	/// architecture, as set by setLastSimulationCycle().
 	long long getLastSimulationCycle() const { return last_simulation_cycle; }
@@ -624,6 +624,8 @@ int Driver::CallNDRangeCreate(comm::Context *context,
 	 	gpu->MapNDRange(ndrange);
 		ndrange->address_space = gpu->getMmu()
 				->newSpace("Southern Islands");
+		ndrange->instruction_address_space = gpu->getMmu()
+				->newSpace("Southern Islands Instructions");
 	}
 	
 	// Return ID of new nd-range 
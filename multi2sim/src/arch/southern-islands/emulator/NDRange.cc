@@ -152,6 +152,9 @@ void NDRange::InitializeFromKernel(Kernel *kernel)
 	// Get SI encoding dictionary
 	BinaryDictEntry *si_enc = kernel->getKernelBinaryFile()->GetSIDictEntry();
 
+	// Save kernel name
+	kernel_name = kernel->getName();
+
 	// Initialize registers and local memory requirements 
 	local_mem_top = kernel->getLocalMemorySize();
 	num_sgpr_used = si_enc->num_sgpr;
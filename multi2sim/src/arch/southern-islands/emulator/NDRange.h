@@ -155,6 +155,9 @@ private:
 	unsigned user_element_count = 0;
 	BinaryUserElement user_elements[BinaryMaxUserElements];
 
+	// Name of the kernel that the ND-Range runs
+	std::string kernel_name;
+
 	// Instruction memory containing Southern Islands ISA
 	std::unique_ptr<mem::Memory> instruction_memory;
 	std::unique_ptr<char[]> instruction_buffer;
@@ -215,6 +218,10 @@ public:
 	// Associated memory address space
 	mem::Mmu::Space *address_space = nullptr;
 
+	// Memory address space for the kernel instructions, used by the timing
+	// simulator to fetch instructions through the instruction caches
+	mem::Mmu::Space *instruction_address_space = nullptr;
+
 	/// Constructor
 	NDRange();
 
@@ -327,6 +334,9 @@ public:
 	/// Get id of NDRange
 	int getId() const { return id; }
 
+	/// Return the name of the kernel that the ND-Range runs
+	const std::string &getKernelName() const { return kernel_name; }
+
 	/// Get index of scalar register which stores workgroup id
 	unsigned getWorkgroupIdSreg() const { return wg_id_sgpr; }
 
@@ -0,0 +1,104 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "StoreBuffer.h"
+
+
+namespace SI
+{
+
+void StoreBuffer::Write(mem::Memory *memory, unsigned address, unsigned size,
+		const char *buffer)
+{
+	// Update youngest value of each byte
+	for (unsigned i = 0; i < size; i++)
+	{
+		unsigned byte_address = address + i;
+		unsigned offset = byte_address % WordSize;
+		Word &word = words[std::make_pair(memory,
+				byte_address - offset)];
+		word.bytes[offset] = buffer[i];
+		word.mask |= 1 << offset;
+	}
+}
+
+
+void StoreBuffer::Read(mem::Memory *memory, unsigned address, unsigned size,
+		char *buffer) const
+{
+	// Read from memory first
+	memory->Read(address, size, buffer);
+
+	// Forward buffered bytes
+	if (words.empty() || !size)
+		return;
+	unsigned first_word = address - address % WordSize;
+	unsigned last_word = address + size - 1;
+	last_word -= last_word % WordSize;
+	for (unsigned word_address = first_word; word_address <= last_word;
+			word_address += WordSize)
+	{
+		auto it = words.find(std::make_pair(memory, word_address));
+		if (it == words.end())
+			continue;
+		const Word &word = it->second;
+		for (unsigned offset = 0; offset < WordSize; offset++)
+		{
+			unsigned byte_address = word_address + offset;
+			if ((word.mask & (1 << offset)) &&
+					byte_address >= address &&
+					byte_address - address < size)
+				buffer[byte_address - address] =
+						word.bytes[offset];
+		}
+	}
+}
+
+
+void StoreBuffer::Commit()
+{
+	// Write each word to memory, or its written bytes if it was only
+	// partially written
+	for (auto &it : words)
+	{
+		mem::Memory *memory = it.first.first;
+		unsigned word_address = it.first.second;
+		Word &word = it.second;
+		if (word.mask == (1 << WordSize) - 1)
+		{
+			memory->Write(word_address, WordSize, word.bytes);
+			continue;
+		}
+		for (unsigned offset = 0; offset < WordSize; offset++)
+			if (word.mask & (1 << offset))
+				memory->Write(word_address + offset, 1,
+						word.bytes + offset);
+	}
+
+	// Empty buffer
+	Clear();
+}
+
+
+void StoreBuffer::Clear()
+{
+	words.clear();
+}
+
+}  // namespace SI
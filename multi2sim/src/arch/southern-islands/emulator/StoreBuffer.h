@@ -0,0 +1,81 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_SOUTHERN_ISLANDS_EMU_STORE_BUFFER_H
+#define ARCH_SOUTHERN_ISLANDS_EMU_STORE_BUFFER_H
+
+#include <map>
+#include <utility>
+
+#include <memory/Memory.h>
+
+
+namespace SI
+{
+
+/// Buffer holding the memory writes performed by a wavefront while it runs
+/// speculatively. Writes are kept out of memory until the buffer is
+/// committed, and are simply dropped if the speculation is squashed. Reads
+/// performed while the buffer is in use see the buffered data.
+class StoreBuffer
+{
+	// Size in bytes of the words tracked by the buffer
+	static const unsigned WordSize = 4;
+
+	// Youngest value of the bytes written in one aligned word
+	struct Word
+	{
+		// Bytes of the word
+		char bytes[WordSize];
+
+		// Bit i is set if byte i was written
+		unsigned char mask = 0;
+	};
+
+	// Words written, indexed by memory and word-aligned address
+	std::map<std::pair<mem::Memory *, unsigned>, Word> words;
+
+public:
+
+	/// Buffer a write of \a size bytes from \a buffer into \a memory
+	void Write(mem::Memory *memory, unsigned address, unsigned size,
+			const char *buffer);
+
+	/// Read \a size bytes from \a memory into \a buffer, forwarding any
+	/// bytes written by buffered stores.
+	void Read(mem::Memory *memory, unsigned address, unsigned size,
+			char *buffer) const;
+
+	/// Apply all buffered writes to memory, and empty the buffer. Each
+	/// byte takes the value of the youngest write to it.
+	void Commit();
+
+	/// Discard all buffered writes
+	void Clear();
+
+	/// Return whether there are no buffered writes
+	bool isEmpty() const { return words.empty(); }
+
+	/// Return the number of words with buffered data
+	int getNumWords() const { return words.size(); }
+};
+
+}  // namespace SI
+
+#endif
@@ -17,6 +17,9 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <cstring>
+
 #include <arch/southern-islands/disassembler/Disassembler.h>
 #include <arch/southern-islands/disassembler/Instruction.h>
 #include <lib/cpp/Debug.h>
@@ -111,6 +114,10 @@ Wavefront::Wavefront(WorkGroup *work_group, int id)
 	this->work_group = work_group;
 	this->id = id;
 
+	// Scalar registers start cleared, so that bitmask writes to VCC or
+	// EXEC do not leave stale bits in the lanes they do not update.
+	memset(sreg, 0, sizeof sreg);
+
 	// Integer inline constants.
 	for(int i = 128; i < 193; i++)
 		sreg[i].as_int = i - 128;
@@ -200,6 +207,13 @@ void Wavefront::Execute()
 	Instruction::Bytes *bytes = instruction->getBytes();
 	int op = instruction->getOp();
 
+	// Instructions affecting other wavefronts cannot be rolled back
+	if (checkpoint_active && (opcode == Instruction::Opcode_S_ENDPGM ||
+			opcode == Instruction::Opcode_S_BARRIER))
+		throw misc::Panic(misc::fmt("Wavefront %d: instruction '%s' "
+				"executed with an active checkpoint",
+				id, instruction->getName()));
+
 	// Create stringstream for debugging
 	std::stringstream ss;
 
@@ -783,6 +797,71 @@ void Wavefront::Execute()
 }
 
 
+void Wavefront::Checkpoint()
+{
+	// Only one level of checkpoints is supported
+	assert(!checkpoint_active);
+	assert(!finished);
+	assert(store_buffer.isEmpty());
+	checkpoint_active = true;
+
+	// Save state of the wavefront
+	checkpoint_pc = pc;
+	std::copy(sreg, sreg + 256, checkpoint_sreg);
+	checkpoint_vm_cnt = vm_cnt;
+	checkpoint_exp_cnt = exp_cnt;
+	checkpoint_lgkm_cnt = lgkm_cnt;
+}
+
+
+void Wavefront::CommitCheckpoint()
+{
+	// Make memory writes visible
+	assert(checkpoint_active);
+	checkpoint_active = false;
+	store_buffer.Commit();
+
+	// Forget saved vector registers
+	for (auto it = work_items_begin, e = work_items_end; it != e; ++it)
+		(*it)->DiscardCheckpoint();
+}
+
+
+void Wavefront::RollbackCheckpoint()
+{
+	// Discard memory writes
+	assert(checkpoint_active);
+	checkpoint_active = false;
+	store_buffer.Clear();
+
+	// Restore state of the wavefront
+	pc = checkpoint_pc;
+	std::copy(checkpoint_sreg, checkpoint_sreg + 256, sreg);
+	vm_cnt = checkpoint_vm_cnt;
+	exp_cnt = checkpoint_exp_cnt;
+	lgkm_cnt = checkpoint_lgkm_cnt;
+
+	// Restore vector registers
+	for (auto it = work_items_begin, e = work_items_end; it != e; ++it)
+		(*it)->RestoreCheckpoint();
+}
+
+
+bool Wavefront::isNextInstructionSerializing() const
+{
+	// Decode instruction at the current PC
+	NDRange *ndrange = work_group->getNDRange();
+	assert(pc < ndrange->getInstructionBufferSize());
+	Instruction next_instruction;
+	next_instruction.Decode(ndrange->getInstructionBuffer() + pc, pc);
+
+	// Check opcode
+	Instruction::Opcode opcode = next_instruction.getOpcode();
+	return opcode == Instruction::Opcode_S_ENDPGM ||
+			opcode == Instruction::Opcode_S_BARRIER;
+}
+
+
 bool Wavefront::isWorkItemActive(int id_in_wavefront)
 {
 	int mask = 1;
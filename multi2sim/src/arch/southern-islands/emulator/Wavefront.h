@@ -24,6 +24,7 @@
 #include <vector>
 
 #include <arch/southern-islands/disassembler/Instruction.h>
+#include <arch/southern-islands/emulator/StoreBuffer.h>
 #include <arch/southern-islands/emulator/WorkItem.h>
 
 namespace SI
@@ -95,6 +96,21 @@ class Wavefront
 	// Fields introduced for timing simulation
 	bool barrier_instruction = false;
 
+	// Whether a checkpoint is active, see Checkpoint()
+	bool checkpoint_active = false;
+
+	// State saved when the checkpoint was taken. Scalar registers are
+	// copied as a whole, while vector registers are saved by each
+	// work-item the first time they are written.
+	unsigned checkpoint_pc = 0;
+	Instruction::Register checkpoint_sreg[256];
+	int checkpoint_vm_cnt = 0;
+	int checkpoint_exp_cnt = 0;
+	int checkpoint_lgkm_cnt = 0;
+
+	// Memory writes performed since the checkpoint was taken
+	StoreBuffer store_buffer;
+
 
 
 
@@ -421,6 +437,43 @@ public:
 	/// position of the program counter
 	void Execute();	
 
+
+
+	//
+	// Checkpoints
+	//
+
+	/// Save the architectural state of the wavefront, so that the
+	/// instructions executed from now on can be squashed later with
+	/// RollbackCheckpoint(), or made permanent with CommitCheckpoint().
+	/// While the checkpoint is active, global memory and LDS writes are
+	/// kept in a store buffer, and vector registers are saved lazily the
+	/// first time each work-item writes them.
+	void Checkpoint();
+
+	/// Make the instructions executed since the last checkpoint permanent,
+	/// writing buffered stores to memory in program order.
+	void CommitCheckpoint();
+
+	/// Squash the instructions executed since the last checkpoint,
+	/// restoring registers and the program counter, and discarding
+	/// buffered stores.
+	void RollbackCheckpoint();
+
+	/// Return whether a checkpoint is active
+	bool hasCheckpoint() const { return checkpoint_active; }
+
+	/// Return the store buffer holding memory writes performed since the
+	/// last checkpoint.
+	StoreBuffer *getStoreBuffer() { return &store_buffer; }
+
+	/// Return whether the instruction at the current program counter has
+	/// effects on other wavefronts of the work-group (a barrier or the end
+	/// of the program). Such an instruction cannot be executed while a
+	/// checkpoint is active, since rolling it back would require undoing
+	/// state outside of the wavefront.
+	bool isNextInstructionSerializing() const;
+
 	/// Return an iterator to the first work-item in the wavefront. The
 	/// work-items can be conveniently traversed with a loop using these
 	/// iterators. This is an example of how to dump all work-items in the
@@ -446,6 +499,9 @@ public:
 	/// Return a new unique sequential identifier for a uop associated with
 	/// the wavefront. This function is used by the timing simulator.
 	long long getUopId() { return ++uop_id_counter; }
+
+	/// Return the identifier of the last uop created for the wavefront
+	long long getLastUopId() const { return uop_id_counter; }
 };
 
 
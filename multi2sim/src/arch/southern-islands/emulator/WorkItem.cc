@@ -290,6 +290,15 @@ void WorkItem::WriteVReg(int vreg,
 {
 	assert(vreg >= 0);
 	assert(vreg < 256);
+
+	// Save old value the first time the register is written after a
+	// checkpoint
+	if (wavefront->hasCheckpoint() && !checkpoint_saved_vregs[vreg])
+	{
+		checkpoint_saved_vregs.set(vreg);
+		checkpoint_vregs.emplace_back(vreg, this->vreg[vreg].as_uint);
+	}
+
 	this->vreg[vreg].as_uint = value;
 
 	// Statistics
@@ -375,4 +384,44 @@ void WorkItem::ReadMemPtr(
 }
 
 
+
+void WorkItem::ReadMemory(mem::Memory *memory, unsigned address,
+		unsigned size, char *buffer)
+{
+	if (wavefront->hasCheckpoint())
+		wavefront->getStoreBuffer()->Read(memory, address, size, buffer);
+	else
+		memory->Read(address, size, buffer);
+}
+
+
+void WorkItem::WriteMemory(mem::Memory *memory, unsigned address,
+		unsigned size, const char *buffer)
+{
+	if (wavefront->hasCheckpoint())
+		wavefront->getStoreBuffer()->Write(memory, address, size, buffer);
+	else
+		memory->Write(address, size, buffer);
+}
+
+
+void WorkItem::RestoreCheckpoint()
+{
+	// Restore in reverse order of first write. Each register appears
+	// only once, so the order is not strictly needed.
+	for (auto it = checkpoint_vregs.rbegin(), e = checkpoint_vregs.rend();
+			it != e;
+			++it)
+		vreg[it->first].as_uint = it->second;
+	DiscardCheckpoint();
+}
+
+
+void WorkItem::DiscardCheckpoint()
+{
+	checkpoint_saved_vregs.reset();
+	checkpoint_vregs.clear();
+}
+
+
 }  // namespace SI
@@ -20,6 +20,10 @@
 #ifndef ARCH_SOUTHERN_ISLANDS_EMU_WORK_ITEM_H
 #define ARCH_SOUTHERN_ISLANDS_EMU_WORK_ITEM_H
 
+#include <bitset>
+#include <utility>
+#include <vector>
+
 #include <arch/southern-islands/disassembler/Instruction.h>
 #include <memory/Memory.h>
 
@@ -196,6 +200,22 @@ private:
 	// Vector registers
 	Instruction::Register vreg[256];
 
+	// Vector registers written since the wavefront took a checkpoint,
+	// and their values at the time of the checkpoint, in the order in
+	// which they were first written.
+	std::bitset<256> checkpoint_saved_vregs;
+	std::vector<std::pair<int, unsigned>> checkpoint_vregs;
+
+	// Read from global memory or LDS, forwarding data from the store
+	// buffer of the wavefront if it has an active checkpoint.
+	void ReadMemory(mem::Memory *memory, unsigned address, unsigned size,
+			char *buffer);
+
+	// Write to global memory or LDS, or to the store buffer of the
+	// wavefront if it has an active checkpoint.
+	void WriteMemory(mem::Memory *memory, unsigned address, unsigned size,
+			const char *buffer);
+
 	// Emulation of ISA. This code expands to one function per ISA
 	// instruction. For example: ISA_s_mov_b32_Impl(Instruction *inst)
 #define DEFINST(_name, _fmt_str, _fmt, _opcode, _size, _flags) \
@@ -438,6 +458,16 @@ public:
 	///
 	void ReadMemPtr(int sreg, MemoryPointer &memory_pointer);
 
+	/// Restore the vector registers written since the wavefront took its
+	/// last checkpoint. This function is invoked by the wavefront when
+	/// rolling back a checkpoint.
+	void RestoreCheckpoint();
+
+	/// Forget the values saved for the last checkpoint of the wavefront.
+	/// This function is invoked by the wavefront when committing a
+	/// checkpoint.
+	void DiscardCheckpoint();
+
 };
 
 }  // namespace SI
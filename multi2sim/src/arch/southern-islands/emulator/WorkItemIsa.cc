@@ -74,7 +74,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORD_Impl(Instruction *instruction)
 
 	// Read value from global memory
 	Instruction::Register value;
-	global_mem->Read(addr, 4, (char *)&value);
+	ReadMemory(global_mem, addr, 4, (char *)&value);
 
 	// Store the data in the destination register
 	WriteSReg(INST.sdst, value.as_uint);
@@ -110,7 +110,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX2_Impl(Instruction *instruction)
 	for (int i = 0; i < 2; i++)
 	{
 		// Read value from global memory
-		global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+		ReadMemory(global_mem, addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -153,7 +153,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX4_Impl(Instruction *instruction)
 	for (int i = 0; i < 4; i++)
 	{
 		// Read value from global memory
-		global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+		ReadMemory(global_mem, addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -195,7 +195,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX8_Impl(Instruction *instruction)
 	for (int i = 0; i < 8; i++)
 	{
 		// Read value from global memory
-		global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+		ReadMemory(global_mem, addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -237,7 +237,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX16_Impl(Instruction *instruction)
 	for (int i = 0; i < 16; i++)
 	{
 		// Read value from global memory
-		global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+		ReadMemory(global_mem, addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -284,7 +284,7 @@ void WorkItem::ISA_S_LOAD_DWORDX2_Impl(Instruction *instruction)
 	for (int i = 0; i < 2; i++)
 	{
 		// Read value from global memory		
-		global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+		ReadMemory(global_mem, m_addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -330,7 +330,7 @@ void WorkItem::ISA_S_LOAD_DWORDX4_Impl(Instruction *instruction)
 	for (int i = 0; i < 4; i++)
 	{
 		// Read value from global memory		
-		global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+		ReadMemory(global_mem, m_addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -377,7 +377,7 @@ void WorkItem::ISA_S_LOAD_DWORDX8_Impl(Instruction *instruction)
 	for (int i = 0; i < 8; i++)
 	{
 		// Read value from global memory		
-		global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+		ReadMemory(global_mem, m_addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -424,7 +424,7 @@ void WorkItem::ISA_S_LOAD_DWORDX16_Impl(Instruction *instruction)
 	for (int i = 0; i < 16; i++)
 	{
 		// Read value from global memory		
-		global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+		ReadMemory(global_mem, m_addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -2351,7 +2351,7 @@ void WorkItem::ISA_V_CVT_I32_F32_Impl(Instruction *instruction)
 	else if (std::isinf(fvalue) || fvalue < std::numeric_limits<int>::min())
 		value.as_int = std::numeric_limits<int>::min();
 	// NaN, 0, -0 --> 0
-	else if (isnan(fvalue) || fvalue == 0.0f || fvalue == -0.0f)
+	else if (std::isnan(fvalue) || fvalue == 0.0f || fvalue == -0.0f)
 		value.as_int = 0;
 	else
 		value.as_int = (int) fvalue;
@@ -6260,11 +6260,11 @@ void WorkItem::ISA_V_INTERP_P1_F32_Impl(Instruction *instruction)
 
 	// 12 successive dwords contain P0 P10 P20
 	// 4dwords P0: X Y Z W, INST.attrchan decides which 1dword to be loaded
-	lds->Read( 
+	ReadMemory(lds,
 		m0_vintrp.for_vintrp.lds_param_offset + 0 + 4 * INST.attrchan ,
 		 4, (char *)&p0.as_uint);
 	// 4dwords P10: X Y Z W, INST.attrchan decides which 1dword to be loaded
-	lds->Read( 
+	ReadMemory(lds,
 		m0_vintrp.for_vintrp.lds_param_offset + 16 + 4 * INST.attrchan,
 		 4, (char *)&p10.as_uint);
 
@@ -6319,7 +6319,7 @@ void WorkItem::ISA_V_INTERP_P2_F32_Impl(Instruction *instruction)
 
 	// 12 successive dwords contain P0 P10 P20
 	// 4dwords P20: X Y Z W, INST.attrchan decides which 1dword to be loaded 
-	lds->Read( m0_vintrp.for_vintrp.lds_param_offset + 32 + 4 * INST.attrchan,
+	ReadMemory(lds, m0_vintrp.for_vintrp.lds_param_offset + 32 + 4 * INST.attrchan,
 		 4, (char *)&p20.as_uint);
 
 	// D = P20 * S + D
@@ -6405,9 +6405,9 @@ void WorkItem::ISA_DS_WRITE2_B32_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Write(addr0.as_uint, 4,
+		WriteMemory(lds, addr0.as_uint, 4,
 			(char *)&data0.as_uint);
-		lds->Write(addr1.as_uint, 4,
+		WriteMemory(lds, addr1.as_uint, 4,
 			(char *)&data1.as_uint);
 	}
 
@@ -6479,7 +6479,7 @@ void WorkItem::ISA_DS_WRITE_B32_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Write(addr.as_uint, 4, 
+		WriteMemory(lds, addr.as_uint, 4, 
 			(char *)&data0.as_uint);
 	}
 
@@ -6535,7 +6535,7 @@ void WorkItem::ISA_DS_WRITE_B8_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Write(addr.as_uint, 1, 
+		WriteMemory(lds, addr.as_uint, 1, 
 			(char *)data0.as_ubyte);
 	}
 
@@ -6591,7 +6591,7 @@ void WorkItem::ISA_DS_WRITE_B16_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Write(addr.as_uint, 2, 
+		WriteMemory(lds, addr.as_uint, 2, 
 			(char *)data0.as_ushort);
 	}
 
@@ -6647,7 +6647,7 @@ void WorkItem::ISA_DS_READ_B32_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Read(addr.as_uint, 4,
+		ReadMemory(lds, addr.as_uint, 4,
 			(char *)&data.as_uint);
 	}
 
@@ -6700,9 +6700,9 @@ void WorkItem::ISA_DS_READ2_B32_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Read(
+		ReadMemory(lds,
 			addr.as_uint + INST.offset0*4, 4, (char *)&data0.as_uint);
-		lds->Read(
+		ReadMemory(lds,
 			addr.as_uint + INST.offset1*4, 4, (char *)&data1.as_uint);
 	}
 
@@ -6765,7 +6765,7 @@ void WorkItem::ISA_DS_READ_I8_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Read(addr.as_uint, 1,
+		ReadMemory(lds, addr.as_uint, 1,
 			&data.as_byte[0]);
 	}
 
@@ -6821,7 +6821,7 @@ void WorkItem::ISA_DS_READ_U8_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Read(addr.as_uint, 1,
+		ReadMemory(lds, addr.as_uint, 1,
 			(char *)&data.as_ubyte[0]);
 	}
 
@@ -6877,7 +6877,7 @@ void WorkItem::ISA_DS_READ_I16_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Read(addr.as_uint, 2, (char *)&data.as_short[0]);
+		ReadMemory(lds, addr.as_uint, 2, (char *)&data.as_short[0]);
 	}
 
 	// Extend the sign.
@@ -6933,7 +6933,7 @@ void WorkItem::ISA_DS_READ_U16_Impl(Instruction *instruction)
 	}
 	else
 	{
-		lds->Read(addr.as_uint, 2,
+		ReadMemory(lds, addr.as_uint, 2,
 			(char *)&data.as_ushort[0]);
 	}
 
@@ -7021,7 +7021,7 @@ void WorkItem::ISA_BUFFER_LOAD_SBYTE_Impl(Instruction *instruction)
 		stride * (idx_vgpr + id_in_wavefront);
 
 	
-	global_mem->Read(addr, bytes_to_read, (char *)&value);
+	ReadMemory(global_mem, addr, bytes_to_read, (char *)&value);
 	
 	// Sign extend
 	value.as_int = (int) value.as_byte[0];
@@ -7091,7 +7091,7 @@ void WorkItem::ISA_BUFFER_LOAD_DWORD_Impl(Instruction *instruction)
 		stride * (idx_vgpr + id_in_wavefront);
 
 	
-	global_mem->Read(addr, bytes_to_read, (char *)&value);
+	ReadMemory(global_mem, addr, bytes_to_read, (char *)&value);
 	
 	// Sign extend
 	value.as_int = (int) value.as_byte[0];
@@ -7166,7 +7166,7 @@ void WorkItem::ISA_BUFFER_STORE_BYTE_Impl(Instruction *instruction)
 
 	value.as_int = ReadVReg(INST.vdata);
 
-	global_mem->Write(addr, bytes_to_write, (char *)&value);
+	WriteMemory(global_mem, addr, bytes_to_write, (char *)&value);
 	
 	// Sign extend
 	//value.as_int = (int) value.as_byte[0];
@@ -7241,7 +7241,7 @@ void WorkItem::ISA_BUFFER_STORE_DWORD_Impl(Instruction *instruction)
 
 	value.as_int = ReadVReg(INST.vdata);
 
-	global_mem->Write(addr, bytes_to_write, (char *)&value);
+	WriteMemory(global_mem, addr, bytes_to_write, (char *)&value);
 	
 	// Record last memory access for the detailed simulator.
 	global_memory_access_address = addr;
@@ -7320,14 +7320,14 @@ void WorkItem::ISA_BUFFER_ATOMIC_ADD_Impl(Instruction *instruction)
 
 	// Read existing value from global memory
 	
-	global_mem->Read(addr, bytes_to_read, prev_value.as_byte);
+	ReadMemory(global_mem, addr, bytes_to_read, prev_value.as_byte);
 
 	// Read value to add to existing value from a register
 	value.as_int = ReadVReg(INST.vdata);
 
 	// Compute and store the updated value
 	value.as_int += prev_value.as_int;
-	global_mem->Write(addr, bytes_to_write, (char *)&value);
+	WriteMemory(global_mem, addr, bytes_to_write, (char *)&value);
 	
 	// If glc bit set, return the previous value in a register
 	if (INST.glc)
@@ -7410,7 +7410,7 @@ void WorkItem::ISA_TBUFFER_LOAD_FORMAT_X_Impl(Instruction *instruction)
 		stride * (idx_vgpr + 0/*work_item->id_in_wavefront*/);
 
 	
-	global_mem->Read(addr, bytes_to_read, (char *)&value);
+	ReadMemory(global_mem, addr, bytes_to_read, (char *)&value);
 
 	WriteVReg(INST.vdata, value.as_uint);
 
@@ -7492,7 +7492,7 @@ void WorkItem::ISA_TBUFFER_LOAD_FORMAT_XY_Impl(Instruction *instruction)
 	for (i = 0; i < 2; i++)
 	{
 		
-		global_mem->Read(addr+4*i, 4, (char *)&value);
+		ReadMemory(global_mem, addr+4*i, 4, (char *)&value);
 
 		WriteVReg(INST.vdata + i, value.as_uint);
 
@@ -7580,7 +7580,7 @@ void WorkItem::ISA_TBUFFER_LOAD_FORMAT_XYZW_Impl(Instruction *instruction)
 	for (i = 0; i < 4; i++)
 	{
 		
-		global_mem->Read(addr+4*i, 4, (char *)&value);
+		ReadMemory(global_mem, addr+4*i, 4, (char *)&value);
 
 		WriteVReg(INST.vdata + i, value.as_uint);
 
@@ -7652,7 +7652,7 @@ void WorkItem::ISA_TBUFFER_STORE_FORMAT_X_Impl(Instruction *instruction)
 
 	value.as_uint = ReadVReg(INST.vdata);
 
-	global_mem->Write(addr, bytes_to_write, (char *)&value);
+	WriteMemory(global_mem, addr, bytes_to_write, (char *)&value);
 
 	// Record last memory access for the detailed simulator.
 	global_memory_access_address = addr;
@@ -7724,7 +7724,7 @@ void WorkItem::ISA_TBUFFER_STORE_FORMAT_XY_Impl(Instruction *instruction)
 	{
 		value.as_uint = ReadVReg(INST.vdata + i);
 
-		global_mem->Write(addr+4*i, 4, (char *)&value);
+		WriteMemory(global_mem, addr+4*i, 4, (char *)&value);
 
 		// TODO Print value based on type
 		if (Emulator::isa_debug)
@@ -7797,7 +7797,7 @@ void WorkItem::ISA_TBUFFER_STORE_FORMAT_XYZW_Impl(Instruction *instruction)
 	{
 		value.as_uint = ReadVReg(INST.vdata + i);
 
-		global_mem->Write(addr+4*i, 4, (char *)&value);
+		WriteMemory(global_mem, addr+4*i, 4, (char *)&value);
 
 		// TODO Print value based on type
 		if (Emulator::isa_debug)
@@ -73,9 +73,8 @@ void BranchUnit::Issue(std::unique_ptr<Uop> uop)
 
 void BranchUnit::Complete()
 {
-	// Get compute unit and GPU objects
+	// Get compute unit object
 	ComputeUnit *compute_unit = getComputeUnit();
-	Gpu *gpu = compute_unit->getGpu();
 
 	// Sanity check the write buffer
 	assert((int) write_buffer.size() <= write_latency * width);
@@ -105,17 +104,23 @@ void BranchUnit::Complete()
 		compute_unit->getScoreboard(uop->getWavefrontPoolId())->
 			ReleaseRegisters(uop->getWavefront(), uop);
 
-		// Access complete, remove the uop from the queue, and get the
-		// iterator for the next element
-		it = write_buffer.erase(it);
+		// Access complete
 		assert(uop->getWorkGroup()
 				->inflight_instructions > 0);
 		uop->getWorkGroup()->
 				inflight_instructions--;
 
+		// Latency from issue to completion
+		compute_unit->RecordUopLatency(uop);
+
+		// Remove the uop from the queue, and get the iterator for the
+		// next element
+		it = write_buffer.erase(it);
+
 		// Statistics
 		num_instructions++;
-		gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+		compute_unit->last_complete_cycle = compute_unit->getTiming()->
+				getCycle();
 	}
 }
 
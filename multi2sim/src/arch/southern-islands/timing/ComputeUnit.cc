@@ -83,6 +83,43 @@ ComputeUnit::ComputeUnit(int index, Gpu *gpu) :
 }
 
 
+std::unique_ptr<Uop> ComputeUnit::NewUop(Wavefront *wavefront,
+		WavefrontPoolEntry *wavefront_pool_entry,
+		int wavefront_pool_id,
+		long long pc)
+{
+	// Allocate uop in the pool
+	std::unique_ptr<Uop> uop(new (uop_pool) Uop(
+			wavefront,
+			wavefront_pool_entry,
+			timing->getCycle(),
+			wavefront->getWorkGroup(),
+			wavefront_pool_id));
+
+	// Copy instruction flags
+	uop->vector_memory_read = wavefront->vector_memory_read;
+	uop->vector_memory_write = wavefront->vector_memory_write;
+	uop->vector_memory_atomic = wavefront->vector_memory_atomic;
+	uop->scalar_memory_read = wavefront->scalar_memory_read;
+	uop->lds_read = wavefront->lds_read;
+	uop->lds_write = wavefront->lds_write;
+	uop->wavefront_last_instruction = wavefront->finished;
+	uop->memory_wait = wavefront->memory_wait;
+	uop->at_barrier = wavefront->isBarrierInstruction();
+	uop->setInstruction(wavefront->getInstruction());
+	uop->vector_memory_global_coherency =
+			wavefront->vector_memory_global_coherency;
+	uop->lgkm_cnt = wavefront->getLgkmcnt();
+	uop->vm_cnt = wavefront->getVmcnt();
+	uop->exp_cnt = wavefront->getExpcnt();
+	uop->setPC(pc);
+
+	// Per-work-item memory accesses, only for memory instructions
+	uop->CaptureWorkItemInfo();
+	return uop;
+}
+
+
 void ComputeUnit::IssueToExecutionUnit(FetchBuffer *fetch_buffer,
 		ExecutionUnit *execution_unit, int index, int &instruction_issued)
 {
@@ -101,29 +138,8 @@ void ComputeUnit::IssueToExecutionUnit(FetchBuffer *fetch_buffer,
 		//Issue to execution unit, erase from fetch buffer
 		execution_unit->Issue(std::move(*it));
 
-
-/*		/// test
-		//if (fetch_buffer->getId() == 0 && uop->getComputeUnit()->getIndex() == 0)
-		if (uop->getComputeUnit()->getIndex() == 0)
-		{
-			//if (uop->getWavefront()->getId() <=3 )
-				std::cout<<"Wavefront ID  "<<uop->getWavefront()->getId()<<
-				" Issue pc" << uop->getPC() <<"in cycle"<<
-						timing->getCycle()<<std::endl;
-		}
-
-*/
 		fetch_buffer->Remove(index,it);
 
-/*		/// test
-		if (uop->getWavefront()->getId() == 0)
-		{
-			uop->getWavefront()->num_issued_instructions++;
-			std::cout<<"number of issued instructions " <<
-					uop->getWavefront()->num_issued_instructions << "in cycle"
-					<<timing->getCycle() <<"PC"<<uop->getPC()<<std::endl;
-		}
-*/
 		// Issue successfully, set flag to 1
 		instruction_issued = 1;
 
@@ -1081,10 +1097,13 @@ void ComputeUnit::Issue(FetchBuffer *fetch_buffer,
 				// Add the index to speculation list
 				wavefront_pool->push_backSpeculationList(value);
 			}
-			std::cout<<"!!!!!"<<wavefront_pool->getNormalListSize()<<"in cycle "<<timing->getCycle()
-					<<std::endl;
-			std::cout<<"!!!!!"<<wavefront_pool->getSpeculationListSize()<<"in cycle "<<timing->getCycle()
-					<<std::endl;
+			Timing::pipeline_debug << misc::fmt("cu=%d "
+					"normal_to_speculation "
+					"normal=%d speculation=%d cycle=%lld\n",
+					index,
+					wavefront_pool->getNormalListSize(),
+					wavefront_pool->getSpeculationListSize(),
+					timing->getCycle());
 		}
 
 		if (speculation_to_normal_value.size() > 0)
@@ -1103,10 +1122,13 @@ void ComputeUnit::Issue(FetchBuffer *fetch_buffer,
 				wavefront_pool->push_backNormalList(value);
 			}
 
-			std::cout<<"*****"<<wavefront_pool->getNormalListSize()<<"in cycle "<<timing->getCycle()
-							<<std::endl;
-			std::cout<<"*****"<<wavefront_pool->getSpeculationListSize()<<"in cycle "<<timing->getCycle()
-							<<std::endl;
+			Timing::pipeline_debug << misc::fmt("cu=%d "
+					"speculation_to_normal "
+					"normal=%d speculation=%d cycle=%lld\n",
+					index,
+					wavefront_pool->getNormalListSize(),
+					wavefront_pool->getSpeculationListSize(),
+					timing->getCycle());
 		}
 
 		int last_issued_normal_list_index =
@@ -1137,6 +1159,117 @@ void ComputeUnit::Issue(FetchBuffer *fetch_buffer,
 }
 
 
+bool ComputeUnit::FetchInstructionBlock(
+		WavefrontPoolEntry *wavefront_pool_entry,
+		Wavefront *wavefront,
+		bool speculative)
+{
+	// Instruction fetch is not modeled through the memory hierarchy
+	if (!instruction_cache)
+		return true;
+
+	// Block containing the next instruction of the wavefront
+	NDRange *ndrange = wavefront->getWorkGroup()->getNDRange();
+	unsigned address = ndrange->getInstructionAddress() + wavefront->getPC();
+	unsigned block_address = address &
+			~(instruction_cache->getBlockSize() - 1);
+
+	// The block is already in the instruction buffer, or on its way
+	if (wavefront_pool_entry->instruction_buffer_block == block_address)
+	{
+		if (!wavefront_pool_entry->instruction_buffer_witness)
+			return true;
+
+		num_instruction_fetch_stalls++;
+		return false;
+	}
+
+	// Translate address. Instructions live in an address space separate
+	// from the data of the ND-Range.
+	assert(ndrange->instruction_address_space);
+	unsigned physical_address = gpu->getMmu()->TranslateVirtualAddress(
+			ndrange->instruction_address_space,
+			address);
+
+	// The instruction cache must be able to accept a new access
+	if (!instruction_cache->canAccess(physical_address))
+	{
+		num_instruction_fetch_stalls++;
+		return false;
+	}
+
+	// Probe the cache to classify the access for statistics
+	int set;
+	int way;
+	int tag;
+	mem::Cache::BlockState state;
+	bool hit = instruction_cache->FindBlock(physical_address, set, way,
+			tag, state);
+	num_instruction_cache_accesses++;
+	num_instruction_cache_misses += !hit;
+	if (speculative)
+	{
+		num_speculative_instruction_cache_accesses++;
+		num_speculative_instruction_cache_misses += !hit;
+	}
+
+	// Fill the instruction buffer. The front-end runs sequentially across
+	// compute units, so the access can be submitted right away.
+	wavefront_pool_entry->instruction_buffer_block = block_address;
+	wavefront_pool_entry->instruction_buffer_witness--;
+	instruction_cache->Access(mem::Module::AccessLoad, physical_address,
+			&wavefront_pool_entry->instruction_buffer_witness);
+	return false;
+}
+
+
+void ComputeUnit::SquashPreExecution(WavefrontPoolEntry *wavefront_pool_entry,
+		int wavefront_pool_id,
+		int index)
+{
+	Wavefront *wavefront = wavefront_pool_entry->getWavefront();
+	assert(wavefront->hasCheckpoint());
+
+	// Discard pre-executed uops emulated after the checkpoint
+	FetchBuffer *pre_execution_buffer = pre_execution_buffers
+			[wavefront_pool_id].get();
+	for (auto it = pre_execution_buffer->begin(index);
+			it != pre_execution_buffer->end(index);)
+	{
+		auto next = std::next(it);
+		if ((*it)->getIdInWavefront() >
+				wavefront_pool_entry->checkpoint_uop_id)
+			pre_execution_buffer->Remove(index, it);
+		it = next;
+	}
+
+	// Discard uops fetched after the checkpoint and not issued yet. These
+	// were counted as in flight.
+	FetchBuffer *speculation_fetch_buffer = speculation_fetch_buffers
+			[wavefront_pool_id].get();
+	for (auto it = speculation_fetch_buffer->begin(index);
+			it != speculation_fetch_buffer->end(index);)
+	{
+		auto next = std::next(it);
+		Uop *uop = it->get();
+		if (uop->getIdInWavefront() >
+				wavefront_pool_entry->checkpoint_uop_id)
+		{
+			uop->getWorkGroup()->inflight_instructions--;
+			uop->getWavefront()->inflight_instructions--;
+			speculation_fetch_buffer->Remove(index, it);
+		}
+		it = next;
+	}
+
+	// Emulate again from the checkpoint in normal mode
+	wavefront->RollbackCheckpoint();
+	wavefront_pool_entry->execution_mode = 0;
+	wavefront_pool_entry->specuation_to_normal = false;
+	num_pre_execution_squashes++;
+}
+
+
 void ComputeUnit::Fetch(FetchBuffer *fetch_buffer,
 		WavefrontPool *wavefront_pool)
 {
@@ -1276,6 +1409,15 @@ void ComputeUnit::Fetch(FetchBuffer *fetch_buffer,
 
 		if (!timing->IsHintFileEmpty())
 		{
+			// The memory wait that started pre-execution is over, so
+			// the instructions pre-executed since then are confirmed
+			if (wavefront_pool_entry->specuation_to_normal)
+			{
+				wavefront_pool_entry->specuation_to_normal = false;
+				if (wavefront->hasCheckpoint())
+					wavefront->CommitCheckpoint();
+			}
+
 			if (wavefront_pool_entry->execution_mode == 1)
 				///compare pre-execution pc to see if there is
 				// continuous instructions to execute????????????????????????
@@ -1352,74 +1494,50 @@ void ComputeUnit::Fetch(FetchBuffer *fetch_buffer,
 
 				if (target_pc >= wavefront->getPC())
 				{
+					bool instruction_buffer_ready = true;
+					bool target_fetched = false;
 					while(wavefront->getPC() <= target_pc)
 					{
+						// Stop pre-executing if the instruction is
+						// not in the instruction buffer yet
+						instruction_buffer_ready = FetchInstructionBlock(
+								wavefront_pool_entry,
+								wavefront,
+								true);
+						if (!instruction_buffer_ready)
+							break;
+
+						// Barriers and the end of the program cannot be
+						// pre-executed. Wait for the memory wait to
+						// finish instead.
+						if (wavefront->isNextInstructionSerializing())
+						{
+							instruction_buffer_ready = false;
+							break;
+						}
+
+						// Keep the state of the wavefront before its
+						// first pre-executed instruction
+						if (!wavefront->hasCheckpoint())
+						{
+							wavefront->Checkpoint();
+							wavefront_pool_entry->checkpoint_uop_id =
+									wavefront->getLastUopId();
+						}
+
 						long long pc = wavefront->getPC();
 						wavefront->Execute();
 
 						// Create uop
-						auto uop = misc::new_unique<Uop>(
-								wavefront,
-								wavefront_pool_entry,
-								timing->getCycle(),
-								wavefront->getWorkGroup(),
-								fetch_buffer->getId());
-						uop->vector_memory_read = wavefront->vector_memory_read;
-						uop->vector_memory_write = wavefront->vector_memory_write;
-						uop->vector_memory_atomic = wavefront->vector_memory_atomic;
-						uop->scalar_memory_read = wavefront->scalar_memory_read;
-						uop->lds_read = wavefront->lds_read;
-						uop->lds_write = wavefront->lds_write;
-						uop->wavefront_last_instruction = wavefront->finished;
-						uop->memory_wait = wavefront->memory_wait;
-						uop->at_barrier = wavefront->isBarrierInstruction();
-						uop->setInstruction(wavefront->getInstruction());
-						uop->vector_memory_global_coherency =
-								wavefront->vector_memory_global_coherency;
-						uop->lgkm_cnt = wavefront->getLgkmcnt();
-						uop->vm_cnt = wavefront->getVmcnt();
-						uop->exp_cnt = wavefront->getExpcnt();
-						uop->setPC(pc);
-
-						// Update last memory accesses
-						for (auto it = wavefront->getWorkItemsBegin(),
-								e = wavefront->getWorkItemsEnd();
-								it != e;
-								++it)
-						{
-							// Get work item
-							WorkItem *work_item = it->get();
-
-							// Get uop work item info
-							Uop::WorkItemInfo *work_item_info;
-							work_item_info =
-								&uop->work_item_info_list
-										[work_item->getIdInWavefront()];
-
-							// Global memory
-							work_item_info->global_memory_access_address =
-									work_item->global_memory_access_address;
-							work_item_info->global_memory_access_size =
-									work_item->global_memory_access_size;
-
-							// LDS
-							work_item_info->lds_access_count =
-								work_item->lds_access_count;
-							for (int j = 0; j < work_item->lds_access_count; j++)
-							{
-								work_item_info->lds_access[j].type =
-									work_item->lds_access[j].type;
-								work_item_info->lds_access[j].addr =
-									work_item->lds_access[j].addr;
-								work_item_info->lds_access[j].size =
-									work_item->lds_access[j].size;
-							}
-						}
+						std::unique_ptr<Uop> uop = NewUop(wavefront,
+								wavefront_pool_entry, fetch_buffer->getId(), pc);
 
 						if (uop->getPC() != target_pc )
 							pre_execution_buffer->addUop(index,std::move(uop));
 						else
 						{
+							target_fetched = true;
+
 							// Access instruction cache. Record the time when the
 							// instruction will have been fetched, as per the latency
 							// of the instruction memory.
@@ -1452,6 +1570,19 @@ void ComputeUnit::Fetch(FetchBuffer *fetch_buffer,
 								addUop(index,std::move(uop));
 						}
 					}
+
+					// Resume from the same hint in the next cycle
+					if (!instruction_buffer_ready)
+						continue;
+
+					// A branch took the pre-execution past the
+					// instruction given by the hint
+					if (!target_fetched)
+					{
+						SquashPreExecution(wavefront_pool_entry,
+								fetch_buffer->getId(), index);
+						continue;
+					}
 				}
 				else if (target_pc == 0)  /// ??????? if there is no more preexecution instruction by hint
 				{
@@ -1730,34 +1861,19 @@ void ComputeUnit::Fetch(FetchBuffer *fetch_buffer,
 				}
 				else
 				{
+					// Wait for the instruction buffer
+					if (!FetchInstructionBlock(wavefront_pool_entry,
+							wavefront, false))
+						continue;
+
 					long long pc = wavefront->getPC();
 
 					// Emulate instructions
 					wavefront->Execute();
 
 					// Create uop
-					auto uop = misc::new_unique<Uop>(
-							wavefront,
-							wavefront_pool_entry,
-							timing->getCycle(),
-							wavefront->getWorkGroup(),
-							fetch_buffer->getId());
-					uop->vector_memory_read = wavefront->vector_memory_read;
-					uop->vector_memory_write = wavefront->vector_memory_write;
-					uop->vector_memory_atomic = wavefront->vector_memory_atomic;
-					uop->scalar_memory_read = wavefront->scalar_memory_read;
-					uop->lds_read = wavefront->lds_read;
-					uop->lds_write = wavefront->lds_write;
-					uop->wavefront_last_instruction = wavefront->finished;
-					uop->memory_wait = wavefront->memory_wait;
-					uop->at_barrier = wavefront->isBarrierInstruction();
-					uop->setInstruction(wavefront->getInstruction());
-					uop->vector_memory_global_coherency =
-							wavefront->vector_memory_global_coherency;
-					uop->lgkm_cnt = wavefront->getLgkmcnt();
-					uop->vm_cnt = wavefront->getVmcnt();
-					uop->exp_cnt = wavefront->getExpcnt();
-					uop->setPC(pc);
+					std::unique_ptr<Uop> uop = NewUop(wavefront,
+							wavefront_pool_entry, fetch_buffer->getId(), pc);
 
 					// Checks
 					assert(wavefront->getWorkGroup() && uop->getWorkGroup());
@@ -1801,40 +1917,6 @@ void ComputeUnit::Fetch(FetchBuffer *fetch_buffer,
 								uop->getId());
 					}
 
-					// Update last memory accesses
-					for (auto it = wavefront->getWorkItemsBegin(),
-							e = wavefront->getWorkItemsEnd();
-							it != e;
-							++it)
-					{
-						// Get work item
-						WorkItem *work_item = it->get();
-
-						// Get uop work item info
-						Uop::WorkItemInfo *work_item_info;
-						work_item_info =
-							&uop->work_item_info_list[work_item->getIdInWavefront()];
-
-						// Global memory
-						work_item_info->global_memory_access_address =
-								work_item->global_memory_access_address;
-						work_item_info->global_memory_access_size =
-								work_item->global_memory_access_size;
-
-						// LDS
-						work_item_info->lds_access_count =
-							work_item->lds_access_count;
-						for (int j = 0; j < work_item->lds_access_count; j++)
-						{
-							work_item_info->lds_access[j].type =
-								work_item->lds_access[j].type;
-							work_item_info->lds_access[j].addr =
-								work_item->lds_access[j].addr;
-							work_item_info->lds_access[j].size =
-								work_item->lds_access[j].size;
-						}
-					}
-
 					// Access instruction cache. Record the time when the
 					// instruction will have been fetched, as per the latency
 					// of the instruction memory.
@@ -1878,34 +1960,19 @@ void ComputeUnit::Fetch(FetchBuffer *fetch_buffer,
 		}
 		else
 		{
+			// Wait for the instruction buffer
+			if (!FetchInstructionBlock(wavefront_pool_entry, wavefront,
+					false))
+				continue;
+
 			long long pc = wavefront->getPC();
 
 			// Emulate instructions
 			wavefront->Execute();
 
 			// Create uop
-			auto uop = misc::new_unique<Uop>(
-					wavefront,
-					wavefront_pool_entry,
-					timing->getCycle(),
-					wavefront->getWorkGroup(),
-					fetch_buffer->getId());
-			uop->vector_memory_read = wavefront->vector_memory_read;
-			uop->vector_memory_write = wavefront->vector_memory_write;
-			uop->vector_memory_atomic = wavefront->vector_memory_atomic;
-			uop->scalar_memory_read = wavefront->scalar_memory_read;
-			uop->lds_read = wavefront->lds_read;
-			uop->lds_write = wavefront->lds_write;
-			uop->wavefront_last_instruction = wavefront->finished;
-			uop->memory_wait = wavefront->memory_wait;
-			uop->at_barrier = wavefront->isBarrierInstruction();
-			uop->setInstruction(wavefront->getInstruction());
-			uop->vector_memory_global_coherency =
-					wavefront->vector_memory_global_coherency;
-			uop->lgkm_cnt = wavefront->getLgkmcnt();
-			uop->vm_cnt = wavefront->getVmcnt();
-			uop->exp_cnt = wavefront->getExpcnt();
-			uop->setPC(pc);
+			std::unique_ptr<Uop> uop = NewUop(wavefront,
+					wavefront_pool_entry, fetch_buffer->getId(), pc);
 
 /*
 			/// test
@@ -1968,40 +2035,6 @@ void ComputeUnit::Fetch(FetchBuffer *fetch_buffer,
 						uop->getId());
 			}
 
-			// Update last memory accesses
-			for (auto it = wavefront->getWorkItemsBegin(),
-					e = wavefront->getWorkItemsEnd();
-					it != e;
-					++it)
-			{
-				// Get work item
-				WorkItem *work_item = it->get();
-
-				// Get uop work item info
-				Uop::WorkItemInfo *work_item_info;
-				work_item_info =
-					&uop->work_item_info_list[work_item->getIdInWavefront()];
-
-				// Global memory
-				work_item_info->global_memory_access_address =
-						work_item->global_memory_access_address;
-				work_item_info->global_memory_access_size =
-						work_item->global_memory_access_size;
-
-				// LDS
-				work_item_info->lds_access_count =
-					work_item->lds_access_count;
-				for (int j = 0; j < work_item->lds_access_count; j++)
-				{
-					work_item_info->lds_access[j].type =
-						work_item->lds_access[j].type;
-					work_item_info->lds_access[j].addr =
-						work_item->lds_access[j].addr;
-					work_item_info->lds_access[j].size =
-						work_item->lds_access[j].size;
-				}
-			}
-
 			// Access instruction cache. Record the time when the
 			// instruction will have been fetched, as per the latency
 			// of the instruction memory.
@@ -2182,9 +2215,6 @@ void ComputeUnit::RemoveWorkGroup(WorkGroup *work_group)
 
 void ComputeUnit::UnmapWorkGroup(WorkGroup *work_group)
 {
-	// Get Gpu object
-	Gpu *gpu = getGpu();
-
 	// Add work group register access statistics to compute unit
 	num_sreg_reads += work_group->getSregReadCount();
 	num_sreg_writes += work_group->getSregWriteCount();
@@ -2198,20 +2228,77 @@ void ComputeUnit::UnmapWorkGroup(WorkGroup *work_group)
 	// Unmap wavefronts from instruction buffer
 	work_group->wavefront_pool->UnmapWavefronts(work_group);
 	
-	// If compute unit is not already in the available list, place
-	// it there. The vector list of work groups does not shrink,
-	// when we unmap a workgroup.
-	assert((int) work_groups.size() <= gpu->getWorkGroupsPerComputeUnit());
-	if (!in_available_compute_units)
-		gpu->InsertInAvailableComputeUnits(this);
+	// The rest of the work is done on state shared with other compute
+	// units, and is postponed until the end of the cycle.
+	assert((int) work_groups.size() <= getGpu()->getWorkGroupsPerComputeUnit());
+	pending_unmapped_work_groups.push_back(work_group);
+}
 
-	// Trace
-	Timing::trace << misc::fmt("si.unmap_wg cu=%d wg=%d\n", index,
-			work_group->getId());
 
-	// Remove the work group from the running work groups list
-	NDRange *ndrange = work_group->getNDRange();
-	ndrange->RemoveWorkGroup(work_group);
+void ComputeUnit::Access(mem::Module *module,
+		mem::Module::AccessType access_type,
+		mem::Mmu::Space *address_space,
+		unsigned address,
+		int *witness)
+{
+	PendingAccess access;
+	access.module = module;
+	access.access_type = access_type;
+	access.address_space = address_space;
+	access.address = address;
+	access.witness = witness;
+	pending_accesses.push_back(access);
+}
+
+
+void ComputeUnit::RecordUopLatency(Uop *uop)
+{
+	long long issue_cycle = uop->issue_ready - issue_latency;
+	uop_latency.Add(timing->getCycle() - issue_cycle);
+}
+
+
+void ComputeUnit::CommitSharedState()
+{
+	// Submit memory accesses
+	mem::Mmu *mmu = gpu->getMmu();
+	for (PendingAccess &access : pending_accesses)
+	{
+		// Translate virtual address
+		unsigned address = access.address;
+		if (access.address_space)
+			address = mmu->TranslateVirtualAddress(
+					access.address_space,
+					address);
+
+		// Submit access
+		access.module->Access(access.access_type, address,
+				access.witness);
+	}
+	pending_accesses.clear();
+
+	// Release finished work-groups
+	for (WorkGroup *work_group : pending_unmapped_work_groups)
+	{
+		// If compute unit is not already in the available list, place
+		// it there. The vector list of work groups does not shrink,
+		// when we unmap a workgroup.
+		if (!in_available_compute_units)
+			gpu->InsertInAvailableComputeUnits(this);
+
+		// Trace
+		Timing::trace << misc::fmt("si.unmap_wg cu=%d wg=%d\n", index,
+				work_group->getId());
+
+		// Remove the work group from the running work groups list
+		NDRange *ndrange = work_group->getNDRange();
+		ndrange->RemoveWorkGroup(work_group);
+	}
+	pending_unmapped_work_groups.clear();
+
+	// Record last completion in the GPU
+	if (last_complete_cycle > gpu->last_complete_cycle)
+		gpu->last_complete_cycle = last_complete_cycle;
 }
 
 
@@ -2254,9 +2341,18 @@ void ComputeUnit::UpdateFetchVisualization(FetchBuffer *fetch_buffer)
 void ComputeUnit::Run()
 {
 	// Return if no work groups are mapped to this compute unit
-	if (!work_groups.size())
+	if (!isBusy())
 		return;
-	
+
+	// Advance pipeline
+	RunBackEnd();
+	CommitSharedState();
+	RunFrontEnd();
+}
+
+
+void ComputeUnit::RunBackEnd()
+{
 	// Save timing simulator
 	timing = Timing::getInstance();
 
@@ -2300,6 +2396,14 @@ void ComputeUnit::Run()
 		}
 	}
 
+}
+
+
+void ComputeUnit::RunFrontEnd()
+{
+	// Save timing simulator
+	timing = Timing::getInstance();
+
 	// Fetch
 	for (int i = 0; i < num_wavefront_pools; i++)
 		Fetch(fetch_buffers[i].get(), wavefront_pools[i].get());
@@ -22,6 +22,9 @@
 
 #include <list>
 
+#include <lib/cpp/Histogram.h>
+#include <lib/cpp/SlotPool.h>
+#include <memory/Mmu.h>
 #include <memory/Module.h>
 
 #include "BranchUnit.h"
@@ -39,6 +42,7 @@ namespace SI
 
 // Forward declarations
 class Timing;
+class Wavefront;
 class WorkGroup;
 class Gpu;
 
@@ -47,6 +51,35 @@ class Gpu;
 /// Class representing one compute unit in the GPU device.
 class ComputeUnit
 {
+	// Pool where all uops of this compute unit are allocated. This field
+	// must be declared before any buffer holding uops, so that it is
+	// destroyed after all of them.
+	misc::SlotPool uop_pool;
+
+	// Create a new uop from the pool for the instruction that the given
+	// wavefront just emulated, starting at the given PC.
+	std::unique_ptr<Uop> NewUop(Wavefront *wavefront,
+			WavefrontPoolEntry *wavefront_pool_entry,
+			int wavefront_pool_id,
+			long long pc);
+
+	// Make sure that the next instruction of a wavefront is present in its
+	// instruction buffer, filling it from the instruction cache otherwise.
+	// Return true if the instruction can be fetched in the current cycle.
+	// Argument 'speculative' indicates whether the wavefront is running in
+	// pre-execution mode, for statistics.
+	bool FetchInstructionBlock(WavefrontPoolEntry *wavefront_pool_entry,
+			Wavefront *wavefront,
+			bool speculative);
+
+	// Squash the pre-execution of the wavefront in the given entry of a
+	// wavefront pool. Instructions emulated under the checkpoint that were
+	// not issued yet are discarded, the wavefront is rolled back to its
+	// checkpoint, and it continues in normal mode.
+	void SquashPreExecution(WavefrontPoolEntry *wavefront_pool_entry,
+			int wavefront_pool_id,
+			int index);
+
 	// Fetch an instruction from the given wavefront pool
 	void Fetch(FetchBuffer *fetch_buffer, WavefrontPool *wavefront_pool);
 
@@ -111,6 +144,24 @@ class ComputeUnit
 	// Counter of identifiers assigned to uops in this compute unit
 	long long uop_id_counter = 0;
 
+	// Memory access requested by the pipeline in the current cycle and
+	// not submitted to its memory module yet
+	struct PendingAccess
+	{
+		mem::Module *module;
+		mem::Module::AccessType access_type;
+		mem::Mmu::Space *address_space;
+		unsigned address;
+		int *witness;
+	};
+
+	// Memory accesses requested in the current cycle, in program order
+	std::vector<PendingAccess> pending_accesses;
+
+	// Work-groups that finished in the current cycle and still need to be
+	// released to the GPU and their ND-Range
+	std::vector<WorkGroup *> pending_unmapped_work_groups;
+
 public:
 
 	//
@@ -168,9 +219,47 @@ public:
 	/// Constructor
 	ComputeUnit(int index, Gpu *gpu);
 
-	/// Advance compute unit state by one cycle
+	/// Advance compute unit state by one cycle. This is equivalent to
+	/// calling RunBackEnd(), CommitSharedState(), and RunFrontEnd() in
+	/// this order.
 	void Run();
 
+	/// Return whether the compute unit has work-groups mapped, and must
+	/// then be advanced in the current cycle.
+	bool isBusy() const { return work_groups.size(); }
+
+	/// Advance the execution units and the issue stage by one cycle. This
+	/// function only modifies state private to the compute unit: memory
+	/// accesses and released work-groups are buffered until the next call
+	/// to CommitSharedState(). Different compute units can thus run this
+	/// function concurrently.
+	void RunBackEnd();
+
+	/// Submit memory accesses and release work-groups buffered by the last
+	/// call to RunBackEnd(). Compute units must commit in increasing order
+	/// of their index to produce deterministic results.
+	void CommitSharedState();
+
+	/// Advance the fetch stage by one cycle. This stage emulates
+	/// instructions functionally, and must run sequentially across compute
+	/// units, after the compute unit has committed its shared state.
+	void RunFrontEnd();
+
+	/// Request an access to a memory module on behalf of the pipeline. If
+	/// an address space is given, the address is virtual and is translated
+	/// by the GPU MMU at the time the access is submitted. The access is
+	/// submitted in the next call to CommitSharedState(), keeping the
+	/// order in which accesses were requested.
+	void Access(mem::Module *module,
+			mem::Module::AccessType access_type,
+			mem::Mmu::Space *address_space,
+			unsigned address,
+			int *witness);
+
+	/// Record the latency of a uop completing in the current cycle, from
+	/// the cycle it was issued to its execution unit.
+	void RecordUopLatency(Uop *uop);
+
 	/// Return the index of this compute unit in the GPU
 	int getIndex() const { return index; }
 
@@ -187,7 +276,10 @@ public:
 	/// Map a work group to the compute unit
 	void MapWorkGroup(WorkGroup *work_group);
 
-	/// Unmap a work group from the compute unit
+	/// Unmap a work group from the compute unit. The compute unit stops
+	/// using the work-group immediately, while the work-group is returned
+	/// to the GPU and its ND-Range in the next call to
+	/// CommitSharedState().
 	void UnmapWorkGroup(WorkGroup *work_group);
 
 	/// Add a work group pointer to the work_groups list
@@ -202,12 +294,23 @@ public:
 	/// Return the associated LDS module
 	mem::Module *getLdsModule() const { return lds_module.get(); }
 
+	/// Return the LDS unit
+	LdsUnit *getLdsUnit() { return &lds_unit; }
+
+	/// Return the pool where uops of this compute unit are allocated
+	const misc::SlotPool *getUopPool() const { return &uop_pool; }
+
 	/// Cache used for vector data
 	mem::Module *vector_cache = nullptr;
 
 	/// Cache used for scalar data
 	mem::Module *scalar_cache = nullptr;
 
+	/// Cache used for instructions. If no instruction module is given in
+	/// the memory configuration, this field is null and instructions are
+	/// fetched with a fixed latency.
+	mem::Module *instruction_cache = nullptr;
+
 	/// Iterator of the compute unit location in the available compute 
 	/// units list
 	std::list<ComputeUnit *>::iterator available_compute_units_iterator;
@@ -225,6 +328,9 @@ public:
 	// Number of total instructions
 	long long num_total_instructions = 0;
 
+	// Latency of uops from their issue to their completion, in cycles
+	misc::Histogram uop_latency;
+
 	// Number of issued branch instructions
 	long long num_branch_instructions = 0;
 
@@ -286,6 +392,10 @@ public:
 	//
 	long long num_total_speculation_mode = 0;
 
+	// Number of times that pre-execution diverged from the hints and was
+	// rolled back
+	long long num_pre_execution_squashes = 0;
+
 	//
 	long long num_issued_instructions_in_speculation_mode = 0;
 
@@ -293,12 +403,31 @@ public:
 
 	long long last_issue_cycle = 0;
 
+	// Last cycle when a uop completed execution in this compute unit
 	long long last_complete_cycle = 0;
 
 	long long wavefront_pool_cycles = 0;
 
 	long long wavefront_pool_issued_cycles = 0;
 
+	// Number of instruction cache accesses to fill instruction buffers
+	long long num_instruction_cache_accesses = 0;
+
+	// Number of instruction cache accesses that missed in the cache
+	long long num_instruction_cache_misses = 0;
+
+	// Number of instruction cache accesses issued by wavefronts in
+	// pre-execution mode
+	long long num_speculative_instruction_cache_accesses = 0;
+
+	// Number of instruction cache misses caused by wavefronts in
+	// pre-execution mode
+	long long num_speculative_instruction_cache_misses = 0;
+
+	// Number of times a wavefront could not fetch because its instruction
+	// buffer was waiting for the instruction cache
+	long long num_instruction_fetch_stalls = 0;
+
 };
 
 }
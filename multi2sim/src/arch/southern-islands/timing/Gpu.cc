@@ -35,6 +35,7 @@ int Gpu::num_vector_registers = 65536;
 int Gpu::lds_allocation_size = 64; 
 int Gpu::lds_size = 65536;
 long long Gpu::max_cycles = 0;
+int Gpu::num_threads = 1;
 
 // String map of the argument's access type                                      
 const misc::StringMap Gpu::register_allocation_granularity_map =                                
@@ -199,9 +200,41 @@ void Gpu::CalcGetWorkGroupsPerWavefrontPool(int work_items_per_work_group,
 
 void Gpu::Run()
 {
-	// Advance one cycle in each compute unit
+	// Compute units are advanced sequentially if only one host thread is
+	// used, or if tracing/debugging output is active, since its contents
+	// depend on the order of the calls.
+	if (num_threads <= 1 || Timing::trace || Timing::pipeline_debug ||
+			Emulator::scheduler_debug)
+	{
+		// Advance one cycle in each compute unit
+		for (auto &compute_unit : compute_units)
+			compute_unit->Run();
+		return;
+	}
+
+	// Create thread pool on first use
+	if (!thread_pool)
+		thread_pool = misc::new_unique<misc::ThreadPool>(num_threads);
+
+	// Collect compute units with work
+	busy_compute_units.clear();
 	for (auto &compute_unit : compute_units)
-		compute_unit->Run();
+		if (compute_unit->isBusy())
+			busy_compute_units.push_back(compute_unit.get());
+
+	// Advance the back-end of all busy compute units concurrently
+	thread_pool->ParallelFor(busy_compute_units.size(), [this](int index)
+	{
+		busy_compute_units[index]->RunBackEnd();
+	});
+
+	// Commit shared state and run the front-end in compute unit order,
+	// which reproduces the sequence of the sequential mode.
+	for (ComputeUnit *compute_unit : busy_compute_units)
+	{
+		compute_unit->CommitSharedState();
+		compute_unit->RunFrontEnd();
+	}
 }
 
 }
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include <lib/cpp/Misc.h>
+#include <lib/cpp/ThreadPool.h>
 #include <memory/Mmu.h>
 
 #include "ComputeUnit.h"
@@ -73,6 +74,13 @@ private:
 	/// Number of work_groups allowed in a compute unit
 	int work_groups_per_compute_unit = 0;
 
+	// Host threads used to advance compute units in parallel, created on
+	// the first cycle if more than one thread is requested
+	std::unique_ptr<misc::ThreadPool> thread_pool;
+
+	// Compute units with work in the current cycle
+	std::vector<ComputeUnit *> busy_compute_units;
+
 public:
 
 	//
@@ -85,6 +93,10 @@ public:
 
 	// Number of compute units
 	static int num_compute_units;
+
+	// Number of host threads used to advance compute units, set with
+	// command-line option '--si-threads'
+	static int num_threads;
 	
 
 
@@ -182,7 +194,9 @@ public:
 		return available_compute_units.end();
 	}
 
-	/// Advance one cycle in the GPU state
+	/// Advance one cycle in the GPU state. If more than one host thread
+	/// is configured, the back-ends of all compute units are advanced
+	/// concurrently, producing the same results as the sequential mode.
 	void Run();
 	
 	/// Add a compute unit to the list of available compute units
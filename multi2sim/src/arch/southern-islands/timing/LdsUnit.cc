@@ -17,6 +17,9 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
+#include <arch/southern-islands/emulator/NDRange.h>
 #include <arch/southern-islands/emulator/WorkGroup.h>
 #include <arch/southern-islands/emulator/Wavefront.h>
 #include <arch/southern-islands/emulator/WorkItem.h>
@@ -37,6 +40,98 @@ int LdsUnit::read_buffer_size = 1;
 int LdsUnit::write_latency = 1;
 int LdsUnit::write_buffer_size = 1;
 int LdsUnit::max_in_flight_mem_accesses = 32;
+int LdsUnit::num_banks = 32;
+int LdsUnit::bank_width = 4;
+
+
+int LdsUnit::getBankConflictDegree(const std::vector<unsigned> &addresses)
+{
+	// Bank words accessed, sorted so that each word is counted once
+	std::vector<unsigned> words;
+	words.reserve(addresses.size());
+	for (unsigned address : addresses)
+		words.push_back(address / bank_width);
+	std::sort(words.begin(), words.end());
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+
+	// Number of different words in each bank
+	std::vector<int> bank_words(num_banks);
+	int degree = 0;
+	for (unsigned word : words)
+		degree = std::max(degree, ++bank_words[word % num_banks]);
+	return degree;
+}
+
+
+int LdsUnit::getWavefrontBankConflictDegree(const std::vector<int> &lanes,
+		const std::vector<unsigned> &addresses)
+{
+	// Addresses of each half-wavefront
+	assert(lanes.size() == addresses.size());
+	std::vector<unsigned> half_addresses;
+	half_addresses.reserve(half_wavefront_size);
+	int degree = 0;
+	for (int first_lane = 0; first_lane < (int) WorkGroup::WavefrontSize;
+			first_lane += half_wavefront_size)
+	{
+		half_addresses.clear();
+		for (unsigned i = 0; i < lanes.size(); i++)
+			if (lanes[i] >= first_lane && lanes[i] < first_lane +
+					half_wavefront_size)
+				half_addresses.push_back(addresses[i]);
+		degree = std::max(degree, getBankConflictDegree(
+				half_addresses));
+	}
+	return degree;
+}
+
+
+int LdsUnit::ComputeBankConflicts(Uop *uop)
+{
+	// Get useful objects
+	Wavefront *wavefront = uop->getWavefront();
+
+	// Instructions like 'ds_write2' perform several accesses per
+	// work-item, each of them served by the banks separately.
+	int instruction_degree = 0;
+	int cycles = 0;
+	for (int i = 0; i < WorkItem::MaxLdsAccessesPerInst; i++)
+	{
+		// Collect addresses of access i
+		conflict_addresses.clear();
+		conflict_lanes.clear();
+		for (auto it = wavefront->getWorkItemsBegin(),
+				e = wavefront->getWorkItemsEnd();
+				it != e;
+				++it)
+		{
+			int id_in_wavefront = (*it)->getIdInWavefront();
+			if (i < uop->getLdsAccessCount(id_in_wavefront))
+			{
+				conflict_addresses.push_back(
+						uop->getLdsAccessAddress(
+						id_in_wavefront, i));
+				conflict_lanes.push_back(id_in_wavefront);
+			}
+		}
+
+		// Each conflicting word takes one more cycle
+		int degree = getWavefrontBankConflictDegree(conflict_lanes,
+				conflict_addresses);
+		instruction_degree = std::max(instruction_degree, degree);
+		cycles += degree;
+	}
+
+	// Record conflict degree in the histogram of the kernel
+	std::vector<long long> &histogram = bank_conflict_histograms[
+			uop->getWorkGroup()->getNDRange()->getKernelName()];
+	if ((int) histogram.size() <= instruction_degree)
+		histogram.resize(instruction_degree + 1);
+	histogram[instruction_degree]++;
+
+	// Return number of cycles
+	return cycles;
+}
 
 
 void LdsUnit::Run()
@@ -112,17 +207,22 @@ void LdsUnit::Complete()
 		compute_unit->getScoreboard(uop->getWavefrontPoolId())->
 			ReleaseRegisters(uop->getWavefront(), uop);
 
-		// Access complete, remove the uop from the queue
-		it = write_buffer.erase(it);
+		// Access complete
 		assert(uop->getWorkGroup()
 				->inflight_instructions > 0);
 		uop->getWorkGroup()->
 				inflight_instructions--;
 
+		// Latency from issue to completion
+		compute_unit->RecordUopLatency(uop);
+
+		// Remove the uop from the queue
+		it = write_buffer.erase(it);
+
 		// Statistics
 		num_instructions++;
-		compute_unit->getGpu()->last_complete_cycle = compute_unit->
-				getTiming()->getCycle();
+		compute_unit->last_complete_cycle = compute_unit->getTiming()->
+				getCycle();
 	}
 }
 
@@ -149,8 +249,10 @@ void LdsUnit::Write()
 		// One more instruction processed
 		instructions_processed++;
 
-		// Break if Uop is not ready yet
-		if (uop->lds_witness)
+		// Break if Uop is not ready yet, either because of pending
+		// accesses or because the banks are still serving it.
+		if (uop->lds_witness || compute_unit->getTiming()->getCycle() <
+				uop->execute_ready)
 			break;
 
 		// Stall if the width has been reached
@@ -287,6 +389,34 @@ void LdsUnit::Mem()
 			break;
 		}
 
+		// Stall while the banks serve the conflicting accesses of a
+		// previous instruction
+		if (compute_unit->getTiming()->getCycle() < banks_busy_until)
+		{
+			// Trace
+			Timing::trace << misc::fmt("si.inst "
+					"id=%lld "
+					"cu=%d "
+					"wf=%d "
+					"uop_id=%lld "
+					"stg=\"s\"\n",
+					uop->getIdInComputeUnit(),
+					compute_unit->getIndex(),
+					uop->getWavefront()->getId(),
+					uop->getIdInWavefront());
+			break;
+		}
+
+		// Occupy the banks for one cycle per conflicting word. An
+		// instruction with a single conflict-free access is served in
+		// the current cycle.
+		int bank_cycles = ComputeBankConflicts(uop);
+		int conflict_cycles = std::max(bank_cycles - 1, 0);
+		banks_busy_until = compute_unit->getTiming()->getCycle() +
+				conflict_cycles;
+		uop->execute_ready = banks_busy_until;
+		num_bank_conflict_cycles += conflict_cycles;
+
 		// Access local memory
 		for (auto it = uop->getWavefront()->getWorkItemsBegin(),
 				e = uop->getWavefront()->getWorkItemsEnd();
@@ -295,18 +425,15 @@ void LdsUnit::Mem()
 		{
 			// Get work item
 			WorkItem *work_item = it->get();
-
-			// Get uop work item info
-			Uop::WorkItemInfo *work_item_info;
-			work_item_info =
-				&uop->work_item_info_list[work_item->getIdInWavefront()];
+			int id_in_wavefront = work_item->getIdInWavefront();
 
 			// Access type
 			mem::Module::AccessType access_type;
 
-			for (int i = 0; i < work_item_info->lds_access_count; i++)
+			int lds_access_count = uop->getLdsAccessCount(id_in_wavefront);
+			for (int i = 0; i < lds_access_count; i++)
 			{
-				switch (work_item->lds_access[i].type)
+				switch (uop->getLdsAccessType(id_in_wavefront, i))
 				{
 
 				case WorkItem::MemoryAccessType::MemoryAccessRead:
@@ -327,9 +454,11 @@ void LdsUnit::Mem()
 				}
 
 				// Start access
-				compute_unit->getLdsModule()->Access(
+				compute_unit->Access(
+						compute_unit->getLdsModule(),
 						access_type,
-						work_item_info->lds_access[i].addr,
+						nullptr,
+						uop->getLdsAccessAddress(id_in_wavefront, i),
 						&uop->lds_witness);
 				uop->lds_witness--;
 			}
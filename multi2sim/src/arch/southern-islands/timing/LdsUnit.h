@@ -20,6 +20,10 @@
 #ifndef ARCH_SOUTHERN_ISLANDS_TIMING_LDS_UNIT_H
 #define ARCH_SOUTHERN_ISLANDS_TIMING_LDS_UNIT_H
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "ExecutionUnit.h"
 
 namespace SI
@@ -44,6 +48,20 @@ class LdsUnit : public ExecutionUnit
 	// Variable number of register instructions
 	std::deque<std::unique_ptr<Uop>> write_buffer;
 
+	// Cycle until which the LDS banks are busy serializing the conflicting
+	// accesses of the last instruction that entered the mem stage
+	long long banks_busy_until = 0;
+
+	// Addresses accessed by the work-items of a wavefront in one LDS
+	// access, and the index of each work-item in the wavefront, used
+	// internally when computing bank conflicts
+	std::vector<unsigned> conflict_addresses;
+	std::vector<int> conflict_lanes;
+
+	// Return the number of cycles that the LDS banks need to serve all
+	// accesses of the given uop, and record its conflict degree.
+	int ComputeBankConflicts(Uop *uop);
+
 public:
 	//
 	// Static fields
@@ -76,6 +94,32 @@ public:
 	/// Maximum number of in flight memory accesses
 	static int max_in_flight_mem_accesses;
 
+	/// Number of banks in the LDS
+	static int num_banks;
+
+	/// Width of each LDS bank in bytes
+	static int bank_width;
+
+	/// Return the bank conflict degree of one LDS access performed by a
+	/// set of work-items, given the addresses they access. The degree is
+	/// the largest number of different bank words accessed in the same
+	/// bank. Work-items accessing the same word are served by a single
+	/// broadcast. The degree is 1 for a conflict-free access, and 0 if
+	/// the list of addresses is empty.
+	static int getBankConflictDegree(const std::vector<unsigned> &addresses);
+
+	/// Number of work-items of a wavefront whose accesses are served by
+	/// the LDS banks together
+	static const int half_wavefront_size = 32;
+
+	/// Return the bank conflict degree of one LDS access performed by the
+	/// work-items of a wavefront, given the index in the wavefront of each
+	/// work-item and the address it accesses. Each half-wavefront is served
+	/// by the banks separately, so the degree is the largest degree of
+	/// the two halves.
+	static int getWavefrontBankConflictDegree(const std::vector<int> &lanes,
+			const std::vector<unsigned> &addresses);
+
 
 
 
@@ -122,6 +166,15 @@ public:
 
 	/// Statistics
 	long long num_instructions;
+
+	/// Number of cycles that LDS instructions stalled due to bank
+	/// conflicts
+	long long num_bank_conflict_cycles = 0;
+
+	/// Histogram of bank conflict degrees of LDS instructions, indexed
+	/// by kernel name. Position i of each histogram counts instructions
+	/// with conflict degree i.
+	std::map<std::string, std::vector<long long>> bank_conflict_histograms;
 };
 
 }
@@ -105,7 +105,6 @@ void ScalarUnit::Complete()
 {
 	// Get useful objects
 	ComputeUnit *compute_unit = getComputeUnit();
-	Gpu *gpu = compute_unit->getGpu();
 
 	// Initialize iterator
 	auto it = write_buffer.begin();
@@ -284,17 +283,20 @@ void ScalarUnit::Complete()
 		}
 */
 
-		// Access complete, remove the uop from the queue
-		it = write_buffer.erase(it);
+		// Access complete
 		assert(uop->getWorkGroup()->inflight_instructions > 0);
 		uop->getWorkGroup()->inflight_instructions--;
 
+		// Latency from issue to completion
+		compute_unit->RecordUopLatency(uop);
+
+		// Remove the uop from the queue
+		it = write_buffer.erase(it);
+
 		// Statistics
 		num_instructions++;
-		gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
-
-		///
-		compute_unit->last_complete_cycle = compute_unit->getTiming()->getCycle();
+		compute_unit->last_complete_cycle = compute_unit->getTiming()->
+				getCycle();
 	}
 }
 
@@ -553,18 +555,14 @@ void ScalarUnit::Execute()
 			uop->global_memory_access_address = uop->getWavefront()->
 					getScalarWorkItem()->global_memory_access_address;
 
-			// Translate virtual address to physical address
-			unsigned phys_addr = compute_unit->getGpu()->
-					getMmu()->TranslateVirtualAddress(
-							uop->getWorkGroup()->
-							getNDRange()->
-							address_space,
-						uop->global_memory_access_address);
-
-			// Submit the access
-			compute_unit->scalar_cache->Access(
+			// Submit the access. The virtual address is translated
+			// when the access reaches the scalar cache.
+			compute_unit->Access(
+					compute_unit->scalar_cache,
 					mem::Module::AccessType::AccessLoad,
-					phys_addr, &uop->global_memory_witness);
+					uop->getWorkGroup()->getNDRange()->address_space,
+					uop->global_memory_access_address,
+					&uop->global_memory_witness);
 
 			// Trace
 			Timing::trace << misc::fmt("si.inst "
@@ -197,7 +197,7 @@ void ScoreBoard::ReleaseRegisters(Wavefront *wavefront, Uop *uop)
 	if (format == Instruction::FormatMTBUF || format == Instruction::FormatMUBUF
 			|| format == Instruction::FormatMIMG)
 	{
-		for (unsigned i = 0; i < 14; i++)
+		for (unsigned i = 0; i < 4; i++)
 		{
 			int index = uop->getDestinationVectorRegisterIndex(i);
 			if (index > 0)
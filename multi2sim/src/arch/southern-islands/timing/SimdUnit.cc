@@ -77,7 +77,6 @@ void SimdUnit::Complete()
 {
 	// Get useful objects
 	ComputeUnit *compute_unit = getComputeUnit();
-	Gpu *gpu = compute_unit->getGpu();
 
 	// Sanity check exec buffer
 	assert(int(exec_buffer.size()) <= exec_buffer_size);
@@ -107,19 +106,25 @@ void SimdUnit::Complete()
 
 		// Statistics
 		num_instructions++;
-		gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+		compute_unit->last_complete_cycle = compute_unit->getTiming()->
+				getCycle();
 
 		// Release Scoreboard
 		compute_unit->getScoreboard(uop->getWavefrontPoolId())->
 			ReleaseRegisters(uop->getWavefront(), uop);
 
-		// Remove uop from the exec buffer and get the iterator to the
-		// next element
-		it = exec_buffer.erase(it);
+		// Instruction complete
 		assert(uop->getWorkGroup()
 				->inflight_instructions > 0);
 		uop->getWorkGroup()->
 				inflight_instructions--;
+
+		// Latency from issue to completion
+		compute_unit->RecordUopLatency(uop);
+
+		// Remove uop from the exec buffer and get the iterator to the
+		// next element
+		it = exec_buffer.erase(it);
 	}
 
 }
@@ -19,6 +19,7 @@
 
 #include <arch/common/Arch.h>
 #include <lib/cpp/CommandLine.h>
+#include <lib/esim/IntervalStatistics.h>
 #include <memory/System.h>
 #include <arch/southern-islands/emulator/Emulator.h>
 
@@ -199,6 +200,12 @@ const std::string Timing::help_message =
 	"      Latency of register file writes in number of cycles.\n"
 	"  WriteBufferSize = <num> (Default = 1)\n"
 	"      Size of the buffer holding register write instructions.\n"
+	"  NumBanks = <num> (Default = 32)\n"
+	"      Number of LDS banks. Work-items of the same half-wavefront\n"
+	"      accessing different words of the same bank in one instruction\n"
+	"      are served in sequence.\n"
+	"  BankWidth = <bytes> (Default = 4)\n"
+	"      Width of each LDS bank in bytes.\n"
 	"\n"
 	"Section '[ VectorMemUnit ]': parameters for the Vector Memory Units.\n"
 	"\n"
@@ -254,6 +261,10 @@ Timing::Timing() : comm::Timing("SouthernIslands")
 	// Create GPU
 	gpu = misc::new_unique<Gpu>();
 
+	// Interval statistics
+	if (esim::IntervalStatistics::getInstance()->isActive())
+		RegisterIntervalStatistics();
+
 	/// Adding the SI related header to the trace
 	trace.Header(misc::fmt("si.init version=\"%d.%d\" "
 			"num_compute_units=%d\n",
@@ -291,6 +302,44 @@ Timing::Timing() : comm::Timing("SouthernIslands")
 }
 
 
+void Timing::RegisterIntervalStatistics()
+{
+	// Cycles of the GPU
+	esim::IntervalStatistics *interval_statistics =
+			esim::IntervalStatistics::getInstance();
+	auto cycles = [this]() { return (double) getCycle(); };
+
+	// Columns of each compute unit
+	for (int i = 0; i < gpu->num_compute_units; i++)
+	{
+		ComputeUnit *compute_unit = gpu->getComputeUnit(i);
+		std::string prefix = misc::fmt("si.cu%d.", i);
+
+		// Instructions per cycle
+		interval_statistics->RegisterRatio(prefix + "IPC",
+				[compute_unit]() { return (double) compute_unit->
+						num_total_instructions; },
+				cycles);
+
+		// Speculation mode entries and instructions issued
+		// speculatively
+		interval_statistics->RegisterCounter(prefix + "SpecModes",
+				[compute_unit]() { return (double) compute_unit->
+						num_total_speculation_mode; });
+		interval_statistics->RegisterCounter(prefix + "SpecInsts",
+				[compute_unit]() { return (double) compute_unit->
+						num_total_speculation_instructions; });
+
+		// Instruction cache miss rate
+		interval_statistics->RegisterRatio(prefix + "ICacheMissRate",
+				[compute_unit]() { return (double) compute_unit->
+						num_instruction_cache_misses; },
+				[compute_unit]() { return (double) compute_unit->
+						num_instruction_cache_accesses; });
+	}
+}
+
+
 Timing *Timing::getInstance()
 {
 	// Instance already exists
@@ -520,6 +569,7 @@ void Timing::ParseMemoryConfigurationEntry(misc::IniFile *ini_file,
 	ini_file->Allow(section, "DataModule");
 	ini_file->Allow(section, "ConstantDataModule");
 	ini_file->Allow(section, "Module");
+	ini_file->Allow(section, "InstModule");
 
 	// Unified or separate data and constant memory
 	bool unified_present = ini_file->Exists(section, "Module");
@@ -592,6 +642,14 @@ void Timing::ParseMemoryConfigurationEntry(misc::IniFile *ini_file,
 		vector_cache_name = scalar_cache_name =
 				ini_file->ReadString(section, "Module");
 	}
+
+	// Instruction cache is optional, and only modeled if variable
+	// 'InstModule' is given, for both unified and separate modules.
+	// Without it, instructions are fetched with a fixed latency.
+	std::string instruction_cache_name;
+	if (ini_file->Exists(section, "InstModule"))
+		instruction_cache_name = ini_file->ReadString(section,
+				"InstModule");
 	if (vector_cache_name.empty() || scalar_cache_name.empty())
 		throw misc::Error(misc::fmt("%s: [%s]: invalid name for vector "
 				"or scalar cache",
@@ -621,9 +679,27 @@ void Timing::ParseMemoryConfigurationEntry(misc::IniFile *ini_file,
 				section.c_str(),
 				scalar_cache_name.c_str()));
 	
+	// Assign instruction cache
+	if (!instruction_cache_name.empty())
+	{
+		compute_unit->instruction_cache = mem_system->getModule(
+				instruction_cache_name);
+		if (!compute_unit->instruction_cache)
+			throw misc::Error(misc::fmt("%s: [%s]: '%s' is not a "
+					"valid module name: The given module "
+					"name must match a module declared in "
+					"a section [Module <name>] in the "
+					"memory configuration file.\n",
+					ini_file->getPath().c_str(),
+					section.c_str(),
+					instruction_cache_name.c_str()));
+	}
+	
 	// Add modules to list of memory entries
 	entry_modules.push_back(compute_unit->vector_cache);
 	entry_modules.push_back(compute_unit->scalar_cache);
+	if (compute_unit->instruction_cache)
+		entry_modules.push_back(compute_unit->instruction_cache);
 	
 	// Debug
 	mem::System::debug << misc::fmt("\tSouthern Islands compute unit %d\n",
@@ -632,6 +708,10 @@ void Timing::ParseMemoryConfigurationEntry(misc::IniFile *ini_file,
 			<< compute_unit->vector_cache->getName() << '\n'
 			<< "\t\tEntry for scalar mem -> "
 			<< compute_unit->scalar_cache->getName() << '\n'
+			<< "\t\tEntry for instruction mem -> "
+			<< (compute_unit->instruction_cache ?
+				compute_unit->instruction_cache->getName() :
+				"none") << '\n'
 			<< '\n';
 }
 
@@ -694,6 +774,14 @@ void Timing::RegisterOptions()
 	command_line->RegisterUInt32("--si-issue-mode <mode>", Timing::issue_mode,
 			"Issue scheduler mode. 1 default, 0 speculation mode.");
 
+	// Option --si-threads <int>
+	command_line->RegisterInt32("--si-threads <num>", Gpu::num_threads,
+			"Number of host threads used to advance the compute "
+			"units of the GPU in detailed simulation. Results are "
+			"identical to those obtained with one thread (default). "
+			"Compute units run sequentially while tracing or "
+			"pipeline debugging is active.");
+
 	// Option --si-max-cycles <int>
 	command_line->RegisterInt64("--si-max-cycles <cycles>", Gpu::max_cycles,
 			"Maximum number of cycles for the timing simulator "
@@ -719,6 +807,10 @@ void Timing::ProcessOptions()
 	if (!config_file.empty())
 		ini_file.Load(config_file);
 		
+	// Number of host threads passed with option '--si-threads'
+	if (Gpu::num_threads < 1)
+		throw Error("Option --si-threads must be at least 1");
+
 	// Instantiate timing simulator if '--si-sim detailed' is present
 	if (sim_kind == comm::Arch::SimDetailed)
 	{
@@ -873,6 +965,18 @@ void Timing::ParseConfiguration(misc::IniFile *ini_file)
 	LdsUnit::write_buffer_size = ini_file->ReadInt(section,
 					"WriteBufferSize",
 					LdsUnit::write_buffer_size);
+	LdsUnit::num_banks = ini_file->ReadInt(section, "NumBanks",
+					LdsUnit::num_banks);
+	LdsUnit::bank_width = ini_file->ReadInt(section, "BankWidth",
+					LdsUnit::bank_width);
+	if (LdsUnit::num_banks < 1)
+		throw Error(misc::fmt("%s: The value for 'NumBanks' "
+				"must be at least 1.\n",
+				ini_file->getPath().c_str()));
+	if (LdsUnit::bank_width < 1)
+		throw Error(misc::fmt("%s: The value for 'BankWidth' "
+				"must be at least 1.\n",
+				ini_file->getPath().c_str()));
 
 	// Section [VectorMemUnit]
 	VectorMemoryUnit::width = ini_file->ReadInt(section, "Width",
@@ -998,6 +1102,8 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 			LdsUnit::max_in_flight_mem_accesses);
 	os << misc::fmt("WriteLatency = %d\n", LdsUnit::write_latency);
 	os << misc::fmt("WriteBufferSize = %d\n", LdsUnit::write_buffer_size);
+	os << misc::fmt("NumBanks = %d\n", LdsUnit::num_banks);
+	os << misc::fmt("BankWidth = %d\n", LdsUnit::bank_width);
 	os << misc::fmt("\n");
 
 	// Vector Memory
@@ -1054,6 +1160,51 @@ void Timing::DumpSummary(std::ostream &os) const
 }
 
 
+void Timing::DumpJsonReport(misc::JsonWriter &json) const
+{
+	// Device
+	Emulator *emulator = Emulator::getInstance();
+	json.Member("Frequency", getFrequencyDomain()->getFrequency());
+	json.Member("Cycles", getCycle());
+	json.Member("NDRangeCount", emulator->num_ndranges);
+	json.Member("WorkGroupCount", emulator->num_work_groups);
+	json.Member("Instructions", emulator->getNumInstructions());
+	json.Member("InstructionsPerCycle", getCycle() ?
+			(double) emulator->getNumInstructions() / getCycle() :
+			0.0);
+
+	// Compute units, and latency of the uops of all of them
+	misc::Histogram uop_latency;
+	json.Key("ComputeUnits");
+	json.BeginObject();
+	for (auto it = gpu->getComputeUnitsBegin(),
+			e = gpu->getComputeUnitsEnd();
+			it != e; ++it)
+	{
+		ComputeUnit *compute_unit = it->get();
+		uop_latency.Merge(compute_unit->uop_latency);
+		json.Key(misc::fmt("%d", compute_unit->getIndex()));
+		json.BeginObject();
+		json.Member("WorkGroupCount",
+				compute_unit->num_mapped_work_groups);
+		json.Member("WavefrontCount",
+				compute_unit->num_mapped_wavefronts);
+		json.Member("Instructions",
+				compute_unit->num_total_instructions);
+		json.Member("InstructionCacheAccesses",
+				compute_unit->num_instruction_cache_accesses);
+		json.Member("InstructionCacheMisses",
+				compute_unit->num_instruction_cache_misses);
+		json.Key("UopLatency");
+		compute_unit->uop_latency.DumpJson(json);
+		json.EndObject();
+	}
+	json.EndObject();
+	json.Key("UopLatency");
+	uop_latency.DumpJson(json);
+}
+
+
 void Timing::DumpReport() const
 {
 	// Check if the report file has been set
@@ -1139,6 +1290,8 @@ void Timing::DumpReport() const
 				compute_unit->num_lds_speculation_instructions);
 		report << misc::fmt("Num Total Execution Mode = %lld\n",
 				compute_unit->num_total_speculation_mode);
+		report << misc::fmt("Pre-execution Squashes = %lld\n",
+				compute_unit->num_pre_execution_squashes);
 		report << misc::fmt("Long latency Stall Cycles = %lld\n",
 				compute_unit->long_latency_stall_cycles + getCycle()-
 						compute_unit->last_issue_cycle);
@@ -1172,9 +1325,65 @@ void Timing::DumpReport() const
 		report << misc::fmt("LDS.Writes = %lld\n", compute_unit->getLdsModule()->num_writes);              
 		report << misc::fmt("LDS.CoalescedWrites = %lld\n",                       
 				coalesced_writes); 
+		report << misc::fmt("LDS.BankConflictCycles = %lld\n",
+				compute_unit->getLdsUnit()->num_bank_conflict_cycles);
+		report << misc::fmt("\n");
+		report << misc::fmt("InstructionCache.Accesses = %lld\n",
+				compute_unit->num_instruction_cache_accesses);
+		report << misc::fmt("InstructionCache.Misses = %lld\n",
+				compute_unit->num_instruction_cache_misses);
+		report << misc::fmt("InstructionCache.SpeculativeAccesses = %lld\n",
+				compute_unit->num_speculative_instruction_cache_accesses);
+		report << misc::fmt("InstructionCache.SpeculativeMisses = %lld\n",
+				compute_unit->num_speculative_instruction_cache_misses);
+		report << misc::fmt("InstructionFetchStalls = %lld\n",
+				compute_unit->num_instruction_fetch_stalls);
 		report << misc::fmt("\n\n");                                              
 	}         
 
+	// Merge LDS bank conflict histograms of all compute units
+	std::map<std::string, std::vector<long long>> histograms;
+	for (auto it = gpu->getComputeUnitsBegin(),
+			e = gpu->getComputeUnitsEnd();
+			it != e; ++it)
+	{
+		LdsUnit *lds_unit = (*it)->getLdsUnit();
+		for (auto &pair : lds_unit->bank_conflict_histograms)
+		{
+			std::vector<long long> &histogram = histograms[pair.first];
+			if (histogram.size() < pair.second.size())
+				histogram.resize(pair.second.size());
+			for (unsigned i = 0; i < pair.second.size(); i++)
+				histogram[i] += pair.second[i];
+		}
+	}
+
+	// Report LDS bank conflict degrees for each kernel
+	for (auto &pair : histograms)
+	{
+		// Total instructions and average degree
+		long long num_instructions = 0;
+		long long total_degree = 0;
+		for (unsigned i = 0; i < pair.second.size(); i++)
+		{
+			num_instructions += pair.second[i];
+			total_degree += i * pair.second[i];
+		}
+		double average_degree = num_instructions ?
+				(double) total_degree / num_instructions : 0.0;
+
+		// Dump histogram, skipping empty degrees
+		report << misc::fmt("[ LDSBankConflicts %s ]\n\n",
+				pair.first.c_str());
+		report << misc::fmt("Instructions = %lld\n", num_instructions);
+		report << misc::fmt("AverageDegree = %.4g\n", average_degree);
+		for (unsigned i = 0; i < pair.second.size(); i++)
+			if (pair.second[i])
+				report << misc::fmt("Degree.%u = %lld\n", i,
+						pair.second[i]);
+		report << misc::fmt("\n\n");
+	}
+
 	// Close the report file
 	report.close();
 }
@@ -83,6 +83,10 @@ class Timing : public comm::Timing
 	// List of entry modules to the memory hierarchy
 	std::vector<mem::Module *> entry_modules;
 
+	// Register the IPC, speculation activity, and instruction cache miss
+	// rate of each compute unit in the interval statistics
+	void RegisterIntervalStatistics();
+
 public:
 
 	//
@@ -120,6 +124,11 @@ public:
 	/// '--si-sim-kind'.
 	static comm::Arch::SimKind getSimKind() { return sim_kind; }
 
+	/// Set the name of the hint file, as given with command-line option
+	/// '--si-hint'. Hints are read from the file when the timing
+	/// simulator is created.
+	static void setHintFile(const std::string &value) { hint_file = value; }
+
 	/// Southern Island GPU trace version identifier
 	static const int trace_version_major;
 	static const int trace_version_minor;
@@ -185,6 +194,10 @@ public:
 	/// Dump a report of all the statistics collected during the execution
 	/// of one or more OpenCL kernels 
 	void DumpReport() const override;
+
+	/// Dump the main statistics of the GPU and of each compute unit into
+	/// the JSON report, including the histograms of uop latencies.
+	void DumpJsonReport(misc::JsonWriter &json) const override;
 	
 	/// Return the number of entry modules.
 	/// See comm::Timing::getNumEntryModules() for details.
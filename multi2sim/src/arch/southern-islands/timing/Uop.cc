@@ -46,9 +46,6 @@ Uop::Uop(Wavefront *wavefront, WavefrontPoolEntry *wavefront_pool_entry,
 	compute_unit = wavefront_pool_entry->getWavefrontPool()->getComputeUnit();
 	id_in_compute_unit = compute_unit->getUopId();
 	
-	// Allocate room for the work-item info structures
-	work_item_info_list.resize(WorkGroup::WavefrontSize);
-
 	// Initialize source scalar register index
 	for (int i = 0; i < 4; i++)
 		source_scalar_register_index[i] = -1;
@@ -67,6 +64,47 @@ Uop::Uop(Wavefront *wavefront, WavefrontPoolEntry *wavefront_pool_entry,
 }
 
 
+void Uop::CaptureWorkItemInfo()
+{
+	// Only memory instructions carry per-work-item information
+	Instruction::Format format = instruction.getFormat();
+	if (format != Instruction::FormatMUBUF &&
+			format != Instruction::FormatMTBUF &&
+			format != Instruction::FormatDS)
+		return;
+
+	// Copy last memory accesses of each work-item
+	assert((int) WorkGroup::WavefrontSize <= MaxWorkItems);
+	for (auto it = wavefront->getWorkItemsBegin(),
+			e = wavefront->getWorkItemsEnd();
+			it != e;
+			++it)
+	{
+		// Get work item
+		WorkItem *work_item = it->get();
+		int id = work_item->getIdInWavefront();
+
+		// Global memory
+		global_memory_access_address_list[id] =
+				work_item->global_memory_access_address;
+		global_memory_access_size_list[id] =
+				work_item->global_memory_access_size;
+
+		// LDS
+		lds_access_count_list[id] = work_item->lds_access_count;
+		for (int j = 0; j < work_item->lds_access_count; j++)
+		{
+			lds_access_type_list[j][id] = work_item->lds_access[j].type;
+			lds_access_addr_list[j][id] = work_item->lds_access[j].addr;
+			lds_access_size_list[j][id] = work_item->lds_access[j].size;
+		}
+	}
+
+	// Record capture
+	work_item_info_captured = true;
+}
+
+
 void Uop::setInstructionRegistersIndex()
 {
 	switch(this->instruction.getFormat())
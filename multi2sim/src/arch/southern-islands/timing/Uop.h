@@ -20,8 +20,11 @@
 #ifndef ARCH_SOUTHERN_ISLANDS_TIMING_UOP_H
 #define ARCH_SOUTHERN_ISLANDS_TIMING_UOP_H
 
+#include <cassert>
+
 #include <arch/southern-islands/disassembler/Instruction.h>
-#include<arch/southern-islands/emulator/WorkItem.h>
+#include <arch/southern-islands/emulator/WorkItem.h>
+#include <lib/cpp/SlotPool.h>
 
 
 namespace SI
@@ -45,6 +48,10 @@ class Uop
 	// Counter tracking the ID assigned to the last uop created
 	static long long id_counter;
 
+	// Maximum number of work-items in a wavefront for which per-lane
+	// memory information is captured
+	static const int MaxWorkItems = 64;
+
 
 
 
@@ -99,6 +106,28 @@ class Uop
 	// Destination vector register index
 	int destination_vector_register_index[4];
 
+	// Flag indicating whether per-work-item memory information was
+	// captured for this uop, see CaptureWorkItemInfo()
+	bool work_item_info_captured = false;
+
+	// Bit mask of work-items that already made a successful vector cache
+	// access. Bit i corresponds to the work-item with identifier i in the
+	// wavefront.
+	unsigned long long accessed_cache_mask = 0;
+
+	// Per-work-item memory information, stored as one array per field and
+	// indexed by the work-item identifier in the wavefront. These arrays
+	// are left uninitialized unless 'work_item_info_captured' is set.
+	unsigned global_memory_access_address_list[MaxWorkItems];
+	unsigned global_memory_access_size_list[MaxWorkItems];
+	unsigned char lds_access_count_list[MaxWorkItems];
+	unsigned char lds_access_type_list
+			[WorkItem::MaxLdsAccessesPerInst][MaxWorkItems];
+	unsigned lds_access_addr_list
+			[WorkItem::MaxLdsAccessesPerInst][MaxWorkItems];
+	unsigned lds_access_size_list
+			[WorkItem::MaxLdsAccessesPerInst][MaxWorkItems];
+
 public:
 
 	/// Constructor
@@ -107,6 +136,26 @@ public:
 			WorkGroup *work_group,
 			int wavefront_pool_id);
 
+	/// Uops are allocated from the pool of their compute unit. Use
+	/// ComputeUnit::NewUop() to create them.
+	static void *operator new(size_t size, misc::SlotPool &pool)
+	{
+		return pool.Allocate(size);
+	}
+
+	/// Release the memory of a uop back to its pool
+	static void operator delete(void *ptr)
+	{
+		misc::SlotPool::Free(ptr);
+	}
+
+	/// Counterpart of the pool-based operator new, invoked only if the
+	/// constructor throws an exception.
+	static void operator delete(void *ptr, misc::SlotPool &pool)
+	{
+		misc::SlotPool::Free(ptr);
+	}
+
 	/// Flags updated during instruction execution
 	bool vector_memory_read;
 	bool vector_memory_write;
@@ -123,31 +172,75 @@ public:
 	int vm_cnt;
 	int exp_cnt;
 
-	/// Part of a GPU instruction specific for each work-item within wavefront
-	struct WorkItemInfo
+	/// Return true if the uop carries per-work-item memory information,
+	/// captured at fetch time for vector memory and LDS instructions only.
+	bool hasWorkItemInfo() const { return work_item_info_captured; }
+
+	/// Capture the global memory and LDS accesses performed by each
+	/// work-item of the wavefront in its last emulated instruction. The
+	/// information is only recorded if the instruction associated with the
+	/// uop is a vector memory (MUBUF/MTBUF) or LDS (DS) instruction.
+	void CaptureWorkItemInfo();
+
+	/// Return the global memory address accessed by the given work-item
+	unsigned getGlobalMemoryAccessAddress(int id_in_wavefront) const
 	{
-		// For global memory accesses
-		unsigned int global_memory_access_address;
-		unsigned int global_memory_access_size;
+		assert(work_item_info_captured);
+		return global_memory_access_address_list[id_in_wavefront];
+	}
 
-		// Flags
-		// Active after instruction emulation
-		bool active = true;
+	/// Return the size of the global memory access of the given work-item
+	unsigned getGlobalMemoryAccessSize(int id_in_wavefront) const
+	{
+		assert(work_item_info_captured);
+		return global_memory_access_size_list[id_in_wavefront];
+	}
 
-		// Mark a work item that has successfully made a cache access
-		bool accessed_cache = false;
+	/// Return whether the given work-item already made a successful vector
+	/// cache access for this uop.
+	bool getAccessedCache(int id_in_wavefront) const
+	{
+		return accessed_cache_mask & (1ull << id_in_wavefront);
+	}
 
-		// Number of lds_accesses
-		int lds_access_count;
+	/// Mark the given work-item as having accessed the vector cache
+	void setAccessedCache(int id_in_wavefront)
+	{
+		accessed_cache_mask |= 1ull << id_in_wavefront;
+	}
 
-		// Information for each lds_access
-		WorkItem::MemoryAccess lds_access[WorkItem::MaxLdsAccessesPerInst];
-	};
+	/// Return the number of LDS accesses performed by the given work-item
+	int getLdsAccessCount(int id_in_wavefront) const
+	{
+		assert(work_item_info_captured);
+		return lds_access_count_list[id_in_wavefront];
+	}
 
-	/// Vector containing work item specific information.  Indices of this
-	/// vector must be the same as the corresponding work item's id
-	/// in wavefront.
-	std::vector<WorkItemInfo> work_item_info_list;
+	/// Return the type of the LDS access with the given index performed by
+	/// the given work-item.
+	WorkItem::MemoryAccessType getLdsAccessType(int id_in_wavefront,
+			int index) const
+	{
+		assert(index < getLdsAccessCount(id_in_wavefront));
+		return (WorkItem::MemoryAccessType)
+				lds_access_type_list[index][id_in_wavefront];
+	}
+
+	/// Return the address of the LDS access with the given index performed
+	/// by the given work-item.
+	unsigned getLdsAccessAddress(int id_in_wavefront, int index) const
+	{
+		assert(index < getLdsAccessCount(id_in_wavefront));
+		return lds_access_addr_list[index][id_in_wavefront];
+	}
+
+	/// Return the size of the LDS access with the given index performed by
+	/// the given work-item.
+	unsigned getLdsAccessSize(int id_in_wavefront, int index) const
+	{
+		assert(index < getLdsAccessCount(id_in_wavefront));
+		return lds_access_size_list[index][id_in_wavefront];
+	}
 
 	/// Return the unique identifier assigned in sequential order to the
 	/// uop when it was created.
@@ -82,9 +82,8 @@ void VectorMemoryUnit::Issue(std::unique_ptr<Uop> uop)
 
 void VectorMemoryUnit::Complete()
 {
-	// Get compute unit and GPU objects
+	// Get compute unit object
 	ComputeUnit *compute_unit = getComputeUnit();
-	Gpu *gpu = compute_unit->getGpu();
 
 	// Sanity check the write buffer
 	assert((int) write_buffer.size() <= width);
@@ -115,17 +114,23 @@ void VectorMemoryUnit::Complete()
 		compute_unit->getScoreboard(uop->getWavefrontPoolId())->
 			ReleaseRegisters(uop->getWavefront(), uop);
 
-		// Access complete, remove the uop from the queue and get the 
-		// iterator for the next element
-		it = write_buffer.erase(it);
+		// Access complete
 		assert(uop->getWorkGroup()
 				->inflight_instructions > 0);
 		uop->getWorkGroup()->
 				inflight_instructions--;
 
+		// Latency from issue to completion
+		compute_unit->RecordUopLatency(uop);
+
+		// Remove the uop from the queue and get the iterator for the
+		// next element
+		it = write_buffer.erase(it);
+
 		// Statistics
 		num_instructions++;
-		gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+		compute_unit->last_complete_cycle = compute_unit->getTiming()->
+				getCycle();
 	}
 }
 
@@ -330,42 +335,38 @@ void VectorMemoryUnit::Memory()
 			if (uop->getWavefront()->isWorkItemActive(
 					work_item->getIdInWavefront()))
 			{
-				// Get the work item uop
-				Uop::WorkItemInfo *work_item_info = 
-						&uop->work_item_info_list[
-						work_item->getIdInWavefront()];
-
-				// Check if the work item info struct has
-				// already made a successful vector cache
-				// access. If so, move on to the next work item.
-				if (work_item_info->accessed_cache)	
+				// Check if the work item has already made a
+				// successful vector cache access. If so, move on
+				// to the next work item.
+				int id_in_wavefront = work_item->getIdInWavefront();
+				if (uop->getAccessedCache(id_in_wavefront))
 					continue;
 
-				// Translate virtual address to a physical 
-				// address
-				unsigned physical_address = compute_unit->
-						getGpu()->
-						getMmu()->
-						TranslateVirtualAddress(
-						uop->getWorkGroup()->
-						getNDRange()->
-						address_space,
-						work_item_info->
-						global_memory_access_address);
-		
+				// Virtual address of the access. It is
+				// translated into a physical address when the
+				// access is submitted to the vector cache.
+				unsigned virtual_address = uop->
+						getGlobalMemoryAccessAddress(
+						id_in_wavefront);
 
 				// Make sure we can access the vector cache. If 
 				// so, submit the access. If we can access the
-				// cache, mark the accessed flag of the work 
-				// item info struct.
+				// cache, mark the work item as accessed in the
+				// uop. Availability only depends on the free
+				// ports and MSHR entries of the cache, not on
+				// the address itself.
 				if (compute_unit->vector_cache->
-						canAccess(physical_address))
+						canAccess(virtual_address))
 				{
-					compute_unit->vector_cache->Access(
+					compute_unit->Access(
+							compute_unit->vector_cache,
 							module_access_type,
-							physical_address, 
+							uop->getWorkGroup()->
+							getNDRange()->
+							address_space,
+							virtual_address,
 							&uop->global_memory_witness);
-					work_item_info->accessed_cache = true;
+					uop->setAccessedCache(id_in_wavefront);
 
 					// Access global memory
 					uop->global_memory_witness--;
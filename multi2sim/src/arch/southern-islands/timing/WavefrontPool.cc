@@ -45,6 +45,10 @@ void WavefrontPoolEntry::Clear()
 	ready_next_cycle = false;
 	wavefront_finished = false;
 	active = false;
+
+	// Invalidate the instruction buffer. The witness is not reset, since
+	// accesses still in flight will increment it when they complete.
+	instruction_buffer_block = -1;
 }
 
 
@@ -143,6 +143,10 @@ public:
 	/// Flag indicates the mode transfer from pre-execution mode to normal mode
 	bool specuation_to_normal = false;
 
+	/// Identifier of the last uop created for the wavefront before it
+	/// took a checkpoint to pre-execute instructions
+	long long checkpoint_uop_id = 0;
+
 	/// Indicates whether the wavefront is waiting for a long latency operation
 	bool long_operation_wait = false;
 
@@ -156,6 +160,17 @@ public:
 	/// current pc for wavefront normal mode
 	long long normal_fetch_pc = 0;
 
+	/// Virtual address of the instruction memory block currently held in
+	/// the instruction buffer of the wavefront, or -1 if the buffer is
+	/// empty. Only used when the compute unit has an instruction cache.
+	long long instruction_buffer_block = -1;
+
+	/// Witness for the instruction cache accesses filling the instruction
+	/// buffer. It is decremented for every access issued, and incremented
+	/// by the memory hierarchy when the access completes. The buffer is
+	/// ready when the witness is back to zero.
+	int instruction_buffer_witness = 0;
+
 	// list of register number dependent with a long op
 	std::list<int> long_op_dependent_register;
 };
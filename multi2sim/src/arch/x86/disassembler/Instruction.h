@@ -190,6 +190,7 @@ private:
 	// Prefixes
 	Reg segment;  // Reg. used to override segment
 	int prefixes;  // Mask of prefixes of type 'X86InstPrefix'
+	bool lock;  // Lock prefix, not part of the prefix mask
 	int op_size;  // Operand size: 2 or 4, default 4
 	int addr_size;  // Address size: 2 or 4, default 4
 	
@@ -286,6 +287,9 @@ public:
 	/// Return the opcode index (value between 0 and 7)
 	int getOpIndex() const { return opindex; }
 
+	/// Return whether the instruction has a \c lock prefix
+	bool hasLockPrefix() const { return lock; }
+
 	/// Return segment register
 	Reg getSegment() const { return segment; }
 
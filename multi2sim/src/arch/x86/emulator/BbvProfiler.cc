@@ -0,0 +1,117 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include <lib/cpp/Misc.h>
+
+#include "BbvProfiler.h"
+#include "Emulator.h"
+
+
+namespace x86
+{
+
+BbvProfiler::BbvProfiler(const std::string &path, long long interval) :
+		file(path),
+		interval(interval)
+{
+	if (!file)
+		throw Error(misc::fmt("%s: Cannot open basic block vector file",
+				path.c_str()));
+	os = &file;
+}
+
+
+BbvProfiler::BbvProfiler(std::ostream &os, long long interval) :
+		os(&os),
+		interval(interval)
+{
+}
+
+
+BbvProfiler::~BbvProfiler()
+{
+	Flush();
+}
+
+
+void BbvProfiler::CountBlock(Block &block)
+{
+	if (block.size == block.counted)
+		return;
+
+	// Assign identifier to new block
+	auto it = block_ids.emplace(block.eip, block_ids.size() + 1).first;
+	counts[it->second] += block.size - block.counted;
+	block.counted = block.size;
+}
+
+
+void BbvProfiler::DumpInterval()
+{
+	// Account for blocks still being executed
+	for (auto &it : blocks)
+		CountBlock(it.second);
+
+	// Dump frequency vector
+	*os << 'T';
+	for (auto &it : counts)
+		*os << ':' << it.first << ':' << it.second << ' ';
+	*os << '\n';
+
+	// New interval
+	counts.clear();
+	num_instructions = 0;
+	num_intervals++;
+}
+
+
+void BbvProfiler::Record(int context_id, unsigned eip, unsigned size,
+		unsigned next_eip)
+{
+	// Start a new block
+	Block &block = blocks[context_id];
+	if (!block.size)
+		block.eip = eip;
+	block.size++;
+	num_instructions++;
+
+	// The block ends if the instruction does not fall through
+	if (next_eip != eip + size)
+	{
+		CountBlock(block);
+		block.size = 0;
+		block.counted = 0;
+	}
+
+	// End of interval
+	if (num_instructions == interval)
+		DumpInterval();
+}
+
+
+void BbvProfiler::Flush()
+{
+	if (num_instructions)
+		DumpInterval();
+	os->flush();
+}
+
+}  // namespace x86
@@ -0,0 +1,138 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMULATOR_BBV_PROFILER_H
+#define ARCH_X86_EMULATOR_BBV_PROFILER_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+
+namespace x86
+{
+
+/// Basic block vector profiler. Execution is divided in intervals of a fixed
+/// number of instructions, and the number of instructions executed in each
+/// basic block during an interval is dumped as one line of a SimPoint
+/// frequency vector file:
+///
+///	T:<block>:<count> :<block>:<count> ...
+///
+/// Basic blocks are identified by their start address, and numbered from 1
+/// in order of first execution. A block ends with the first instruction
+/// that does not fall through to the next one.
+class BbvProfiler
+{
+	// Basic block being executed by a context
+	struct Block
+	{
+		// Address of the first instruction
+		unsigned eip = 0;
+
+		// Instructions executed in the block so far
+		int size = 0;
+
+		// Instructions of the block already accounted for in a
+		// previous interval
+		int counted = 0;
+	};
+
+	// Output stream
+	std::ostream *os;
+
+	// Output file, if the profile is dumped into a file
+	std::ofstream file;
+
+	// Instructions in each interval
+	long long interval;
+
+	// Instructions executed in the current interval
+	long long num_instructions = 0;
+
+	// Number of intervals dumped
+	long long num_intervals = 0;
+
+	// Block being executed by each context, indexed by context
+	// identifier
+	std::unordered_map<int, Block> blocks;
+
+	// Identifier assigned to each block, indexed by its start address
+	std::unordered_map<unsigned, int> block_ids;
+
+	// Instructions executed in each block in the current interval,
+	// indexed by block identifier
+	std::map<int, long long> counts;
+
+	// Add the instructions of a block not accounted for yet to the current
+	// interval
+	void CountBlock(Block &block);
+
+	// Dump the current interval and start a new one
+	void DumpInterval();
+
+public:
+
+	/// Constructor
+	///
+	/// \param path
+	///	Output file
+	///
+	/// \param interval
+	///	Number of instructions in each interval
+	///
+	BbvProfiler(const std::string &path, long long interval);
+
+	/// Constructor dumping the profile into an output stream
+	BbvProfiler(std::ostream &os, long long interval);
+
+	/// Destructor. The last interval is dumped even if incomplete.
+	~BbvProfiler();
+
+	/// Record the execution of a non-speculative instruction
+	///
+	/// \param context_id
+	///	Identifier of the context executing the instruction
+	///
+	/// \param eip
+	///	Address of the instruction
+	///
+	/// \param size
+	///	Size of the instruction in bytes
+	///
+	/// \param next_eip
+	///	Address of the next instruction executed by the context
+	///
+	void Record(int context_id, unsigned eip, unsigned size,
+			unsigned next_eip);
+
+	/// Dump the incomplete interval, if any
+	void Flush();
+
+	/// Return the number of intervals dumped
+	long long getNumIntervals() const { return num_intervals; }
+
+	/// Return the number of distinct basic blocks executed
+	int getNumBlocks() const { return block_ids.size(); }
+};
+
+}  // namespace x86
+
+#endif
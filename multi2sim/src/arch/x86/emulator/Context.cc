@@ -103,12 +103,21 @@ Context::~Context()
 
 void Context::UpdateState(unsigned state)
 {
-	// If the difference between the old and new state lies in other
-	// states other than 'ContextSpecMode', a reschedule is marked. */
+	// Entering or leaving speculative mode does not affect the emulator
+	// context lists or timer. The timing simulator recovers contexts from
+	// speculative mode in the commit stage of several cores concurrently,
+	// so shared emulator state must not be touched in this case.
 	unsigned diff = this->state ^ state;
-	if (diff & ~StateSpecMode)
-		emulator->schedule_signal = true;
-	
+	if (!(diff & ~StateSpecMode))
+	{
+		this->state = state;
+		return;
+	}
+
+	// The difference between the old and new state lies in states other
+	// than 'ContextSpecMode', so a reschedule is marked.
+	emulator->schedule_signal = true;
+
 	// Update state
 	this->state = state;
 	if (this->state & StateFinished)
@@ -133,8 +142,8 @@ void Context::UpdateState(unsigned state)
 	emulator->UpdateFinishedContexts(this, this->state & StateFinished);
 	emulator->UpdateSuspendedContexts(this, this->state & StateSuspended);
 
-	// Dump new state (ignore ContextSpecMode state, it's too frequent)
-	if (Emulator::context_debug && (diff & ~StateSpecMode))
+	// Dump new state
+	if (Emulator::context_debug)
 	{
 		Emulator::context_debug << misc::fmt(
 				"[%s] Instruction %lld: Changed state to %s\n",
@@ -368,6 +377,9 @@ void Context::Initialize()
 
 	// Create file descriptor table
 	file_table = misc::new_shared<comm::FileTable>();
+
+	// Create an empty loader, with no program
+	loader = misc::new_shared<Loader>();
 }
 
 
@@ -750,15 +762,15 @@ void Context::HostThreadTimerCancel()
 }
 
 
-void Context::Execute()
+void Context::DecodeInstruction()
 {
 	// Memory permissions should not be checked if the context is executing in
 	// speculative mode. This will prevent guest segmentation faults to occur.
+	// The safe mode of the memory is not modified otherwise, since other
+	// contexts can be accessing it concurrently.
 	bool spec_mode = getState(StateSpecMode);
 	if (spec_mode)
 		memory->setSafe(false);
-	else
-		memory->setSafeDefault();
 
 	// Read instruction from memory. Memory should be accessed here in unsafe mode
 	// (i.e., allowing segmentation faults) if executing speculatively.
@@ -767,18 +779,18 @@ void Context::Execute()
 			regs.getEip(), 20, mem::Memory::AccessExec);
 	if (!buffer_ptr)
 	{
-		// Disable safe mode. If a part of the 20 read bytes does not
+		// Read in unsafe mode. If a part of the 20 read bytes does not
 		// belong to the actual instruction, and they lie on a page with
 		// no permissions, this would generate an undesired protection
 		// fault.
-		memory->setSafe(false);
 		buffer_ptr = (unsigned char *)buffer;
-		memory->Access(regs.getEip(), 20, (char *)buffer_ptr,
+		memory->AccessUnsafe(regs.getEip(), 20, (char *)buffer_ptr,
 				mem::Memory::AccessExec);
 	}
 
 	// Return to default safe mode
-	memory->setSafeDefault();
+	if (spec_mode)
+		memory->setSafeDefault();
 
 	// Disassemble
 	inst.Decode((char *)buffer_ptr, regs.getEip());
@@ -790,6 +802,30 @@ void Context::Execute()
 				buffer_ptr[0], buffer_ptr[1],
 				buffer_ptr[2], buffer_ptr[3]));
 	}
+}
+
+
+bool Context::isSerializingInstruction() const
+{
+	// System calls
+	Instruction::Opcode opcode = inst.getOpcode();
+	if (opcode == Instruction::Opcode_int_imm8)
+		return true;
+
+	// Atomic read-modify-write instructions, either with a lock prefix or
+	// exchanging a register with memory
+	if (inst.hasLockPrefix())
+		return true;
+	return (opcode == Instruction::Opcode_xchg_rm8_r8 ||
+			opcode == Instruction::Opcode_xchg_rm16_r16 ||
+			opcode == Instruction::Opcode_xchg_rm32_r32) &&
+			inst.getModRmMod() != 3;
+}
+
+
+void Context::ExecuteInstruction()
+{
+	bool spec_mode = getState(StateSpecMode);
 
 	// Clear existing list of microinstructions, though the architectural
 	// simulator might have cleared it already. A new list will be generated
@@ -858,11 +894,44 @@ void Context::Execute()
 	if (emulator->call_debug)
 		DebugCallInst();
 
+	// Basic block vector profile
+	BbvProfiler *bbv_profiler = emulator->getBbvProfiler();
+	if (bbv_profiler && !spec_mode)
+		bbv_profiler->Record(getId(), current_eip, inst.getSize(),
+				regs.getEip());
+}
+
+
+void Context::Execute()
+{
+	// Read, decode, and emulate the instruction
+	DecodeInstruction();
+	ExecuteInstruction();
+
 	// Stats
 	emulator->incNumInstructions();
 }
 
 
+int Context::ExecuteConcurrent(int max_instructions)
+{
+	assert(!getState(StateSpecMode));
+	int count = 0;
+	while (count < max_instructions)
+	{
+		// Leave the instruction for the emulator to run it alone
+		DecodeInstruction();
+		if (isSerializingInstruction())
+			break;
+
+		// Emulate it
+		ExecuteInstruction();
+		count++;
+	}
+	return count;
+}
+
+
 void Context::FinishGroup(int exit_code)
 {
 	// Make call on group parent only
@@ -495,6 +495,18 @@ private:
 	// Table of functions
 	static ExecuteInstFn execute_inst_fn[Instruction::OpcodeCount];
 
+	// Read the instruction pointed to by register eip from memory and
+	// decode it into field 'inst'
+	void DecodeInstruction();
+
+	// Emulate the instruction decoded in field 'inst'
+	void ExecuteInstruction();
+
+	// Return whether the instruction decoded in field 'inst' must run
+	// while no other context is executing. These are system calls and
+	// atomic read-modify-write instructions.
+	bool isSerializingInstruction() const;
+
 	// Safe memory accesses, based on the current speculative mode
 	void MemoryRead(unsigned int address, int size, void *buffer);
 	void MemoryWrite(unsigned int address, int size, void *buffer);
@@ -737,7 +749,7 @@ public:
 	/// in unit tests.
 	/// This function initialize memory object, speculative memory, 
 	/// memory management unit, spaces in memory management unit,
-	/// and an empty file_table.
+	/// an empty file_table, and an empty loader.
 	/// This function shoule only be used from unit test. In real 
 	/// execution environment, function Load can initialize all these
 	/// field and loading an executable into the Loader. If a context
@@ -760,6 +772,29 @@ public:
 	/// Initialize the context by forking a parent context.
 	void Fork(Context *parent);
 
+	/// Save the state of the context into a checkpoint output stream,
+	/// including registers, memory image, open files, and signal state
+	/// (ContextCheckpoint.cc). Open pipes, sockets, or devices cannot be
+	/// checkpointed.
+	///
+	/// \throw
+	///	An x86::Error is thrown if the context cannot be checkpointed.
+	void SaveCheckpoint(std::ostream &os) const;
+
+	/// Initialize the context from a checkpoint created with
+	/// SaveCheckpoint(), as an alternative to Load(). Files open when
+	/// the checkpoint was saved are reopened at the same offset.
+	///
+	/// \param buffer
+	///	Position in the buffer where the context state starts
+	///
+	/// \param end
+	///	Past-the-end position of the buffer
+	///
+	/// \return
+	///	Position in the buffer right after the context state
+	const char *LoadCheckpoint(const char *buffer, const char *end);
+
 	/// Return the MMU used by the context.
 	mem::Mmu *getMmu() const { return mmu; }
 
@@ -844,6 +879,17 @@ public:
 	/// register \c eip.
 	void Execute();
 
+	/// Run up to \a max_instructions instructions, stopping before the
+	/// first system call or atomic read-modify-write instruction, which
+	/// must be run with Execute() while no other context is executing.
+	/// Contexts can invoke this function concurrently. The instructions
+	/// are not added to the emulator instruction count.
+	///
+	/// \return
+	///	The number of instructions executed
+	///
+	int ExecuteConcurrent(int max_instructions);
+
 	/// Return a reference of the register file
 	Regs &getRegs() { return regs; }
 
@@ -855,6 +901,17 @@ public:
 		return memory.get();
 	}
 
+	/// Return the file descriptor table
+	comm::FileTable *getFileTable() const { return file_table.get(); }
+
+	/// Return the table of signal handlers
+	SignalHandlerTable *getSignalHandlerTable() const {
+		return signal_handler_table.get();
+	}
+
+	/// Return the table of signal masks
+	SignalMaskTable &getSignalMaskTable() { return signal_mask_table; }
+
 	/// Force a new 'eip' value for the context. The forced value should be
 	/// the same as the current 'eip' under normal circumstances. If it is
 	/// not, speculative execution starts, which will end on the next call
@@ -0,0 +1,351 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <type_traits>
+#include <unistd.h>
+
+#include <lib/cpp/Misc.h>
+
+#include "Context.h"
+#include "Emulator.h"
+
+
+namespace x86
+{
+
+// The register file is saved as a raw copy
+static_assert(std::is_trivially_copyable<Regs>::value,
+		"Regs must be trivially copyable to be checkpointed");
+
+
+namespace
+{
+
+// Write a value with a trivial representation
+template<typename T> void WriteValue(std::ostream &os, const T &value)
+{
+	os.write((const char *) &value, sizeof value);
+}
+
+// Write a string, preceded by its length
+void WriteString(std::ostream &os, const std::string &s)
+{
+	WriteValue<unsigned>(os, s.size());
+	os.write(s.data(), s.size());
+}
+
+// Write a vector of strings, preceded by its size
+void WriteStrings(std::ostream &os, const std::vector<std::string> &v)
+{
+	WriteValue<unsigned>(os, v.size());
+	for (auto &s : v)
+		WriteString(os, s);
+}
+
+// Write a signal set as its 64-bit mask
+void WriteSignalSet(std::ostream &os, const SignalSet &set)
+{
+	const misc::Bitmap &bitmap = set.getBitmap();
+	unsigned long long mask = 0;
+	memcpy(&mask, bitmap.getBuffer(), std::min(sizeof mask,
+			bitmap.getSizeInBytes()));
+	WriteValue(os, mask);
+}
+
+
+// Sequential reader of checkpoint fields from a buffer
+class Reader
+{
+	const char *buffer;
+	const char *end;
+
+public:
+
+	Reader(const char *buffer, const char *end) :
+			buffer(buffer),
+			end(end)
+	{
+	}
+
+	const char *getBuffer() const { return buffer; }
+
+	void setBuffer(const char *buffer) { this->buffer = buffer; }
+
+	void Read(void *data, size_t size)
+	{
+		if ((size_t) (end - buffer) < size)
+			throw Error("Truncated checkpoint");
+		memcpy(data, buffer, size);
+		buffer += size;
+	}
+
+	template<typename T> T ReadValue()
+	{
+		T value;
+		Read(&value, sizeof value);
+		return value;
+	}
+
+	std::string ReadString()
+	{
+		unsigned size = ReadValue<unsigned>();
+		if ((size_t) (end - buffer) < size)
+			throw Error("Truncated checkpoint");
+		std::string s(buffer, size);
+		buffer += size;
+		return s;
+	}
+
+	std::vector<std::string> ReadStrings()
+	{
+		std::vector<std::string> v(ReadValue<unsigned>());
+		for (auto &s : v)
+			s = ReadString();
+		return v;
+	}
+
+	SignalSet ReadSignalSet()
+	{
+		SignalSet set;
+		unsigned long long mask = ReadValue<unsigned long long>();
+		for (int sig = 1; sig <= 64; sig++)
+			if (mask & (1ull << (sig - 1)))
+				set.Add(sig);
+		return set;
+	}
+};
+
+}  // anonymous namespace
+
+
+void Context::SaveCheckpoint(std::ostream &os) const
+{
+	// Only contexts executing regular code can be saved
+	if (state & (StateSuspended | StateSpecMode | StateFinished
+			| StateZombie))
+		throw Error(misc::fmt("Context %d: cannot save a checkpoint of "
+				"a suspended, speculative, or finished context",
+				getId()));
+
+	// Registers
+	WriteValue(os, regs);
+
+	// Loader
+	WriteStrings(os, loader->args);
+	WriteStrings(os, loader->env);
+	WriteString(os, loader->interp);
+	WriteString(os, loader->exe);
+	WriteString(os, loader->cwd);
+	WriteString(os, loader->stdin_file_name);
+	WriteString(os, loader->stdout_file_name);
+	WriteValue(os, loader->stack_base);
+	WriteValue(os, loader->stack_top);
+	WriteValue(os, loader->stack_size);
+	WriteValue(os, loader->environ_base);
+	WriteValue(os, loader->bottom);
+	WriteValue(os, loader->prog_entry);
+	WriteValue(os, loader->interp_prog_entry);
+	WriteValue(os, loader->phdt_base);
+	WriteValue(os, loader->phdr_count);
+	WriteValue(os, loader->at_random_addr);
+	WriteValue(os, loader->at_random_addr_holder);
+
+	// Miscellaneous state
+	WriteValue(os, glibc_segment_base);
+	WriteValue(os, glibc_segment_limit);
+	WriteValue(os, clear_child_tid);
+	WriteValue(os, robust_list_head);
+
+	// File descriptors. Open files are recorded with their current offset
+	// to be reopened on restore.
+	WriteValue(os, file_table->getSize());
+	for (int index = 0; index < file_table->getSize(); index++)
+	{
+		comm::FileDescriptor *desc = file_table->getFileDescriptor(index);
+		WriteValue<bool>(os, desc);
+		if (!desc)
+			continue;
+
+		// Only files that can be reopened are supported
+		comm::FileDescriptor::Type type = desc->getType();
+		if (type != comm::FileDescriptor::TypeRegular &&
+				type != comm::FileDescriptor::TypeStandard &&
+				type != comm::FileDescriptor::TypeVirtual)
+			throw Error(misc::fmt("Context %d: cannot save a "
+					"checkpoint with an open %s file "
+					"descriptor (%d)", getId(),
+					comm::FileDescriptor::TypeTypeMap[type],
+					index));
+
+		// Dump
+		long long offset = desc->getPath().empty() ? 0 :
+				lseek(desc->getHostIndex(), 0, SEEK_CUR);
+		WriteValue(os, type);
+		WriteValue(os, desc->getFlags());
+		WriteString(os, desc->getPath());
+		WriteValue(os, std::max(offset, 0ll));
+	}
+
+	// Signal masks, and register file backed up by a running signal
+	// handler, if any
+	WriteSignalSet(os, signal_mask_table.getPending());
+	WriteSignalSet(os, signal_mask_table.getBlocked());
+	WriteSignalSet(os, signal_mask_table.getBackup());
+	WriteValue(os, signal_mask_table.getRetCodePtr());
+	WriteValue(os, signal_mask_table.hasRegs());
+	if (signal_mask_table.hasRegs())
+		WriteValue(os, signal_mask_table.getRegs());
+
+	// Signal handlers
+	for (int sig = 1; sig <= 64; sig++)
+	{
+		SignalHandler *handler = signal_handler_table->
+				getSignalHandler(sig);
+		WriteValue(os, handler->getHandler());
+		WriteValue(os, handler->getFlags());
+		WriteValue(os, handler->getRestorer());
+		WriteSignalSet(os, handler->getMask());
+	}
+
+	// Memory image
+	memory->SaveCheckpoint(os);
+}
+
+
+const char *Context::LoadCheckpoint(const char *buffer, const char *end)
+{
+	// Program must not have been loaded before
+	if (loader.get() || memory.get())
+		throw misc::Panic("Context already initialized");
+	Reader reader(buffer, end);
+
+	// Registers
+	regs = reader.ReadValue<Regs>();
+
+	// Loader
+	loader = misc::new_shared<Loader>();
+	loader->args = reader.ReadStrings();
+	loader->env = reader.ReadStrings();
+	loader->interp = reader.ReadString();
+	loader->exe = reader.ReadString();
+	loader->cwd = reader.ReadString();
+	loader->stdin_file_name = reader.ReadString();
+	loader->stdout_file_name = reader.ReadString();
+	loader->stack_base = reader.ReadValue<unsigned>();
+	loader->stack_top = reader.ReadValue<unsigned>();
+	loader->stack_size = reader.ReadValue<unsigned>();
+	loader->environ_base = reader.ReadValue<unsigned>();
+	loader->bottom = reader.ReadValue<unsigned>();
+	loader->prog_entry = reader.ReadValue<unsigned>();
+	loader->interp_prog_entry = reader.ReadValue<unsigned>();
+	loader->phdt_base = reader.ReadValue<unsigned>();
+	loader->phdr_count = reader.ReadValue<unsigned>();
+	loader->at_random_addr = reader.ReadValue<unsigned>();
+	loader->at_random_addr_holder = reader.ReadValue<unsigned>();
+
+	// Miscellaneous state
+	glibc_segment_base = reader.ReadValue<unsigned>();
+	glibc_segment_limit = reader.ReadValue<unsigned>();
+	clear_child_tid = reader.ReadValue<unsigned>();
+	robust_list_head = reader.ReadValue<unsigned>();
+
+	// File descriptors. Standard descriptors without a path are bound to
+	// the host standard streams, and the rest are reopened. Descriptors
+	// sharing a path, such as a redirected stdout and stderr, share the
+	// host descriptor as well.
+	file_table = misc::new_shared<comm::FileTable>();
+	std::map<std::string, int> host_indexes;
+	int size = reader.ReadValue<int>();
+	for (int index = 0; index < size; index++)
+	{
+		// Free entry
+		file_table->freeFileDescriptor(index);
+		if (!reader.ReadValue<bool>())
+			continue;
+
+		// Read descriptor
+		auto type = reader.ReadValue<comm::FileDescriptor::Type>();
+		int flags = reader.ReadValue<int>();
+		std::string path = reader.ReadString();
+		long long offset = reader.ReadValue<long long>();
+
+		// Reopen host file, without truncating it again
+		int host_index = index;
+		if (!path.empty() && host_indexes.count(path))
+		{
+			host_index = host_indexes[path];
+		}
+		else if (!path.empty())
+		{
+			host_index = open(path.c_str(), flags &
+					~(O_CREAT | O_EXCL | O_TRUNC));
+			if (host_index < 0)
+				throw Error(misc::fmt("%s: cannot reopen file "
+						"from checkpoint", path.c_str()));
+			if (!(flags & O_APPEND))
+				lseek(host_index, offset, SEEK_SET);
+			host_indexes[path] = host_index;
+		}
+		file_table->newFileDescriptor(type, index, host_index,
+				path, flags);
+	}
+
+	// Signal masks
+	signal_mask_table.getPending() = reader.ReadSignalSet();
+	signal_mask_table.setBlocked(reader.ReadSignalSet());
+	signal_mask_table.setBackup(reader.ReadSignalSet());
+	signal_mask_table.setRetCodePtr(reader.ReadValue<unsigned>());
+	if (reader.ReadValue<bool>())
+		signal_mask_table.setRegs(reader.ReadValue<Regs>());
+
+	// Signal handlers
+	signal_handler_table = misc::new_shared<SignalHandlerTable>();
+	for (int sig = 1; sig <= 64; sig++)
+	{
+		SignalHandler *handler = signal_handler_table->
+				getSignalHandler(sig);
+		unsigned address = reader.ReadValue<unsigned>();
+		unsigned flags = reader.ReadValue<unsigned>();
+		unsigned restorer = reader.ReadValue<unsigned>();
+		handler->set(address, flags, restorer);
+		handler->getMask() = reader.ReadSignalSet();
+	}
+
+	// Memory image
+	memory = misc::new_shared<mem::Memory>();
+	reader.setBuffer(memory->LoadCheckpoint(reader.getBuffer(), end));
+
+	// Structures derived from the memory image, created as in Load()
+	assert(!mmu_space);
+	mmu_space = mmu->newSpace();
+	spec_mem = misc::new_unique<mem::SpecMem>(memory.get());
+	call_stack = misc::new_unique<comm::CallStack>(loader->exe);
+
+	// Debug
+	emulator->loader_debug << misc::fmt("Context %d restored from "
+			"checkpoint at eip 0x%x\n", getId(), regs.getEip());
+
+	// Return position after the context
+	return reader.getBuffer();
+}
+
+}  // namespace x86
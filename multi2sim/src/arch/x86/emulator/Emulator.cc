@@ -17,6 +17,14 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <arch/x86/disassembler/Disassembler.h>
 #include <lib/esim/Engine.h>
 
@@ -35,6 +43,17 @@ std::string Emulator::syscall_debug_file;
 
 long long Emulator::max_instructions;
 
+std::string Emulator::save_checkpoint_file;
+std::string Emulator::load_checkpoint_file;
+long long Emulator::checkpoint_instruction;
+bool Emulator::checkpoint_magic;
+
+std::string Emulator::bbv_file;
+long long Emulator::bbv_interval = 100000000;
+
+int Emulator::num_threads = 1;
+int Emulator::thread_quantum = 1000;
+
 std::unique_ptr<Emulator> Emulator::instance;
 
 misc::Debug Emulator::call_debug;
@@ -91,6 +110,80 @@ void Emulator::RegisterOptions()
 			"instructions. On x86 detailed simulation, it is given as "
 			"the number of committed (non-speculative) instructions. "
 			"A value of 0 means no limit.");
+
+	// Option --x86-save-checkpoint <file>
+	command_line->RegisterString("--x86-save-checkpoint <file>",
+			save_checkpoint_file,
+			"Save the state of the x86 emulator into a checkpoint "
+			"file and finish the simulation, when the condition given "
+			"with option '--x86-checkpoint-at' or "
+			"'--x86-checkpoint-magic' is met. Checkpoints are taken "
+			"during functional simulation, or during the fast-forward "
+			"phase of detailed simulation. Only programs running on a "
+			"single context can be checkpointed.");
+
+	// Option --x86-checkpoint-at <num_inst>
+	command_line->RegisterInt64("--x86-checkpoint-at <num_inst> "
+			"(default = 0)",
+			checkpoint_instruction,
+			"Number of emulated x86 instructions after which the "
+			"checkpoint given in '--x86-save-checkpoint' is saved.");
+
+	// Option --x86-checkpoint-magic
+	command_line->RegisterBool("--x86-checkpoint-magic",
+			checkpoint_magic,
+			"Save the checkpoint given in '--x86-save-checkpoint' "
+			"when the guest program executes the magic instruction "
+			"'xchg %bx, %bx', encoded as bytes 66 87 db.");
+
+	// Option --x86-load-checkpoint <file>
+	command_line->RegisterString("--x86-load-checkpoint <file>",
+			load_checkpoint_file,
+			"Restore the state of the x86 emulator from a checkpoint "
+			"file created with '--x86-save-checkpoint', instead of "
+			"loading a program from the command line. Files open by "
+			"the guest program when the checkpoint was saved are "
+			"reopened.");
+
+	// Option --x86-bbv <file>
+	command_line->RegisterString("--x86-bbv <file>", bbv_file,
+			"Profile the basic blocks executed by x86 programs, and "
+			"dump one basic block vector per interval in SimPoint "
+			"format into the given file. Basic blocks are numbered "
+			"in order of first execution. The resulting file can be "
+			"used by SimPoint to select representative intervals "
+			"for option '--x86-simpoints'.");
+
+	// Option --x86-bbv-interval <num_inst>
+	command_line->RegisterInt64("--x86-bbv-interval <num_inst> "
+			"(default = 100000000)",
+			bbv_interval,
+			"Number of non-speculative x86 instructions in each "
+			"interval of the basic block vector profile, and in "
+			"each simulation point given in '--x86-simpoints'.");
+
+	// Option --x86-emu-threads <num>
+	command_line->RegisterInt32("--x86-emu-threads <num> (default = 1)",
+			num_threads,
+			"Number of host threads used to run the contexts of "
+			"multithreaded guest programs concurrently, in "
+			"functional simulation and in the fast-forward phase of "
+			"detailed simulation. System calls and atomic "
+			"instructions (lock prefix, or xchg with memory) run "
+			"while all other contexts are stopped. The interleaving "
+			"of memory accesses of different contexts depends on the "
+			"host, so programs with data races, or whose threads "
+			"spin, can behave differently across runs. Contexts run "
+			"sequentially while ISA or call debugging, basic block "
+			"profiling, or checkpointing is active.");
+
+	// Option --x86-emu-quantum <num_inst>
+	command_line->RegisterInt32("--x86-emu-quantum <num_inst> "
+			"(default = 1000)",
+			thread_quantum,
+			"Maximum number of instructions run by each context "
+			"between two synchronizations of the host threads given "
+			"in option '--x86-emu-threads'.");
 }
 
 
@@ -102,6 +195,38 @@ void Emulator::ProcessOptions()
 	isa_debug.setPath(isa_debug_file);
 	loader_debug.setPath(loader_debug_file);
 	syscall_debug.setPath(syscall_debug_file);
+
+	// Checkpoints
+	if (save_checkpoint_file.empty() && (checkpoint_instruction ||
+			checkpoint_magic))
+		throw Error("Options '--x86-checkpoint-at' and "
+				"'--x86-checkpoint-magic' require option "
+				"'--x86-save-checkpoint'");
+	if (!save_checkpoint_file.empty() && !checkpoint_instruction &&
+			!checkpoint_magic)
+		throw Error("Option '--x86-save-checkpoint' requires option "
+				"'--x86-checkpoint-at' or '--x86-checkpoint-magic'");
+	if (checkpoint_instruction < 0)
+		throw Error("Invalid value for option '--x86-checkpoint-at'");
+
+	// Basic block vectors
+	if (bbv_interval < 1)
+		throw Error("Invalid value for option '--x86-bbv-interval'");
+
+	// Host threads
+	if (num_threads < 1)
+		throw Error("Option '--x86-emu-threads' must be at least 1");
+	if (thread_quantum < 1)
+		throw Error("Option '--x86-emu-quantum' must be at least 1");
+}
+
+
+Emulator::Emulator() : comm::Emulator("x86")
+{
+	// Basic block vector profiler
+	if (!bbv_file.empty())
+		bbv_profiler = misc::new_unique<BbvProfiler>(bbv_file,
+				bbv_interval);
 }
 
 
@@ -421,7 +546,157 @@ void Emulator::ProcessEvents()
 }
 
 
-bool Emulator::Run()
+// Identifier at the beginning of a checkpoint file, followed by a version
+static const char checkpoint_magic_string[8] = { 'M', '2', 'S', 'X', '8', '6',
+		'C', 'K' };
+static const unsigned checkpoint_version = 1;
+
+
+void Emulator::SaveCheckpoint(const std::string &path)
+{
+	// Only one context
+	if (contexts.size() != 1)
+		throw Error(misc::fmt("%s: cannot save a checkpoint with %d "
+				"contexts, only single-threaded programs are "
+				"supported", path.c_str(), (int) contexts.size()));
+
+	// Open file
+	std::ofstream f(path, std::ios::binary);
+	if (!f)
+		throw Error(misc::fmt("%s: cannot create checkpoint file",
+				path.c_str()));
+
+	// Header
+	f.write(checkpoint_magic_string, sizeof checkpoint_magic_string);
+	f.write((const char *) &checkpoint_version, sizeof checkpoint_version);
+	f.write((const char *) &num_instructions, sizeof num_instructions);
+
+	// Context
+	contexts.front()->SaveCheckpoint(f);
+	f.close();
+	if (!f)
+		throw Error(misc::fmt("%s: cannot write checkpoint file",
+				path.c_str()));
+
+	// Message
+	std::cerr << misc::fmt("x86 checkpoint saved in '%s' after %lld "
+			"instructions\n", path.c_str(), num_instructions);
+}
+
+
+void Emulator::LoadCheckpoint(const std::string &path)
+{
+	// Map file
+	int fd = open(path.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st))
+		throw Error(misc::fmt("%s: cannot open checkpoint file",
+				path.c_str()));
+	size_t size = st.st_size;
+	void *data = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) :
+			MAP_FAILED;
+	close(fd);
+	if (data == MAP_FAILED)
+		throw Error(misc::fmt("%s: cannot map checkpoint file",
+				path.c_str()));
+	const char *buffer = (const char *) data;
+	const char *end = buffer + size;
+
+	// Check header
+	unsigned version;
+	long long checkpoint_num_instructions;
+	size_t header_size = sizeof checkpoint_magic_string + sizeof version +
+			sizeof checkpoint_num_instructions;
+	if (size < header_size || memcmp(buffer, checkpoint_magic_string,
+			sizeof checkpoint_magic_string))
+	{
+		munmap(data, size);
+		throw Error(misc::fmt("%s: not an x86 checkpoint file",
+				path.c_str()));
+	}
+	buffer += sizeof checkpoint_magic_string;
+	memcpy(&version, buffer, sizeof version);
+	buffer += sizeof version;
+	memcpy(&checkpoint_num_instructions, buffer,
+			sizeof checkpoint_num_instructions);
+	buffer += sizeof checkpoint_num_instructions;
+	if (version != checkpoint_version)
+	{
+		munmap(data, size);
+		throw Error(misc::fmt("%s: unsupported checkpoint version %u",
+				path.c_str(), version));
+	}
+
+	// Create context. The mapping is released also if the checkpoint
+	// turns out to be corrupt.
+	try
+	{
+		Context *context = newContext();
+		context->LoadCheckpoint(buffer, end);
+	}
+	catch (...)
+	{
+		munmap(data, size);
+		throw;
+	}
+	munmap(data, size);
+
+	// Debug
+	loader_debug << misc::fmt("Checkpoint '%s' restored, taken after "
+			"%lld instructions\n", path.c_str(),
+			checkpoint_num_instructions);
+}
+
+
+bool Emulator::canRunConcurrently() const
+{
+	// Debug output, profiles, and checkpoints depend on the order in
+	// which instructions of different contexts run
+	return num_threads > 1 && running_contexts.size() > 1 &&
+			!isa_debug && !call_debug && !bbv_profiler &&
+			save_checkpoint_file.empty();
+}
+
+
+void Emulator::RunConcurrently(int max_instructions)
+{
+	// Create thread pool on first use
+	if (!thread_pool)
+		thread_pool = misc::new_unique<misc::ThreadPool>(num_threads);
+
+	// Collect running contexts in the order of the primary list
+	concurrent_contexts.clear();
+	for (auto &context : contexts)
+		if (context->getState(Context::StateRunning))
+			concurrent_contexts.push_back(context.get());
+
+	// Run contexts concurrently until each of them runs out of quantum or
+	// reaches an instruction that needs to run alone
+	concurrent_instructions.assign(concurrent_contexts.size(), 0);
+	thread_pool->ParallelFor(concurrent_contexts.size(),
+			[this, max_instructions](int index)
+	{
+		concurrent_instructions[index] = concurrent_contexts[index]->
+				ExecuteConcurrent(max_instructions);
+	});
+
+	// Stats
+	for (int count : concurrent_instructions)
+		num_instructions += count;
+
+	// Run pending system calls and atomic instructions one at a time. A
+	// system call can change the state of other contexts.
+	for (unsigned i = 0; i < concurrent_contexts.size(); i++)
+	{
+		Context *context = concurrent_contexts[i];
+		if (concurrent_instructions[i] < max_instructions &&
+				context->getState(Context::StateRunning))
+			context->Execute();
+	}
+}
+
+
+bool Emulator::Run(long long limit)
 {
 	// Stop if there is no more contexts
 	if (!contexts.size())
@@ -435,17 +710,48 @@ bool Emulator::Run()
 	if (esim->hasFinished())
 		return true;
 
-	// Run an instruction from every running context. During execution, a
-	// context can remove itself from the running list, so traversing the
-	// running list is not an option.
-	for (auto &context : contexts)
+	// Run contexts concurrently, sharing the remaining instructions up to
+	// the limit among them
+	if (canRunConcurrently())
 	{
-		// Skip if not running
-		if (!context->getState(Context::StateRunning))
-			continue;
+		if (max_instructions && (!limit || max_instructions < limit))
+			limit = max_instructions;
+		long long quantum = thread_quantum;
+		if (limit)
+			quantum = std::min(quantum, (limit - num_instructions) /
+					(long long) running_contexts.size());
+		RunConcurrently(std::max(quantum, 1ll));
+	}
+	else
+	{
+		// Run an instruction from every running context. During
+		// execution, a context can remove itself from the running list,
+		// so traversing the running list is not an option.
+		for (auto &context : contexts)
+		{
+			// Skip if not running
+			if (!context->getState(Context::StateRunning))
+				continue;
+
+			// Run one iteration
+			context->Execute();
 
-		// Run one iteration
-		context->Execute();
+			// Checkpoint requested by the guest
+			if (checkpoint_magic && isCheckpointMagic(
+					context->getInstruction()))
+				checkpoint_pending = true;
+		}
+	}
+
+	// Save checkpoint and finish
+	if (!save_checkpoint_file.empty() && (checkpoint_pending ||
+			(checkpoint_instruction &&
+			num_instructions >= checkpoint_instruction)))
+	{
+		SaveCheckpoint(save_checkpoint_file);
+		save_checkpoint_file.clear();
+		esim->Finish("x86Checkpoint");
+		return true;
 	}
 
 	// Free finished contexts
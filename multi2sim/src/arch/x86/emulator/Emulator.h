@@ -21,13 +21,16 @@
 #define ARCH_X86_EMULATOR_EMULATOR_H
 
 #include <pthread.h>
+#include <vector>
 
 #include <arch/common/Arch.h>
 #include <arch/common/Emulator.h>
 #include <lib/cpp/CommandLine.h>
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/Error.h>
+#include <lib/cpp/ThreadPool.h>
 
+#include "BbvProfiler.h"
 #include "Context.h"
 
 
@@ -68,6 +71,27 @@ class Emulator : public comm::Emulator
 	// Maximum number of instructions
 	static long long max_instructions;
 
+	// Checkpoint file to create, and file to restore the initial state from
+	static std::string save_checkpoint_file;
+	static std::string load_checkpoint_file;
+
+	// Number of emulated instructions after which the checkpoint is saved,
+	// or 0 if not given
+	static long long checkpoint_instruction;
+
+	// Save the checkpoint when the guest executes the magic instruction
+	static bool checkpoint_magic;
+
+	// Basic block vector file, and number of instructions in each
+	// profiling interval
+	static std::string bbv_file;
+	static long long bbv_interval;
+
+	// Number of host threads running contexts concurrently, and maximum
+	// number of instructions run by each context between synchronizations
+	static int num_threads;
+	static int thread_quantum;
+
 	// Unique instance of singleton
 	static std::unique_ptr<Emulator> instance;
 
@@ -110,6 +134,27 @@ class Emulator : public comm::Emulator
 	// for FIFO wakeups.
 	long long futex_sleep_count = 0;
 
+	// A context executed the checkpoint magic instruction
+	bool checkpoint_pending = false;
+
+	// Basic block vector profiler, if enabled
+	std::unique_ptr<BbvProfiler> bbv_profiler;
+
+	// Pool of host threads running contexts, created on first use
+	std::unique_ptr<misc::ThreadPool> thread_pool;
+
+	// Running contexts advanced concurrently in the current iteration,
+	// and number of instructions run by each
+	std::vector<Context *> concurrent_contexts;
+	std::vector<int> concurrent_instructions;
+
+	// Return whether running contexts can be advanced concurrently
+	bool canRunConcurrently() const;
+
+	// Advance all running contexts concurrently up to the given number
+	// of instructions each
+	void RunConcurrently(int max_instructions);
+
 
 public:
 
@@ -132,6 +177,35 @@ public:
 	/// Return the maximum number of instructions, as set up by the user
 	static long long getMaxInstructions() { return max_instructions; }
 
+	/// Return the checkpoint file to restore the initial state from, as
+	/// given in option `--x86-load-checkpoint`, or an empty string if none.
+	static const std::string &getLoadCheckpointFile()
+	{
+		return load_checkpoint_file;
+	}
+
+	/// Set the number of host threads running contexts concurrently and
+	/// the maximum number of instructions run by each context between
+	/// synchronizations, as given in options `--x86-emu-threads` and
+	/// `--x86-emu-quantum`.
+	static void setNumThreads(int num_threads, int thread_quantum)
+	{
+		Emulator::num_threads = num_threads;
+		Emulator::thread_quantum = thread_quantum;
+	}
+
+	/// Return the number of instructions in each interval of the basic
+	/// block vector profile, as given in option `--x86-bbv-interval`.
+	static long long getBbvInterval() { return bbv_interval; }
+
+	/// Return whether an instruction is the magic instruction used by
+	/// guest programs to request a checkpoint (`xchg %bx, %bx`)
+	static bool isCheckpointMagic(Instruction *inst)
+	{
+		return inst->getOpcode() == Instruction::Opcode_xchg_rm16_r16
+				&& inst->getModRm() == 0xdb;
+	}
+
 	/// Debugger for function calls
 	static misc::Debug call_debug;
 
@@ -155,7 +229,11 @@ public:
 	//
 
 	/// Constructor
-	Emulator() : comm::Emulator("x86") { }
+	Emulator();
+
+	/// Return the basic block vector profiler, or `nullptr` if profiling
+	/// is disabled.
+	BbvProfiler *getBbvProfiler() const { return bbv_profiler.get(); }
 
 	/// Create a new context associated with the emulator. The context is
 	/// inserted in the main emulator context list. Its state is set to
@@ -178,6 +256,21 @@ public:
 			const std::string &stdin_file_name = "",
 			const std::string &stdout_file_name = "");
 
+	/// Save the state of the emulator into a checkpoint file. The content
+	/// of the memory image is compressed. Only one context is supported.
+	///
+	/// \throw
+	///	An x86::Error is thrown if the emulator state cannot be saved.
+	void SaveCheckpoint(const std::string &path);
+
+	/// Create a context from a checkpoint file created with
+	/// SaveCheckpoint(). The file is memory-mapped, and memory pages are
+	/// decompressed directly from the mapping.
+	///
+	/// \throw
+	///	An x86::Error is thrown if the file is not a valid checkpoint.
+	void LoadCheckpoint(const std::string &path);
+
 	/// Return a unique process ID. Contexts can call this function when
 	/// created to obtain their unique identifier.
 	int getPid() { return pid++; }
@@ -210,7 +303,14 @@ public:
 	/// Run one iteration of the emulation loop.
 	/// \return This function \c true if the iteration had a useful
 	/// emulation, and \c false if all contexts finished execution.
-	bool Run();
+	bool Run() { return Run(max_instructions); }
+
+	/// Run one iteration of the emulation loop. If contexts run
+	/// concurrently on several host threads, the iteration does not run
+	/// past \a limit emulated instructions by more than one instruction
+	/// per running context, as the sequential emulation loop. A value of 0
+	/// means no limit.
+	bool Run(long long limit);
 
 
 
@@ -227,11 +227,15 @@ public:
 	/// Return a constant reference to the registers storing a copy. Before
 	/// calling this function, the user has to make sure that registers have
 	/// been stored with a previous call to setRegs().
-	const Regs &getRegs() {
+	const Regs &getRegs() const {
 		assert(regs.get());
 		return *regs;
 	}
 
+	/// Return whether a copy of the register file is currently stored,
+	/// i.e., whether a signal handler is running.
+	bool hasRegs() const { return regs.get(); }
+
 	/// Free the copy of the register file stored. The caller must be sure
 	/// that a register file was previously stored with a call to setRegs().
 	/// The call to freeRegs() is optional for optimization. Not calling it
@@ -264,6 +268,12 @@ public:
 	/// BackupBlockedSignals()
 	void RestoreBlockedSignals() { blocked = backup; }
 
+	/// Return the backup copy of the blocked signal mask
+	const SignalSet &getBackup() const { return backup; }
+
+	/// Set the backup copy of the blocked signal mask
+	void setBackup(const SignalSet &backup) { this->backup = backup; }
+
 	/// Return address where the return code can be found.
 	unsigned getRetCodePtr() const { return ret_code_ptr; }
 };
@@ -300,6 +310,17 @@ public:
 	/// Return the flags associated with the signal handler
 	unsigned getFlags() const { return flags; }
 
+	/// Return the address of the function restoring the signal context
+	unsigned getRestorer() const { return restorer; }
+
+	/// Set the signal handler fields
+	void set(unsigned handler, unsigned flags, unsigned restorer)
+	{
+		this->handler = handler;
+		this->flags = flags;
+		this->restorer = restorer;
+	}
+
 	/// Return the mask associated with the signal handler
 	SignalSet &getMask() { return mask; }
 
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cmath>
+
 #include <lib/cpp/Misc.h>
 
 #include "BranchPredictor.h"
@@ -35,6 +37,32 @@ int BranchPredictor::two_level_l1_size;
 int BranchPredictor::two_level_l2_size;
 int BranchPredictor::two_level_history_size;
 int BranchPredictor::two_level_l2_height;
+int BranchPredictor::tage_num_tables;
+int BranchPredictor::tage_table_size;
+int BranchPredictor::tage_tag_bits;
+int BranchPredictor::tage_min_history;
+int BranchPredictor::tage_max_history;
+std::vector<int> BranchPredictor::tage_history_lengths;
+int BranchPredictor::perceptron_num_tables;
+int BranchPredictor::perceptron_table_size;
+int BranchPredictor::perceptron_history_size;
+int BranchPredictor::perceptron_threshold;
+bool BranchPredictor::loop_present;
+int BranchPredictor::loop_size;
+bool BranchPredictor::ittage_present;
+int BranchPredictor::ittage_num_tables;
+int BranchPredictor::ittage_table_size;
+int BranchPredictor::ittage_tag_bits;
+int BranchPredictor::ittage_min_history;
+int BranchPredictor::ittage_max_history;
+std::vector<int> BranchPredictor::ittage_history_lengths;
+
+// Confidence needed by the loop predictor to override the main predictor
+static const int loop_confidence_threshold = 3;
+
+// Number of updates of the TAGE predictor after which useful counters are
+// halved
+static const int tage_aging_period = 256 * 1024;
 
 misc::StringMap BranchPredictor::KindMap =
 {
@@ -43,7 +71,9 @@ misc::StringMap BranchPredictor::KindMap =
 	{"NotTaken", KindNottaken},
 	{"Bimodal", KindBimod},
 	{"TwoLevel", KindTwoLevel},
-	{"Combined", KindCombined}
+	{"Combined", KindCombined},
+	{"TAGE", KindTage},
+	{"Perceptron", KindPerceptron}
 };
 
 BranchPredictor::BranchPredictor(const std::string &name)
@@ -53,8 +83,8 @@ BranchPredictor::BranchPredictor(const std::string &name)
 	// Initialize
 	ras = misc::new_unique_array<int>(ras_size);
 	
-	// Bimodal predictor
-	if (kind == KindBimod || kind == KindCombined)
+	// Bimodal predictor, also used as the base predictor of TAGE
+	if (kind == KindBimod || kind == KindCombined || kind == KindTage)
 	{
 		bimod = misc::new_unique_array<char>(bimod_size);
 		for (int i = 0; i < bimod_size; i++)
@@ -78,11 +108,66 @@ BranchPredictor::BranchPredictor(const std::string &name)
 			choice[i] = 2;
 	}
 
+	// TAGE predictor
+	if (kind == KindTage)
+		tage = misc::new_unique_array<TageEntry>(tage_num_tables *
+				tage_table_size);
+
+	// Perceptron predictor
+	if (kind == KindPerceptron)
+	{
+		perceptron = misc::new_unique_array<signed char>(
+				perceptron_num_tables * perceptron_table_size);
+		perceptron_indices = misc::new_unique_array<int>(
+				perceptron_num_tables);
+	}
+
+	// Loop predictor
+	if (loop_present)
+		loop = misc::new_unique_array<LoopEntry>(loop_size);
+
+	// ITTAGE predictor
+	if (ittage_present)
+		ittage = misc::new_unique_array<IttageEntry>(ittage_num_tables *
+				ittage_table_size);
+
+	// Global history, used by TAGE, perceptron, and ITTAGE
+	if (kind == KindTage || kind == KindPerceptron || ittage_present)
+		history = misc::new_unique_array<unsigned>(
+				history_buffer_size / 32);
+
 	// Allocate BTB and assign LRU counters
 	btb = misc::new_unique_array<BtbEntry>(btb_num_sets * btb_num_ways);
 	for (int i = 0; i < btb_num_sets; i++)
 		for (int j = 0; j < btb_num_ways; j++)
 			btb[i * btb_num_ways + j].counter = j;
+
+	// Statistics
+	provider_predictions.resize(ProviderTage +
+			(kind == KindTage ? tage_num_tables : 0));
+	provider_mispredictions.resize(provider_predictions.size());
+	indirect_predictions.resize(1 + (ittage_present ?
+			ittage_num_tables : 0));
+	indirect_mispredictions.resize(indirect_predictions.size());
+}
+
+
+void BranchPredictor::setHistoryLengths(std::vector<int> &lengths,
+		int num_tables, int min_history, int max_history)
+{
+	lengths.resize(num_tables);
+	for (int i = 0; i < num_tables; i++)
+	{
+		// Geometric series from the shortest to the longest length
+		double ratio = num_tables > 1 ?
+				(double) i / (num_tables - 1) : 0.0;
+		lengths[i] = (int) (min_history * pow((double) max_history /
+				min_history, ratio) + 0.5);
+
+		// Lengths must be strictly increasing
+		if (i > 0 && lengths[i] <= lengths[i - 1])
+			lengths[i] = lengths[i - 1] + 1;
+	}
 }
 
 
@@ -108,6 +193,30 @@ void BranchPredictor::ParseConfiguration(misc::IniFile *ini_file)
 	// Two-level branch predictor parameter
 	two_level_l2_height = 1 << two_level_history_size;
 
+	// TAGE predictor
+	tage_num_tables = ini_file->ReadInt(section, "TAGE.NumTables", 7);
+	tage_table_size = ini_file->ReadInt(section, "TAGE.TableSize", 1024);
+	tage_tag_bits = ini_file->ReadInt(section, "TAGE.TagBits", 9);
+	tage_min_history = ini_file->ReadInt(section, "TAGE.MinHistory", 5);
+	tage_max_history = ini_file->ReadInt(section, "TAGE.MaxHistory", 130);
+
+	// Perceptron predictor
+	perceptron_num_tables = ini_file->ReadInt(section, "Perceptron.NumTables", 8);
+	perceptron_table_size = ini_file->ReadInt(section, "Perceptron.TableSize", 1024);
+	perceptron_history_size = ini_file->ReadInt(section, "Perceptron.HistorySize", 64);
+
+	// Loop predictor
+	loop_present = ini_file->ReadBool(section, "Loop.Present", false);
+	loop_size = ini_file->ReadInt(section, "Loop.Size", 64);
+
+	// ITTAGE predictor
+	ittage_present = ini_file->ReadBool(section, "ITTAGE.Present", false);
+	ittage_num_tables = ini_file->ReadInt(section, "ITTAGE.NumTables", 4);
+	ittage_table_size = ini_file->ReadInt(section, "ITTAGE.TableSize", 256);
+	ittage_tag_bits = ini_file->ReadInt(section, "ITTAGE.TagBits", 9);
+	ittage_min_history = ini_file->ReadInt(section, "ITTAGE.MinHistory", 4);
+	ittage_max_history = ini_file->ReadInt(section, "ITTAGE.MaxHistory", 64);
+
 	// Integrity
 	if (bimod_size & (bimod_size - 1))
 		throw Error("number of entries in bimodal precitor must be a power of 2");
@@ -123,6 +232,37 @@ void BranchPredictor::ParseConfiguration(misc::IniFile *ini_file)
 		throw Error("two-level predictor sizes must be power of 2");
 	if (two_level_l2_size & (two_level_l2_size - 1))
 		throw Error("two-level predictor sizes must be power of 2");
+	if (tage_num_tables < 1 || tage_num_tables > MaxTaggedTables ||
+			ittage_num_tables < 1 || ittage_num_tables > MaxTaggedTables)
+		throw Error(misc::fmt("number of TAGE and ITTAGE tables must be "
+				"between 1 and %d", MaxTaggedTables));
+	if (tage_table_size < 2 || (tage_table_size & (tage_table_size - 1)) ||
+			ittage_table_size < 2 || (ittage_table_size &
+			(ittage_table_size - 1)))
+		throw Error("TAGE and ITTAGE table sizes must be powers of 2");
+	if (tage_tag_bits < 2 || tage_tag_bits > 16 ||
+			ittage_tag_bits < 2 || ittage_tag_bits > 16)
+		throw Error("TAGE and ITTAGE tags must have between 2 and 16 bits");
+	if (tage_min_history < 1 || tage_max_history < tage_min_history ||
+			tage_max_history > 1024 || ittage_min_history < 1 ||
+			ittage_max_history < ittage_min_history ||
+			ittage_max_history > 1024)
+		throw Error("TAGE and ITTAGE history lengths must be between 1 "
+				"and 1024, with the minimum not above the maximum");
+	if (perceptron_num_tables < 1 || perceptron_table_size < 2 ||
+			(perceptron_table_size & (perceptron_table_size - 1)))
+		throw Error("perceptron table size must be a power of 2");
+	if (perceptron_history_size < 1 || perceptron_history_size > 1024)
+		throw Error("perceptron history size must be >=1 and <=1024");
+	if (loop_size < 1 || (loop_size & (loop_size - 1)))
+		throw Error("number of entries in loop predictor must be a power of 2");
+
+	// Derived parameters
+	setHistoryLengths(tage_history_lengths, tage_num_tables,
+			tage_min_history, tage_max_history);
+	setHistoryLengths(ittage_history_lengths, ittage_num_tables,
+			ittage_min_history, ittage_max_history);
+	perceptron_threshold = (int) (2.14 * (perceptron_num_tables + 1) + 20.58);
 }
 
 
@@ -138,10 +278,494 @@ void BranchPredictor::DumpConfiguration(std::ostream &os)
 	os << misc::fmt("\tTwoLevel.L1Size: %d\n", two_level_l1_size);
 	os << misc::fmt("\tTwoLevel.L2Size: %d\n", two_level_l2_size);
 	os << misc::fmt("\tTwoLevel.HistorySize: %d\n", two_level_history_size);
+	os << misc::fmt("\tTAGE.NumTables: %d\n", tage_num_tables);
+	os << misc::fmt("\tTAGE.TableSize: %d\n", tage_table_size);
+	os << misc::fmt("\tPerceptron.NumTables: %d\n", perceptron_num_tables);
+	os << misc::fmt("\tPerceptron.TableSize: %d\n", perceptron_table_size);
+	os << misc::fmt("\tLoop.Size: %d\n", loop_size);
+	os << misc::fmt("\tITTAGE.NumTables: %d\n", ittage_num_tables);
 }
 
 
-BranchPredictor::Prediction BranchPredictor::Lookup(Uop *uop)
+std::string BranchPredictor::getProviderName(int provider)
+{
+	if (provider == ProviderBase)
+		return kind == KindTage ? "TAGE.Base" : KindMap[kind];
+	if (provider == ProviderLoop)
+		return "Loop";
+	return misc::fmt("TAGE.T%d", provider - ProviderTage + 1);
+}
+
+
+void BranchPredictor::DumpReport(std::ostream &os) const
+{
+	// Only for predictors with several components
+	if (!hasProviderStats())
+		return;
+
+	// Direction predictions
+	os << "; Branch predictor components\n";
+	os << ";    Predictions - Committed branches predicted by the component\n";
+	os << ";    Mispred - Mispredicted committed branches\n";
+	for (int provider = 0; provider < (int) provider_predictions.size();
+			provider++)
+	{
+		if (provider == ProviderLoop && !loop_present)
+			continue;
+		std::string provider_name = getProviderName(provider);
+		os << misc::fmt("BranchPredictor.%s.Predictions = %lld\n",
+				provider_name.c_str(),
+				provider_predictions[provider]);
+		os << misc::fmt("BranchPredictor.%s.Mispred = %lld\n",
+				provider_name.c_str(),
+				provider_mispredictions[provider]);
+	}
+
+	// Indirect branch targets
+	if (ittage_present)
+	{
+		os << misc::fmt("BranchPredictor.Indirect.BTB.Predictions = %lld\n",
+				indirect_predictions[0]);
+		os << misc::fmt("BranchPredictor.Indirect.BTB.Mispred = %lld\n",
+				indirect_mispredictions[0]);
+		for (int table = 0; table < ittage_num_tables; table++)
+		{
+			os << misc::fmt("BranchPredictor.Indirect.ITTAGE.T%d."
+					"Predictions = %lld\n", table + 1,
+					indirect_predictions[table + 1]);
+			os << misc::fmt("BranchPredictor.Indirect.ITTAGE.T%d."
+					"Mispred = %lld\n", table + 1,
+					indirect_mispredictions[table + 1]);
+		}
+	}
+	os << '\n';
+}
+
+
+void BranchPredictor::PushHistory(bool taken)
+{
+	int bit = history_buffer_size - 1 -
+			(history_position & (history_buffer_size - 1));
+	if (taken)
+		history[bit / 32] |= 1u << (bit % 32);
+	else
+		history[bit / 32] &= ~(1u << (bit % 32));
+	history_position++;
+}
+
+
+unsigned BranchPredictor::getHistory(long long position, int offset,
+		int count) const
+{
+	// Bit of the most recent outcome requested. Outcomes before the
+	// first one pushed read as not taken.
+	assert(count > 0 && count <= 32);
+	long long first = position - 1 - offset;
+	int bit = history_buffer_size - 1 -
+			(first & (history_buffer_size - 1));
+
+	// Read two consecutive words, wrapping around the buffer
+	int num_words = history_buffer_size / 32;
+	int word = bit / 32;
+	unsigned long long value = (unsigned long long)
+			history[(word + 1) % num_words] << 32 | history[word];
+	value >>= bit % 32;
+	return count == 32 ? (unsigned) value :
+			(unsigned) value & ((1u << count) - 1);
+}
+
+
+unsigned BranchPredictor::FoldHistory(long long position, int offset,
+		int length, int bits) const
+{
+	unsigned value = 0;
+	for (int i = 0; i < length; i += bits)
+		value ^= getHistory(position, offset + i,
+				std::min(bits, length - i));
+	return value;
+}
+
+
+int BranchPredictor::getTaggedIndex(unsigned eip, long long position,
+		int table, int history_length, int table_size) const
+{
+	int bits = misc::LogBase2(table_size);
+	return (eip ^ (eip >> (table + 1)) ^ FoldHistory(position, 0,
+			history_length, bits)) & (table_size - 1);
+}
+
+
+unsigned BranchPredictor::getTaggedTag(unsigned eip, long long position,
+		int history_length, int tag_bits) const
+{
+	return (eip ^ FoldHistory(position, 0, history_length, tag_bits) ^
+			(FoldHistory(position, 0, history_length, tag_bits - 1)
+			<< 1)) & ((1u << tag_bits) - 1);
+}
+
+
+void BranchPredictor::LookupTage(unsigned eip, long long position,
+		TageLookup &lookup) const
+{
+	// Find the two longest matching tagged tables
+	lookup.provider = -1;
+	lookup.alternate = -1;
+	for (int table = 0; table < tage_num_tables; table++)
+	{
+		int length = tage_history_lengths[table];
+		lookup.index[table] = getTaggedIndex(eip, position, table,
+				length, tage_table_size);
+		lookup.tag[table] = getTaggedTag(eip, position, length,
+				tage_tag_bits);
+		const TageEntry &entry = tage[table * tage_table_size +
+				lookup.index[table]];
+		if (entry.tag == lookup.tag[table])
+		{
+			lookup.alternate = lookup.provider;
+			lookup.provider = table;
+		}
+	}
+
+	// Prediction of the base predictor
+	bool base_taken = bimod[eip & (bimod_size - 1)] > 1;
+
+	// Alternate prediction
+	lookup.alternate_taken = base_taken;
+	if (lookup.alternate >= 0)
+		lookup.alternate_taken = tage[lookup.alternate * tage_table_size +
+				lookup.index[lookup.alternate]].counter >= 0;
+
+	// No tagged table hit
+	if (lookup.provider < 0)
+	{
+		lookup.provider_taken = base_taken;
+		lookup.taken = base_taken;
+		return;
+	}
+
+	// Use the provider, unless its entry was newly allocated and the
+	// alternate prediction has proven more accurate in that case
+	const TageEntry &entry = tage[lookup.provider * tage_table_size +
+			lookup.index[lookup.provider]];
+	lookup.provider_taken = entry.counter >= 0;
+	bool weak = entry.counter == 0 || entry.counter == -1;
+	lookup.taken = weak && !entry.useful && tage_use_alternate >= 8 ?
+			lookup.alternate_taken :
+			lookup.provider_taken;
+}
+
+
+void BranchPredictor::UpdateTage(Branch &branch, bool taken)
+{
+	// Look up the tables again with the history seen at fetch
+	TageLookup lookup;
+	LookupTage(branch.eip, branch.history_position, lookup);
+	TageEntry *provider = lookup.provider < 0 ? nullptr :
+			&tage[lookup.provider * tage_table_size +
+			lookup.index[lookup.provider]];
+
+	// Learn whether to trust newly allocated entries
+	if (provider && (provider->counter == 0 || provider->counter == -1)
+			&& !provider->useful
+			&& lookup.provider_taken != lookup.alternate_taken)
+	{
+		if (lookup.alternate_taken == taken)
+			tage_use_alternate = std::min(tage_use_alternate + 1, 15);
+		else
+			tage_use_alternate = std::max(tage_use_alternate - 1, 0);
+	}
+
+	// On a misprediction, allocate an entry in a table with a longer
+	// history. If none is free, age the candidates.
+	if (lookup.taken != taken && lookup.provider < tage_num_tables - 1)
+	{
+		bool allocated = false;
+		for (int table = lookup.provider + 1; table < tage_num_tables;
+				table++)
+		{
+			TageEntry &entry = tage[table * tage_table_size +
+					lookup.index[table]];
+			if (entry.useful)
+				continue;
+			entry.tag = lookup.tag[table];
+			entry.counter = taken ? 0 : -1;
+			allocated = true;
+			break;
+		}
+		for (int table = lookup.provider + 1; !allocated &&
+				table < tage_num_tables; table++)
+		{
+			TageEntry &entry = tage[table * tage_table_size +
+					lookup.index[table]];
+			entry.useful--;
+		}
+	}
+
+	// Update the provider counter, or the base predictor
+	if (provider)
+	{
+		if (taken)
+			provider->counter = std::min(provider->counter + 1, 3);
+		else
+			provider->counter = std::max(provider->counter - 1, -4);
+		if (lookup.provider_taken != lookup.alternate_taken)
+		{
+			if (lookup.provider_taken == taken)
+				provider->useful = std::min(provider->useful + 1, 3);
+			else if (provider->useful)
+				provider->useful--;
+		}
+	}
+	else
+	{
+		char *bimod_ptr = &bimod[branch.eip & (bimod_size - 1)];
+		if (taken)
+			*bimod_ptr = *bimod_ptr + 1 > 3 ? 3 : *bimod_ptr + 1;
+		else
+			*bimod_ptr = *bimod_ptr - 1 < 0 ? 0 : *bimod_ptr - 1;
+	}
+
+	// Periodically age all useful counters
+	if (++tage_num_updates >= tage_aging_period)
+	{
+		tage_num_updates = 0;
+		for (int i = 0; i < tage_num_tables * tage_table_size; i++)
+			tage[i].useful >>= 1;
+	}
+}
+
+
+int BranchPredictor::getPerceptronOutput(unsigned eip, long long position,
+		int *indices) const
+{
+	// The first table is indexed by the branch address only, and each of
+	// the others by the address hashed with a segment of the history.
+	int bits = misc::LogBase2(perceptron_table_size);
+	int segment = std::max(1, perceptron_history_size /
+			std::max(1, perceptron_num_tables - 1));
+	int output = 0;
+	for (int table = 0; table < perceptron_num_tables; table++)
+	{
+		unsigned hash = eip;
+		if (table > 0)
+		{
+			int offset = (table - 1) * segment;
+			int length = table == perceptron_num_tables - 1 ?
+					perceptron_history_size - offset :
+					segment;
+			if (length > 0)
+				hash ^= (eip >> table) ^ FoldHistory(position,
+						offset, length, bits);
+		}
+		int index = table * perceptron_table_size +
+				(hash & (perceptron_table_size - 1));
+		if (indices)
+			indices[table] = index;
+		output += perceptron[index];
+	}
+	return output;
+}
+
+
+void BranchPredictor::UpdatePerceptron(Branch &branch, bool taken)
+{
+	// Train if the prediction was wrong or the output was not confident
+	int output = getPerceptronOutput(branch.eip, branch.history_position,
+			perceptron_indices.get());
+	if ((output >= 0) == taken && std::abs(output) > perceptron_threshold)
+		return;
+	for (int table = 0; table < perceptron_num_tables; table++)
+	{
+		signed char &weight = perceptron[perceptron_indices[table]];
+		if (taken && weight < 127)
+			weight++;
+		else if (!taken && weight > -128)
+			weight--;
+	}
+}
+
+
+void BranchPredictor::LookupLoop(Branch &branch)
+{
+	// Miss
+	LoopEntry &entry = loop[branch.eip & (loop_size - 1)];
+	if (entry.tag != branch.eip)
+		return;
+
+	// Predict the exit of the loop if this is the last iteration of a run
+	branch.loop_hit = true;
+	branch.loop_iteration = entry.iteration;
+	bool exit = entry.trip_count &&
+			entry.iteration + 1 == entry.trip_count;
+	branch.loop_prediction = entry.taken != exit ?
+			PredictionTaken : PredictionNotTaken;
+
+	// Override the main predictor if confident
+	branch.loop_confident = entry.trip_count &&
+			entry.confidence >= loop_confidence_threshold;
+	if (branch.loop_confident && loop_use >= 0)
+	{
+		branch.prediction = branch.loop_prediction;
+		branch.provider = ProviderLoop;
+	}
+
+	// Count iterations for branches in the correct path
+	if (!branch.speculative_mode)
+	{
+		bool taken = branch.neip != branch.eip + branch.mop_size;
+		entry.iteration = taken == entry.taken ?
+				entry.iteration + 1 : 0;
+	}
+}
+
+
+void BranchPredictor::UpdateLoop(Branch &branch, bool taken)
+{
+	LoopEntry &entry = loop[branch.eip & (loop_size - 1)];
+	Prediction outcome = taken ? PredictionTaken : PredictionNotTaken;
+	if (branch.loop_hit && entry.tag == branch.eip)
+	{
+		// Learn whether the loop predictor is more accurate than the
+		// main predictor. A wrong confident prediction frees the entry.
+		if (branch.loop_confident)
+		{
+			if (branch.loop_prediction != branch.main_prediction)
+				loop_use = branch.loop_prediction == outcome ?
+						std::min(loop_use + 1, 63) :
+						std::max(loop_use - 1, -64);
+			if (branch.loop_prediction != outcome)
+			{
+				entry = LoopEntry();
+				return;
+			}
+			if (branch.main_prediction != outcome)
+				entry.age = std::min(entry.age + 1, 7);
+		}
+
+		// Exit of the loop, check the trip count
+		if (taken != entry.taken)
+		{
+			int trip_count = branch.loop_iteration + 1;
+			if (trip_count == entry.trip_count)
+				entry.confidence = std::min(entry.confidence + 1,
+						loop_confidence_threshold);
+			else
+			{
+				entry.trip_count = trip_count;
+				entry.confidence = 0;
+			}
+		}
+		else if (entry.trip_count &&
+				branch.loop_iteration + 1 >= entry.trip_count)
+		{
+			// Loop ran longer than its trip count
+			entry.trip_count = 0;
+			entry.confidence = 0;
+		}
+		return;
+	}
+
+	// Allocate an entry when the main predictor fails, assuming that the
+	// misprediction was a loop exit
+	if (branch.main_prediction == outcome)
+		return;
+	if (entry.age > 0)
+	{
+		entry.age--;
+		return;
+	}
+	entry = LoopEntry();
+	entry.tag = branch.eip;
+	entry.taken = !taken;
+	entry.age = 3;
+}
+
+
+bool BranchPredictor::isIndirect(const Branch &branch)
+{
+	Uinst *uinst = branch.uinst;
+	return (uinst->getOpcode() == Uinst::OpcodeJump ||
+			uinst->getOpcode() == Uinst::OpcodeCall) &&
+			uinst->getIDep(0);
+}
+
+
+void BranchPredictor::UpdateIttage(Branch &branch)
+{
+	// Find the longest matching table with the history seen at fetch
+	int index[MaxTaggedTables];
+	unsigned tag[MaxTaggedTables];
+	IttageEntry *provider = nullptr;
+	int provider_table = -1;
+	for (int table = 0; table < ittage_num_tables; table++)
+	{
+		int length = ittage_history_lengths[table];
+		index[table] = getTaggedIndex(branch.eip, branch.history_position,
+				table, length, ittage_table_size);
+		tag[table] = getTaggedTag(branch.eip, branch.history_position,
+				length, ittage_tag_bits);
+		IttageEntry &entry = ittage[table * ittage_table_size +
+				index[table]];
+		if (entry.tag == tag[table])
+		{
+			provider = &entry;
+			provider_table = table;
+		}
+	}
+
+	// Update the provider target, replacing it once confidence is lost
+	bool mispredicted = branch.predicted_neip != branch.neip;
+	if (provider)
+	{
+		if (provider->target == branch.neip)
+		{
+			provider->confidence = std::min(provider->confidence + 1, 3);
+			if (!mispredicted)
+				provider->useful = 1;
+		}
+		else if (provider->confidence)
+			provider->confidence--;
+		else
+			provider->target = branch.neip;
+	}
+
+	// On a misprediction, allocate an entry in a longer table
+	if (!mispredicted)
+		return;
+	bool allocated = false;
+	for (int table = provider_table + 1; table < ittage_num_tables; table++)
+	{
+		IttageEntry &entry = ittage[table * ittage_table_size +
+				index[table]];
+		if (!allocated && !entry.useful)
+		{
+			entry.tag = tag[table];
+			entry.target = branch.neip;
+			entry.confidence = 0;
+			allocated = true;
+		}
+		else if (!allocated)
+			entry.useful = 0;
+	}
+}
+
+
+BranchPredictor::Branch &BranchPredictor::getBranch(Uop *uop)
+{
+	// Fields of the uop that the predictor reads, possibly updated since
+	// the last access to the predictor
+	Branch &branch = uop->branch;
+	branch.uinst = uop->getUinst();
+	branch.eip = uop->eip;
+	branch.mop_size = uop->mop_size;
+	branch.neip = uop->neip;
+	branch.predicted_neip = uop->predicted_neip;
+	branch.speculative_mode = uop->speculative_mode;
+	return branch;
+}
+
+
+BranchPredictor::Prediction BranchPredictor::Lookup(Branch &branch)
 {
 	// Local variable
 	Prediction prediction;
@@ -150,81 +774,113 @@ BranchPredictor::Prediction BranchPredictor::Lookup(Uop *uop)
 	// provides information about the branch, i.e., target address and whether it
 	// is a call, ret, jump, or conditional branch. Thus, branches other than
 	// conditional ones are always predicted taken.
-	assert(uop->getFlags() & Uinst::FlagCtrl);
-	if (uop->getFlags() & Uinst::FlagUncond)
+	assert(branch.uinst->getFlags() & Uinst::FlagCtrl);
+	if (branch.uinst->getFlags() & Uinst::FlagUncond)
 	{
-		uop->prediction = PredictionTaken;
+		branch.prediction = PredictionTaken;
 		return PredictionTaken;
 	}
 
 	// An internal branch (string operations) is always predicted taken
-	if (uop->getUinst()->getOpcode() == Uinst::OpcodeIbranch)
+	if (branch.uinst->getOpcode() == Uinst::OpcodeIbranch)
 	{
-		uop->prediction = PredictionTaken;
+		branch.prediction = PredictionTaken;
 		return PredictionTaken;
 	}
 
 	// Perfect predictor
 	if (kind == KindPerfect)
 	{
-		if (uop->neip != uop->eip + uop->mop_size)
+		if (branch.neip != branch.eip + branch.mop_size)
 			prediction = PredictionTaken;
 		else
 			prediction = PredictionNotTaken;
-		uop->prediction = prediction;
+		branch.prediction = prediction;
 	}
 
 	// Taken predictor
 	if (kind == KindTaken)
-		uop->prediction = PredictionTaken;
+		branch.prediction = PredictionTaken;
 
 	// Not-taken predictor
 	if (kind == KindNottaken)
-		uop->prediction = PredictionNotTaken;
+		branch.prediction = PredictionNotTaken;
 
 	// Bimodal predictor
 	if (kind == KindBimod || kind == KindCombined)
 	{
-		int bimod_index = uop->eip & (bimod_size - 1);
+		int bimod_index = branch.eip & (bimod_size - 1);
 		Prediction bimod_prediction = bimod[bimod_index] > 1 ?
 				PredictionTaken :
 				PredictionNotTaken;
-		uop->bimod_index = bimod_index;
-		uop->bimod_prediction = bimod_prediction;
-		uop->prediction = bimod_prediction;
+		branch.bimod_index = bimod_index;
+		branch.bimod_prediction = bimod_prediction;
+		branch.prediction = bimod_prediction;
 	}
 
 	// Two-level adaptive
 	if (kind == KindTwoLevel || kind == KindCombined)
 	{
-		int two_level_bht_index = uop->eip & (two_level_l1_size - 1);
+		int two_level_bht_index = branch.eip & (two_level_l1_size - 1);
 		int two_level_pht_row = two_level_bht[two_level_bht_index];
 		assert(two_level_pht_row < two_level_l2_height);
-		int two_level_pht_col = uop->eip & (two_level_l2_size - 1);
+		int two_level_pht_col = branch.eip & (two_level_l2_size - 1);
 		Prediction two_level_prediction = two_level_pht[two_level_pht_row * two_level_l2_size + two_level_pht_col] > 1 ?
 				PredictionTaken : PredictionNotTaken;
-		uop->two_level_bht_index = two_level_bht_index;
-		uop->two_level_pht_row = two_level_pht_row;
-		uop->two_level_pht_col = two_level_pht_col;
-		uop->two_level_prediction = two_level_prediction;
-		uop->prediction = two_level_prediction;
+		branch.two_level_bht_index = two_level_bht_index;
+		branch.two_level_pht_row = two_level_pht_row;
+		branch.two_level_pht_col = two_level_pht_col;
+		branch.two_level_prediction = two_level_prediction;
+		branch.prediction = two_level_prediction;
 	}
 
 	// Combined
 	if (kind == KindCombined)
 	{
-		int choice_index = uop->eip & (choice_size - 1);
+		int choice_index = branch.eip & (choice_size - 1);
 		Prediction choice_prediction = choice[choice_index] > 1 ?
-				uop->two_level_prediction :
-				uop->bimod_prediction;
-		uop->choice_index = choice_index;
-		uop->choice_prediction = choice_prediction;
-		uop->prediction = choice_prediction;
+				branch.two_level_prediction :
+				branch.bimod_prediction;
+		branch.choice_index = choice_index;
+		branch.choice_prediction = choice_prediction;
+		branch.prediction = choice_prediction;
+	}
+
+	// TAGE
+	branch.history_position = history_position;
+	if (kind == KindTage)
+	{
+		TageLookup lookup;
+		LookupTage(branch.eip, history_position, lookup);
+		branch.provider = lookup.provider < 0 ? ProviderBase :
+				ProviderTage + lookup.provider;
+		branch.prediction = lookup.taken ? PredictionTaken :
+				PredictionNotTaken;
 	}
 
+	// Perceptron
+	if (kind == KindPerceptron)
+	{
+		branch.prediction = getPerceptronOutput(branch.eip, history_position,
+				nullptr) >= 0 ? PredictionTaken :
+				PredictionNotTaken;
+	}
+
+	// Loop predictor, overriding the main prediction if confident
+	branch.main_prediction = branch.prediction;
+	if (loop_present)
+		LookupLoop(branch);
+
+	// Since the emulator runs ahead of the pipeline, the outcome of the
+	// branch is already known. Appending it to the global history for
+	// branches in the correct path only is equivalent to updating the
+	// history speculatively and repairing it on recovery.
+	if (history && !branch.speculative_mode)
+		PushHistory(branch.neip != branch.eip + branch.mop_size);
+
 	// Return prediction
-	assert(uop->prediction == PredictionTaken || uop->prediction == PredictionNotTaken);
-	return uop->prediction;
+	assert(branch.prediction == PredictionTaken || branch.prediction == PredictionNotTaken);
+	return branch.prediction;
 }
 
 
@@ -259,6 +915,41 @@ int BranchPredictor::LookupMultiple(unsigned int eip, int count)
 
 
 void BranchPredictor::Update(Uop *uop)
+{
+	// Branch information
+	Branch &branch = getBranch(uop);
+	assert(!branch.speculative_mode);
+	assert(branch.uinst->getFlags() & Uinst::FlagCtrl);
+	bool taken = branch.neip != branch.eip + branch.mop_size;
+
+	// Stats
+	accesses++;
+	if (branch.neip == branch.predicted_neip)
+		hits++;
+	if (ittage_present && isIndirect(branch))
+	{
+		indirect_predictions[branch.indirect_provider]++;
+		if (branch.neip != branch.predicted_neip)
+			indirect_mispredictions[branch.indirect_provider]++;
+	}
+
+	// Statistics per component, for conditional branches
+	Prediction outcome = taken ? PredictionTaken : PredictionNotTaken;
+	if (kind != KindPerfect &&
+			!(branch.uinst->getFlags() & Uinst::FlagUncond) &&
+			branch.uinst->getOpcode() != Uinst::OpcodeIbranch)
+	{
+		provider_predictions[branch.provider]++;
+		if (branch.prediction != outcome)
+			provider_mispredictions[branch.provider]++;
+	}
+
+	// Train predictors
+	Train(branch);
+}
+
+
+void BranchPredictor::Train(Branch &branch)
 {
 	// Taken/NotTaken flag
 	bool taken;
@@ -275,28 +966,34 @@ void BranchPredictor::Update(Uop *uop)
 	// pointer to combined branch prediction table
 	char *choice_ptr;
 
-	assert(!uop->speculative_mode);
-	assert(uop->getFlags() & Uinst::FlagCtrl);
-	taken = uop->neip != uop->eip + uop->mop_size;
-
-	// Stats
-	accesses++;
-	if (uop->neip == uop->predicted_neip)
-		hits++;
+	assert(!branch.speculative_mode);
+	assert(branch.uinst->getFlags() & Uinst::FlagCtrl);
+	taken = branch.neip != branch.eip + branch.mop_size;
 
 	// Update predictors. This is only done for conditional branches. Thus,
 	// exit now if instruction is a call, ret, or jmp.
 	// No update is performed in a perfect branch predictor either.
 	if (kind == KindPerfect)
 		return;
-	if (uop->getFlags() & Uinst::FlagUncond)
+	if (branch.uinst->getFlags() & Uinst::FlagUncond)
 		return;
 
+	// TAGE and perceptron predictors
+	if (kind == KindTage)
+		UpdateTage(branch, taken);
+	if (kind == KindPerceptron)
+		UpdatePerceptron(branch, taken);
+
+	// Loop predictor
+	if (loop_present && branch.uinst->getOpcode() !=
+			Uinst::OpcodeIbranch)
+		UpdateLoop(branch, taken);
+
 	// Bimodal predictor was used
 	if (kind == KindBimod ||
-			(kind == KindCombined && uop->choice_prediction == PredictionNotTaken))
+			(kind == KindCombined && branch.choice_prediction == PredictionNotTaken))
 	{
-		bimod_ptr = &bimod[uop->bimod_index];
+		bimod_ptr = &bimod[branch.bimod_index];
 		if (taken)
 			*bimod_ptr = *bimod_ptr + 1 > 3 ? 3 : *bimod_ptr + 1;
 		else
@@ -305,15 +1002,15 @@ void BranchPredictor::Update(Uop *uop)
 
 	// Two-level adaptive predictor was used
 	if (kind == KindTwoLevel || (kind == KindCombined &&
-			uop->choice_prediction == PredictionTaken))
+			branch.choice_prediction == PredictionTaken))
 	{
 		// Shift entry in BHT (level 1), and append direction
-		bht_ptr = &two_level_bht[uop->two_level_bht_index];
+		bht_ptr = &two_level_bht[branch.two_level_bht_index];
 		*bht_ptr = ((*bht_ptr << 1) | taken) & (two_level_l2_height - 1);
 
 		// Update counter in PHT (level 2) as per direction
-		pht_ptr = &two_level_pht[uop->two_level_pht_row *
-		                            two_level_l2_size + uop->two_level_pht_col];
+		pht_ptr = &two_level_pht[branch.two_level_pht_row *
+		                            two_level_l2_size + branch.two_level_pht_col];
 		if (taken)
 			*pht_ptr = *pht_ptr + 1 > 3 ? 3 : *pht_ptr + 1;
 		else
@@ -322,10 +1019,10 @@ void BranchPredictor::Update(Uop *uop)
 
 	// Choice predictor - update only if bimodal and two-level
 	// predictions differ.
-	if (kind == KindCombined && uop->bimod_prediction != uop->two_level_prediction)
+	if (kind == KindCombined && branch.bimod_prediction != branch.two_level_prediction)
 	{
-		choice_ptr = &choice[uop->choice_index];
-		if (uop->bimod_prediction == PredictionTaken)
+		choice_ptr = &choice[branch.choice_index];
+		if (branch.bimod_prediction == PredictionTaken)
 			*choice_ptr = *choice_ptr - 1 < 0 ? 0 : *choice_ptr - 1;
 		else
 			*choice_ptr = *choice_ptr + 1 > 3 ? 3 : *choice_ptr + 1;
@@ -333,7 +1030,7 @@ void BranchPredictor::Update(Uop *uop)
 }
 
 
-unsigned int BranchPredictor::LookupBtb(Uop *uop)
+unsigned int BranchPredictor::LookupBtb(Branch &branch)
 {
 	// Local variable
 	BtbEntry *entry;
@@ -341,22 +1038,22 @@ unsigned int BranchPredictor::LookupBtb(Uop *uop)
 	bool hit = false;
 
 	// Assertion
-	assert(uop->getFlags() & Uinst::FlagCtrl);
+	assert(branch.uinst->getFlags() & Uinst::FlagCtrl);
 
 	// Perfect branch predictor
 	if (kind == KindPerfect)
-		return uop->neip;
+		return branch.neip;
 
 	// Internal branch (string operations) always predicted to jump to itself
-	if (uop->getUinst()->getOpcode() == Uinst::OpcodeIbranch)
-		return uop->eip;
+	if (branch.uinst->getOpcode() == Uinst::OpcodeIbranch)
+		return branch.eip;
 
 	// Search address in BTB
-	int set = uop->eip & (btb_num_sets - 1);
+	int set = branch.eip & (btb_num_sets - 1);
 	for (int way = 0; way < btb_num_ways; way++)
 	{
 		entry = &btb[set * btb_num_ways + way];
-		if (entry->source != uop->eip)
+		if (entry->source != branch.eip)
 			continue;
 		target = entry->target;
 		hit = true;
@@ -366,28 +1063,49 @@ unsigned int BranchPredictor::LookupBtb(Uop *uop)
 	// If there was a hit, we know whether branch is a call.
 	// In this case, push return address into RAS. To avoid
 	// updates at recovery, do it only for non-spec instructions.
-	if (hit && uop->getUinst()->getOpcode() == Uinst::OpcodeCall
-			&& !uop->speculative_mode)
+	if (hit && branch.uinst->getOpcode() == Uinst::OpcodeCall
+			&& !branch.speculative_mode)
 	{
-		ras[ras_index] = uop->eip + uop->mop_size;
+		ras[ras_index] = branch.eip + branch.mop_size;
 		ras_index = (ras_index + 1) % ras_size;
 	}
 
 	// If there was a hit, we know whether branch is a ret. In this case,
 	// pop target from the RAS, and ignore target obtained from BTB.
-	if (hit && uop->getUinst()->getOpcode() == Uinst::OpcodeRet
-			&& !uop->speculative_mode)
+	if (hit && branch.uinst->getOpcode() == Uinst::OpcodeRet
+			&& !branch.speculative_mode)
 	{
 		ras_index = (ras_index + ras_size - 1) % ras_size;
 		target = ras[ras_index];
 	}
 
+	// Indirect jumps and calls take their target from the longest
+	// matching ITTAGE table, if any
+	if (hit && ittage_present && isIndirect(branch))
+	{
+		branch.history_position = history_position;
+		for (int table = ittage_num_tables - 1; table >= 0; table--)
+		{
+			int length = ittage_history_lengths[table];
+			int index = getTaggedIndex(branch.eip, history_position,
+					table, length, ittage_table_size);
+			const IttageEntry &entry = ittage[table *
+					ittage_table_size + index];
+			if (entry.tag != getTaggedTag(branch.eip, history_position,
+					length, ittage_tag_bits))
+				continue;
+			target = entry.target;
+			branch.indirect_provider = table + 1;
+			break;
+		}
+	}
+
 	// Return
 	return target;
 }
 
 
-void BranchPredictor::UpdateBtb(Uop *uop)
+void BranchPredictor::UpdateBtb(Branch &branch)
 {
 	// Local variable
 	BtbEntry *entry;
@@ -398,12 +1116,16 @@ void BranchPredictor::UpdateBtb(Uop *uop)
 	if (kind == KindPerfect)
 		return;
 
+	// Indirect target predictor
+	if (ittage_present && isIndirect(branch))
+		UpdateIttage(branch);
+
 	// Search address in BTB
-	int set = uop->eip & (btb_num_sets - 1);
+	int set = branch.eip & (btb_num_sets - 1);
 	for (int way = 0; way < btb_num_ways; way++)
 	{
 		entry = &btb[set * btb_num_ways + way];
-		if (entry->source == uop->eip)
+		if (entry->source == branch.eip)
 		{
 			found = true;
 			found_entry = entry;
@@ -420,8 +1142,8 @@ void BranchPredictor::UpdateBtb(Uop *uop)
 			entry->counter--;
 			if (entry->counter < 0) {
 				entry->counter = btb_num_ways - 1;
-				entry->source = uop->eip;
-				entry->target = uop->neip;
+				entry->source = branch.eip;
+				entry->target = branch.neip;
 			}
 		}
 	}
@@ -436,11 +1158,44 @@ void BranchPredictor::UpdateBtb(Uop *uop)
 				entry->counter--;
 		}
 		found_entry->counter = btb_num_ways - 1;
-		found_entry->target = uop->neip;
+		found_entry->target = branch.neip;
 	}
 }
 
 
+BranchPredictor::Prediction BranchPredictor::Lookup(Uop *uop)
+{
+	return Lookup(getBranch(uop));
+}
+
+
+unsigned int BranchPredictor::LookupBtb(Uop *uop)
+{
+	return LookupBtb(getBranch(uop));
+}
+
+
+void BranchPredictor::UpdateBtb(Uop *uop)
+{
+	UpdateBtb(getBranch(uop));
+}
+
+
+void BranchPredictor::Warm(Branch &branch)
+{
+	// Look up as the fetch stage would
+	assert(!branch.speculative_mode);
+	assert(branch.uinst->getFlags() & Uinst::FlagCtrl);
+	unsigned target = LookupBtb(branch);
+	if (Lookup(branch) == PredictionTaken && target)
+		branch.predicted_neip = target;
+
+	// Train as the commit stage would, without statistics
+	Train(branch);
+	UpdateBtb(branch);
+}
+
+
 unsigned int BranchPredictor::getNextBranch(unsigned int eip,
 		unsigned int block_size)
 {
@@ -21,6 +21,7 @@
 #define ARCH_X86_TIMING_BRANCH_PREDICTOR_H
 
 #include <string>
+#include <vector>
 
 #include <arch/x86/emulator/Uinst.h>
 #include <lib/cpp/Error.h>
@@ -54,12 +55,108 @@ public:
 		KindNottaken,
 		KindBimod,
 		KindTwoLevel,
-		KindCombined
+		KindCombined,
+		KindTage,
+		KindPerceptron
 	};
 
+	/// Component that provided a direction prediction. Tagged tables of
+	/// the TAGE predictor are numbered from ProviderTage on.
+	enum Provider
+	{
+		ProviderBase = 0,
+		ProviderLoop,
+		ProviderTage
+	};
+
+	/// Maximum number of tagged tables in the TAGE and ITTAGE predictors
+	static const int MaxTaggedTables = 16;
+
 	/// string map of branch predictor kind
 	static misc::StringMap KindMap;
 
+	/// Information about a branch used by the predictor, from its lookup
+	/// at fetch until the predictor is trained at commit. Uops embed one,
+	/// and the sampler creates them standalone to warm up the predictor
+	/// without going through the pipeline.
+	struct Branch
+	{
+		/// Control micro-instruction
+		Uinst *uinst = nullptr;
+
+		/// Address of the macro-instruction
+		unsigned eip = 0;
+
+		/// Size of the macro-instruction
+		int mop_size = 0;
+
+		/// Address of the next macro-instruction. It is known at
+		/// lookup, since the emulator runs ahead of the pipeline.
+		unsigned neip = 0;
+
+		/// Predicted address of the next macro-instruction
+		unsigned predicted_neip = 0;
+
+		/// True if the branch is in a mispredicted path
+		bool speculative_mode = false;
+
+		/// Global prediction
+		Prediction prediction = PredictionNotTaken;
+
+		/// Bimodal predictor index
+		int bimod_index = 0;
+
+		/// Prediction from bimodal branch predictor
+		Prediction bimod_prediction = PredictionNotTaken;
+
+		/// Two-level branch predictor BHT index
+		int two_level_bht_index = 0;
+
+		/// Two-level branch predictor PHT row
+		int two_level_pht_row = 0;
+
+		/// Two-level branch predictor PHT column
+		int two_level_pht_col = 0;
+
+		/// Two-level branch prediction
+		Prediction two_level_prediction = PredictionNotTaken;
+
+		/// Choice index in the combined branch predictor
+		int choice_index = 0;
+
+		/// Prediction in the combined branch predictor
+		Prediction choice_prediction = PredictionNotTaken;
+
+		/// Number of outcomes in the global history of the branch
+		/// predictor when the branch was looked up. History-based
+		/// indices are computed again from it when the branch commits.
+		long long history_position = 0;
+
+		/// Component that provided the direction prediction
+		int provider = ProviderBase;
+
+		/// Prediction of the main predictor, before the loop predictor
+		/// possibly overrides it
+		Prediction main_prediction = PredictionNotTaken;
+
+		/// True if the loop predictor had an entry for the branch
+		bool loop_hit = false;
+
+		/// Iteration of the loop counted by the loop predictor
+		int loop_iteration = 0;
+
+		/// Prediction from the loop predictor
+		Prediction loop_prediction = PredictionNotTaken;
+
+		/// True if the loop predictor was confident about its
+		/// prediction
+		bool loop_confident = false;
+
+		/// For indirect branches, component that provided the target:
+		/// 0 for the BTB, or ITTAGE table plus one
+		int indirect_provider = 0;
+	};
+
 private:
 
 	//
@@ -96,6 +193,64 @@ private:
 	// Height of the level 2 table of the two-level predictor
 	static int two_level_l2_height;
 
+	// Number of tagged tables of the TAGE predictor
+	static int tage_num_tables;
+
+	// Number of entries of each tagged table of the TAGE predictor
+	static int tage_table_size;
+
+	// Number of tag bits in the TAGE predictor
+	static int tage_tag_bits;
+
+	// Shortest and longest history lengths of the TAGE tagged tables
+	static int tage_min_history;
+	static int tage_max_history;
+
+	// History length of each tagged table of the TAGE predictor, growing
+	// geometrically from the shortest to the longest
+	static std::vector<int> tage_history_lengths;
+
+	// Number of weight tables of the hashed perceptron predictor
+	static int perceptron_num_tables;
+
+	// Number of weights in each table of the perceptron predictor
+	static int perceptron_table_size;
+
+	// Global history length used by the perceptron predictor
+	static int perceptron_history_size;
+
+	// Training threshold of the perceptron predictor
+	static int perceptron_threshold;
+
+	// Whether the loop predictor is present
+	static bool loop_present;
+
+	// Number of entries of the loop predictor
+	static int loop_size;
+
+	// Whether the ITTAGE indirect target predictor is present
+	static bool ittage_present;
+
+	// Number of tagged tables of the ITTAGE predictor
+	static int ittage_num_tables;
+
+	// Number of entries of each table of the ITTAGE predictor
+	static int ittage_table_size;
+
+	// Number of tag bits in the ITTAGE predictor
+	static int ittage_tag_bits;
+
+	// Shortest and longest history lengths of the ITTAGE tables
+	static int ittage_min_history;
+	static int ittage_max_history;
+
+	// History length of each table of the ITTAGE predictor
+	static std::vector<int> ittage_history_lengths;
+
+	// Fill a vector with history lengths growing geometrically
+	static void setHistoryLengths(std::vector<int> &lengths,
+			int num_tables, int min_history, int max_history);
+
 
 
 
@@ -138,10 +293,246 @@ private:
 	//   2,3 - Use two-level adaptive predictor
 	std::unique_ptr<char[]> choice;
 
+
+
+
+	//
+	// Global history
+	//
+
+	// Number of outcomes kept in the global history. It must be larger
+	// than the longest history length plus the number of branches in
+	// flight, since history-based indices are computed again at commit.
+	static const int history_buffer_size = 4096;
+
+	// Global history of conditional branch outcomes, as a circular
+	// buffer of bits. The outcome pushed in position 'p' is stored in bit
+	// 'history_buffer_size - 1 - p' (modulo the buffer size), so that
+	// recent outcomes are read in increasing bit order.
+	std::unique_ptr<unsigned[]> history;
+
+	// Number of outcomes pushed into the global history so far
+	long long history_position = 0;
+
+	// Append a branch outcome to the global history
+	void PushHistory(bool taken);
+
+	// Return 'count' outcomes of the global history, up to 32, as seen
+	// when the history had 'position' elements, skipping the 'offset'
+	// most recent ones. The most recent outcome is returned in bit 0.
+	unsigned getHistory(long long position, int offset, int count) const;
+
+	// Fold 'length' outcomes of the global history, skipping the
+	// 'offset' most recent ones, into a value of 'bits' bits by
+	// xor-ing chunks of that size.
+	unsigned FoldHistory(long long position, int offset, int length,
+			int bits) const;
+
+	// Return the index into a tagged table of a TAGE-like predictor
+	int getTaggedIndex(unsigned eip, long long position, int table,
+			int history_length, int table_size) const;
+
+	// Return the tag of a branch in a tagged table of a TAGE-like
+	// predictor
+	unsigned getTaggedTag(unsigned eip, long long position,
+			int history_length, int tag_bits) const;
+
+
+
+
+	//
+	// TAGE predictor
+	//
+
+	// Entry of a TAGE tagged table
+	struct TageEntry
+	{
+		// Signed 3-bit prediction counter, taken if >= 0
+		signed char counter;
+
+		// Partial tag
+		unsigned short tag;
+
+		// 2-bit useful counter
+		unsigned char useful;
+	};
+
+	// Tagged tables, tage_num_tables * tage_table_size entries. The
+	// bimodal table is used as the base predictor.
+	std::unique_ptr<TageEntry[]> tage;
+
+	// Result of looking up the TAGE predictor
+	struct TageLookup
+	{
+		int index[MaxTaggedTables];
+		unsigned tag[MaxTaggedTables];
+		int provider;  // Tagged table, or -1 for the base predictor
+		int alternate;  // Tagged table, or -1 for the base predictor
+		bool provider_taken;
+		bool alternate_taken;
+		bool taken;  // Final prediction
+	};
+
+	// 4-bit counter deciding whether to use the alternate prediction when
+	// the provider entry was newly allocated
+	int tage_use_alternate = 8;
+
+	// Number of updates since the useful counters were last aged
+	int tage_num_updates = 0;
+
+	// Look up the TAGE predictor for a branch
+	void LookupTage(unsigned eip, long long position,
+			TageLookup &lookup) const;
+
+	// Train the TAGE predictor with the outcome of a branch
+	void UpdateTage(Branch &branch, bool taken);
+
+
+
+
+	//
+	// Perceptron predictor
+	//
+
+	// Weights, perceptron_num_tables * perceptron_table_size entries
+	std::unique_ptr<signed char[]> perceptron;
+
+	// Indices of the weights used by the branch being trained, one per
+	// table, kept here to avoid allocating them on every update
+	std::unique_ptr<int[]> perceptron_indices;
+
+	// Compute the output of the perceptron predictor for a branch. If
+	// 'indices' is not null, the indices of the weights used are returned
+	// in it.
+	int getPerceptronOutput(unsigned eip, long long position,
+			int *indices) const;
+
+	// Train the perceptron predictor with the outcome of a branch
+	void UpdatePerceptron(Branch &branch, bool taken);
+
+
+
+
+	//
+	// Loop predictor
+	//
+
+	// Entry of the loop predictor
+	struct LoopEntry
+	{
+		// Branch address
+		unsigned tag;
+
+		// Number of iterations of the last complete run of the loop,
+		// or 0 if not known yet
+		int trip_count;
+
+		// Number of iterations of the current run, counted at fetch
+		int iteration;
+
+		// Number of consecutive runs with the same trip count
+		int confidence;
+
+		// Replacement counter, decremented by allocation attempts
+		int age;
+
+		// Direction of the branch while the loop iterates
+		bool taken;
+	};
+
+	// Loop predictor table, direct-mapped
+	std::unique_ptr<LoopEntry[]> loop;
+
+	// 7-bit counter deciding whether confident loop predictions override
+	// the main predictor, trained when both disagree
+	int loop_use = 0;
+
+	// Look up the loop predictor and advance its iteration counter
+	void LookupLoop(Branch &branch);
+
+	// Train the loop predictor with the outcome of a branch
+	void UpdateLoop(Branch &branch, bool taken);
+
+
+
+
+	//
+	// ITTAGE predictor
+	//
+
+	// Entry of an ITTAGE table
+	struct IttageEntry
+	{
+		// Predicted target
+		unsigned target;
+
+		// Partial tag
+		unsigned short tag;
+
+		// 2-bit confidence counter
+		unsigned char confidence;
+
+		// 1-bit useful counter
+		unsigned char useful;
+	};
+
+	// Tables, ittage_num_tables * ittage_table_size entries
+	std::unique_ptr<IttageEntry[]> ittage;
+
+	// Return whether a branch gets its target from the ITTAGE predictor,
+	// i.e., whether it is an indirect jump or call
+	static bool isIndirect(const Branch &branch);
+
+	// Train the ITTAGE predictor with the target of an indirect branch
+	void UpdateIttage(Branch &branch);
+
+
+
+
+	//
+	// Statistics
+	//
+
 	// Stats 
 	long long accesses = 0;
 	long long hits = 0;
 
+	// Committed conditional branches predicted by each provider
+	std::vector<long long> provider_predictions;
+
+	// Mispredicted committed conditional branches of each provider
+	std::vector<long long> provider_mispredictions;
+
+	// Committed indirect branches predicted by the BTB (element 0) and
+	// by each ITTAGE table
+	std::vector<long long> indirect_predictions;
+
+	// Mispredicted committed indirect branches of each provider
+	std::vector<long long> indirect_mispredictions;
+
+
+
+
+	//
+	// Accesses
+	//
+
+	// Copy the fields of a uop read by the predictor into its branch
+	// information, and return it
+	static Branch &getBranch(Uop *uop);
+
+	// Predict the direction of a branch
+	Prediction Lookup(Branch &branch);
+
+	// Train the direction predictors with the outcome of a branch
+	void Train(Branch &branch);
+
+	// Predict the target of a branch
+	unsigned LookupBtb(Branch &branch);
+
+	// Train the BTB and target predictors with the target of a branch
+	void UpdateBtb(Branch &branch);
+
 public:
 
 	//
@@ -185,6 +576,48 @@ public:
 
 	static int getTwoLevelL2Height() { return two_level_l2_height; }
 
+	static int getTageNumTables() { return tage_num_tables; }
+
+	static int getTageTableSize() { return tage_table_size; }
+
+	static int getTageTagBits() { return tage_tag_bits; }
+
+	static int getTageMinHistory() { return tage_min_history; }
+
+	static int getTageMaxHistory() { return tage_max_history; }
+
+	static int getTageHistoryLength(int table) { return tage_history_lengths[table]; }
+
+	static int getPerceptronNumTables() { return perceptron_num_tables; }
+
+	static int getPerceptronTableSize() { return perceptron_table_size; }
+
+	static int getPerceptronHistorySize() { return perceptron_history_size; }
+
+	static bool isLoopPresent() { return loop_present; }
+
+	static int getLoopSize() { return loop_size; }
+
+	static bool isIttagePresent() { return ittage_present; }
+
+	static int getIttageNumTables() { return ittage_num_tables; }
+
+	static int getIttageTableSize() { return ittage_table_size; }
+
+	static int getIttageTagBits() { return ittage_tag_bits; }
+
+	static int getIttageMinHistory() { return ittage_min_history; }
+
+	static int getIttageMaxHistory() { return ittage_max_history; }
+
+	/// Return whether any of the components that report per-provider
+	/// statistics is configured
+	static bool hasProviderStats()
+	{
+		return kind == KindTage || kind == KindPerceptron ||
+				loop_present || ittage_present;
+	}
+
 
 
 
@@ -201,6 +634,47 @@ public:
 	/// Dump configuration
 	void DumpConfiguration(std::ostream &os = std::cout);
 
+	/// Dump statistics of the components providing the predictions
+	void DumpReport(std::ostream &os = std::cout) const;
+
+	/// Return the name of a direction prediction provider
+	static std::string getProviderName(int provider);
+
+	/// Return the number of committed branches
+	long long getNumAccesses() const { return accesses; }
+
+	/// Return the number of committed branches whose next instruction was
+	/// predicted correctly
+	long long getNumHits() const { return hits; }
+
+	/// Return the number of committed conditional branches predicted by
+	/// a provider
+	long long getProviderPredictions(int provider) const
+	{
+		return provider_predictions[provider];
+	}
+
+	/// Return the number of mispredicted committed conditional branches
+	/// predicted by a provider
+	long long getProviderMispredictions(int provider) const
+	{
+		return provider_mispredictions[provider];
+	}
+
+	/// Return the number of committed indirect branches whose target was
+	/// provided by the BTB (provider 0) or by ITTAGE table 'provider - 1'
+	long long getIndirectPredictions(int provider) const
+	{
+		return indirect_predictions[provider];
+	}
+
+	/// Return the number of mispredicted committed indirect branches
+	/// whose target was provided by the given provider
+	long long getIndirectMispredictions(int provider) const
+	{
+		return indirect_mispredictions[provider];
+	}
+
 	char getBimodStatus(int index) const { return bimod[index]; }
 
 	int getTwoLevelBhtStatus(int index) const { return two_level_bht[index]; }
@@ -269,6 +743,18 @@ public:
 	///
 	void UpdateBtb(Uop *uop);
 
+	/// Look up and train the predictor with a branch executed outside of
+	/// the pipeline, as done while warming up the predictor in fast
+	/// forward. Statistics are not updated.
+	///
+	/// \param branch
+	///	Branch information. The caller sets the micro-instruction, the
+	///	addresses of the branch and of the next instruction, the size
+	///	of the branch, and the address of the next instruction in
+	///	sequence as the predicted one.
+	///
+	void Warm(Branch &branch);
+
 	/// Find address of next branch after eip within current block.
 	/// This is useful for accessing the trace cache. At that point, the
 	/// uop is not ready to call \c LookupBtb(), since functional simulation
@@ -28,7 +28,9 @@ namespace x86
 Core::Core(Cpu *cpu,
 		int id) :
 		cpu(cpu),
-		id(id)
+		id(id),
+		event_queue(Cpu::getNumThreads() * Cpu::getReorderBufferSize()),
+		uop_pool(Cpu::getNumThreads() * Cpu::getReorderBufferSize())
 {
 	// Assign name
 	name = misc::fmt("Core %d", id);
@@ -48,7 +50,7 @@ void Core::Dump(std::ostream &os) const
 }
 
 
-void Core::InsertInEventQueue(std::shared_ptr<Uop> uop, int latency)
+void Core::InsertInEventQueue(Uop *uop, int latency)
 {
 	// Sanity
 	assert(!uop->in_event_queue);
@@ -57,39 +59,40 @@ void Core::InsertInEventQueue(std::shared_ptr<Uop> uop, int latency)
 	assert(!uop->completed);
 	uop->complete_when = cpu->getCycle() + latency;
 
-	// Find position in event queue
-	auto it = event_queue.begin();
-	auto e = event_queue.end();
-	while (it != e)
-	{
-		// Check if position found
-		if (uop->Compare(it->get()) < 0)
-			break;
-
-		// Next
-		++it;
-	}
+	// Find position in event queue. Most uops complete after the ones
+	// already in the queue, so the search starts at the tail.
+	int index = event_queue.size();
+	while (index > 0 && uop->Compare(event_queue[index - 1]) < 0)
+		index--;
 
 	// Insert
-	uop->event_queue_iterator = event_queue.insert(it, uop);
+	event_queue.Insert(index, uop);
 	uop->in_event_queue = true;
 }
 
 
-void Core::ExtractFromEventQueue(Uop *uop)
+void Core::ExtractFromEventQueue(int index)
 {
 	// Uop must be in the queue
+	Uop *uop = event_queue[index];
 	assert(uop->in_event_queue);
 
-	// Save iterator
-	auto it = uop->event_queue_iterator;
-
-	// Indicate that the uop is not in the queue anymore
+	// Remove it from the queue
 	uop->in_event_queue = false;
-	uop->event_queue_iterator = event_queue.end();
+	event_queue.Erase(index);
+	ReleaseUop(uop);
+}
 
-	// Remove it as the last step, as this may free the uop
-	event_queue.erase(it);
+
+void Core::FreeReleasedUops()
+{
+	for (Uop *uop : released_uops)
+	{
+		uop->in_release_list = false;
+		if (!uop->isInPipeline())
+			misc::SlotPool::Delete(uop);
+	}
+	released_uops.clear();
 }
 
 
@@ -312,7 +315,7 @@ void Core::Writeback()
 			break;
 
 		// Pick uop from the head of the event queue
-		std::shared_ptr<Uop> uop = event_queue.front();
+		Uop *uop = event_queue.front();
 
 		// If the uop is set to complete later than the current cycle,
 		// there is nothing else to extract from the event queue.
@@ -324,7 +327,7 @@ void Core::Writeback()
 		assert(!uop->completed);
 
 		// Extract element from event queue
-		ExtractFromEventQueue(uop.get());
+		ExtractFromEventQueue(0);
 
 		// If this instruction is the first in speculative mode
 		// (typically a mispredicted branch), and recovery is configured
@@ -355,10 +358,15 @@ void Core::Writeback()
 		// Instruction has completed
 		uop->completed = true;
 
-		// Write output registers
+		// A uop replayed after a memory-order violation has a copy
+		// in the pipeline, and its registers were already released
 		Thread *thread = uop->getThread();
+		if (uop->replayed)
+			continue;
+
+		// Write output registers
 		RegisterFile *register_file = thread->getRegisterFile();
-		register_file->WriteUop(uop.get());
+		register_file->WriteUop(uop);
 
 		// Increment number of writes to core's register counters
 		num_integer_register_writes += uop->getNumIntegerOutputs();
@@ -374,6 +382,10 @@ void Core::Writeback()
 		if (recover)
 			thread->Recover();
 	}
+
+	// Replay loads that violated memory ordering in this cycle
+	for (auto &thread : threads)
+		thread->Replay();
 }
 
 
@@ -450,15 +462,26 @@ void Core::Commit()
 }
 
 
+void Core::EvictContexts()
+{
+	for (auto &thread : threads)
+		thread->EvictDrainedContext();
+}
+
+
 void Core::Run()
 {
 	// Run stages in reverse order
 	Commit();
 	Writeback();
+	EvictContexts();
 	Issue();
 	Dispatch();
 	Decode();
 	Fetch();
+
+	// Return uops that left the pipeline to the pool
+	FreeReleasedUops();
 }
 
 }
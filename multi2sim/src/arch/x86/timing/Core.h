@@ -21,10 +21,11 @@
 #define ARCH_X86_TIMING_CORE_H
 
 #include <vector>
-#include <list>
 #include <string>
 
 #include <arch/x86/emulator/Uinst.h>
+#include <lib/cpp/RingBuffer.h>
+#include <lib/cpp/SlotPool.h>
 
 #include "Alu.h"
 #include "Thread.h"
@@ -57,8 +58,15 @@ private:
 	// Arithmetic-logic unit
 	Alu alu;
 
-	// Event queue
-	std::list<std::shared_ptr<Uop>> event_queue;
+	// Event queue, sorted by completion cycle
+	misc::RingBuffer<Uop *> event_queue;
+
+	// Pool of uops of all threads in the core
+	misc::SlotPool uop_pool;
+
+	// Uops that left their last pipeline structure during the current
+	// cycle, returned to the pool at the end of it by FreeReleasedUops()
+	std::vector<Uop *> released_uops;
 
 
 
@@ -288,24 +296,65 @@ public:
 	/// Insert uop into event queue, making it ready to be extract in
 	/// \a latency cycles from now. The uop's field `complete_when` is
 	/// set to the current cycle plus \a latency in the function.
-	void InsertInEventQueue(std::shared_ptr<Uop> uop, int latency);
+	void InsertInEventQueue(Uop *uop, int latency);
+
+	/// Extract the uop at the given position of the event queue, where
+	/// position 0 is the uop completing first.
+	void ExtractFromEventQueue(int index);
+
+	/// Return the number of uops in the event queue
+	int getEventQueueSize() const { return event_queue.size(); }
 
-	/// Extract uop from event queue. The given uop must be placed at the
-	/// head of the event queue.
-	void ExtractFromEventQueue(Uop *uop);
+	/// Return the uop at the given position of the event queue
+	Uop *getEventQueueUop(int index) { return event_queue[index]; }
 
-	/// Return an iterator to the first element of the event queue
-	std::list<std::shared_ptr<Uop>>::iterator getEventQueueBegin()
+
+
+
+	//
+	// Uop pool
+	//
+
+	/// Create a new uop for one of the threads of the core. The uop is
+	/// owned by the core, and is returned to its pool once it leaves the
+	/// last pipeline structure that references it.
+	Uop *NewUop(Thread *thread, Context *context,
+			std::shared_ptr<Uinst> uinst)
+	{
+		return uop_pool.New<Uop>(thread, context, uinst);
+	}
+
+	/// Create a copy of a uop that is about to be replayed, with the same
+	/// identifiers and fetch information, but with its pipeline state reset
+	/// as if it had not been dispatched yet. See Uop::ResetState().
+	Uop *CloneUop(const Uop *uop)
 	{
-		return event_queue.begin();
+		Uop *clone = uop_pool.New<Uop>(*uop);
+		clone->ResetState();
+		return clone;
 	}
 
-	/// Return a past-the-end iterator to the event queue
-	std::list<std::shared_ptr<Uop>>::iterator getEventQueueEnd()
+	/// Notify that a uop was removed from a pipeline structure. If it is
+	/// not referenced by any other structure, it is scheduled to be
+	/// returned to the pool at the end of the current cycle. Deferring
+	/// the release lets pipeline stages keep using a uop while moving it
+	/// from one queue to the next.
+	void ReleaseUop(Uop *uop)
 	{
-		return event_queue.end();
+		if (!uop->isInPipeline() && !uop->in_release_list)
+		{
+			uop->in_release_list = true;
+			released_uops.push_back(uop);
+		}
 	}
 
+	/// Return to the pool all uops released in the current cycle that
+	/// were not inserted again in another pipeline structure.
+	void FreeReleasedUops();
+
+	/// Return the uop pool of the core
+	const misc::SlotPool *getUopPool() const { return &uop_pool; }
+
 
 
 
@@ -400,6 +449,10 @@ public:
 	/// Commit stage
 	void Commit();
 
+	/// Evict the contexts whose pipelines were drained by the commit stage
+	/// in the current cycle after receiving an eviction signal.
+	void EvictContexts();
+
 
 
 
@@ -79,6 +79,7 @@ int Cpu::thread_quantum;
 int Cpu::thread_switch_penalty;
 long long Cpu::num_fast_forward_instructions;
 long long Cpu::max_cycles = 0;
+int Cpu::num_host_threads = 1;
 int Cpu::recover_penalty;
 Cpu::RecoverKind Cpu::recover_kind;
 Cpu::FetchKind Cpu::fetch_kind;
@@ -90,6 +91,8 @@ Cpu::IssueKind Cpu::issue_kind;
 int Cpu::commit_width;
 Cpu::CommitKind Cpu::commit_kind;
 bool Cpu::occupancy_stats;
+bool Cpu::macro_fusion;
+bool Cpu::micro_fusion;
 int Cpu::reorder_buffer_size;
 Cpu::ReorderBufferKind Cpu::reorder_buffer_kind;
 int Cpu::fetch_queue_size;
@@ -97,6 +100,8 @@ Cpu::InstructionQueueKind Cpu::instruction_queue_kind;
 int Cpu::instruction_queue_size;
 Cpu::LoadStoreQueueKind Cpu::load_store_queue_kind;
 int Cpu::load_store_queue_size;
+bool Cpu::store_forwarding;
+int Cpu::store_forward_latency;
 int Cpu::uop_queue_size;
 
 esim::Event *Cpu::event_memory_access_start;
@@ -136,6 +141,8 @@ void Cpu::ParseConfiguration(misc::IniFile *ini_file)
 	section = "General";
 	num_cores = ini_file->ReadInt(section, "Cores", num_cores);
 	num_threads = ini_file->ReadInt(section, "Threads", num_threads);
+	num_fast_forward_instructions = ini_file->ReadInt64(section,
+			"FastForward", 0);
 	context_quantum = ini_file->ReadInt(section, "ContextQuantum", 100000);
 	thread_quantum = ini_file->ReadInt(section, "ThreadQuantum", 1000);
 	thread_switch_penalty = ini_file->ReadInt(section, "ThreadSwitchPenalty", 0);
@@ -158,6 +165,8 @@ void Cpu::ParseConfiguration(misc::IniFile *ini_file)
 			commit_kind_map, CommitKindShared);
 	commit_width = ini_file->ReadInt(section, "CommitWidth", 4);
 	occupancy_stats = ini_file->ReadBool(section, "OccupancyStats", false);
+	macro_fusion = ini_file->ReadBool(section, "MacroFusion", false);
+	micro_fusion = ini_file->ReadBool(section, "MicroFusion", false);
 
 	// Section '[ Queues ]'
 	section = "Queues";
@@ -172,7 +181,13 @@ void Cpu::ParseConfiguration(misc::IniFile *ini_file)
 	load_store_queue_kind = (LoadStoreQueueKind) ini_file->ReadEnum(section, "LsqKind",
 			load_store_queue_kind_map, LoadStoreQueueKindPrivate);
 	load_store_queue_size = ini_file->ReadInt(section, "LsqSize", 20);
+	store_forwarding = ini_file->ReadBool(section, "StoreForwarding", false);
+	store_forward_latency = ini_file->ReadInt(section, "StoreForwardLatency", 2);
 	uop_queue_size = ini_file->ReadInt(section, "UopQueueSize", 32);
+	if (store_forward_latency < 1)
+		throw Timing::Error(misc::fmt("%s: Invalid value for "
+				"'StoreForwardLatency'",
+				ini_file->getPath().c_str()));
 }
 
 
@@ -181,16 +196,73 @@ void Cpu::Run()
 	// Invoke scheduler
 	Schedule();
 
-	// Run all cores
+	// Cores are advanced sequentially if only one host thread is used, or
+	// if tracing/debugging output is active, since its contents depend on
+	// the order of the calls.
+	if (num_host_threads <= 1 || Timing::trace || RegisterFile::debug ||
+			TraceCache::debug)
+	{
+		for (auto &core : cores)
+			core->Run();
+		return;
+	}
+
+	// Create thread pool on first use
+	if (!thread_pool)
+		thread_pool = misc::new_unique<misc::ThreadPool>(
+				num_host_threads);
+
+	// Commit and writeback only touch state private to each core, so they
+	// run concurrently in all cores.
+	thread_pool->ParallelFor(num_cores, [this](int index)
+	{
+		cores[index]->Commit();
+		cores[index]->Writeback();
+	});
+
+	// Context evictions update the emulator, and the issue stage starts
+	// accesses to the shared memory hierarchy. They run in core order,
+	// which reproduces the sequence of the sequential mode.
+	for (auto &core : cores)
+	{
+		core->EvictContexts();
+		core->Issue();
+	}
+
+	// Dispatch and decode, private to each core
+	thread_pool->ParallelFor(num_cores, [this](int index)
+	{
+		cores[index]->Dispatch();
+		cores[index]->Decode();
+	});
+
+	// Fetch runs the emulator and accesses the instruction caches
+	for (auto &core : cores)
+	{
+		core->Fetch();
+		core->FreeReleasedUops();
+	}
+}
+
+
+bool Cpu::isDrained() const
+{
 	for (auto &core : cores)
-		core->Run();
+	{
+		if (core->getEventQueueSize())
+			return false;
+		for (int i = 0; i < num_threads; i++)
+			if (!core->getThread(i)->isDrained())
+				return false;
+	}
+	return true;
 }
 
 
 void Cpu::MemoryAccess(mem::Module *module,
 			mem::Module::AccessType access_type,
 			unsigned address,
-			std::shared_ptr<Uop> uop)
+			Uop *uop)
 {
 	// New frame
 	auto frame = misc::new_shared<MemoryAccessFrame>();
@@ -199,6 +271,10 @@ void Cpu::MemoryAccess(mem::Module *module,
 	frame->address = address;
 	frame->uop = uop;
 
+	// The uop stays alive until the access completes
+	assert(!uop->in_memory_access);
+	uop->in_memory_access = true;
+
 	// Schedule event
 	esim::Engine *esim_engine = esim::Engine::getInstance();
 	esim_engine->Call(event_memory_access_start, frame);
@@ -224,8 +300,10 @@ void Cpu::MemoryAccessHandler(esim::Event *event, esim::Frame *esim_frame)
 	else if (event == event_memory_access_end)
 	{
 		// Insert uop into the core's event queue
-		Core *core = frame->uop->getCore();
-		core->InsertInEventQueue(frame->uop, 0);
+		Uop *uop = frame->uop;
+		uop->in_memory_access = false;
+		Core *core = uop->getCore();
+		core->InsertInEventQueue(uop, 0);
 	}
 	else
 	{
@@ -241,35 +319,35 @@ long long Cpu::getCycle() const
 }
 
 
-void Cpu::InsertInTraceList(std::shared_ptr<Uop> uop)
+void Cpu::InsertInTraceList(Uop *uop)
 {
 	assert(Timing::trace == true);
 	assert(!uop->in_trace_list);
 	uop->in_trace_list = true;
-	uop->trace_list_iterator = trace_list.insert(trace_list.end(), uop);
+	trace_list.push_back(uop);
 }
 
 
 void Cpu::EmptyTraceList()
 {
-	while (trace_list.size())
+	for (Uop *uop : trace_list)
 	{
-		// Get instruction at the head
-		std::shared_ptr<Uop> uop = trace_list.front();
-		assert(uop->in_trace_list);
-
 		// Remove from trace list
-		trace_list.pop_front();
+		assert(uop->in_trace_list);
 		uop->in_trace_list = false;
-		uop->trace_list_iterator = trace_list.end();
 
 		// Trace
+		Core *core = uop->getCore();
 		Timing::trace << misc::fmt("x86.end_inst "
 				"id=%lld "
 				"core=%d\n",
 				uop->getIdInCore(),
-				uop->getCore()->getId());
+				core->getId());
+
+		// The uop can now go back to the pool
+		core->ReleaseUop(uop);
 	}
+	trace_list.clear();
 }
 
 }
@@ -20,10 +20,12 @@
 #ifndef ARCH_X86_TIMING_CPU_H
 #define ARCH_X86_TIMING_CPU_H
 
+#include <atomic>
 #include <deque>
 #include <list>
 #include <vector>
 
+#include <lib/cpp/ThreadPool.h>
 #include <memory/Mmu.h>
 #include <memory/Module.h>
 #include <arch/x86/emulator/Emulator.h>
@@ -136,6 +138,9 @@ public:
 	// Maximum number of cycles to simulate
 	static long long max_cycles;
 
+	// Number of host threads used to run the cores
+	static int num_host_threads;
+
 
 private:
 
@@ -183,7 +188,10 @@ private:
 	std::string stage;
 
 	// List containing uops that need to report an 'end_inst' trace event 
-	std::list<std::shared_ptr<Uop>> trace_list;
+	std::vector<Uop *> trace_list;
+
+	// Pool of host threads running the cores, created on first use
+	std::unique_ptr<misc::ThreadPool> thread_pool;
 
 
 
@@ -195,36 +203,55 @@ private:
 	// Number of fectched micro-instructions
 	long long num_fetched_uinsts = 0;
 
+	// Counters updated by the commit, writeback, and dispatch stages are
+	// atomic, since these stages run concurrently in all cores.
+
 	// Number of dispatched micro-instructions for every opcode
-	long long num_dispatched_uinst_array[Uinst::OpcodeCount] = { };
+	std::atomic<long long> num_dispatched_uinst_array[Uinst::OpcodeCount] = { };
 
 	// Number of issued micro-instructions for every opcode
 	long long num_issued_uinst_array[Uinst::OpcodeCount] = { };
 
 	// Number of committed micro-instructions for every opcode
-	long long num_committed_uinst_array[Uinst::OpcodeCount] = { };
+	std::atomic<long long> num_committed_uinst_array[Uinst::OpcodeCount] = { };
 
 	// Number of dispatched micro-instructions
-	long long num_dispatched_uinsts = 0;
+	std::atomic<long long> num_dispatched_uinsts{0};
 
 	// Number of issued micro-instructions
 	long long num_issued_uinsts = 0;
 
 	// Number of committed micro-instructions
-	long long num_committed_uinsts = 0;
+	std::atomic<long long> num_committed_uinsts{0};
 
 
 	// Committed macro-instructions
-	long long num_committed_instructions = 0;
+	std::atomic<long long> num_committed_instructions{0};
 
 	// Number of squashed micro-instructions
-	long long num_squashed_uinsts = 0;
+	std::atomic<long long> num_squashed_uinsts{0};
+
+	// Number of loads that got their data forwarded from an older store
+	long long num_forwarded_loads = 0;
+
+	// Number of loads that issued before an older store to the same
+	// address
+	std::atomic<long long> num_memory_order_violations{0};
+
+	// Number of micro-instructions replayed after memory-order violations
+	std::atomic<long long> num_replayed_uinsts{0};
 
 	// Number of branch micro-instructions
-	long long num_branches = 0;
+	std::atomic<long long> num_branches{0};
 
 	// Number of mis-predicted branch micro-instructions
-	long long num_mispredicted_branches = 0;
+	std::atomic<long long> num_mispredicted_branches{0};
+
+	// Number of committed branches macro-fused with the preceding uop
+	std::atomic<long long> num_macro_fused_uinsts{0};
+
+	// Number of committed uops micro-fused with the preceding load
+	std::atomic<long long> num_micro_fused_uinsts{0};
 
 
 
@@ -259,7 +286,7 @@ private:
 		unsigned address = -1;
 
 		// Uop associated with the memory access
-		std::shared_ptr<Uop> uop;
+		Uop *uop = nullptr;
 	};
 
 	// Event scheduled to start a memory access
@@ -311,6 +338,12 @@ private:
 	// Flag that indicates Cpu to calculate structures occupancy statistics
 	static bool occupancy_stats;
 
+	// Fuse conditional branches with the preceding flag-producing uop
+	static bool macro_fusion;
+
+	// Fuse loads with the uop consuming their result
+	static bool micro_fusion;
+
 
 
 
@@ -339,6 +372,12 @@ private:
 	// Load/Store queue size
 	static int load_store_queue_size;
 
+	// Whether loads are checked against older stores in the store queue
+	static bool store_forwarding;
+
+	// Latency of a load whose data is forwarded from an older store
+	static int store_forward_latency;
+
 	// Uop queue size
 	static int uop_queue_size;
 
@@ -356,6 +395,9 @@ private:
 	// UpdateContextAllocationCycle().
 	long long min_context_allocate_cycle = 0;
 
+	// Fetch is stopped in all threads until the pipelines are empty
+	bool draining = false;
+
 public:
 
 	//
@@ -398,6 +440,15 @@ public:
 	/// Get load/store queue size
 	static int getLoadStoreQueueSize() { return load_store_queue_size; }
 
+	/// Return whether loads are checked against older stores in the
+	/// store queue, getting their data forwarded, waiting, or being
+	/// replayed after a memory-order violation
+	static bool getStoreForwarding() { return store_forwarding; }
+
+	/// Return the latency of a load whose data is forwarded from an older
+	/// store in the store queue
+	static int getStoreForwardLatency() { return store_forward_latency; }
+
 	/// Return the size of the uop queue, as configured by the user
 	static int getUopQueueSize() { return uop_queue_size; }
 
@@ -480,7 +531,7 @@ public:
 	/// Insert an uop into a list of uops that still need to dump an
 	/// 'end_inst' trace event. This will happen when the trace list is
 	/// emptied with a call to EmptyUopTraceList().
-	void InsertInTraceList(std::shared_ptr<Uop> uop);
+	void InsertInTraceList(Uop *uop);
 
 	/// Empty the uop trace list and make every uop contained in it dump
 	/// its last 'end_inst' trace event.
@@ -489,19 +540,35 @@ public:
 	/// Simulate one cycle of the CPU for all its cores and threads.
 	void Run();
 
+	/// Stop or resume fetching in all threads. While stopped, the
+	/// instructions in the pipelines keep executing until they commit.
+	void setDraining(bool draining) { this->draining = draining; }
+
+	/// Return whether fetch is stopped to drain the pipelines
+	bool isDraining() const { return draining; }
+
+	/// Return true if no uop is left in the pipeline of any thread
+	bool isDrained() const;
+
 	/// Update structure occupancy statistics
 	void UpdateOccupancyStats();
 
 	/// Get occupancy statistics flag
 	static bool getOccupancyStats() { return occupancy_stats; }
 
+	/// Return whether macro-fusion is enabled
+	static bool getMacroFusion() { return macro_fusion; }
+
+	/// Return whether micro-fusion is enabled
+	static bool getMicroFusion() { return micro_fusion; }
+
 	/// Perform a memory access on the given module for the given address.
 	/// When the access completes, the \a uop is inserted in the event
 	/// queue of the corresponding core.
 	void MemoryAccess(mem::Module *module,
 			mem::Module::AccessType access_type,
 			unsigned address,
-			std::shared_ptr<Uop> uop);
+			Uop *uop);
 
 
 
@@ -549,10 +616,11 @@ public:
 		num_dispatched_uinsts++;
 	}
 
-	/// Return the array of dispatched micro-instructions
-	const long long *getNumDispatchedUinstArray() const
+	/// Return the number of dispatched micro-instructions of each kind
+	std::vector<long long> getNumDispatchedUinstArray() const
 	{
-		return num_dispatched_uinst_array;
+		return std::vector<long long>(num_dispatched_uinst_array,
+				num_dispatched_uinst_array + Uinst::OpcodeCount);
 	}
 
 	/// Return the number of dispatched micro-instructions
@@ -589,10 +657,11 @@ public:
 		num_committed_uinsts++;
 	}
 
-	/// Return the array of committed micro-instructions
-	const long long *getNumCommittedUinstArray() const
+	/// Return the number of committed micro-instructions of each kind
+	std::vector<long long> getNumCommittedUinstArray() const
 	{
-		return num_committed_uinst_array;
+		return std::vector<long long>(num_committed_uinst_array,
+				num_committed_uinst_array + Uinst::OpcodeCount);
 	}
 
 	/// Return the number of committed micro-instructions
@@ -607,6 +676,24 @@ public:
 	/// Return the number of squashed micro-instructions
 	long long getNumSquashedUinsts() const { return num_squashed_uinsts; }
 
+	/// Increment the number of loads forwarded from older stores
+	void incNumForwardedLoads() { num_forwarded_loads++; }
+
+	/// Return the number of loads forwarded from older stores
+	long long getNumForwardedLoads() const { return num_forwarded_loads; }
+
+	/// Increment the number of memory-order violations
+	void incNumMemoryOrderViolations() { num_memory_order_violations++; }
+
+	/// Return the number of memory-order violations
+	long long getNumMemoryOrderViolations() const { return num_memory_order_violations; }
+
+	/// Increment the number of replayed micro-instructions
+	void incNumReplayedUinsts() { num_replayed_uinsts++; }
+
+	/// Return the number of replayed micro-instructions
+	long long getNumReplayedUinsts() const { return num_replayed_uinsts; }
+
 	/// Increment the number of committed instructions
 	void incNumCommittedInstructions() { num_committed_instructions++; }
 	
@@ -624,6 +711,18 @@ public:
 
 	/// Return the number of mispredicted branches
 	long long getNumMispredictedBranches() const { return num_mispredicted_branches; }
+
+	/// Increment the number of committed macro-fused branches
+	void incNumMacroFusedUinsts() { num_macro_fused_uinsts++; }
+
+	/// Return the number of committed macro-fused branches
+	long long getNumMacroFusedUinsts() const { return num_macro_fused_uinsts; }
+
+	/// Increment the number of committed micro-fused uops
+	void incNumMicroFusedUinsts() { num_micro_fused_uinsts++; }
+
+	/// Return the number of committed micro-fused uops
+	long long getNumMicroFusedUinsts() const { return num_micro_fused_uinsts; }
 };
 
 }
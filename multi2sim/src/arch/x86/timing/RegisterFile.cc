@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include "RegisterFile.h"
 #include "Core.h"
 #include "Thread.h"
@@ -447,6 +449,21 @@ void RegisterFile::Rename(Uop *uop)
 		}
 	}
 
+	// Wait for source operands that are still being computed. The uop
+	// is woken up when the last of them is written back.
+	uop->num_pending_inputs = 0;
+	for (int dep = 0; dep < Uinst::MaxIDeps; dep++)
+	{
+		PhysicalRegister *reg = getPhysicalRegister(
+				uop->getUinst()->getIDep(dep),
+				uop->getInput(dep));
+		if (reg && reg->pending)
+		{
+			reg->consumers.push_back(uop);
+			uop->num_pending_inputs++;
+		}
+	}
+
 	// Rename output int/FP/XMM registers (not flags)
 	int flag_physical_register = -1;
 	int flag_count = 0;
@@ -610,19 +627,94 @@ bool RegisterFile::isUopReady(Uop *uop)
 }
 
 
-void RegisterFile::WriteUop(Uop *uop)
+bool RegisterFile::isStoreAddressReady(Uop *uop)
+{
+	for (int dep = 0; dep < Uinst::MaxIDeps; dep++)
+	{
+		if (!uop->isStoreAddressInput(dep))
+			continue;
+		PhysicalRegister *reg = getPhysicalRegister(
+				uop->getUinst()->getIDep(dep),
+				uop->getInput(dep));
+		if (reg && reg->pending)
+			return false;
+	}
+	return true;
+}
+
+
+void RegisterFile::RemoveConsumer(Uop *uop)
+{
+	for (int dep = 0; dep < Uinst::MaxIDeps; dep++)
+	{
+		// Only pending registers keep track of consumers
+		PhysicalRegister *reg = getPhysicalRegister(
+				uop->getUinst()->getIDep(dep),
+				uop->getInput(dep));
+		if (!reg || !reg->pending)
+			continue;
+
+		// Remove one occurrence of the uop, since it appears once for
+		// every input that maps to the register.
+		auto it = std::find(reg->consumers.begin(),
+				reg->consumers.end(), uop);
+		if (it != reg->consumers.end())
+		{
+			reg->consumers.erase(it);
+			uop->num_pending_inputs--;
+		}
+	}
+
+	// Sanity
+	assert(!uop->num_pending_inputs);
+}
+
+
+RegisterFile::PhysicalRegister *RegisterFile::getPhysicalRegister(
+		int logical_register,
+		int physical_register)
 {
+	if (Uinst::isIntegerDependency(logical_register))
+		return &integer_registers[physical_register];
+	else if (Uinst::isFloatingPointDependency(logical_register))
+		return &floating_point_registers[physical_register];
+	else if (Uinst::isXmmDependency(logical_register))
+		return &xmm_registers[physical_register];
+	else
+		return nullptr;
+}
+
+
+void RegisterFile::WritePhysicalRegister(PhysicalRegister *reg)
+{
+	// Result available
+	reg->pending = false;
+
+	// Wake up consumers with no other pending source. Stores are resolved
+	// as soon as their address is known, even if their data is not.
+	for (Uop *uop : reg->consumers)
+	{
+		if (uop->in_store_queue && !uop->address_resolved &&
+				isStoreAddressReady(uop))
+			uop->getThread()->ResolveStore(uop);
+		assert(uop->num_pending_inputs > 0);
+		uop->num_pending_inputs--;
+		if (!uop->num_pending_inputs)
+			uop->getThread()->WakeupUop(uop);
+	}
+	reg->consumers.clear();
+}
 
+
+void RegisterFile::WriteUop(Uop *uop)
+{
 	for (int dep = 0; dep < Uinst::MaxODeps; dep++)
 	{
-		int logical_register = uop->getUinst()->getODep(dep);
-		int physical_register = uop->getOutput(dep);
-		if (Uinst::isIntegerDependency(logical_register))
-			integer_registers[physical_register].pending = false;
-		else if (Uinst::isFloatingPointDependency(logical_register))
-			floating_point_registers[physical_register].pending = false;
-		else if (Uinst::isXmmDependency(logical_register))
-			xmm_registers[physical_register].pending = false;
+		PhysicalRegister *reg = getPhysicalRegister(
+				uop->getUinst()->getODep(dep),
+				uop->getOutput(dep));
+		if (reg)
+			WritePhysicalRegister(reg);
 	}
 }
 
@@ -635,7 +727,6 @@ void RegisterFile::UndoUop(Uop *uop)
 
 	// Undo mappings in reverse order, in case an instruction has a
 	// duplicated output dependence.
-	assert(uop->speculative_mode);
 	for (int dep = Uinst::MaxODeps - 1; dep >= 0; dep--)
 	{
 		int logical_register = uop->getUinst()->getODep(dep);
@@ -20,6 +20,8 @@
 #ifndef ARCH_X86_TIMING_REGISTER_FILE_H
 #define ARCH_X86_TIMING_REGISTER_FILE_H
 
+#include <vector>
+
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/IniFile.h>
 #include <arch/x86/emulator/Uinst.h>
@@ -80,8 +82,22 @@ private:
 
 		// Number of logical registers mapped to this physical register
 		int busy = 0;
+
+		// Uops waiting for the result of this physical register, woken
+		// up when it is written back.
+		std::vector<Uop *> consumers;
 	};
 
+	// Return the physical register associated with the given input or
+	// output dependence, or null if the dependence is not an integer,
+	// floating-point, or XMM register.
+	PhysicalRegister *getPhysicalRegister(int logical_register,
+			int physical_register);
+
+	// Mark a physical register as written back, waking up the uops that
+	// were waiting for it.
+	void WritePhysicalRegister(PhysicalRegister *reg);
+
 
 
 
@@ -286,12 +302,21 @@ public:
 	/// Check if input dependencies are resolved
 	bool isUopReady(Uop *uop);
 
+	/// Check if the input dependencies forming the address of a store are
+	/// resolved, regardless of the data it writes
+	bool isStoreAddressReady(Uop *uop);
+
+	/// Stop tracking the pending input operands of a uop that was renamed
+	/// but is being squashed before all its sources were written back.
+	void RemoveConsumer(Uop *uop);
+
 	/// Update the state of the register file when an uop completes, that
 	/// is, when its results are written back.
 	void WriteUop(Uop *uop);
 
 	/// Update the state of the register file when an uop is recovered from
-	/// speculative execution
+	/// speculative execution, or squashed for replay after a memory-order
+	/// violation. Uops must be undone from youngest to oldest.
 	void UndoUop(Uop *uop);
 
 	/// Update the state of the register file when an uop commits
@@ -0,0 +1,426 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <lib/cpp/Misc.h>
+#include <lib/esim/Engine.h>
+
+#include "BranchPredictor.h"
+#include "Core.h"
+#include "Cpu.h"
+#include "Sampler.h"
+#include "Thread.h"
+
+
+namespace x86
+{
+
+long long Sampler::period;
+long long Sampler::warmup_length;
+long long Sampler::window_length;
+bool Sampler::functional_warming;
+double Sampler::confidence;
+std::vector<Sampler::SimPoint> Sampler::simpoints;
+
+std::string Sampler::simpoints_file;
+std::string Sampler::weights_file;
+
+
+void Sampler::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "Sampling";
+
+	// Read variables
+	period = ini_file->ReadInt64(section, "Period", 0);
+	warmup_length = ini_file->ReadInt64(section, "Warmup", 2000);
+	window_length = ini_file->ReadInt64(section, "Window", 1000);
+	functional_warming = ini_file->ReadBool(section, "FunctionalWarming",
+			true);
+	confidence = ini_file->ReadDouble(section, "Confidence", 0.997);
+
+	// Simulation points
+	simpoints.clear();
+	if (simpoints_file.empty() != weights_file.empty())
+		throw Error("Options '--x86-simpoints' and "
+				"'--x86-simpoint-weights' must be used together");
+	if (!simpoints_file.empty())
+	{
+		std::ifstream simpoints_stream(simpoints_file);
+		std::ifstream weights_stream(weights_file);
+		if (!simpoints_stream || !weights_stream)
+			throw Error(misc::fmt("%s, %s: Cannot open simulation "
+					"point files", simpoints_file.c_str(),
+					weights_file.c_str()));
+		ReadSimPoints(simpoints_stream, weights_stream);
+		if (period)
+			throw Error(misc::fmt("%s: 'Period' must be 0 when "
+					"simulation points are given",
+					section.c_str()));
+		if (warmup_length < 0)
+			throw Error(misc::fmt("%s: Invalid value for 'Warmup'",
+					section.c_str()));
+	}
+
+	// Integrity checks
+	if (!period)
+		return;
+	if (period < 0 || warmup_length < 0 || window_length < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'Period', "
+				"'Warmup', or 'Window'", section.c_str()));
+	if (period < warmup_length + window_length)
+		throw Error(misc::fmt("%s: 'Period' must be at least the sum of "
+				"'Warmup' and 'Window'", section.c_str()));
+	if (confidence <= 0.0 || confidence >= 1.0)
+		throw Error(misc::fmt("%s: 'Confidence' must be between 0 "
+				"and 1", section.c_str()));
+}
+
+
+void Sampler::ReadSimPoints(std::istream &simpoints_stream,
+		std::istream &weights_stream)
+{
+	// Weights, indexed by cluster
+	std::unordered_map<int, double> weights;
+	std::string line;
+	while (std::getline(weights_stream, line))
+	{
+		std::istringstream line_stream(line);
+		double weight;
+		int cluster;
+		if (!(line_stream >> weight))
+			continue;
+		if (!(line_stream >> cluster) || weight < 0.0)
+			throw Error(misc::fmt("Invalid simulation point weight: "
+					"'%s'", line.c_str()));
+		weights[cluster] = weight;
+	}
+
+	// Simulation points
+	simpoints.clear();
+	while (std::getline(simpoints_stream, line))
+	{
+		std::istringstream line_stream(line);
+		long long interval;
+		int cluster;
+		if (!(line_stream >> interval))
+			continue;
+		if (!(line_stream >> cluster) || interval < 0)
+			throw Error(misc::fmt("Invalid simulation point: '%s'",
+					line.c_str()));
+		auto it = weights.find(cluster);
+		if (it == weights.end())
+			throw Error(misc::fmt("No weight for cluster %d of "
+					"simulation point %lld", cluster,
+					interval));
+		simpoints.push_back({ interval, it->second });
+	}
+
+	// Simulate in order of execution
+	std::sort(simpoints.begin(), simpoints.end(),
+			[](const SimPoint &a, const SimPoint &b)
+			{
+				return a.interval < b.interval;
+			});
+}
+
+
+long long Sampler::getMeasuredLength()
+{
+	return simpoints.size() ? Emulator::getBbvInterval() : window_length;
+}
+
+
+double Sampler::getZScore(double confidence)
+{
+	// Bisection over the cumulative distribution function of the standard
+	// normal distribution, so that P(-z < X < z) = confidence
+	double low = 0.0;
+	double high = 10.0;
+	for (int i = 0; i < 60; i++)
+	{
+		double z = (low + high) / 2.0;
+		if (std::erf(z / std::sqrt(2.0)) < confidence)
+			low = z;
+		else
+			high = z;
+	}
+	return (low + high) / 2.0;
+}
+
+
+void Sampler::WarmBranchPredictor(Context *context, unsigned eip)
+{
+	// Train the predictor with every control micro-instruction, without
+	// creating uops or updating statistics
+	Thread *thread = context->thread;
+	BranchPredictor *branch_predictor = thread->getBranchPredictor();
+	unsigned mop_size = context->getInstruction()->getSize();
+	while (context->getNumUinsts())
+	{
+		std::shared_ptr<Uinst> uinst = context->ExtractUinst();
+		if (!(uinst->getFlags() & Uinst::FlagCtrl))
+			continue;
+
+		// Look up and update
+		BranchPredictor::Branch branch;
+		branch.uinst = uinst.get();
+		branch.eip = eip;
+		branch.mop_size = mop_size;
+		branch.neip = context->getRegs().getEip();
+		branch.predicted_neip = eip + mop_size;
+		branch_predictor->Warm(branch);
+	}
+}
+
+
+void Sampler::FastForward(long long num_instructions)
+{
+	// Do not run past the maximum number of instructions
+	if (Emulator::getMaxInstructions())
+		num_instructions = std::min(num_instructions,
+				Emulator::getMaxInstructions()
+				- Cpu::getNumFastForwardInstructions()
+				- cpu->getNumCommittedInstructions()
+				- num_functional_instructions);
+
+	// Run one instruction of every running context at a time. Finished
+	// contexts are not freed here, since they can still be allocated to
+	// hardware threads. The thread scheduler frees them later.
+	Emulator *emulator = Emulator::getInstance();
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	long long count = 0;
+	while (count < num_instructions && emulator->getNumRunningContexts()
+			&& !esim_engine->hasFinished())
+	{
+		for (auto it = emulator->getContextsBegin(),
+				e = emulator->getContextsEnd();
+				it != e;
+				++it)
+		{
+			Context *context = it->get();
+			if (!context->getState(Context::StateRunning))
+				continue;
+
+			// Execute instruction
+			unsigned eip = context->getRegs().getEip();
+			context->Execute();
+			count++;
+
+			// Functional warming
+			if (functional_warming && context->thread)
+				WarmBranchPredictor(context, eip);
+		}
+
+		// Wake up suspended contexts
+		emulator->ProcessEvents();
+	}
+	num_functional_instructions += count;
+
+	// Resume fetch where each allocated context stopped
+	for (int i = 0; i < Cpu::getNumCores(); i++)
+	{
+		Core *core = cpu->getCore(i);
+		for (int j = 0; j < Cpu::getNumThreads(); j++)
+		{
+			Thread *thread = core->getThread(j);
+			if (thread->context)
+				thread->setFetchNeip(thread->context->getRegs().getEip());
+		}
+	}
+}
+
+
+long long Sampler::getNumInstructions() const
+{
+	return Cpu::getNumFastForwardInstructions() +
+			cpu->getNumCommittedInstructions() +
+			num_functional_instructions;
+}
+
+
+void Sampler::Run()
+{
+	long long num_instructions = cpu->getNumCommittedInstructions();
+	long long cycle = cpu->getCycle();
+	switch (phase)
+	{
+
+	case PhaseDrain:
+
+		// Stop fetching until all instructions have left the pipeline
+		cpu->setDraining(true);
+		if (!cpu->isDrained())
+			return;
+		cpu->setDraining(false);
+
+		// Fast-forward to the next warm-up. With simulation points,
+		// the warm-up precedes the next point, and the simulation
+		// finishes after the last one.
+		if (simpoints.empty())
+		{
+			FastForward(period - warmup_length - window_length);
+		}
+		else if (next_simpoint < simpoints.size())
+		{
+			long long start = simpoints[next_simpoint].interval *
+					Emulator::getBbvInterval();
+			FastForward(std::max(0ll, start - warmup_length -
+					getNumInstructions()));
+		}
+		else
+		{
+			esim::Engine::getInstance()->Finish("x86SimPoints");
+			return;
+		}
+		phase = PhaseWarmup;
+		phase_instructions = cpu->getNumCommittedInstructions();
+		phase_cycle = cycle;
+		break;
+
+	case PhaseWarmup:
+
+		// Start measurement. Simulation points are measured from the
+		// first instruction of their interval.
+		if (simpoints.size() && getNumInstructions() <
+				simpoints[next_simpoint].interval *
+				Emulator::getBbvInterval())
+			return;
+		if (simpoints.empty() && num_instructions - phase_instructions
+				< warmup_length)
+			return;
+		phase = PhaseMeasure;
+		phase_instructions = num_instructions;
+		phase_cycle = cycle;
+		break;
+
+	case PhaseMeasure:
+
+		// Record the window
+		if (num_instructions - phase_instructions < getMeasuredLength())
+			return;
+		if (simpoints.size())
+		{
+			AddUnit(num_instructions - phase_instructions,
+					cycle - phase_cycle,
+					simpoints[next_simpoint].weight);
+			next_simpoint++;
+			phase = PhaseDrain;
+			break;
+		}
+		AddUnit(num_instructions - phase_instructions,
+				cycle - phase_cycle);
+
+		// Without fast-forward, the next warm-up starts right away
+		phase = period > warmup_length + window_length ?
+				PhaseDrain : PhaseWarmup;
+		phase_instructions = num_instructions;
+		phase_cycle = cycle;
+		break;
+	}
+}
+
+
+void Sampler::AddUnit(long long num_instructions, long long num_cycles,
+		double weight)
+{
+	assert(num_instructions > 0);
+	double cpi = (double) num_cycles / num_instructions;
+	num_units++;
+	weight_sum += weight;
+	cpi_sum += weight * cpi;
+	cpi_square_sum += weight * cpi * cpi;
+	num_measured_instructions += num_instructions;
+	num_measured_cycles += num_cycles;
+}
+
+
+double Sampler::getCpiStdDev() const
+{
+	if (num_units < 2 || weight_sum <= 0.0)
+		return 0.0;
+	double mean = getMeanCpi();
+	double variance = (cpi_square_sum / weight_sum - mean * mean) *
+			num_units / (num_units - 1);
+	return variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
+
+
+double Sampler::getCpiError() const
+{
+	if (!num_units)
+		return 0.0;
+	return getZScore(confidence) * getCpiStdDev() / std::sqrt(num_units);
+}
+
+
+void Sampler::DumpSummary(std::ostream &os) const
+{
+	// Estimated IPC, and the bounds of its confidence interval
+	double cpi = getMeanCpi();
+	double error = getCpiError();
+	os << misc::fmt("SampledUnits = %d\n", num_units);
+	os << misc::fmt("SampledIPC = %.4g\n", cpi > 0.0 ? 1.0 / cpi : 0.0);
+	os << misc::fmt("SampledIPCInterval = %.4g %.4g\n",
+			cpi + error > 0.0 ? 1.0 / (cpi + error) : 0.0,
+			cpi - error > 0.0 ? 1.0 / (cpi - error) : 0.0);
+}
+
+
+void Sampler::DumpReport(std::ostream &os) const
+{
+	// Estimates for the whole execution
+	long long num_instructions = cpu->getNumCommittedInstructions() +
+			num_functional_instructions;
+	double cpi = getMeanCpi();
+	double error = getCpiError();
+
+	os << "; Sampled simulation\n";
+	os << ";    Units - Number of measurement windows\n";
+	os << ";    CPI - Mean CPI of all windows and its standard deviation\n";
+	os << ";    CPIError - Half width of the confidence interval of the CPI\n";
+	os << ";    EstimatedCycles - Cycles estimated for all instructions, with\n";
+	os << ";        periodic sampling only\n";
+	os << "[ Sampling ]\n";
+	os << misc::fmt("Units = %d\n", num_units);
+	if (simpoints.size())
+		os << misc::fmt("SimPoints = %d\n", (int) simpoints.size());
+	os << misc::fmt("MeasuredInstructions = %lld\n", num_measured_instructions);
+	os << misc::fmt("MeasuredCycles = %lld\n", num_measured_cycles);
+	os << misc::fmt("FunctionalInstructions = %lld\n", num_functional_instructions);
+	os << misc::fmt("CPI = %.4g\n", cpi);
+	os << misc::fmt("CPIStdDev = %.4g\n", getCpiStdDev());
+	os << misc::fmt("CPIError = %.4g\n", error);
+	os << misc::fmt("CPIRelativeError = %.4g\n", cpi > 0.0 ? error / cpi : 0.0);
+	os << misc::fmt("Confidence = %.4g\n", confidence);
+	os << misc::fmt("IPC = %.4g\n", cpi > 0.0 ? 1.0 / cpi : 0.0);
+	if (simpoints.empty())
+		os << misc::fmt("EstimatedCycles = %.0f\n",
+				cpi * num_instructions);
+	os << '\n';
+}
+
+}  // namespace x86
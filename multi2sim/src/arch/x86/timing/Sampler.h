@@ -0,0 +1,255 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_SAMPLER_H
+#define ARCH_X86_TIMING_SAMPLER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+
+
+namespace x86
+{
+
+// Forward declarations
+class Context;
+class Cpu;
+
+/// Sampling of the detailed simulation. Execution is divided in periods of a
+/// fixed number of instructions. Each period starts with a functional
+/// fast-forward, followed by a detailed warm-up of the microarchitectural
+/// state and a measured detailed window. The CPI measured in all windows is
+/// used to estimate the CPI of the whole program, together with a confidence
+/// interval.
+///
+/// Alternatively, the measured windows are the simulation points selected
+/// by SimPoint from a basic block vector profile. Each simulation point is
+/// one profiling interval, and its CPI is weighted with the weight of its
+/// cluster. The simulation finishes after the last simulation point.
+class Sampler
+{
+public:
+
+	/// Simulation point
+	struct SimPoint
+	{
+		/// Index of the profiling interval
+		long long interval;
+
+		/// Weight of the cluster that the interval represents
+		double weight;
+	};
+
+	/// Phases of a sampling period
+	enum Phase
+	{
+		PhaseDrain = 0,
+		PhaseFunctional,
+		PhaseWarmup,
+		PhaseMeasure
+	};
+
+private:
+
+	//
+	// Static fields
+	//
+
+	// Instructions in each sampling period, or 0 if sampling is disabled
+	static long long period;
+
+	// Instructions executed in detail before each measurement
+	static long long warmup_length;
+
+	// Instructions measured in each sampling period
+	static long long window_length;
+
+	// Whether branch predictors are trained during fast-forward
+	static bool functional_warming;
+
+	// Confidence level of the reported interval
+	static double confidence;
+
+	// Simulation points, sorted by interval
+	static std::vector<SimPoint> simpoints;
+
+
+
+
+	//
+	// Class members
+	//
+
+	// CPU being sampled
+	Cpu *cpu;
+
+	// Current phase
+	Phase phase = PhaseDrain;
+
+	// Committed instructions and cycle when the current phase started
+	long long phase_instructions = 0;
+	long long phase_cycle = 0;
+
+	// Instructions executed functionally by the sampler
+	long long num_functional_instructions = 0;
+
+	// Number of measurement windows completed
+	int num_units = 0;
+
+	// Next simulation point to measure
+	unsigned next_simpoint = 0;
+
+	// Sum of the weights of all windows, of their weighted CPI, and of
+	// their weighted squared CPI
+	double weight_sum = 0.0;
+	double cpi_sum = 0.0;
+	double cpi_square_sum = 0.0;
+
+	// Committed instructions and cycles in all windows
+	long long num_measured_instructions = 0;
+	long long num_measured_cycles = 0;
+
+	// Execute the given number of instructions functionally
+	void FastForward(long long num_instructions);
+
+	// Return the number of instructions executed so far, both in detail
+	// and functionally
+	long long getNumInstructions() const;
+
+	// Return the number of instructions measured in each window
+	static long long getMeasuredLength();
+
+	// Train the branch predictor of the thread that the context is mapped
+	// to with the instruction that the context just executed
+	static void WarmBranchPredictor(Context *context, unsigned eip);
+
+public:
+
+	/// Exception for the sampler
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("X86 sampler");
+		}
+	};
+
+	/// File with the simulation points selected by SimPoint, as given in
+	/// option `--x86-simpoints`
+	static std::string simpoints_file;
+
+	/// File with the weights of the simulation points, as given in
+	/// option `--x86-simpoint-weights`
+	static std::string weights_file;
+
+	/// Read the configuration from section `[ Sampling ]` of the CPU
+	/// configuration file, and the simulation points if given
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Read simulation points and their weights in SimPoint format. Each
+	/// line of \a simpoints contains an interval index and a cluster
+	/// identifier, and each line of \a weights contains a weight and a
+	/// cluster identifier.
+	///
+	/// \throw
+	///	A Sampler::Error is thrown if the files are malformed.
+	static void ReadSimPoints(std::istream &simpoints,
+			std::istream &weights);
+
+	/// Clear the list of simulation points
+	static void ClearSimPoints() { simpoints.clear(); }
+
+	/// Return the simulation points, sorted by interval
+	static const std::vector<SimPoint> &getSimPoints() { return simpoints; }
+
+	/// Return whether sampled simulation is enabled
+	static bool isEnabled() { return period > 0 || simpoints.size(); }
+
+	/// Return the number of instructions in each sampling period
+	static long long getPeriod() { return period; }
+
+	/// Return the number of detailed warm-up instructions
+	static long long getWarmupLength() { return warmup_length; }
+
+	/// Return the number of measured instructions in each period
+	static long long getWindowLength() { return window_length; }
+
+	/// Return whether branch predictors are warmed during fast-forward
+	static bool getFunctionalWarming() { return functional_warming; }
+
+	/// Return the confidence level of the reported interval
+	static double getConfidence() { return confidence; }
+
+	/// Return the quantile of the standard normal distribution for a
+	/// two-sided confidence interval with the given level
+	static double getZScore(double confidence);
+
+	/// Constructor
+	Sampler(Cpu *cpu) : cpu(cpu)
+	{
+	}
+
+	/// Advance the sampling state machine. This function is called once
+	/// per cycle before the pipeline stages run.
+	void Run();
+
+	/// Return the current phase
+	Phase getPhase() const { return phase; }
+
+	/// Return the number of instructions executed functionally
+	long long getNumFunctionalInstructions() const
+	{
+		return num_functional_instructions;
+	}
+
+	/// Return the number of measurement windows completed
+	int getNumUnits() const { return num_units; }
+
+	/// Record a completed measurement window with the given weight
+	void AddUnit(long long num_instructions, long long num_cycles,
+			double weight = 1.0);
+
+	/// Return the weighted mean CPI over all windows
+	double getMeanCpi() const
+	{
+		return weight_sum > 0.0 ? cpi_sum / weight_sum : 0.0;
+	}
+
+	/// Return the sample standard deviation of the CPI of all windows
+	double getCpiStdDev() const;
+
+	/// Return the half width of the confidence interval of the mean CPI
+	double getCpiError() const;
+
+	/// Dump the sampling results as part of the statistics summary
+	void DumpSummary(std::ostream &os = std::cout) const;
+
+	/// Dump the sampling results into the pipeline report
+	void DumpReport(std::ostream &os = std::cout) const;
+};
+
+}  // namespace x86
+
+#endif
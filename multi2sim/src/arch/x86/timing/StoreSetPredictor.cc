@@ -0,0 +1,123 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/Misc.h>
+
+#include "StoreSetPredictor.h"
+
+
+namespace x86
+{
+
+bool StoreSetPredictor::present;
+int StoreSetPredictor::ssit_size;
+int StoreSetPredictor::lfst_size;
+
+
+void StoreSetPredictor::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "StoreSetPredictor";
+
+	// Read variables
+	present = ini_file->ReadBool(section, "Present", false);
+	ssit_size = ini_file->ReadInt(section, "SSIT.Size", 1024);
+	lfst_size = ini_file->ReadInt(section, "LFST.Size", 128);
+
+	// Integrity checks
+	if ((ssit_size & (ssit_size - 1)) || ssit_size < 1)
+		throw Error(misc::fmt("%s: 'SSIT.Size' must be a power of 2 "
+				"greater than 0", section.c_str()));
+	if (lfst_size < 1)
+		throw Error(misc::fmt("%s: 'LFST.Size' must be greater "
+				"than 0", section.c_str()));
+}
+
+
+StoreSetPredictor::StoreSetPredictor(const std::string &name) :
+		name(name)
+{
+	// Initialize tables
+	ssit = misc::new_unique_array<int>(ssit_size);
+	lfst = misc::new_unique_array<long long>(lfst_size);
+	for (int i = 0; i < ssit_size; i++)
+		ssit[i] = -1;
+}
+
+
+long long StoreSetPredictor::LookupLoad(unsigned eip) const
+{
+	int store_set = getSsitEntry(eip);
+	return store_set < 0 ? 0 : lfst[store_set];
+}
+
+
+void StoreSetPredictor::DispatchStore(unsigned eip, long long id)
+{
+	int store_set = getSsitEntry(eip);
+	if (store_set >= 0)
+		lfst[store_set] = id;
+}
+
+
+void StoreSetPredictor::ResolveStore(unsigned eip, long long id)
+{
+	// Only clear the entry if no younger store of the same set was
+	// dispatched in the meantime
+	int store_set = getSsitEntry(eip);
+	if (store_set >= 0 && lfst[store_set] == id)
+		lfst[store_set] = 0;
+}
+
+
+void StoreSetPredictor::Update(unsigned load_eip, unsigned store_eip)
+{
+	int &load_set = getSsitEntry(load_eip);
+	int &store_set = getSsitEntry(store_eip);
+
+	// Neither instruction has a store set, allocate a new one
+	if (load_set < 0 && store_set < 0)
+	{
+		load_set = next_store_set;
+		store_set = next_store_set;
+		lfst[next_store_set] = 0;
+		next_store_set = (next_store_set + 1) % lfst_size;
+		return;
+	}
+
+	// Only one of them has a store set, share it with the other
+	if (load_set < 0)
+	{
+		load_set = store_set;
+		return;
+	}
+	if (store_set < 0)
+	{
+		store_set = load_set;
+		return;
+	}
+
+	// Both have a store set, merge them into the smaller one
+	if (load_set < store_set)
+		store_set = load_set;
+	else
+		load_set = store_set;
+}
+
+}  // namespace x86
@@ -0,0 +1,151 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_STORE_SET_PREDICTOR_H
+#define ARCH_X86_TIMING_STORE_SET_PREDICTOR_H
+
+#include <memory>
+#include <string>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+
+
+namespace x86
+{
+
+/// Memory dependence predictor based on store sets. Loads and stores that
+/// caused memory-order violations in the past are assigned the same store
+/// set through the store set identifier table (SSIT), indexed by
+/// instruction address. The last fetched store table (LFST) records, for
+/// each store set, the last store dispatched into the pipeline. A load
+/// belonging to a store set is predicted to depend on that store, and waits
+/// until its address is known before issuing.
+class StoreSetPredictor
+{
+	//
+	// Static fields
+	//
+
+	// Whether the predictor is present
+	static bool present;
+
+	// Number of entries in the store set identifier table
+	static int ssit_size;
+
+	// Number of entries in the last fetched store table, i.e., maximum
+	// number of store sets
+	static int lfst_size;
+
+
+
+
+	//
+	// Class members
+	//
+
+	// Name of the predictor
+	std::string name;
+
+	// Store set identifier table, with one store set index per entry, or
+	// -1 for instructions that are not part of any store set
+	std::unique_ptr<int[]> ssit;
+
+	// Last fetched store table, with the identifier of the last store
+	// uop dispatched in each store set, or 0 if none
+	std::unique_ptr<long long[]> lfst;
+
+	// Next store set to allocate, assigned round-robin
+	int next_store_set = 0;
+
+	// Return the SSIT entry for an instruction address
+	int &getSsitEntry(unsigned eip) const
+	{
+		return ssit[eip & (ssit_size - 1)];
+	}
+
+public:
+
+	/// Exception for the store set predictor
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("X86 store set predictor");
+		}
+	};
+
+	/// Read the predictor configuration from section
+	/// `[ StoreSetPredictor ]` of the CPU configuration file
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Return whether the predictor is present. If it is not, loads never
+	/// wait for older stores with unknown addresses.
+	static bool isPresent() { return present; }
+
+	/// Return the number of entries in the SSIT
+	static int getSsitSize() { return ssit_size; }
+
+	/// Return the number of entries in the LFST
+	static int getLfstSize() { return lfst_size; }
+
+	/// Constructor
+	StoreSetPredictor(const std::string &name = "");
+
+	/// Return the store set that the instruction at the given address
+	/// belongs to, or -1 if none.
+	int getStoreSet(unsigned eip) const { return getSsitEntry(eip); }
+
+	/// Look up the predictor for a load being dispatched.
+	///
+	/// \param eip
+	///	Address of the load instruction
+	///
+	/// \return
+	///	Identifier of the store uop that the load is predicted to depend
+	///	on, or 0 if no dependence is predicted.
+	///
+	long long LookupLoad(unsigned eip) const;
+
+	/// Record a store being dispatched as the last fetched store of its
+	/// store set, if any.
+	///
+	/// \param eip
+	///	Address of the store instruction
+	///
+	/// \param id
+	///	Identifier of the store uop
+	///
+	void DispatchStore(unsigned eip, long long id);
+
+	/// Notify that the address of a store is known, so that loads
+	/// dispatched from now on do not wait for it.
+	void ResolveStore(unsigned eip, long long id);
+
+	/// Train the predictor after a load issued before an older store that
+	/// wrote the same location, placing both instructions in the same
+	/// store set.
+	void Update(unsigned load_eip, unsigned store_eip);
+};
+
+}  // namespace x86
+
+#endif
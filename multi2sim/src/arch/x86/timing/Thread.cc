@@ -33,7 +33,8 @@ const misc::StringMap Thread::fetch_stall_map =
 	{ "Context", FetchStallContext },
 	{ "Suspended", FetchStallSuspended },
 	{ "FetchQueue", FetchStallFetchQueue },
-	{ "InstructionMemory", FetchStallInstructionMemory }
+	{ "InstructionMemory", FetchStallInstructionMemory },
+	{ "Drain", FetchStallDrain }
 };
 
 
@@ -69,13 +70,34 @@ Thread::Thread(Core *core,
 	branch_predictor = misc::new_unique<BranchPredictor>(name +
 			".BranchPredictor");
 
+	// Initialize memory dependence predictor
+	if (StoreSetPredictor::isPresent())
+		store_set_predictor = misc::new_unique<StoreSetPredictor>(
+				name + ".StoreSetPredictor");
+
 	// Initialize trace cache
 	if (TraceCache::isPresent())
 		trace_cache = misc::new_unique<TraceCache>(name +
 				".TraceCache");
 
+	// Initialize uop cache
+	if (UopCache::isPresent())
+		uop_cache = misc::new_unique<UopCache>(name + ".UopCache");
+
 	// Initialize register file
 	register_file = misc::new_unique<RegisterFile>(this);
+
+	// Size queues after the structures they model. The fetch queue size
+	// is given in bytes, which bounds the number of macro-instructions.
+	fetch_queue.Reserve(Cpu::getFetchQueueSize() +
+			(TraceCache::isPresent() ? TraceCache::getQueueSize() : 0));
+	uop_queue.Reserve(Cpu::getUopQueueSize());
+	reorder_buffer.Reserve(Cpu::getReorderBufferSize());
+	instruction_queue.Reserve(Cpu::getInstructionQueueSize());
+	ready_instruction_queue.Reserve(Cpu::getInstructionQueueSize());
+	load_queue.Reserve(Cpu::getLoadStoreQueueSize());
+	ready_load_queue.Reserve(Cpu::getLoadStoreQueueSize());
+	store_queue.Reserve(Cpu::getLoadStoreQueueSize());
 }
 
 
@@ -103,14 +125,14 @@ void Thread::Dump(std::ostream &os) const
 }
 
 
-void Thread::InsertInFetchQueue(std::shared_ptr<Uop> uop)
+void Thread::InsertInFetchQueue(Uop *uop)
 {
 	// Sanity
 	assert(!uop->in_fetch_queue);
 
 	// Insert in queue
 	uop->in_fetch_queue = true;
-	uop->fetch_queue_iterator = fetch_queue.insert(fetch_queue.end(), uop);
+	fetch_queue.PushBack(uop);
 
 	// Increase occupancy of fetch queue or trace queue
 	if (uop->from_trace_cache)
@@ -135,17 +157,15 @@ void Thread::ExtractFromFetchQueue(Uop *uop)
 	// Sanity: uop must be in the fetch queue, and must be either the first
 	// or the last element in it.
 	assert(uop->in_fetch_queue);
-	assert(uop->fetch_queue_iterator != fetch_queue.end());
 	assert(fetch_queue.size() > 0);
-	assert(uop == fetch_queue.front().get() ||
-			uop == fetch_queue.back().get());
-	
-	// Save iterator
-	auto it = uop->fetch_queue_iterator;
+	assert(uop == fetch_queue.front() || uop == fetch_queue.back());
 
-	// Mark uop as extracted
+	// Remove from the queue
 	uop->in_fetch_queue = false;
-	uop->fetch_queue_iterator = fetch_queue.end();
+	if (uop == fetch_queue.front())
+		fetch_queue.PopFront();
+	else
+		fetch_queue.PopBack();
 
 	// Decrease occupancy of fetch queue or trace queue
 	if (uop->from_trace_cache)
@@ -167,8 +187,8 @@ void Thread::ExtractFromFetchQueue(Uop *uop)
 		}
 	}
 
-	// Extract uop as last step, since uop may be freed here
-	fetch_queue.erase(it);
+	// Release uop as last step
+	core->ReleaseUop(uop);
 }
 
 
@@ -180,12 +200,10 @@ void Thread::DumpFetchQueue(std::ostream &os) const
 	os << std::string(title.size(), '-') << "\n\n";
 
 	// Dump content
-	int index = 0;
-	for (auto &uop : fetch_queue)
+	for (int index = 0; index < fetch_queue.size(); index++)
 	{
 		os << misc::fmt("%3d. ", index);
-		os << *uop << '\n';
-		index++;
+		os << *fetch_queue[index] << '\n';
 	}
 
 	// Empty list
@@ -197,11 +215,11 @@ void Thread::DumpFetchQueue(std::ostream &os) const
 }
 
 
-void Thread::InsertInUopQueue(std::shared_ptr<Uop> uop)
+void Thread::InsertInUopQueue(Uop *uop)
 {
 	assert(!uop->in_uop_queue);
 	uop->in_uop_queue = true;
-	uop->uop_queue_iterator = uop_queue.insert(uop_queue.end(), uop);
+	uop_queue.PushBack(uop);
 }
 
 
@@ -211,17 +229,17 @@ void Thread::ExtractFromUopQueue(Uop *uop)
 	// or the last element in it.
 	assert(uop->in_uop_queue);
 	assert(uop_queue.size() > 0);
-	assert(uop == uop_queue.front().get() || uop_queue.back().get());
-
-	// Save iterator
-	auto it = uop->uop_queue_iterator;
+	assert(uop == uop_queue.front() || uop == uop_queue.back());
 
-	// Mark uop as extracted
+	// Remove from the queue
 	uop->in_uop_queue = false;
-	uop->uop_queue_iterator = uop_queue.end();
+	if (uop == uop_queue.front())
+		uop_queue.PopFront();
+	else
+		uop_queue.PopBack();
 
-	// Extract uop as last step, since this may free it
-	uop_queue.erase(it);
+	// Release uop as last step
+	core->ReleaseUop(uop);
 }
 
 
@@ -233,12 +251,10 @@ void Thread::DumpUopQueue(std::ostream &os) const
 	os << std::string(title.size(), '-') << "\n\n";
 
 	// Dump content
-	int index = 0;
-	for (auto &uop : uop_queue)
+	for (int index = 0; index < uop_queue.size(); index++)
 	{
 		os << misc::fmt("%3d. ", index);
-		os << *uop << '\n';
-		index++;
+		os << *uop_queue[index] << '\n';
 	}
 
 	// Empty list
@@ -259,8 +275,10 @@ bool Thread::canInsertInReorderBuffer()
 
 		// Return whether the number of instructions in this thread's
 		// ROB is smaller than the ROB size configured by the user,
-		// which is specified as a per-thread ROB size.
-		return (int) reorder_buffer.size() <
+		// which is specified as a per-thread ROB size. Fused uops
+		// share the entry of the uop they are fused with.
+		return reorder_buffer.size() -
+				num_fused_uops_in_reorder_buffer <
 				Cpu::getReorderBufferSize();
 
 	case Cpu::ReorderBufferKindShared:
@@ -278,17 +296,21 @@ bool Thread::canInsertInReorderBuffer()
 }
 
 
-void Thread::InsertInReorderBuffer(std::shared_ptr<Uop> uop)
+void Thread::InsertInReorderBuffer(Uop *uop)
 {
 	// Sanity
 	assert(!uop->in_reorder_buffer);
 
 	// Insert into reorder buffer
 	uop->in_reorder_buffer = true;
-	uop->reorder_buffer_iterator = reorder_buffer.insert(reorder_buffer.end(), uop);
+	reorder_buffer.PushBack(uop);
 
-	// Increase per-core counter
-	core->incReorderBufferOccupancy();
+	// Increase per-core counter, unless the uop shares the entry of the
+	// uop it is fused with
+	if (uop->isFused())
+		num_fused_uops_in_reorder_buffer++;
+	else
+		core->incReorderBufferOccupancy();
 }
 
 
@@ -298,20 +320,23 @@ void Thread::ExtractFromReorderBuffer(Uop *uop)
 	// first or the last instruction in that queue.
 	assert(uop->in_reorder_buffer);
 	assert(reorder_buffer.size() > 0);
-	assert(uop == reorder_buffer.front().get() || reorder_buffer.back().get());
-
-	// Save iterator
-	auto it = uop->reorder_buffer_iterator;
+	assert(uop == reorder_buffer.front() || uop == reorder_buffer.back());
 
-	// Mark uop as extracted
+	// Remove from the reorder buffer
 	uop->in_reorder_buffer = false;
-	uop->reorder_buffer_iterator = reorder_buffer.end();
-
-	// Extract uop as last step, since this may free it
-	reorder_buffer.erase(it);
+	if (uop == reorder_buffer.front())
+		reorder_buffer.PopFront();
+	else
+		reorder_buffer.PopBack();
 
 	// Decrease per-core counter
-	core->decReorderBufferOccupancy();
+	if (uop->isFused())
+		num_fused_uops_in_reorder_buffer--;
+	else
+		core->decReorderBufferOccupancy();
+
+	// Release uop as last step
+	core->ReleaseUop(uop);
 }
 
 
@@ -326,13 +351,12 @@ void Thread::DumpReorderBuffer(std::ostream &os) const
 	os << std::string(title.size(), '-') << "\n\n";
 
 	// Dump content
-	int index = 0;
-	for (auto &uop : reorder_buffer)
+	for (int index = 0; index < reorder_buffer.size(); index++)
 	{
 		// Instruction
+		Uop *uop = reorder_buffer[index];
 		os << misc::fmt("%3d. ", index);
 		os << *uop << '\n';
-		index++;
 
 		// Dispatched
 		if (uop->dispatched)
@@ -396,7 +420,7 @@ bool Thread::canInsertInInstructionQueue()
 }
 
 
-void Thread::InsertInInstructionQueue(std::shared_ptr<Uop> uop)
+void Thread::InsertInInstructionQueue(Uop *uop)
 {
 	// Sanity
 	assert(!uop->in_instruction_queue);
@@ -405,8 +429,11 @@ void Thread::InsertInInstructionQueue(std::shared_ptr<Uop> uop)
 
 	// Insert into instruction queue
 	uop->in_instruction_queue = true;
-	uop->instruction_queue_iterator = instruction_queue.insert(
-			instruction_queue.end(), uop);
+	instruction_queue.PushBack(uop);
+
+	// Candidate for issue if no source is pending
+	if (!uop->num_pending_inputs)
+		WakeupUop(uop);
 
 	// Increase per-core counter
 	core->incInstructionQueueOccupancy();
@@ -420,18 +447,16 @@ void Thread::ExtractFromInstructionQueue(Uop *uop)
 	assert(!uop->in_store_queue);
 	assert(uop->in_instruction_queue);
 
-	// Save iterator
-	auto it = uop->instruction_queue_iterator;
-
-	// Mark uop as not present
+	// Remove from queue
+	ExtractFromReadyQueue(uop);
 	uop->in_instruction_queue = false;
-	uop->instruction_queue_iterator = instruction_queue.end();
-	
-	// Remove from queue as the last step, as this may free the uop
-	instruction_queue.erase(it);
+	instruction_queue.Erase(FindInQueue(instruction_queue, uop));
 
 	// Decrease per-core counter
 	core->decInstructionQueueOccupancy();
+
+	// Release uop as last step
+	core->ReleaseUop(uop);
 }
 
 
@@ -443,12 +468,10 @@ void Thread::DumpInstructionQueue(std::ostream &os) const
 	os << std::string(title.size(), '-') << "\n\n";
 
 	// Dump content
-	int index = 0;
-	for (auto &uop : instruction_queue)
+	for (int index = 0; index < instruction_queue.size(); index++)
 	{
 		os << misc::fmt("%3d. ", index);
-		os << *uop << '\n';
-		index++;
+		os << *instruction_queue[index] << '\n';
 	}
 
 	// Empty list
@@ -488,7 +511,7 @@ bool Thread::canInsertInLoadStoreQueue()
 }
 
 
-void Thread::InsertInLoadStoreQueue(std::shared_ptr<Uop> uop)
+void Thread::InsertInLoadStoreQueue(Uop *uop)
 {
 	// Sanity
 	assert(!uop->in_load_queue);
@@ -500,14 +523,18 @@ void Thread::InsertInLoadStoreQueue(std::shared_ptr<Uop> uop)
 
 	case Uinst::OpcodeLoad:
 
-		uop->load_queue_iterator = load_queue.insert(load_queue.end(), uop);
+		load_queue.PushBack(uop);
 		uop->in_load_queue = true;
+		if (!uop->num_pending_inputs)
+			WakeupUop(uop);
 		break;
 
 	case Uinst::OpcodeStore:
 
-		uop->store_queue_iterator = store_queue.insert(store_queue.end(), uop);
+		store_queue.PushBack(uop);
 		uop->in_store_queue = true;
+		if (register_file->isStoreAddressReady(uop))
+			ResolveStore(uop);
 		break;
 	
 	default:
@@ -527,18 +554,16 @@ void Thread::ExtractFromLoadQueue(Uop *uop)
 	assert(!uop->in_store_queue);
 	assert(!uop->in_instruction_queue);
 
-	// Save iterator
-	auto it = uop->load_queue_iterator;
-
-	// Mark as not present in the queue
+	// Remove from queue
+	ExtractFromReadyQueue(uop);
 	uop->in_load_queue = false;
-	uop->load_queue_iterator = load_queue.end();
-	
-	// Remove from queue as last step, as this may free uop
-	load_queue.erase(it);
+	load_queue.Erase(FindInQueue(load_queue, uop));
 
 	// Decrease per-core counter
 	core->decLoadStoreQueueOccupancy();
+
+	// Release uop as last step
+	core->ReleaseUop(uop);
 }
 
 
@@ -549,18 +574,179 @@ void Thread::ExtractFromStoreQueue(Uop *uop)
 	assert(!uop->in_load_queue);
 	assert(uop->in_store_queue);
 
-	// Save iterator
-	auto it = uop->store_queue_iterator;
-
-	// Mark as not present in the queue
+	// Remove from queue
 	uop->in_store_queue = false;
-	uop->store_queue_iterator = store_queue.end();
-
-	// Remove from queue as last step, as this may free uop
-	store_queue.erase(it);
+	store_queue.Erase(FindInQueue(store_queue, uop));
 
 	// Decrease per-core counter
 	core->decLoadStoreQueueOccupancy();
+
+	// Release uop as last step
+	core->ReleaseUop(uop);
+}
+
+
+int Thread::FindInQueue(const misc::RingBuffer<Uop *> &queue, Uop *uop)
+{
+	// Queues are sorted by uop identifier, search binary
+	int low = 0;
+	int high = queue.size() - 1;
+	while (low <= high)
+	{
+		int middle = (low + high) / 2;
+		long long id = queue[middle]->getId();
+		if (id == uop->getId())
+			return middle;
+		if (id < uop->getId())
+			low = middle + 1;
+		else
+			high = middle - 1;
+	}
+
+	// Not found
+	throw misc::Panic("Uop not found in queue");
+}
+
+
+void Thread::InsertInReadyQueue(misc::RingBuffer<Uop *> &queue, Uop *uop)
+{
+	// Uops are usually woken up in program order, search from the tail
+	int index = queue.size();
+	while (index > 0 && queue[index - 1]->getId() > uop->getId())
+		index--;
+	queue.Insert(index, uop);
+	uop->in_ready_queue = true;
+}
+
+
+void Thread::ExtractFromReadyQueue(Uop *uop)
+{
+	// Nothing to do if not in a ready queue
+	if (!uop->in_ready_queue)
+		return;
+
+	// Remove it from the queue matching its kind
+	misc::RingBuffer<Uop *> &queue = uop->in_instruction_queue ?
+			ready_instruction_queue :
+			ready_load_queue;
+	queue.Erase(FindInQueue(queue, uop));
+	uop->in_ready_queue = false;
+}
+
+
+void Thread::WakeupUop(Uop *uop)
+{
+	// Sanity
+	assert(!uop->num_pending_inputs);
+	assert(!uop->in_ready_queue);
+
+	// Input operands are available
+	uop->ready = true;
+
+	// Make it a candidate for issue. Stores are issued at commit, and
+	// were already resolved when their address became known.
+	if (uop->in_instruction_queue)
+		InsertInReadyQueue(ready_instruction_queue, uop);
+	else if (uop->in_load_queue)
+		InsertInReadyQueue(ready_load_queue, uop);
+}
+
+
+Thread::LoadDisambiguation Thread::DisambiguateLoad(Uop *load, Uop *&store)
+{
+	// Bytes read by the load
+	unsigned load_begin = load->physical_address;
+	unsigned load_end = load_begin + load->getUinst()->getSize();
+
+	// Traverse older stores from youngest to oldest
+	for (int index = store_queue.size() - 1; index >= 0; index--)
+	{
+		// Skip younger stores
+		Uop *uop = store_queue[index];
+		if (uop->getId() > load->getId())
+			continue;
+
+		// Store address not known yet. Wait only if the store set
+		// predictor detected a dependence with it.
+		if (!uop->address_resolved)
+		{
+			if (uop->getId() == load->wait_store_id)
+				return LoadDisambiguationWait;
+			continue;
+		}
+
+		// Skip stores to other locations
+		unsigned store_begin = uop->physical_address;
+		unsigned store_end = store_begin + uop->getUinst()->getSize();
+		if (store_end <= load_begin || load_end <= store_begin)
+			continue;
+
+		// Forward data if it is ready and the store covers the whole
+		// load. Otherwise, the load must wait for the store.
+		if (!uop->num_pending_inputs && store_begin <= load_begin &&
+				load_end <= store_end)
+		{
+			store = uop;
+			return LoadDisambiguationForward;
+		}
+		return LoadDisambiguationWait;
+	}
+
+	// No dependence with older stores
+	return LoadDisambiguationMemory;
+}
+
+
+void Thread::ResolveStore(Uop *store)
+{
+	// Address is known
+	assert(store->in_store_queue);
+	assert(!store->address_resolved);
+	store->address_resolved = true;
+
+	// Loads do not check older stores if memory dependences are not
+	// modeled
+	if (!Cpu::getStoreForwarding())
+		return;
+
+	// Loads dispatched from now on do not need to wait for this store
+	if (store_set_predictor)
+		store_set_predictor->ResolveStore(store->eip, store->getId());
+
+	// Bytes written by the store
+	unsigned store_begin = store->physical_address;
+	unsigned store_end = store_begin + store->getUinst()->getSize();
+
+	// Look for younger loads in the reorder buffer that already obtained
+	// their data from memory or from a store older than this one.
+	for (int index = FindInQueue(reorder_buffer, store) + 1;
+			index < reorder_buffer.size(); index++)
+	{
+		// Only issued loads
+		Uop *uop = reorder_buffer[index];
+		if (uop->getOpcode() != Uinst::OpcodeLoad || !uop->issued)
+			continue;
+		if (uop->forward_store_id > store->getId())
+			continue;
+
+		// Skip loads from other locations
+		unsigned load_begin = uop->physical_address;
+		unsigned load_end = load_begin + uop->getUinst()->getSize();
+		if (store_end <= load_begin || load_end <= store_begin)
+			continue;
+
+		// Memory-order violation. Train the predictor, if any, so that
+		// future instances of the load wait for the store.
+		num_memory_order_violations++;
+		cpu->incNumMemoryOrderViolations();
+		if (store_set_predictor)
+			store_set_predictor->Update(uop->eip, store->eip);
+
+		// Schedule replay starting at the oldest offending load
+		if (!replay_uop_id || uop->getId() < replay_uop_id)
+			replay_uop_id = uop->getId();
+		break;
+	}
 }
 
 
@@ -572,12 +758,10 @@ void Thread::DumpLoadStoreQueue(std::ostream &os) const
 	os << std::string(title.size(), '-') << "\n\n";
 
 	// Dump content
-	int index = 0;
-	for (auto &uop : load_queue)
+	for (int index = 0; index < load_queue.size(); index++)
 	{
 		os << misc::fmt("%3d. ", index);
-		os << *uop << '\n';
-		index++;
+		os << *load_queue[index] << '\n';
 	}
 
 	// Empty list
@@ -593,12 +777,10 @@ void Thread::DumpLoadStoreQueue(std::ostream &os) const
 	os << std::string(title.size(), '-') << "\n\n";
 
 	// Dump content
-	index = 0;
-	for (auto &uop : store_queue)
+	for (int index = 0; index < store_queue.size(); index++)
 	{
 		os << misc::fmt("%3d. ", index);
-		os << *uop << '\n';
-		index++;
+		os << *store_queue[index] << '\n';
 	}
 
 	// Empty list
@@ -21,16 +21,20 @@
 #define ARCH_X86_TIMING_THREAD_H
 
 #include <deque>
+#include <mutex>
 #include <string>
 
 #include <memory/Module.h>
 #include <arch/x86/emulator/Uinst.h>
 #include <arch/x86/emulator/Context.h>
+#include <lib/cpp/RingBuffer.h>
 
 #include "Uop.h"
 #include "BranchPredictor.h"
 #include "RegisterFile.h"
+#include "StoreSetPredictor.h"
 #include "TraceCache.h"
+#include "UopCache.h"
 
 
 namespace x86
@@ -82,10 +86,10 @@ private:
 	//
 
 	// Fetch queue
-	std::list<std::shared_ptr<Uop>> fetch_queue;
+	misc::RingBuffer<Uop *> fetch_queue;
 
 	// Insert a uop into the tail of the fetch queue
-	void InsertInFetchQueue(std::shared_ptr<Uop> uop);
+	void InsertInFetchQueue(Uop *uop);
 
 	// Extract a uop from the fetch queue. The uop must be located either
 	// at the head or at the tail of the fetch queue.
@@ -102,10 +106,16 @@ private:
 	//
 
 	// Uop queue
-	std::list<std::shared_ptr<Uop>> uop_queue;
+	misc::RingBuffer<Uop *> uop_queue;
 
 	// Insert a uop into the tail of the uop queue
-	void InsertInUopQueue(std::shared_ptr<Uop> uop);
+	void InsertInUopQueue(Uop *uop);
+
+	// Fuse a uop about to be inserted into the uop queue with the uop at
+	// the tail of the queue, if the pair qualifies for macro- or
+	// micro-fusion and fusion is enabled. Return true if the uop was
+	// fused.
+	bool FuseUop(Uop *uop);
 
 	// Extract a uop from the uop queue. The uop must be located either at
 	// the head or at the tail of the uop queue.
@@ -122,10 +132,14 @@ private:
 	//
 
 	// Reorder buffer
-	std::list<std::shared_ptr<Uop>> reorder_buffer;
+	misc::RingBuffer<Uop *> reorder_buffer;
+
+	// Number of fused uops in the reorder buffer, which do not take an
+	// entry of their own
+	int num_fused_uops_in_reorder_buffer = 0;
 
 	// Insert a uop into the tail of the reorder buffer
-	void InsertInReorderBuffer(std::shared_ptr<Uop> uop);
+	void InsertInReorderBuffer(Uop *uop);
 
 	// Determine whether a new uop can be inserted into this thread's
 	// reorder buffer, based on whether it is private or shared among
@@ -147,11 +161,17 @@ private:
 	// Instruction Queue
 	//
 
-	// Instruction queue
-	std::list<std::shared_ptr<Uop>> instruction_queue;
+	// Instruction queue, in program order
+	misc::RingBuffer<Uop *> instruction_queue;
 
 	// Insert a uop into the tail of the instruction queue
-	void InsertInInstructionQueue(std::shared_ptr<Uop> uop);
+	void InsertInInstructionQueue(Uop *uop);
+
+	// Uops of the instruction queue whose input operands are available,
+	// in program order. Uops are added by WakeupUop() when the last of
+	// their source registers is written back, so the issue stage only
+	// looks at uops that can actually be issued.
+	misc::RingBuffer<Uop *> ready_instruction_queue;
 
 	// Remove a uop from the instruction queue. The uop must be currently
 	// present in said queue.
@@ -172,11 +192,15 @@ private:
 	// Load-store queue
 	//
 	
-	// Load queue
-	std::list<std::shared_ptr<Uop>> load_queue;
+	// Load queue, in program order
+	misc::RingBuffer<Uop *> load_queue;
+
+	// Store queue, in program order
+	misc::RingBuffer<Uop *> store_queue;
 
-	// Store queue
-	std::list<std::shared_ptr<Uop>> store_queue;
+	// Loads of the load queue whose input operands are available, in
+	// program order
+	misc::RingBuffer<Uop *> ready_load_queue;
 
 	// Determine whether a new uop can be inserted into this thread's
 	// load-store queue, based on whether the queue was configured as
@@ -186,7 +210,7 @@ private:
 	// Insert a uop into the tail of the load-store queue (it is in fact
 	// inserted either at the tail of the load queue or the store queue,
 	// depending on the uop kind).
-	void InsertInLoadStoreQueue(std::shared_ptr<Uop> uop);
+	void InsertInLoadStoreQueue(Uop *uop);
 
 	// Remove a uop from the load queue. The uop must be currently present
 	// in said queue.
@@ -196,6 +220,46 @@ private:
 	// in said queue.
 	void ExtractFromStoreQueue(Uop *uop);
 
+	// Possible outcomes of the disambiguation of a load against the older
+	// stores in the store queue
+	enum LoadDisambiguation
+	{
+		LoadDisambiguationMemory,	// Load accesses the memory hierarchy
+		LoadDisambiguationForward,	// Data forwarded from older store
+		LoadDisambiguationWait		// Load must wait for older store
+	};
+
+	// Check a ready load against the older stores in the store queue,
+	// starting with the youngest one. Stores with an unknown address are
+	// skipped, unless the store set predictor tells that the load depends
+	// on them. The first store with a known address that overlaps with
+	// the load forwards its data if the data is ready and covers all bytes
+	// read by the load, or makes the load wait otherwise. If data is
+	// forwarded, the store is returned in argument 'store'. Only invoked
+	// if 'StoreForwarding' is enabled in the CPU configuration.
+	LoadDisambiguation DisambiguateLoad(Uop *load, Uop *&store);
+
+	// Identifier of the oldest load that must be replayed due to a
+	// memory-order violation, or 0 if none
+	long long replay_uop_id = 0;
+
+
+
+
+	//
+	// Wakeup
+	//
+
+	// Return the position of a uop in a queue of uops of this thread
+	// sorted in program order. The uop must be present in the queue.
+	static int FindInQueue(const misc::RingBuffer<Uop *> &queue, Uop *uop);
+
+	// Insert a uop in a ready queue, keeping it in program order
+	static void InsertInReadyQueue(misc::RingBuffer<Uop *> &queue, Uop *uop);
+
+	// Remove a uop from the ready queue it is in, if any
+	void ExtractFromReadyQueue(Uop *uop);
+
 	// Dump content of load_store queue
 	void DumpLoadStoreQueue(std::ostream &os = std::cout) const;
 
@@ -209,9 +273,15 @@ private:
 	// Branch predictor
 	std::unique_ptr<BranchPredictor> branch_predictor;
 
+	// Memory dependence predictor
+	std::unique_ptr<StoreSetPredictor> store_set_predictor;
+
 	// Trace cache
 	std::unique_ptr<TraceCache> trace_cache;
 
+	// Decoded uop cache
+	std::unique_ptr<UopCache> uop_cache;
+
 	// Physical register file
 	std::unique_ptr<RegisterFile> register_file;
 
@@ -253,6 +323,13 @@ private:
 	// Cycle in which last micro-instruction committed
 	long long last_commit_cycle = 0;
 
+	// Set by the commit stage when the pipeline of a context signaled
+	// for eviction becomes empty
+	bool evict_drained_context = false;
+
+	// Mutex serializing the report of commit stalls
+	static std::mutex commit_stall_mutex;
+
 
 
 
@@ -294,12 +371,28 @@ private:
 	// Number of squashed micro-instructions
 	long long num_squashed_uinsts = 0;
 
+	// Number of loads that got their data forwarded from an older store
+	long long num_forwarded_loads = 0;
+
+	// Number of loads that issued before an older store to the same
+	// address
+	long long num_memory_order_violations = 0;
+
+	// Number of micro-instructions replayed after memory-order violations
+	long long num_replayed_uinsts = 0;
+
 	// Number of branch micro-instructions
 	long long num_branches = 0;
 
 	// Number of mis-predicted branch micro-instructions
 	long long num_mispredicted_branches = 0;
 
+	// Number of committed branches macro-fused with the preceding uop
+	long long num_macro_fused_uinsts = 0;
+
+	// Number of committed uops micro-fused with the preceding load
+	long long num_micro_fused_uinsts = 0;
+
 
 
 
@@ -352,6 +445,13 @@ public:
 				&& uop_queue.empty()
 				&& reorder_buffer.empty();
 	}
+
+	/// Return true if the pipeline is empty and all committed stores have
+	/// been sent to memory
+	bool isDrained() const
+	{
+		return isPipelineEmpty() && store_queue.empty();
+	}
 	
 	/// Dump a plain-text representation of the object into the given output
 	/// stream, or into the standard output if argument \a os is committed.
@@ -376,6 +476,15 @@ public:
 	/// Return the thread's trace cache
 	TraceCache *getTraceCache() const { return trace_cache.get(); }
 
+	/// Return the thread's uop cache, or nullptr if not present
+	UopCache *getUopCache() const { return uop_cache.get(); }
+
+	/// Return the thread's branch predictor
+	BranchPredictor *getBranchPredictor() const
+	{
+		return branch_predictor.get();
+	}
+
 	/// Return the thread's register file
 	RegisterFile *getRegisterFile() const { return register_file.get(); }
 
@@ -412,7 +521,8 @@ public:
 		FetchStallContext,		// No context mapped to thread
 		FetchStallSuspended,		// Mapped context is suspended
 		FetchStallFetchQueue,		// Fetch queue is full
-		FetchStallInstructionMemory	// Instruction memory is busy
+		FetchStallInstructionMemory,	// Instruction memory is busy
+		FetchStallDrain			// Pipeline being drained
 	};
 
 	/// String map for values of type FetchStall
@@ -435,17 +545,27 @@ public:
 	///	instruction are considered to come from the trace cache (true)
 	///	or from instruction memory (false).
 	///
+	/// \param fetch_from_uop_cache
+	///	Flag indicating whether the uops for the fetched macro-
+	///	instruction are delivered by the uop cache.
+	///
 	/// \return
 	///	If any of the uops is a branch, the function returns that uop.
 	///	Otherwise, it returns the first uop created, or nullptr if no
 	///	uop was created.
 	///
-	Uop *FetchInstruction(bool fetch_from_trace_cache);
+	Uop *FetchInstruction(bool fetch_from_trace_cache,
+			bool fetch_from_uop_cache = false);
 
 	/// Try to fetch instruction from trace cache.
 	/// Return true if there was a hit and fetching succeeded.
 	bool FetchFromTraceCache();
 
+	/// Try to fetch instructions from the uop cache, up to the end of the
+	/// code window or the first predicted-taken branch. Return true if
+	/// there was a hit and fetching succeeded.
+	bool FetchFromUopCache();
+
 	/// Fetch stage function
 	void Fetch();
 
@@ -458,6 +578,16 @@ public:
 	/// Get the uop queue size in number of uops
 	int getUopQueueSize() const { return uop_queue.size(); }
 
+	/// Get the reorder buffer size in number of uops, including fused
+	/// uops sharing the entry of another uop
+	int getReorderBufferSize() const { return reorder_buffer.size(); }
+
+	/// Get the number of fused uops in the reorder buffer
+	int getNumFusedUopsInReorderBuffer() const
+	{
+		return num_fused_uops_in_reorder_buffer;
+	}
+
 
 
 
@@ -528,6 +658,23 @@ public:
 	/// The function returns the remaining quantum.
 	int IssueInstructionQueue(int quantum);
 
+	/// Notify that all input operands of a uop are available. This is
+	/// invoked by the register file when a uop's last pending source
+	/// register is written back, or upon insertion in the instruction or
+	/// load queue for uops that had no pending sources at rename. The uop
+	/// is marked as ready and becomes a candidate for issue.
+	void WakeupUop(Uop *uop);
+
+	/// Notify that the address of a store in the store queue is known,
+	/// which can happen before its data is ready. This is invoked by the
+	/// register file when the last source register forming the address is
+	/// written back, or upon insertion in the store queue if the address
+	/// was already available. If memory dependences are modeled, younger
+	/// loads that already read the same location from an older source
+	/// violated memory ordering, and the oldest of them is scheduled for
+	/// replay.
+	void ResolveStore(Uop *store);
+
 
 
 
@@ -572,6 +719,14 @@ public:
 	/// Recover from mispeculation
 	void Recover();
 
+	/// If a memory-order violation was detected in the current cycle,
+	/// squash the offending load and all younger uops from the back-end
+	/// of the pipeline, undoing their register renaming, and insert
+	/// copies of them at the head of the uop queue so that they are
+	/// dispatched again. Uops were already emulated at fetch, so they are
+	/// not fetched again.
+	void Replay();
+
 
 
 
@@ -602,6 +757,15 @@ public:
 	/// be such a context currently allocated.
 	void EvictContext();
 
+	/// Evict the context if its pipeline was drained by the commit stage
+	/// after an eviction signal.
+	void EvictDrainedContext()
+	{
+		if (evict_drained_context)
+			EvictContext();
+		evict_drained_context = false;
+	}
+
 	/// Scheduling actions for all contexts currently mapped to a thread.
 	void Schedule();
 
@@ -675,12 +839,27 @@ public:
 	/// Return the number of squashed micro-instructions
 	long long getNumSquashedUinsts() const { return num_squashed_uinsts; }
 
+	/// Return the number of loads forwarded from older stores
+	long long getNumForwardedLoads() const { return num_forwarded_loads; }
+
+	/// Return the number of memory-order violations
+	long long getNumMemoryOrderViolations() const { return num_memory_order_violations; }
+
+	/// Return the number of replayed micro-instructions
+	long long getNumReplayedUinsts() const { return num_replayed_uinsts; }
+
 	/// Return the number of committed branches
 	long long getNumBranches() const { return num_branches; }
 
 	/// Return the number of mispredicted branches
 	long long getNumMispredictedBranches() const { return num_mispredicted_branches; }
 
+	/// Return the number of committed macro-fused branches
+	long long getNumMacroFusedUinsts() const { return num_macro_fused_uinsts; }
+
+	/// Return the number of committed micro-fused uops
+	long long getNumMicroFusedUinsts() const { return num_micro_fused_uinsts; }
+
 	/// Return the number of reads in the reorder buffers
 	long long getNumReorderBufferReads() const { return num_reorder_buffer_reads; }
 
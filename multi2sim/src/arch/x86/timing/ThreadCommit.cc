@@ -31,6 +31,8 @@ const char *Thread::commit_stall_error =
 	"occurred in the management of some modeled structure (network, "
 	"cache system, core queues, etc.).\n";
 
+std::mutex Thread::commit_stall_mutex;
+
 
 bool Thread::canCommit()
 {
@@ -43,6 +45,9 @@ bool Thread::canCommit()
 		last_commit_cycle = cycle;
 	if (cycle - last_commit_cycle > 1000000)
 	{
+		// Commit stages of several cores can stall at once
+		std::lock_guard<std::mutex> lock(commit_stall_mutex);
+
 		// Show warning
 		misc::Warning("[x86] %s: simulation ended due to a commit "
 				"stall.\n\t%s",
@@ -63,12 +68,12 @@ bool Thread::canCommit()
 
 	// Get instruction from reorder buffer head
 	assert(reorder_buffer.size());
-	std::shared_ptr<Uop> uop = reorder_buffer.front();
+	Uop *uop = reorder_buffer.front();
 	assert(uop->getThread() == this);
 
 	// Stores must be ready in order to commit
 	if (uop->getOpcode() == Uinst::OpcodeStore)
-		return register_file->isUopReady(uop.get());
+		return register_file->isUopReady(uop);
 	
 	// Instructions other than stores must be completed
 	return uop->completed;
@@ -80,12 +85,15 @@ void Thread::Commit(int quantum)
 	// Sanity: context must be mapped
 	assert(context);
 
-	// Commit stage for thread
-	while (quantum && canCommit())
+	// Commit stage for thread. A uop fused with the last uop committed
+	// commits along with it.
+	bool committed = false;
+	while ((quantum || (committed && !reorder_buffer.empty() &&
+			reorder_buffer.front()->isFused())) && canCommit())
 	{
 		// Get instruction at the head of the reorder buffer
 		assert(reorder_buffer.size());
-		std::shared_ptr<Uop> uop = reorder_buffer.front();
+		Uop *uop = reorder_buffer.front();
 		assert(uop->getThread() == this);
 
 		// Recover from mispeculation if this is the first uop of a
@@ -108,19 +116,19 @@ void Thread::Commit(int quantum)
 	
 		// Free physical registers
 		assert(!uop->speculative_mode);
-		register_file->CommitUop(uop.get());
+		register_file->CommitUop(uop);
 		
 		// Branches update branch predictor and BTB
 		if (uop->getFlags() & Uinst::FlagCtrl)
 		{
-			branch_predictor->Update(uop.get());
-			branch_predictor->UpdateBtb(uop.get());
+			branch_predictor->Update(uop);
+			branch_predictor->UpdateBtb(uop);
 			num_btb_writes++;
 		}
 
 		// Trace cache
 		if (TraceCache::isPresent())
-			trace_cache->RecordUop(uop.get());
+			trace_cache->RecordUop(uop);
 
 		// Save last commit cycle
 		last_commit_cycle = cpu->getCycle();
@@ -153,6 +161,18 @@ void Thread::Commit(int quantum)
 			}
 		}
 
+		// Fused uops
+		if (uop->macro_fused)
+		{
+			num_macro_fused_uinsts++;
+			cpu->incNumMacroFusedUinsts();
+		}
+		if (uop->micro_fused)
+		{
+			num_micro_fused_uinsts++;
+			cpu->incNumMicroFusedUinsts();
+		}
+
 		// Trace
 		if (Timing::trace)
 		{
@@ -169,10 +189,13 @@ void Thread::Commit(int quantum)
 		}
 
 		// Remove uop from reorder buffer
-		ExtractFromReorderBuffer(uop.get());
+		ExtractFromReorderBuffer(uop);
 
-		// Consume quantum
-		quantum--;
+		// Consume quantum, unless the uop commits along with the uop
+		// it is fused with
+		if (!uop->isFused())
+			quantum--;
+		committed = true;
 
 		// Statistics
 		num_reorder_buffer_reads++;
@@ -180,9 +203,10 @@ void Thread::Commit(int quantum)
 	}
 
 	// If context eviction signal is activated and pipeline is empty,
-	// deallocate context.
+	// deallocate context. This is done by the core after the stage, since
+	// the commit stage of all cores can run concurrently.
 	if (context->evict_signal && isPipelineEmpty())
-		EvictContext();
+		evict_drained_context = true;
 }
 
 }
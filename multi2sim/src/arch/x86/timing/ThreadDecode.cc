@@ -25,6 +25,61 @@
 namespace x86
 {
 
+bool Thread::FuseUop(Uop *uop)
+{
+	// The uop is fused with the last uop decoded, if it is still in the
+	// uop queue. Fused uops are not fused again.
+	if (uop_queue.empty())
+		return false;
+	Uop *prev = uop_queue.back();
+	if (prev->isFused())
+		return false;
+
+	// Macro-fusion of a conditional branch with the preceding compare,
+	// test, or arithmetic instruction setting the flags it reads
+	Uinst::Opcode opcode = prev->getOpcode();
+	if (Cpu::getMacroFusion() &&
+			(uop->getFlags() & Uinst::FlagCond) &&
+			uop->mop_count == 1 &&
+			prev->mop_index == prev->mop_count - 1 &&
+			prev->eip + prev->mop_size == uop->eip &&
+			(opcode == Uinst::OpcodeAdd ||
+			opcode == Uinst::OpcodeSub ||
+			opcode == Uinst::OpcodeAnd))
+	{
+		for (int i = 0; i < Uinst::MaxODeps; i++)
+		{
+			if (prev->getUinst()->getODep(i) == Uinst::DepZps)
+			{
+				uop->macro_fused = true;
+				return true;
+			}
+		}
+	}
+
+	// Micro-fusion of a load with the uop of the same macro-instruction
+	// consuming the loaded value
+	if (Cpu::getMicroFusion() &&
+			opcode == Uinst::OpcodeLoad &&
+			uop->mop_id == prev->mop_id &&
+			!(uop->getFlags() & (Uinst::FlagMem | Uinst::FlagCtrl)))
+	{
+		Uinst::Dep dep = prev->getUinst()->getODep(0);
+		for (int i = 0; i < Uinst::MaxIDeps; i++)
+		{
+			if (dep && uop->getUinst()->getIDep(i) == dep)
+			{
+				uop->micro_fused = true;
+				return true;
+			}
+		}
+	}
+
+	// Not fused
+	return false;
+}
+
+
 void Thread::Decode()
 {
 	for (int i = 0; i < Cpu::getDecodeWidth(); i++)
@@ -39,7 +94,7 @@ void Thread::Decode()
 
 		// Get uop at the head of the fetch queue
 		assert(!fetch_queue.empty());
-		std::shared_ptr<Uop> uop = fetch_queue.front();
+		Uop *uop = fetch_queue.front();
 
 		// If instructions come from the trace cache, i.e., are located
 		// in the trace cache queue, copy all of them into the uop queue
@@ -49,9 +104,10 @@ void Thread::Decode()
 			do
 			{
 				// Extract from fetch queue
-				ExtractFromFetchQueue(uop.get());
+				ExtractFromFetchQueue(uop);
 
 				// Add to uop queue
+				FuseUop(uop);
 				InsertInUopQueue(uop);
 
 				// Done if fetch queue empty
@@ -68,18 +124,62 @@ void Thread::Decode()
 			break;
 		}
 
+		// Uops delivered by the uop cache bypass the legacy decoders.
+		// They are copied into the uop queue up to the uop cache
+		// width, in one single decode slot.
+		if (uop->from_uop_cache)
+		{
+			int num_uops = 0;
+			do
+			{
+				// Extract from fetch queue
+				ExtractFromFetchQueue(uop);
+
+				// Add to uop queue. Fused uops are delivered in
+				// the slot of the uop they are fused with.
+				if (!FuseUop(uop))
+					num_uops++;
+				InsertInUopQueue(uop);
+
+				// Done if fetch queue empty
+				if (fetch_queue.empty())
+					break;
+
+				// Next instruction from fetch queue
+				assert(fetch_queue.size());
+				uop = fetch_queue.front();
+
+			} while (uop->from_uop_cache &&
+					num_uops < UopCache::getWidth() &&
+					(int) uop_queue.size() <
+					Cpu::getUopQueueSize());
+
+			// Consume entire decode width
+			break;
+		}
+
 		// Decode one macro-instruction coming from a block in the
 		// instruction cache. If the cache access finished, extract it
 		// from the fetch queue.
 		assert(!uop->mop_index);
 		if (!instruction_module->isInFlightAccess(uop->fetch_access))
 		{
+			// Decoded uops are stored in the uop cache, unless
+			// they were fetched from the wrong path
+			if (uop_cache && !uop->speculative_mode)
+				uop_cache->Insert(uop->eip, uop->mop_count);
+
+			// A branch macro-fused with the preceding instruction
+			// is decoded in the same slot
+			bool macro_fused = false;
 			do
 			{
 				// Extract from fetch queue
-				ExtractFromFetchQueue(uop.get());
+				ExtractFromFetchQueue(uop);
 
 				// Add to uop queue
+				FuseUop(uop);
+				macro_fused |= uop->macro_fused;
 				InsertInUopQueue(uop);
 
 				// Trace
@@ -99,9 +199,12 @@ void Thread::Decode()
 				uop = fetch_queue.front();
 
 			} while (uop->mop_index);
+
+			// Decode slot not consumed
+			if (macro_fused)
+				i--;
 		}
 	}
 }
 
 }
-
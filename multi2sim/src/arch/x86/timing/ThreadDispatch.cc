@@ -34,12 +34,13 @@ Thread::DispatchStall Thread::canDispatch()
 				DispatchStallContext :
 				DispatchStallUopQueue;
 	
-	// Reorder buffer is full
-	if (!canInsertInReorderBuffer())
+	// Reorder buffer is full. Fused uops share the entry of the uop they
+	// are fused with.
+	Uop *uop = uop_queue.front();
+	if (!uop->isFused() && !canInsertInReorderBuffer())
 		return DispatchStallReorderBuffer;
 
 	// Instruction queue is full
-	Uop *uop = uop_queue.front().get();
 	if (!(uop->getFlags() & Uinst::FlagMem) && !canInsertInInstructionQueue())
 		return DispatchStallInstructionQueue;
 
@@ -58,8 +59,11 @@ Thread::DispatchStall Thread::canDispatch()
 
 int Thread::Dispatch(int quantum)
 {
-	// Repeat while there is quantum left
-	while (quantum)
+	// Repeat while there is quantum left, or while the uop at the head of
+	// the uop queue is fused with the last uop dispatched
+	bool dispatched = false;
+	while (quantum || (dispatched && !uop_queue.empty() &&
+			uop_queue.front()->isFused()))
 	{
 		// Check if we can dispatch
 		DispatchStall stall = canDispatch();
@@ -71,13 +75,13 @@ int Thread::Dispatch(int quantum)
 
 		// Get uop at the head of the uop queue
 		assert(uop_queue.size());
-		std::shared_ptr<Uop> uop = uop_queue.front();
+		Uop *uop = uop_queue.front();
 	
 		// Extract uop from uop queue
-		ExtractFromUopQueue(uop.get());
+		ExtractFromUopQueue(uop);
 		
 		// Register renaming
-		register_file->Rename(uop.get());
+		register_file->Rename(uop);
 		
 		// Insert in reorder buffer
 		InsertInReorderBuffer(uop);
@@ -99,15 +103,27 @@ int Thread::Dispatch(int quantum)
 		// Memory instructions into the load-store queue
 		if ((uop->getFlags() & Uinst::FlagMem))
 		{
+			// Loads look up the store set predictor, and stores
+			// become the last fetched store of their store set.
+			if (store_set_predictor && uop->getOpcode() ==
+					Uinst::OpcodeLoad)
+				uop->wait_store_id = store_set_predictor->
+						LookupLoad(uop->eip);
+			else if (store_set_predictor)
+				store_set_predictor->DispatchStore(uop->eip,
+						uop->getId());
+
 			InsertInLoadStoreQueue(uop);
 			core->incNumLoadStoreQueueWrites();
 			num_load_store_queue_writes++;
 		}
 
-		// Increment dispatch slot
-		core->incDispatchStall(uop->speculative_mode ?
-				DispatchStallSpeculative :
-				DispatchStallUsed, 1);
+		// Increment dispatch slot, unless the uop is dispatched in the
+		// slot of the uop it is fused with
+		if (!uop->isFused())
+			core->incDispatchStall(uop->speculative_mode ?
+					DispatchStallSpeculative :
+					DispatchStallUsed, 1);
 
 		// Increment number of dispatched micro-instructions of each
 		// kind
@@ -121,7 +137,9 @@ int Thread::Dispatch(int quantum)
 			trace_cache->incNumDispatchedUinsts();
 		
 		// Another instruction dispatched, update quantum
-		quantum--;
+		if (!uop->isFused())
+			quantum--;
+		dispatched = true;
 
 		// Trace
 		Timing::trace << misc::fmt("x86.inst "
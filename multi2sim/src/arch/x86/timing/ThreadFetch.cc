@@ -21,6 +21,7 @@
 #include "Timing.h"
 #include "Thread.h"
 #include "TraceCache.h"
+#include "UopCache.h"
 
 
 namespace x86
@@ -40,6 +41,10 @@ Thread::FetchStall Thread::canFetch()
 	if (context->evict_signal)
 		return FetchStallContext;
 
+	// Fetch is stopped while the pipelines are drained
+	if (cpu->isDraining())
+		return FetchStallDrain;
+
 	// Fetch queue must have not exceeded the limit of stored bytes to be
 	// able to store new macro-instructions.
 	if (fetch_queue_occupancy >= Cpu::getFetchQueueSize())
@@ -64,7 +69,8 @@ Thread::FetchStall Thread::canFetch()
 }
 
 
-Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
+Uop *Thread::FetchInstruction(bool fetch_from_trace_cache,
+		bool fetch_from_uop_cache)
 {
 	// A context must be mapped
 	assert(context);
@@ -105,7 +111,7 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 		std::shared_ptr<Uinst> uinst = context->ExtractUinst();
 
 		// Create uop
-		auto uop = misc::new_shared<Uop>(this,
+		Uop *uop = core->NewUop(this,
 				context,
 				uinst);
 
@@ -118,9 +124,10 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 		// Other fields
 		uop->eip = fetch_eip;
 		uop->from_trace_cache = fetch_from_trace_cache;
+		uop->from_uop_cache = fetch_from_uop_cache;
 		uop->speculative_mode = speculative_mode;
 		uop->fetch_address = fetch_address;
-		uop->fetch_access = fetch_access;
+		uop->fetch_access = fetch_from_uop_cache ? 0 : fetch_access;
 		uop->neip = context->getRegs().getEip();
 		uop->predicted_neip = fetch_neip;
 		uop->target_neip = context->getTargetEip();
@@ -176,7 +183,7 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 
 		// Select as returned uop
 		if (!ret_uop || (uop->getFlags() & Uinst::FlagCtrl))
-			ret_uop = uop.get();
+			ret_uop = uop;
 
 		// Insert into fetch queue
 		InsertInFetchQueue(uop);
@@ -186,6 +193,8 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 		num_fetched_uinsts++;
 		if (fetch_from_trace_cache)
 			trace_cache->incNumFetchedUinsts();
+		if (fetch_from_uop_cache)
+			uop_cache->incNumFetchedUinsts();
 
 		// Next micro-instruction
 		uinst_index++;
@@ -252,6 +261,68 @@ bool Thread::FetchFromTraceCache()
 }
 
 
+bool Thread::FetchFromUopCache()
+{
+	// Look up the uop cache
+	assert(uop_cache);
+	if (!uop_cache->Lookup(fetch_neip))
+		return false;
+
+	// Fetch instructions in the window while they are found in the uop
+	// cache, up to the number of uops that the uop cache delivers per
+	// cycle.
+	unsigned window_address = UopCache::getWindowAddress(fetch_neip);
+	int num_uops = 0;
+	do
+	{
+		// If instruction caused context to suspend or finish
+		if (!context->getState(Context::StateRunning))
+			break;
+
+		// If fetch queue is full, stop fetching
+		if (fetch_queue_occupancy >= Cpu::getFetchQueueSize())
+			break;
+
+		// Fetch macro-instruction without accessing the instruction
+		// cache
+		Uop *uop = FetchInstruction(false, true);
+
+		// Invalid x86 instruction, no forward progress in loop
+		if (!context->getInstruction()->getSize())
+			break;
+
+		// No uop was produced by this macro-instruction
+		if (!uop)
+			continue;
+		num_uops += uop->mop_count;
+
+		// Branches are predicted as in a regular fetch
+		if (uop->getFlags() & Uinst::FlagCtrl)
+		{
+			unsigned target = branch_predictor->LookupBtb(uop);
+			BranchPredictor::Prediction prediction =
+					branch_predictor->Lookup(uop);
+			if (prediction == BranchPredictor::PredictionTaken
+					&& target)
+			{
+				fetch_neip = target;
+				uop->predicted_neip = target;
+				break;
+			}
+		}
+
+	} while (num_uops < UopCache::getWidth() &&
+			UopCache::getWindowAddress(fetch_neip) ==
+			window_address &&
+			uop_cache->Contains(fetch_neip));
+
+	// Instructions that miss in the uop cache are fetched again from the
+	// instruction cache, starting with a new block access.
+	fetch_block_address = -1;
+	return true;
+}
+
+
 void Thread::Fetch()
 {
 	// Sanity
@@ -260,6 +331,10 @@ void Thread::Fetch()
 	// Try to fetch from trace cache first
 	if (TraceCache::isPresent() && FetchFromTraceCache())
 		return;
+
+	// Try to fetch decoded uops from the uop cache
+	if (uop_cache && FetchFromUopCache())
+		return;
 	
 	// If new block to fetch is not the same as the previously fetched (and
 	// stored) block, access the instruction cache.
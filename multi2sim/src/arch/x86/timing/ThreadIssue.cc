@@ -29,33 +29,53 @@ namespace x86
 
 int Thread::IssueLoadQueue(int quantum)
 {
-	// List iterators
-	auto it = load_queue.begin();
-	auto e = load_queue.end();
-
-	// Traverse list
-	while (it != e && quantum > 0)
+	// Traverse loads with available operands in program order
+	int index = 0;
+	while (index < ready_load_queue.size() && quantum > 0)
 	{
-		// Get the uop and forward iterator
-		std::shared_ptr<Uop> uop = *it;
-		++it;
-
-		// If the uop is not ready, skip it
-		if (!register_file->isUopReady(uop.get()))
+		// Get the uop
+		Uop *uop = ready_load_queue[index];
+		assert(uop->ready);
+
+		// Check older stores in the store queue, if memory dependences
+		// are modeled
+		Uop *store = nullptr;
+		LoadDisambiguation disambiguation = Cpu::getStoreForwarding() ?
+				DisambiguateLoad(uop, store) :
+				LoadDisambiguationMemory;
+		if (disambiguation == LoadDisambiguationWait)
+		{
+			index++;
 			continue;
+		}
 
 		// Check that memory system is accessible
-		if (!data_module->canAccess(uop->physical_address))
+		if (disambiguation == LoadDisambiguationMemory &&
+				!data_module->canAccess(uop->physical_address))
+		{
+			index++;
 			continue;
-
-		// Remove uop from load queue
-		ExtractFromLoadQueue(uop.get());
-
-		// Access memory system
-		cpu->MemoryAccess(data_module,
-				mem::Module::AccessLoad,
-				uop->physical_address,
-				uop);
+		}
+
+		// Remove uop from load queue. The next ready uop takes its
+		// position.
+		ExtractFromLoadQueue(uop);
+
+		// Take data from the store, or access memory system
+		if (disambiguation == LoadDisambiguationForward)
+		{
+			uop->forward_store_id = store->getId();
+			core->InsertInEventQueue(uop, Cpu::getStoreForwardLatency());
+			num_forwarded_loads++;
+			cpu->incNumForwardedLoads();
+		}
+		else
+		{
+			cpu->MemoryAccess(data_module,
+					mem::Module::AccessLoad,
+					uop->physical_address,
+					uop);
+		}
 
 		// Mark uop as issued
 		uop->issued = true;
@@ -104,16 +124,12 @@ int Thread::IssueLoadQueue(int quantum)
 
 int Thread::IssueStoreQueue(int quantum)
 {
-	// List iterators
-	auto it = store_queue.begin();
-	auto e = store_queue.end();
-
-	// Traverse list
-	while (it != e && quantum > 0)
+	// Traverse queue in program order. Stores issue in order, so they are
+	// always taken from the head.
+	while (store_queue.size() && quantum > 0)
 	{
-		// Get the uop and forward iterator
-		std::shared_ptr<Uop> uop = *it;
-		++it;
+		// Get the uop
+		Uop *uop = store_queue.front();
 
 		// Sanity
 		assert(uop->getOpcode() == Uinst::OpcodeStore);
@@ -127,7 +143,7 @@ int Thread::IssueStoreQueue(int quantum)
 			break;
 
 		// Remove store from store queue
-		ExtractFromStoreQueue(uop.get());
+		ExtractFromStoreQueue(uop);
 
 		// Issue store to memory system
 		cpu->MemoryAccess(data_module,
@@ -185,36 +201,32 @@ int Thread::IssueLoadStoreQueue(int quantum)
 
 int Thread::IssueInstructionQueue(int quantum)
 {
-	// List iterators
-	auto it = instruction_queue.begin();
-	auto e = instruction_queue.end();
-
-	// Traverse list
-	while (it != e && quantum > 0)
+	// Traverse uops with available operands in program order
+	int index = 0;
+	while (index < ready_instruction_queue.size() && quantum > 0)
 	{
-		// Get the uop and forward iterator
-		std::shared_ptr<Uop> uop = *it;
-		++it;
+		// Get the uop
+		Uop *uop = ready_instruction_queue[index];
+		assert(uop->ready);
 
 		// Sanity
 		assert(!(uop->getFlags() & Uinst::FlagMem));
 
-		// If the uop is not ready, skip it
-		if (!register_file->isUopReady(uop.get()))
-			continue;
-
 		// Run the instruction in its corresponding functional unit in
 		// the ALU. If the instruction does not require a functional
 		// unit, a latency of 1 is returned by ALU::Reserve(). If there
 		// is no functional unit available, it returns 0.
 		Alu *alu = core->getAlu();
-		int latency = alu->Reserve(uop.get());
+		int latency = alu->Reserve(uop);
 		if (!latency)
+		{
+			index++;
 			continue;
+		}
 
 		// Instruction was successfully issued, remove from instruction
-		// queue.
-		ExtractFromInstructionQueue(uop.get());
+		// queue. The next ready uop takes its position.
+		ExtractFromInstructionQueue(uop);
 
 		// Instruction has been issued
 		uop->issued = true;
@@ -30,7 +30,7 @@ void Thread::RecoverFetchQueue()
 	while (fetch_queue.size())
 	{
 		// Get uop from the tail
-		std::shared_ptr<Uop> uop = fetch_queue.back();
+		Uop *uop = fetch_queue.back();
 		assert(uop->getThread() == this);
 
 		// Stop if this uop is not in speculative mode anymore
@@ -38,7 +38,7 @@ void Thread::RecoverFetchQueue()
 			break;
 
 		// Remove from fetch queue
-		ExtractFromFetchQueue(uop.get());
+		ExtractFromFetchQueue(uop);
 
 		// Trace
 		if (Timing::trace)
@@ -68,7 +68,7 @@ void Thread::RecoverUopQueue()
 	while (uop_queue.size())
 	{
 		// Get uop from the back
-		std::shared_ptr<Uop> uop = uop_queue.back();
+		Uop *uop = uop_queue.back();
 		assert(uop->getThread() == this);
 
 		// Stop if uop is not in speculative mode
@@ -76,7 +76,7 @@ void Thread::RecoverUopQueue()
 			break;
 
 		// Remove it from uop queue
-		ExtractFromUopQueue(uop.get());
+		ExtractFromUopQueue(uop);
 
 		// Trace
 		if (Timing::trace)
@@ -99,17 +99,17 @@ void Thread::RecoverUopQueue()
 void Thread::RecoverInstructionQueue()
 {
 	// Traverse instruction queue
-	auto it = instruction_queue.begin();
-	auto e = instruction_queue.end();
-	while (it != e)
+	int index = 0;
+	while (index < instruction_queue.size())
 	{
 		// Get instruction
-		Uop *uop = it->get();
-		++it;
+		Uop *uop = instruction_queue[index];
 
 		// Remove if it is a speculative uop
 		if (uop->speculative_mode)
 			ExtractFromInstructionQueue(uop);
+		else
+			index++;
 	}
 }
 
@@ -117,17 +117,17 @@ void Thread::RecoverInstructionQueue()
 void Thread::RecoverLoadQueue()
 {
 	// Traverse load queue
-	auto it = load_queue.begin();
-	auto e = load_queue.end();
-	while (it != e)
+	int index = 0;
+	while (index < load_queue.size())
 	{
 		// Get instruction
-		Uop *uop = it->get();
-		++it;
+		Uop *uop = load_queue[index];
 
 		// Remove if it is a speculative uop
 		if (uop->speculative_mode)
 			ExtractFromLoadQueue(uop);
+		else
+			index++;
 	}
 }
 
@@ -135,17 +135,17 @@ void Thread::RecoverLoadQueue()
 void Thread::RecoverStoreQueue()
 {
 	// Traverse store queue
-	auto it = store_queue.begin();
-	auto e = store_queue.end();
-	while (it != e)
+	int index = 0;
+	while (index < store_queue.size())
 	{
 		// Get instruction
-		Uop *uop = it->get();
-		++it;
+		Uop *uop = store_queue[index];
 
 		// Remove if it is a speculative uop
 		if (uop->speculative_mode)
 			ExtractFromStoreQueue(uop);
+		else
+			index++;
 	}
 }
 
@@ -153,17 +153,15 @@ void Thread::RecoverStoreQueue()
 void Thread::RecoverEventQueue()
 {
 	// Traverse event queue
-	auto it = core->getEventQueueBegin();
-	auto e = core->getEventQueueEnd();
-	while (it != e)
+	int index = 0;
+	while (index < core->getEventQueueSize())
 	{
-		// Get instruction
-		Uop *uop = it->get();
-		++it;
-
 		// Remove if it is a speculative uop in the current thread
+		Uop *uop = core->getEventQueueUop(index);
 		if (uop->getThread() == this && uop->speculative_mode)
-			core->ExtractFromEventQueue(uop);
+			core->ExtractFromEventQueue(index);
+		else
+			index++;
 	}
 }
 
@@ -184,7 +182,7 @@ void Thread::Recover()
 	while (reorder_buffer.size())
 	{
 		// Get instruction at the reorder buffer tail
-		std::shared_ptr<Uop> uop = reorder_buffer.back();
+		Uop *uop = reorder_buffer.back();
 		assert(uop->getThread() == this);
 
 		// If we already removed all speculative instructions, done
@@ -198,12 +196,16 @@ void Thread::Recover()
 		if (uop->from_trace_cache)
 			trace_cache->incNumSquashedUinsts();
 
+		// Stop waiting for source operands
+		if (uop->num_pending_inputs)
+			register_file->RemoveConsumer(uop);
+
 		// Finish register renaming if uop didn't complete yet
 		if (!uop->completed)
-			register_file->WriteUop(uop.get());
+			register_file->WriteUop(uop);
 
 		// Undo register renaming
-		register_file->UndoUop(uop.get());
+		register_file->UndoUop(uop);
 
 		// Trace
 		if (Timing::trace)
@@ -221,7 +223,7 @@ void Thread::Recover()
 		}
 
 		// Remove reorder buffer entry
-		ExtractFromReorderBuffer(uop.get());
+		ExtractFromReorderBuffer(uop);
 	}
 
 	// Check state of fetch stage and mapped context, if still any
@@ -236,5 +238,75 @@ void Thread::Recover()
 	}
 }
 
+
+void Thread::Replay()
+{
+	// Nothing to replay
+	if (!replay_uop_id)
+		return;
+	long long id = replay_uop_id;
+	replay_uop_id = 0;
+
+	// The load may have been squashed by a branch misprediction recovery
+	// in the same cycle, together with all younger uops.
+	if (reorder_buffer.empty() || reorder_buffer.back()->getId() < id)
+		return;
+
+	// Remove the load and younger uops from the instruction queue, load
+	// queue, and store queue, which are kept in program order.
+	while (instruction_queue.size() && instruction_queue.back()->getId() >= id)
+		ExtractFromInstructionQueue(instruction_queue.back());
+	while (load_queue.size() && load_queue.back()->getId() >= id)
+		ExtractFromLoadQueue(load_queue.back());
+	while (store_queue.size() && store_queue.back()->getId() >= id)
+		ExtractFromStoreQueue(store_queue.back());
+
+	// Remove them from the event queue
+	int index = 0;
+	while (index < core->getEventQueueSize())
+	{
+		Uop *uop = core->getEventQueueUop(index);
+		if (uop->getThread() == this && uop->getId() >= id)
+			core->ExtractFromEventQueue(index);
+		else
+			index++;
+	}
+
+	// Remove them from the reorder buffer, restoring the state of the
+	// physical register file, and put copies of them back at the head of
+	// the uop queue.
+	while (reorder_buffer.size() && reorder_buffer.back()->getId() >= id)
+	{
+		// Get instruction at the reorder buffer tail
+		Uop *uop = reorder_buffer.back();
+		assert(uop->getThread() == this);
+
+		// Statistics
+		num_replayed_uinsts++;
+		cpu->incNumReplayedUinsts();
+
+		// Stop waiting for source operands
+		if (uop->num_pending_inputs)
+			register_file->RemoveConsumer(uop);
+
+		// Finish register renaming if uop didn't complete yet
+		if (!uop->completed)
+			register_file->WriteUop(uop);
+
+		// Undo register renaming
+		register_file->UndoUop(uop);
+
+		// A memory access still in flight must not write back
+		uop->replayed = true;
+
+		// Insert copy in uop queue
+		Uop *clone = core->CloneUop(uop);
+		clone->in_uop_queue = true;
+		uop_queue.Insert(0, clone);
+
+		// Remove reorder buffer entry
+		ExtractFromReorderBuffer(uop);
+	}
 }
 
+}
@@ -244,8 +244,11 @@ void Thread::Schedule()
 			EvictContextSignal();
 		}
 
-		// Context lost affinity with the thread
-		if (!context->evict_signal && !context->thread_affinity->Test(id_in_cpu))
+		// Context lost affinity with the thread. The context may have
+		// been evicted right away above if the pipeline was empty, as
+		// it is after fast-forwarding in sampled simulation.
+		if (context && !context->evict_signal &&
+				!context->thread_affinity->Test(id_in_cpu))
 		{
 			// Debug
 			Emulator::context_debug << misc::fmt(
@@ -262,7 +265,7 @@ void Thread::Schedule()
 		}
 
 		// Context quantum expired
-		if (!context->evict_signal && cpu->getCycle()
+		if (context && !context->evict_signal && cpu->getCycle()
 				>= context->allocate_cycle
 				+ Cpu::getContextQuantum())
 		{
@@ -327,7 +330,7 @@ void Thread::Schedule()
 
 		// Context quantum has not expired, but another thread
 		// of higher priority may interrupt it.
-		else if (!context->evict_signal && cpu->getCycle()
+		else if (context && !context->evict_signal && cpu->getCycle()
 				< context->allocate_cycle
 				+ Cpu::getContextQuantum())
 		{
@@ -18,6 +18,7 @@
  */
 
 #include <arch/common/Arch.h>
+#include <lib/esim/IntervalStatistics.h>
 #include <memory/System.h>
 
 #include "Alu.h"
@@ -125,6 +126,15 @@ const std::string Timing::help_message =
 		"      Calculate structures occupancy statistics. Since this computation requires\n"
 		"      additional overhead, the option needs to be enabled explicitly. These statistics\n"
 		"      will be attached to the Cpu report.\n"
+		"  MacroFusion = {t|f} (Default = False)\n"
+		"      Fuse a conditional branch at decode with the preceding compare, test, or\n"
+		"      add/sub/and instruction. The fused branch is decoded, dispatched, and\n"
+		"      committed in the slot of the preceding uop, and shares its reorder buffer\n"
+		"      entry.\n"
+		"  MicroFusion = {t|f} (Default = False)\n"
+		"      Fuse a load at decode with the uop of the same instruction that consumes the\n"
+		"      loaded value, with the same effect on pipeline slots and reorder buffer\n"
+		"      entries. Fused uops still issue and execute separately.\n"
 		"\n"
 		"Section '[ Queues ]':\n"
 		"\n"
@@ -144,6 +154,17 @@ const std::string Timing::help_message =
 		"      Load-store queue sharing among threads.\n"
 		"  LsqSize = <num_uops> (Default = 20)\n"
 		"      Load-store queue size in number of uops (if private, per-thread LSQ size).\n"
+		"  StoreForwarding = {t|f} (Default = False)\n"
+		"      If true, ready loads are checked against older stores in the store queue.\n"
+		"      They get their data forwarded from a store with a known address covering\n"
+		"      them, wait for other overlapping stores, issue ahead of stores with\n"
+		"      unknown addresses, and are replayed if they violate memory ordering. If\n"
+		"      false, memory dependences are not modeled, and loads access memory as\n"
+		"      soon as their address is ready.\n"
+		"  StoreForwardLatency = <cycles> (Default = 2)\n"
+		"      Latency of a load that gets its data forwarded from an older store in the\n"
+		"      store queue, instead of accessing the data cache. Only used if\n"
+		"      'StoreForwarding' is true.\n"
 		"  RfKind = {Private|Shared} (Default = Private)\n"
 		"      Register file sharing among threads.\n"
 		"  RfIntSize = <entries> (Default = 80)\n"
@@ -170,6 +191,24 @@ const std::string Timing::help_message =
 		"  QueueSize = <num_uops> (Default = 32)\n"
 		"      Size of the trace queue size in uops.\n"
 		"\n"
+		"Section '[ UopCache ]':\n"
+		"\n"
+		"  Present = {t|f} (Default = False)\n"
+		"      If true, a decoded uop cache is placed in front of the decoders. Instructions\n"
+		"      found in it are fetched without accessing the instruction cache, and their\n"
+		"      uops bypass the legacy decoders.\n"
+		"  Sets = <num_sets> (Default = 32)\n"
+		"      Number of sets in the uop cache.\n"
+		"  Assoc = <num_ways> (Default = 8)\n"
+		"      Associativity of the uop cache. Each way holds the uops of one code window.\n"
+		"  WindowSize = <bytes> (Default = 32)\n"
+		"      Size of the aligned code windows that the uop cache is indexed by.\n"
+		"  MaxUops = <num_uops> (Default = 18)\n"
+		"      Maximum number of uops stored for one window. Windows that decode into more\n"
+		"      uops are not cached.\n"
+		"  Width = <num_uops> (Default = 6)\n"
+		"      Number of uops delivered by the uop cache per cycle.\n"
+		"\n"
 		"Section '[ FunctionalUnits ]':\n"
 		"\n"
 		"  The possible variables in this section follow the format\n"
@@ -213,7 +252,8 @@ const std::string Timing::help_message =
 		"\n"
 		"Section '[ BranchPredictor ]':\n"
 		"\n"
-		"  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined} (Default = TwoLevel)\n"
+		"  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined|TAGE|Perceptron}\n"
+		"      (Default = TwoLevel)\n"
 		"      Branch predictor type.\n"
 		"  BTB.Sets = <num_sets> (Default = 256)\n"
 		"      Number of sets in the BTB.\n"
@@ -231,6 +271,79 @@ const std::string Timing::help_message =
 		"      For the two-level adaptive predictor, level 2 size.\n"
 		"  TwoLevel.HistorySize = <size> (Default = 8)\n"
 		"      For the two-level adaptive predictor, level 2 history size.\n"
+		"  TAGE.NumTables = <num> (Default = 7)\n"
+		"      For the TAGE predictor, number of tagged tables. The bimodal table\n"
+		"      is used as the base predictor.\n"
+		"  TAGE.TableSize = <entries> (Default = 1024)\n"
+		"      Number of entries of each TAGE tagged table.\n"
+		"  TAGE.TagBits = <bits> (Default = 9)\n"
+		"      Number of bits of the partial tags in TAGE tables.\n"
+		"  TAGE.MinHistory = <length> (Default = 5)\n"
+		"  TAGE.MaxHistory = <length> (Default = 130)\n"
+		"      Global history lengths of the first and last TAGE tables. The\n"
+		"      lengths of the tables in between form a geometric series.\n"
+		"  Perceptron.NumTables = <num> (Default = 8)\n"
+		"      For the hashed perceptron predictor, number of weight tables. The\n"
+		"      first table is indexed by the branch address, and the others by\n"
+		"      the address hashed with consecutive segments of global history.\n"
+		"  Perceptron.TableSize = <entries> (Default = 1024)\n"
+		"      Number of weights of each perceptron table.\n"
+		"  Perceptron.HistorySize = <length> (Default = 64)\n"
+		"      Global history length used by the perceptron predictor.\n"
+		"  Loop.Present = {t|f} (Default = False)\n"
+		"      Add a loop predictor, which overrides the main prediction for\n"
+		"      loops with a constant trip count.\n"
+		"  Loop.Size = <entries> (Default = 64)\n"
+		"      Number of entries of the loop predictor.\n"
+		"  ITTAGE.Present = {t|f} (Default = False)\n"
+		"      Add an ITTAGE indirect target predictor, providing the targets of\n"
+		"      indirect jumps and calls that hit in the BTB.\n"
+		"  ITTAGE.NumTables = <num> (Default = 4)\n"
+		"  ITTAGE.TableSize = <entries> (Default = 256)\n"
+		"  ITTAGE.TagBits = <bits> (Default = 9)\n"
+		"  ITTAGE.MinHistory = <length> (Default = 4)\n"
+		"  ITTAGE.MaxHistory = <length> (Default = 64)\n"
+		"      Number of tables, entries per table, tag bits, and history\n"
+		"      lengths of the ITTAGE predictor.\n"
+		"\n"
+		"Section '[ StoreSetPredictor ]':\n"
+		"\n"
+		"  Present = {t|f} (Default = False)\n"
+		"      If true, loads that caused memory-order violations in the past wait for\n"
+		"      the older stores they conflicted with. If false, loads always issue ahead\n"
+		"      of older stores with unknown addresses, and are replayed on a violation.\n"
+		"      Requires variable 'StoreForwarding' in section [ Queues ].\n"
+		"  SSIT.Size = <entries> (Default = 1024)\n"
+		"      Number of entries of the store set identifier table, indexed by the\n"
+		"      instruction address. Must be a power of 2.\n"
+		"  LFST.Size = <entries> (Default = 128)\n"
+		"      Number of entries of the last fetched store table, which is the maximum\n"
+		"      number of store sets.\n"
+		"\n"
+		"Section '[ Sampling ]':\n"
+		"\n"
+		"  Period = <num_inst> (Default = 0)\n"
+		"      Enable sampled simulation with periods of the given number of\n"
+		"      instructions. Each period runs a functional fast-forward, a detailed\n"
+		"      warm-up, and a measured detailed window. The report includes the CPI\n"
+		"      estimated from all windows and its confidence interval. A value of 0\n"
+		"      disables sampling.\n"
+		"  Warmup = <num_inst> (Default = 2000)\n"
+		"      Instructions simulated in detail before each measurement, which warm\n"
+		"      up caches and pipeline structures.\n"
+		"  Window = <num_inst> (Default = 1000)\n"
+		"      Instructions measured in each period.\n"
+		"  FunctionalWarming = {t|f} (Default = True)\n"
+		"      Train the branch predictors with the branches executed during\n"
+		"      fast-forward.\n"
+		"  Confidence = <level> (Default = 0.997)\n"
+		"      Confidence level of the reported interval.\n"
+		"\n"
+		"  When options '--x86-simpoints' and '--x86-simpoint-weights' are given,\n"
+		"  the measured windows are the simulation points instead, with as many\n"
+		"  instructions as given in '--x86-bbv-interval'. Each one is preceded by\n"
+		"  a fast-forward and a warm-up of 'Warmup' instructions, and its CPI is\n"
+		"  weighted with the weight of its cluster. 'Period' must be 0.\n"
 		"\n";
 
 const char *Timing::error_fast_forward =
@@ -252,6 +365,14 @@ Timing::Timing() : comm::Timing("x86")
 	// Create CPU
 	cpu = misc::new_unique<Cpu>(this);
 
+	// Create sampler
+	if (Sampler::isEnabled())
+		sampler = misc::new_unique<Sampler>(cpu.get());
+
+	// Interval statistics
+	if (esim::IntervalStatistics::getInstance()->isActive())
+		RegisterIntervalStatistics();
+
 	// Create the trace header related to CPU
 	trace.Header(misc::fmt("x86.init version=\"%d.%d\" "
 			"num_cores=%d num_threads=%d\n",
@@ -260,6 +381,47 @@ Timing::Timing() : comm::Timing("x86")
 }
 
 
+void Timing::RegisterIntervalStatistics()
+{
+	// Cycles of the CPU
+	esim::IntervalStatistics *interval_statistics =
+			esim::IntervalStatistics::getInstance();
+	auto cycles = [this]() { return (double) getCycle(); };
+
+	// Committed x86 instructions per cycle
+	Cpu *cpu = this->cpu.get();
+	interval_statistics->RegisterRatio("x86.IPC",
+			[cpu]() { return (double) cpu->
+					getNumCommittedInstructions(); },
+			cycles);
+
+	// Committed uops per cycle and branch misprediction rate of each
+	// core
+	for (int i = 0; i < cpu->getNumCores(); i++)
+	{
+		Core *core = cpu->getCore(i);
+		interval_statistics->RegisterRatio(misc::fmt("x86.c%d.UopIPC",
+				i),
+				[core]() { return (double) core->
+						getNumCommittedUinsts(); },
+				cycles);
+		interval_statistics->RegisterRatio(misc::fmt(
+				"x86.c%d.MispredRate", i),
+				[core]() { return (double) core->
+						getNumMispredictedBranches(); },
+				[core]() { return (double) core->
+						getNumBranches(); });
+	}
+
+	// Phase of the sampled simulation
+	Sampler *sampler = this->sampler.get();
+	if (sampler)
+		interval_statistics->RegisterGauge("x86.SamplerPhase",
+				[sampler]() { return (double) sampler->
+						getPhase(); });
+}
+
+
 Timing *Timing::getInstance()
 {
 	// Instance already exists
@@ -286,10 +448,18 @@ bool Timing::Run()
 			< Cpu::getNumFastForwardInstructions())
 		FastForward();
 
-	// Stop if maximum number of CPU instructions exceeded
+	// Sampled simulation
+	if (sampler)
+		sampler->Run();
+
+	// Stop if maximum number of CPU instructions exceeded, including those
+	// executed functionally by the sampler
 	esim::Engine *esim_engine = esim::Engine::getInstance();
+	long long num_instructions = cpu->getNumCommittedInstructions();
+	if (sampler)
+		num_instructions += sampler->getNumFunctionalInstructions();
 	if (Emulator::getMaxInstructions()
-			&& cpu->getNumCommittedInstructions()
+			&& num_instructions
 			>= Emulator::getMaxInstructions()
 			- Cpu::getNumFastForwardInstructions())
 		esim_engine->Finish("X86MaxInstructions");
@@ -325,7 +495,7 @@ void Timing::FastForward()
 	while (emulator->getNumInstructions()
 			< Cpu::getNumFastForwardInstructions()
 			&& !esim_engine->hasFinished())
-		emulator->Run();
+		emulator->Run(Cpu::getNumFastForwardInstructions());
 
 	// Output warning if simulation finished during fast-forward execution
 	if (esim_engine->hasFinished())
@@ -610,6 +780,32 @@ void Timing::RegisterOptions()
 			"to run.  If this maximum is reached, the simulation "
 			"will finish with the X86MaxCycles string.");
 
+	// Option --x86-host-threads <int>
+	command_line->RegisterInt32("--x86-host-threads <num>",
+			Cpu::num_host_threads,
+			"Number of host threads used to advance the cores of the "
+			"CPU in detailed simulation. Results are identical to "
+			"those obtained with one thread (default). Cores run "
+			"sequentially while tracing or register file and trace "
+			"cache debugging are active.");
+
+	// Option --x86-simpoints <file>
+	command_line->RegisterString("--x86-simpoints <file>",
+			Sampler::simpoints_file,
+			"File with the simulation points selected by SimPoint "
+			"from a profile obtained with option '--x86-bbv'. In "
+			"detailed simulation, only the simulation points are "
+			"simulated in detail, after a functional fast-forward, "
+			"and the simulation finishes after the last one. The "
+			"report estimates the CPI of the program from the CPI "
+			"of each point and its weight. Must be used together "
+			"with '--x86-simpoint-weights'.");
+
+	// Option --x86-simpoint-weights <file>
+	command_line->RegisterString("--x86-simpoint-weights <file>",
+			Sampler::weights_file,
+			"File with the weights of the simulation points given "
+			"in option '--x86-simpoints'.");
 }
 
 
@@ -620,6 +816,10 @@ void Timing::ProcessOptions()
 	if (!config_file.empty())
 		ini_file.Load(config_file);
 
+	// Number of host threads passed with option '--x86-host-threads'
+	if (Cpu::num_host_threads < 1)
+		throw Error("Option --x86-host-threads must be at least 1");
+
 	// Instantiate timing simulator if '--x86-sim detailed' is present
 	if (sim_kind == comm::Arch::SimDetailed)
 	{
@@ -671,9 +871,26 @@ void Timing::ParseConfiguration(misc::IniFile *ini_file)
 	// Parse branch predictor configuration by their sections
 	BranchPredictor::ParseConfiguration(ini_file);
 
+	// Parse store set predictor configuration. The predictor only acts on
+	// loads checked against older stores.
+	StoreSetPredictor::ParseConfiguration(ini_file);
+	if (StoreSetPredictor::isPresent() && !Cpu::getStoreForwarding())
+		throw Error(misc::fmt("%s: Section [ StoreSetPredictor ] is "
+				"present, but variable 'StoreForwarding' in "
+				"section [ Queues ] is false. The store set "
+				"predictor needs loads to be checked against "
+				"older stores.\n",
+				ini_file->getPath().c_str()));
+
 	// Parse trace cache configuration by their sections
 	TraceCache::ParseConfiguration(ini_file);
 
+	// Parse uop cache configuration
+	UopCache::ParseConfiguration(ini_file);
+
+	// Parse sampling configuration
+	Sampler::ParseConfiguration(ini_file);
+
 	// Parse ALU configuration by their sections
 	Alu::ParseConfiguration(ini_file);
 
@@ -730,6 +947,54 @@ void Timing::DumpSummary(std::ostream &os) const
 			/ cpu->getNumBranches()
 			: 0.0;
 	os << misc::fmt("BranchPredictionAccuracy = %.4g\n", branch_accuracy);
+
+	// Sampled simulation
+	if (sampler)
+		sampler->DumpSummary(os);
+}
+
+
+void Timing::DumpJsonReport(misc::JsonWriter &json) const
+{
+	// Global statistics
+	json.Member("Frequency", getFrequencyDomain()->getFrequency());
+	json.Member("Cycles", getCycle());
+	json.Member("FastForwardInstructions",
+			Cpu::getNumFastForwardInstructions());
+	json.Member("CommittedInstructions",
+			cpu->getNumCommittedInstructions());
+	json.Member("CommittedInstructionsPerCycle", cpu->getCycle() ?
+			(double) cpu->getNumCommittedInstructions() /
+			cpu->getCycle() : 0.0);
+	json.Member("CommittedMicroInstructions", cpu->getNumCommittedUinsts());
+	json.Member("CommittedMicroInstructionsPerCycle", cpu->getCycle() ?
+			(double) cpu->getNumCommittedUinsts() /
+			cpu->getCycle() : 0.0);
+	json.Member("Branches", cpu->getNumBranches());
+	json.Member("MispredictedBranches", cpu->getNumMispredictedBranches());
+
+	// Cores
+	json.Key("Cores");
+	json.BeginObject();
+	for (int i = 0; i < Cpu::getNumCores(); i++)
+	{
+		Core *core = cpu->getCore(i);
+		json.Key(core->getName());
+		json.BeginObject();
+		json.Member("DispatchedMicroInstructions",
+				core->getNumDispatchedUinsts());
+		json.Member("IssuedMicroInstructions",
+				core->getNumIssuedUinsts());
+		json.Member("CommittedMicroInstructions",
+				core->getNumCommittedUinsts());
+		json.Member("SquashedMicroInstructions",
+				core->getNumSquashedUinsts());
+		json.Member("Branches", core->getNumBranches());
+		json.Member("MispredictedBranches",
+				core->getNumMispredictedBranches());
+		json.EndObject();
+	}
+	json.EndObject();
 }
 
 
@@ -822,7 +1087,7 @@ void Timing::DumpReport() const
 	
 	// Dispatch stage
 	os << "; Dispatch stage\n";
-	DumpUopReport(os, cpu->getNumDispatchedUinstArray(),
+	DumpUopReport(os, cpu->getNumDispatchedUinstArray().data(),
 			"Dispatch", Cpu::getDispatchWidth());
 
 	// Issue stage
@@ -832,7 +1097,7 @@ void Timing::DumpReport() const
 
 	// Commit stage
 	os << "; Commit stage\n";
-	DumpUopReport(os, cpu->getNumCommittedUinstArray(),
+	DumpUopReport(os, cpu->getNumCommittedUinstArray().data(),
 			"Commit", Cpu::getCommitWidth());
 
 	// Committed branches
@@ -850,6 +1115,28 @@ void Timing::DumpReport() const
 			/ cpu->getNumBranches() : 0.0);
 	os << '\n';
 
+	// Memory disambiguation
+	os << "; Memory disambiguation\n";
+	os << ";    Forwarded - Loads that got their data from an older store\n";
+	os << ";    Violations - Loads issued before an older store to the same address\n";
+	os << ";    Replayed - Uops squashed and dispatched again after a violation\n";
+	os << misc::fmt("LSQ.Forwarded = %lld\n", cpu->getNumForwardedLoads());
+	os << misc::fmt("LSQ.Violations = %lld\n", cpu->getNumMemoryOrderViolations());
+	os << misc::fmt("LSQ.Replayed = %lld\n", cpu->getNumReplayedUinsts());
+	os << '\n';
+
+	// Uop fusion
+	os << "; Uop fusion\n";
+	os << ";    MacroFused - Committed branches fused with the preceding flag-producing uop\n";
+	os << ";    MicroFused - Committed uops fused with the load of their operand\n";
+	os << misc::fmt("Commit.MacroFused = %lld\n", cpu->getNumMacroFusedUinsts());
+	os << misc::fmt("Commit.MicroFused = %lld\n", cpu->getNumMicroFusedUinsts());
+	os << '\n';
+
+	// Sampled simulation
+	if (sampler)
+		sampler->DumpReport(os);
+
 	// Report for each core
 	for (int i = 0; i < Cpu::getNumCores(); i++)
 	{
@@ -996,6 +1283,22 @@ void Timing::DumpReport() const
 					/ thread->getNumBranches() : 0.0);
 			os << '\n';
 
+			// Branch predictor components
+			thread->getBranchPredictor()->DumpReport(os);
+
+			// Memory disambiguation
+			os << "; Memory disambiguation\n";
+			os << misc::fmt("LSQ.Forwarded = %lld\n", thread->getNumForwardedLoads());
+			os << misc::fmt("LSQ.Violations = %lld\n", thread->getNumMemoryOrderViolations());
+			os << misc::fmt("LSQ.Replayed = %lld\n", thread->getNumReplayedUinsts());
+			os << '\n';
+
+			// Uop fusion
+			os << "; Uop fusion\n";
+			os << misc::fmt("Commit.MacroFused = %lld\n", thread->getNumMacroFusedUinsts());
+			os << misc::fmt("Commit.MicroFused = %lld\n", thread->getNumMicroFusedUinsts());
+			os << '\n';
+
 			// Occupancy statistics
 			os << "; Structure statistics (reorder buffer, instruction queue,\n";
 			os << "; load-store queue, integer/floating-point/XMM register file,\n";
@@ -1064,6 +1367,10 @@ void Timing::DumpReport() const
 			TraceCache *trace_cache = thread->getTraceCache();
 			if (TraceCache::isPresent() && trace_cache)
 				trace_cache->DumpReport(os);
+
+			// Uop cache statistics
+			if (thread->getUopCache())
+				thread->getUopCache()->DumpReport(os);
 		}
 	}
 }
@@ -1095,6 +1402,8 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("CommitKind = %s\n", cpu->commit_kind_map[cpu->getCommitKind()]);
 	os << misc::fmt("CommitWidth = %d\n", cpu->getCommitWidth());
 	os << misc::fmt("OccupancyStats = %s\n", cpu->getOccupancyStats() ? "True" : "False");
+	os << misc::fmt("MacroFusion = %s\n", cpu->getMacroFusion() ? "True" : "False");
+	os << misc::fmt("MicroFusion = %s\n", cpu->getMicroFusion() ? "True" : "False");
 	os << std::endl;
 
 	// Queues
@@ -1107,6 +1416,8 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("IqSize = %d\n", cpu->getInstructionQueueSize());
 	os << misc::fmt("LsqKind = %s\n", cpu->load_store_queue_kind_map[cpu->getLoadStoreQueueKind()]);
 	os << misc::fmt("LsqSize = %d\n", cpu->getLoadStoreQueueSize());
+	os << misc::fmt("StoreForwarding = %s\n", cpu->getStoreForwarding() ? "True" : "False");
+	os << misc::fmt("StoreForwardLatency = %d\n", cpu->getStoreForwardLatency());
 	os << misc::fmt("RfKind = %s\n", RegisterFile::KindMap[RegisterFile::getKind()]);
 	os << misc::fmt("RfIntSize = %d\n", RegisterFile::getIntegerSize());
 	os << misc::fmt("RfFpSize = %d\n", RegisterFile::getFloatingPointSize());
@@ -1123,6 +1434,16 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("QueueSize = %d\n", TraceCache::getQueueSize());
 	os << misc::fmt("\n");
 
+	// Uop cache
+	os << misc::fmt("[ Config.UopCache ]\n");
+	os << misc::fmt("Present = %s\n", UopCache::isPresent() ? "True" : "False");
+	os << misc::fmt("Sets = %d\n", UopCache::getNumSets());
+	os << misc::fmt("Assoc = %d\n", UopCache::getNumWays());
+	os << misc::fmt("WindowSize = %d\n", UopCache::getWindowSize());
+	os << misc::fmt("MaxUops = %d\n", UopCache::getMaxUops());
+	os << misc::fmt("Width = %d\n", UopCache::getWidth());
+	os << misc::fmt("\n");
+
 	// ALU
 	Alu::DumpConfiguration(os);
 
@@ -1138,6 +1459,54 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("TwoLevel.L2Size = %d\n", BranchPredictor::getTwoLevelL2Size());
 	os << misc::fmt("TwoLevel.L2Height = %d\n", BranchPredictor::getTwoLevelL2Height());
 	os << misc::fmt("TwoLevel.HistorySize = %d\n", BranchPredictor::getTwoLevelHistorySize());
+	if (BranchPredictor::getKind() == BranchPredictor::KindTage)
+	{
+		os << misc::fmt("TAGE.NumTables = %d\n", BranchPredictor::getTageNumTables());
+		os << misc::fmt("TAGE.TableSize = %d\n", BranchPredictor::getTageTableSize());
+		os << misc::fmt("TAGE.TagBits = %d\n", BranchPredictor::getTageTagBits());
+		os << "TAGE.HistoryLengths =";
+		for (int i = 0; i < BranchPredictor::getTageNumTables(); i++)
+			os << ' ' << BranchPredictor::getTageHistoryLength(i);
+		os << '\n';
+	}
+	if (BranchPredictor::getKind() == BranchPredictor::KindPerceptron)
+	{
+		os << misc::fmt("Perceptron.NumTables = %d\n", BranchPredictor::getPerceptronNumTables());
+		os << misc::fmt("Perceptron.TableSize = %d\n", BranchPredictor::getPerceptronTableSize());
+		os << misc::fmt("Perceptron.HistorySize = %d\n", BranchPredictor::getPerceptronHistorySize());
+	}
+	os << misc::fmt("Loop.Present = %s\n", BranchPredictor::isLoopPresent() ? "True" : "False");
+	if (BranchPredictor::isLoopPresent())
+		os << misc::fmt("Loop.Size = %d\n", BranchPredictor::getLoopSize());
+	os << misc::fmt("ITTAGE.Present = %s\n", BranchPredictor::isIttagePresent() ? "True" : "False");
+	if (BranchPredictor::isIttagePresent())
+	{
+		os << misc::fmt("ITTAGE.NumTables = %d\n", BranchPredictor::getIttageNumTables());
+		os << misc::fmt("ITTAGE.TableSize = %d\n", BranchPredictor::getIttageTableSize());
+		os << misc::fmt("ITTAGE.TagBits = %d\n", BranchPredictor::getIttageTagBits());
+		os << misc::fmt("ITTAGE.MinHistory = %d\n", BranchPredictor::getIttageMinHistory());
+		os << misc::fmt("ITTAGE.MaxHistory = %d\n", BranchPredictor::getIttageMaxHistory());
+	}
+	os << misc::fmt("\n");
+
+	// Store set predictor
+	os << misc::fmt("[ Config.StoreSetPredictor ]\n");
+	os << misc::fmt("Present = %s\n", StoreSetPredictor::isPresent() ? "True" : "False");
+	os << misc::fmt("SSIT.Size = %d\n", StoreSetPredictor::getSsitSize());
+	os << misc::fmt("LFST.Size = %d\n", StoreSetPredictor::getLfstSize());
+	os << misc::fmt("\n");
+
+	// Sampling
+	os << misc::fmt("[ Config.Sampling ]\n");
+	os << misc::fmt("Period = %lld\n", Sampler::getPeriod());
+	if (Sampler::isEnabled())
+	{
+		os << misc::fmt("Warmup = %lld\n", Sampler::getWarmupLength());
+		os << misc::fmt("Window = %lld\n", Sampler::getWindowLength());
+		os << misc::fmt("FunctionalWarming = %s\n", Sampler::getFunctionalWarming() ? "True" : "False");
+		os << misc::fmt("Confidence = %.4g\n", Sampler::getConfidence());
+		os << misc::fmt("SimPoints = %d\n", (int) Sampler::getSimPoints().size());
+	}
 	os << misc::fmt("\n");
 
 	// End of configuration
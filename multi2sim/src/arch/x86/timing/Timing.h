@@ -30,7 +30,9 @@
 
 #include "BranchPredictor.h"
 #include "Cpu.h"
+#include "Sampler.h"
 #include "TraceCache.h"
+#include "UopCache.h"
 
 
 namespace x86
@@ -80,9 +82,16 @@ class Timing : public comm::Timing
 	// CPU object
 	std::unique_ptr<Cpu> cpu;
 
+	// Sampler, if sampled simulation is enabled
+	std::unique_ptr<Sampler> sampler;
+
 	// List of entry modules to the memory hierarchy
 	std::vector<mem::Module *> entry_modules;
 
+	// Register the IPC of the CPU and its cores, and the phase of the
+	// sampler, in the interval statistics
+	void RegisterIntervalStatistics();
+
 	// Dump a specific part of a statistics report related with uops.
 	void DumpUopReport(std::ostream &os, const long long *uop_stats,
 			const std::string &prefix, int peak_ipc) const;
@@ -172,6 +181,10 @@ public:
 	/// Dump a report of statistics collected during x86 simulation
 	void DumpReport() const override;
 
+	/// Dump the main statistics of the x86 simulation, globally and for
+	/// each core, into the JSON report.
+	void DumpJsonReport(misc::JsonWriter &json) const override;
+
 	/// Dump the configuration of the CPU
 	void DumpConfiguration(std::ofstream &os) const;
 
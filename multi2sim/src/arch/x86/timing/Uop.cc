@@ -96,6 +96,55 @@ void Uop::CountDependencies()
 }
 
 
+bool Uop::isStoreAddressInput(int index) const
+{
+	// Stores computing an effective address depend on it
+	for (int dep = 0; dep < Uinst::MaxIDeps; dep++)
+		if (uinst->getIDep(dep) == Uinst::DepEa)
+			return uinst->getIDep(index) == Uinst::DepEa;
+
+	// Other stores, such as pushes or string stores, take their address
+	// from the first input
+	return index == 0;
+}
+
+
+void Uop::ResetState()
+{
+	// Queues
+	in_fetch_queue = false;
+	in_uop_queue = false;
+	in_event_queue = false;
+	in_reorder_buffer = false;
+	in_instruction_queue = false;
+	in_load_queue = false;
+	in_store_queue = false;
+	in_trace_list = false;
+	in_memory_access = false;
+	in_release_list = false;
+
+	// Memory dependences
+	memory_access = 0;
+	wait_store_id = 0;
+	forward_store_id = 0;
+	address_resolved = false;
+	replayed = false;
+
+	// State
+	dispatched = false;
+	dispatch_when = 0;
+	ready = false;
+	ready_when = 0;
+	num_pending_inputs = 0;
+	in_ready_queue = false;
+	issued = false;
+	issue_when = 0;
+	completed = false;
+	complete_when = 0;
+	first_alu_cycle = 0;
+}
+
+
 void Uop::Dump(std::ostream &os) const
 {
 	// Fields
@@ -104,6 +153,10 @@ void Uop::Dump(std::ostream &os) const
 	os << misc::fmt("spec = %c, ", speculative_mode ? 't' : 'f');
 	os << misc::fmt("first_spec = %c, ", first_speculative_mode ? 't' : 'f');
 	os << misc::fmt("trace_cache = %c, ", from_trace_cache ? 't' : 'f');
+	if (from_uop_cache)
+		os << "uop_cache = t, ";
+	if (isFused())
+		os << misc::fmt("fused = %s, ", macro_fused ? "macro" : "micro");
 
 	// Memory access
 	if (memory_access)
@@ -138,6 +138,12 @@ public:
 			Context *context,
 			std::shared_ptr<Uinst> uinst);
 
+	/// Return the uop to the state it had before being dispatched, keeping
+	/// its identifiers and the information collected at fetch. This is
+	/// used on a copy of a uop that is sent back to the uop queue for
+	/// replay.
+	void ResetState();
+
 	/// Dump uop information
 	void Dump(std::ostream &os = std::cout) const;
 
@@ -197,6 +203,12 @@ public:
 		return inputs[index];
 	}
 
+	/// Return true if the input dependency at the given index is part of
+	/// the address of a store, rather than the data it writes. This is the
+	/// effective address if the store has one, or its first input
+	/// otherwise.
+	bool isStoreAddressInput(int index) const;
+
 	/// Get output physical register dependency
 	int getOutput(int index) const
 	{
@@ -259,65 +271,55 @@ public:
 
 
 	//
-	// Queues and iterators
+	// Queues
 	//
 
 	/// True if the instruction is currently in the fetch queue
 	bool in_fetch_queue = false;
 
-	/// Position of the uop in the thread's fetch queue
-	std::list<std::shared_ptr<Uop>>::iterator fetch_queue_iterator;
-
 	/// True if the instruction is currently in the uop queue
 	bool in_uop_queue = false;
 
-	/// Position of the uop in the thread's uop queue
-	std::list<std::shared_ptr<Uop>>::iterator uop_queue_iterator;
-
 	/// True if the instruction is currently in the core's event queue
 	bool in_event_queue = false;
 
-	/// Position of the uop in the core's event queue, or past-the-end
-	/// iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator event_queue_iterator;
-
 	/// True if the instruction is currently present in the thread's
 	/// reorder buffer
 	bool in_reorder_buffer = false;
 
-	/// Position of the uop in the reorder buffer, if present
-	std::list<std::shared_ptr<Uop>>::iterator reorder_buffer_iterator;
-
 	/// True if the instruction is currently present in the thread's
 	/// instruction queue
 	bool in_instruction_queue = false;
 
-	/// Position of the uop in the thread's instruction queue, or past-the-
-	/// end iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator instruction_queue_iterator;
-
 	/// True if the instruction is currently present in the thread's
 	/// load queue
 	bool in_load_queue = false;
 
-	/// Position of the uop in the thread's load queue, or past-the-end
-	/// iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator load_queue_iterator;
-
 	/// True if the instruction is currently present in the thread's
 	/// store queue
 	bool in_store_queue = false;
 
-	/// Position of the uop in the thread's store queue, or past-the-end
-	/// iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator store_queue_iterator;
-
 	/// True if the instruction is currently present in the uop trace list
 	/// of the CPU
 	bool in_trace_list = false;
 
-	/// Position of the uop in the CPU's trace list, if present
-	std::list<std::shared_ptr<Uop>>::iterator trace_list_iterator;
+	/// True if the instruction has a memory access in flight, started
+	/// with Cpu::MemoryAccess()
+	bool in_memory_access = false;
+
+	/// True if the instruction is in the core's list of uops pending to be
+	/// returned to the uop pool, see Core::ReleaseUop()
+	bool in_release_list = false;
+
+	/// Return whether the uop is still referenced by any pipeline
+	/// structure. Uops that are not are returned to the core's uop pool.
+	bool isInPipeline() const
+	{
+		return in_fetch_queue || in_uop_queue || in_event_queue ||
+				in_reorder_buffer || in_instruction_queue ||
+				in_load_queue || in_store_queue ||
+				in_trace_list || in_memory_access;
+	}
 
 
 
@@ -360,6 +362,9 @@ public:
 
 	/// Flag indicating whether the uop was fetched from the trace cache
 	bool from_trace_cache = false;
+
+	/// Flag indicating whether the uop was fetched from the uop cache
+	bool from_uop_cache = false;
 	
 	/// Physical address that this uop was fetched from
 	unsigned fetch_address = 0;
@@ -377,42 +382,63 @@ public:
 
 
 	//
-	// Branch prediction
+	// Decode info
 	//
-	
-	/// Address of next predicted x86 macro-instruction (for branches)
-	unsigned int predicted_neip = 0;
 
-	/// Address of target x86 macro-instruction assuming branch taken (for
-	/// branches)
-	unsigned int target_neip = 0;
+	/// True if the uop is a conditional branch fused at decode with the
+	/// preceding flag-producing uop
+	bool macro_fused = false;
 
-	/// Global prediction
-	BranchPredictor::Prediction prediction = BranchPredictor::PredictionNotTaken;
+	/// True if the uop is fused at decode with the preceding load of the
+	/// same macro-instruction, which produces one of its operands
+	bool micro_fused = false;
 
-	/// Bimodal predictor index
-	int bimod_index = 0;
+	/// Return whether the uop is fused with the preceding uop. Fused uops
+	/// are dispatched and committed along with the uop they are fused
+	/// with, and do not take an entry of their own in the reorder buffer.
+	bool isFused() const { return macro_fused || micro_fused; }
 
-	/// Prediction from bimodal branch predictor
-	BranchPredictor::Prediction bimod_prediction = BranchPredictor::PredictionNotTaken;
 
-	/// Two-level branch predictor BHT index
-	int two_level_bht_index = 0;
 
-	/// Two-level branch predictor PHT row
-	int two_level_pht_row = 0;
 
-	/// Two-level branch predictor PHT column
-	int two_level_pht_col = 0;
+	//
+	// Memory dependences
+	//
+
+	/// For loads, identifier of the older store that the load is predicted
+	/// to depend on by the store set predictor, or 0 if none
+	long long wait_store_id = 0;
+
+	/// For loads, identifier of the store that forwarded its data to the
+	/// load, or 0 if the load accessed the memory hierarchy
+	long long forward_store_id = 0;
+
+	/// For stores, true once their address is known and they were checked
+	/// against younger loads that already read memory
+	bool address_resolved = false;
 
-	/// Two-level branch prediction
-	BranchPredictor::Prediction two_level_prediction = BranchPredictor::PredictionNotTaken;
+	/// True if the uop was squashed after a memory-order violation and
+	/// replaced by a copy in the uop queue. Its result, if it is still in
+	/// flight, must be discarded.
+	bool replayed = false;
+
+
+
+
+	//
+	// Branch prediction
+	//
+	
+	/// Address of next predicted x86 macro-instruction (for branches)
+	unsigned int predicted_neip = 0;
 
-	/// Choice index in the combined branch predictor
-	int choice_index = 0;
+	/// Address of target x86 macro-instruction assuming branch taken (for
+	/// branches)
+	unsigned int target_neip = 0;
 
-	/// Prediction in the combined branch predictor
-	BranchPredictor::Prediction choice_prediction = BranchPredictor::PredictionNotTaken;
+	/// State of the branch predictor for this uop, from its lookup at
+	/// fetch until its update at commit
+	BranchPredictor::Branch branch;
 	
 	
 	
@@ -433,6 +459,15 @@ public:
 	/// Cycle when uop was made ready, or 0 if not ready yet
 	long long ready_when = 0;
 
+	/// Number of input operands whose physical register is still pending.
+	/// Set at rename and decremented by the register file as producers
+	/// write back.
+	int num_pending_inputs = 0;
+
+	/// True if the uop is in its thread's ready instruction queue or
+	/// ready load queue
+	bool in_ready_queue = false;
+
 	/// True if uop was already issued
 	bool issued = false;
 
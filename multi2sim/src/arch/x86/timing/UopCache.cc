@@ -0,0 +1,214 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include <lib/cpp/Misc.h>
+
+#include "UopCache.h"
+
+
+namespace x86
+{
+
+bool UopCache::present;
+int UopCache::num_sets;
+int UopCache::num_ways;
+int UopCache::window_size;
+int UopCache::max_uops;
+int UopCache::width;
+
+
+bool UopCache::Entry::Contains(unsigned eip) const
+{
+	return std::find(eips.begin(), eips.end(), eip) != eips.end();
+}
+
+
+void UopCache::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "UopCache";
+
+	// Read variables
+	present = ini_file->ReadBool(section, "Present", false);
+	num_sets = ini_file->ReadInt(section, "Sets", 32);
+	num_ways = ini_file->ReadInt(section, "Assoc", 8);
+	window_size = ini_file->ReadInt(section, "WindowSize", 32);
+	max_uops = ini_file->ReadInt(section, "MaxUops", 18);
+	width = ini_file->ReadInt(section, "Width", 6);
+
+	// Integrity checks
+	if (num_sets < 1 || (num_sets & (num_sets - 1)))
+		throw Error(misc::fmt("%s: 'Sets' must be a power of 2 "
+				"greater than 0", section.c_str()));
+	if (num_ways < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'Assoc'",
+				section.c_str()));
+	if (window_size < 1 || (window_size & (window_size - 1)))
+		throw Error(misc::fmt("%s: 'WindowSize' must be a power of 2 "
+				"greater than 0", section.c_str()));
+	if (max_uops < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'MaxUops'",
+				section.c_str()));
+	if (width < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'Width'",
+				section.c_str()));
+}
+
+
+void UopCache::DumpConfiguration(std::ostream &os)
+{
+	os << "; Uop cache - parameters\n";
+	os << misc::fmt("UopCache.Sets = %d\n", num_sets);
+	os << misc::fmt("UopCache.Assoc = %d\n", num_ways);
+	os << misc::fmt("UopCache.WindowSize = %d\n", window_size);
+	os << misc::fmt("UopCache.MaxUops = %d\n", max_uops);
+	os << misc::fmt("UopCache.Width = %d\n", width);
+	os << '\n';
+}
+
+
+UopCache::UopCache(const std::string &name) :
+		name(name),
+		entries(num_sets * num_ways)
+{
+}
+
+
+void UopCache::DumpReport(std::ostream &os) const
+{
+	// Configuration
+	DumpConfiguration(os);
+
+	// Statistics
+	os << "; Uop cache - statistics\n";
+	os << misc::fmt("UopCache.Lookups = %lld\n", num_lookups);
+	os << misc::fmt("UopCache.Hits = %lld\n", num_hits);
+	os << misc::fmt("UopCache.HitRatio = %.4g\n", num_lookups ?
+			(double) num_hits / num_lookups : 0.0);
+	os << misc::fmt("UopCache.Insertions = %lld\n", num_insertions);
+	os << misc::fmt("UopCache.Evictions = %lld\n", num_evictions);
+	os << misc::fmt("UopCache.Overflows = %lld\n", num_overflows);
+	os << misc::fmt("UopCache.Fetched = %lld\n", num_fetched_uinsts);
+	os << '\n';
+}
+
+
+UopCache::Entry *UopCache::getEntry(unsigned eip)
+{
+	unsigned tag = getWindowAddress(eip);
+	int set = (tag / window_size) % num_sets;
+	for (int way = 0; way < num_ways; way++)
+	{
+		Entry *entry = &entries[set * num_ways + way];
+		if (entry->valid && entry->tag == tag)
+			return entry;
+	}
+	return nullptr;
+}
+
+
+bool UopCache::Contains(unsigned eip)
+{
+	Entry *entry = getEntry(eip);
+	return entry && entry->Contains(eip);
+}
+
+
+bool UopCache::Lookup(unsigned eip)
+{
+	// Statistics
+	num_lookups++;
+
+	// Miss
+	Entry *entry = getEntry(eip);
+	if (!entry || !entry->Contains(eip))
+		return false;
+
+	// Hit
+	entry->last_access = ++access_counter;
+	num_hits++;
+	return true;
+}
+
+
+void UopCache::Insert(unsigned eip, int num_uops)
+{
+	// Window already allocated
+	Entry *entry = getEntry(eip);
+	if (entry)
+	{
+		// Instruction already stored, or window not cacheable
+		entry->last_access = ++access_counter;
+		if (!entry->cacheable || entry->Contains(eip))
+			return;
+
+		// Windows decoding into more uops than an entry can hold are
+		// not cached. The entry stays allocated as non-cacheable, so
+		// that the window is not allocated again until it is replaced.
+		if (entry->num_uops + num_uops > max_uops)
+		{
+			entry->cacheable = false;
+			entry->num_uops = 0;
+			entry->eips.clear();
+			num_overflows++;
+			return;
+		}
+	}
+	else
+	{
+		// An instruction that does not fit in an entry by itself is
+		// not cached, and does not replace any entry
+		if (num_uops > max_uops)
+		{
+			num_overflows++;
+			return;
+		}
+
+		// Allocate the window, replacing the least recently used
+		// entry of the set
+		unsigned tag = getWindowAddress(eip);
+		int set = (tag / window_size) % num_sets;
+		entry = &entries[set * num_ways];
+		for (int way = 1; way < num_ways; way++)
+		{
+			Entry *candidate = &entries[set * num_ways + way];
+			if (!candidate->valid || (entry->valid &&
+					candidate->last_access <
+					entry->last_access))
+				entry = candidate;
+		}
+		if (entry->valid)
+			num_evictions++;
+		entry->valid = true;
+		entry->cacheable = true;
+		entry->tag = tag;
+		entry->num_uops = 0;
+		entry->eips.clear();
+		entry->last_access = ++access_counter;
+	}
+
+	// Store instruction
+	entry->eips.push_back(eip);
+	entry->num_uops += num_uops;
+	num_insertions++;
+}
+
+}  // namespace x86
@@ -0,0 +1,232 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_UOP_CACHE_H
+#define ARCH_X86_TIMING_UOP_CACHE_H
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+
+
+namespace x86
+{
+
+/// Decoded uop cache. The cache stores the uops of macro-instructions
+/// decoded by the legacy decoders, grouped in aligned windows of code bytes.
+/// Instructions found in the cache are fetched without accessing the
+/// instruction cache, and their uops skip the legacy decoders.
+class UopCache
+{
+	// Uop cache entry, holding the decoded uops of one code window
+	struct Entry
+	{
+		// True if the entry holds a window
+		bool valid = false;
+
+		// False if the window decodes into more uops than the entry
+		// can hold. No instructions are stored for it in that case.
+		bool cacheable = true;
+
+		// Address of the window
+		unsigned tag = 0;
+
+		// Cycle of the last access, used for LRU replacement
+		long long last_access = 0;
+
+		// Number of uops stored for the window
+		int num_uops = 0;
+
+		// Addresses of the macro-instructions stored for the window
+		std::vector<unsigned> eips;
+
+		// Return whether the macro-instruction at the given address is
+		// stored in the entry
+		bool Contains(unsigned eip) const;
+	};
+
+
+	//
+	// Static fields
+	//
+
+	// Flag indicating whether the uop cache is present
+	static bool present;
+
+	// Number of sets
+	static int num_sets;
+
+	// Associativity
+	static int num_ways;
+
+	// Size of a code window in bytes
+	static int window_size;
+
+	// Maximum number of uops stored for one window
+	static int max_uops;
+
+	// Number of uops delivered per cycle
+	static int width;
+
+
+
+	//
+	// Class members
+	//
+
+	// Name of the uop cache
+	std::string name;
+
+	// Entries (num_sets * num_ways elements)
+	std::vector<Entry> entries;
+
+	// Counter used to timestamp accesses
+	long long access_counter = 0;
+
+	// Return the entry holding the window of the given address, or
+	// nullptr if the window is not in the cache
+	Entry *getEntry(unsigned eip);
+
+
+
+	//
+	// Statistics
+	//
+
+	// Number of lookups
+	long long num_lookups = 0;
+
+	// Number of lookups that hit
+	long long num_hits = 0;
+
+	// Number of macro-instructions inserted
+	long long num_insertions = 0;
+
+	// Number of valid windows replaced
+	long long num_evictions = 0;
+
+	// Number of windows dropped for exceeding the maximum number of uops
+	long long num_overflows = 0;
+
+	// Number of uops fetched from the cache
+	long long num_fetched_uinsts = 0;
+
+public:
+
+	/// Exception for the x86 uop cache
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("x86 uop cache");
+		}
+	};
+
+
+
+	//
+	// Static members
+	//
+
+	/// Read uop cache configuration from configuration file
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Dump configuration
+	static void DumpConfiguration(std::ostream &os = std::cout);
+
+	/// Return whether the uop cache was configured as present
+	static bool isPresent() { return present; }
+
+	/// Return the number of sets
+	static int getNumSets() { return num_sets; }
+
+	/// Return the associativity
+	static int getNumWays() { return num_ways; }
+
+	/// Return the size of a code window in bytes
+	static int getWindowSize() { return window_size; }
+
+	/// Return the maximum number of uops stored for one window
+	static int getMaxUops() { return max_uops; }
+
+	/// Return the number of uops delivered per cycle
+	static int getWidth() { return width; }
+
+	/// Return the address of the window containing the given address
+	static unsigned getWindowAddress(unsigned eip)
+	{
+		return eip & ~(window_size - 1);
+	}
+
+
+
+	//
+	// Class members
+	//
+
+	/// Constructor
+	UopCache(const std::string &name = "");
+
+	/// Dump the uop cache report
+	void DumpReport(std::ostream &os = std::cout) const;
+
+	/// Look up the macro-instruction at the given address, recording the
+	/// access in the statistics. Return true on a hit.
+	bool Lookup(unsigned eip);
+
+	/// Return whether the macro-instruction at the given address is in
+	/// the cache, without recording an access.
+	bool Contains(unsigned eip);
+
+	/// Store the uops of a macro-instruction decoded by the legacy
+	/// decoders.
+	///
+	/// \param eip
+	///	Address of the macro-instruction
+	///
+	/// \param num_uops
+	///	Number of uops that the macro-instruction decodes into
+	///
+	void Insert(unsigned eip, int num_uops);
+
+	/// Increment the number of uops fetched from the cache
+	void incNumFetchedUinsts(int count = 1) { num_fetched_uinsts += count; }
+
+	/// Return the number of lookups
+	long long getNumLookups() const { return num_lookups; }
+
+	/// Return the number of hits
+	long long getNumHits() const { return num_hits; }
+
+	/// Return the number of valid windows replaced
+	long long getNumEvictions() const { return num_evictions; }
+
+	/// Return the number of windows dropped for exceeding the maximum
+	/// number of uops
+	long long getNumOverflows() const { return num_overflows; }
+};
+
+}  // namespace x86
+
+#endif
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include <lib/esim/Engine.h>
+#include <lib/esim/IntervalStatistics.h>
 
 #include "Address.h"
 #include "Bank.h"
@@ -62,6 +63,31 @@ Controller::Controller(int id, misc::IniFile *config,
 		Controller(id)
 {
 	ParseConfiguration(config, section);
+
+	// Interval statistics
+	if (esim::IntervalStatistics::getInstance()->isActive())
+		RegisterIntervalStatistics();
+}
+
+
+void Controller::RegisterIntervalStatistics()
+{
+	// Requests received per cycle
+	esim::IntervalStatistics *interval_statistics =
+			esim::IntervalStatistics::getInstance();
+	std::string prefix = "dram." + name + ".";
+	auto cycles = []() { return (double) System::frequency_domain->
+			getCycle(); };
+	interval_statistics->RegisterRatio(prefix + "ReadBandwidth",
+			[this]() { return (double) num_read_requests; },
+			cycles);
+	interval_statistics->RegisterRatio(prefix + "WriteBandwidth",
+			[this]() { return (double) num_write_requests; },
+			cycles);
+
+	// Requests waiting in the incoming queue
+	interval_statistics->RegisterGauge(prefix + "QueueLength",
+			[this]() { return (double) incoming_requests.size(); });
 }
 
 
@@ -211,6 +237,12 @@ void Controller::ParseConfigurationTiming(misc::IniFile *ini_file,
 
 void Controller::AddRequest(std::shared_ptr<Request> request)
 {
+	// Statistics
+	if (request->getType() == RequestRead)
+		num_read_requests++;
+	else
+		num_write_requests++;
+
 	// Add the request to the controller incoming request queue.
 	incoming_requests.push(request);
 
@@ -109,6 +109,14 @@ class Controller
 	// controller
 	std::map<int, esim::Event *> SCHEDULERS;
 
+	// Number of read and write requests received
+	long long num_read_requests = 0;
+	long long num_write_requests = 0;
+
+	// Register the requests received and the length of the incoming
+	// request queue in the interval statistics
+	void RegisterIntervalStatistics();
+
 public:
 
 	Controller(int id);
@@ -155,6 +163,12 @@ public:
 	/// Add a request to the controller's incoming request queue.
 	void AddRequest(std::shared_ptr<Request> request);
 
+	/// Return the number of read requests received
+	long long getNumReadRequests() const { return num_read_requests; }
+
+	/// Return the number of write requests received
+	long long getNumWriteRequests() const { return num_write_requests; }
+
 	/// Obtain the Event for the controller's request processor.
 	static esim::Event *getRequestProcessor(int controller)
 	{
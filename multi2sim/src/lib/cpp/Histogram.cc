@@ -0,0 +1,147 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "Histogram.h"
+#include "Json.h"
+
+
+namespace misc
+{
+
+
+int Histogram::getBucket(long long value)
+{
+	int bucket = 0;
+	while (value > 0)
+	{
+		value >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+
+void Histogram::Add(long long value)
+{
+	// Negative values count as 0
+	value = std::max(value, 0LL);
+
+	// Bucket
+	int bucket = getBucket(value);
+	if (bucket >= (int) buckets.size())
+		buckets.resize(bucket + 1);
+	buckets[bucket]++;
+
+	// Summary
+	min = count ? std::min(min, value) : value;
+	max = count ? std::max(max, value) : value;
+	count++;
+	sum += value;
+}
+
+
+void Histogram::Merge(const Histogram &histogram)
+{
+	// Nothing to add
+	if (!histogram.count)
+		return;
+
+	// Buckets
+	if (histogram.buckets.size() > buckets.size())
+		buckets.resize(histogram.buckets.size());
+	for (unsigned i = 0; i < histogram.buckets.size(); i++)
+		buckets[i] += histogram.buckets[i];
+
+	// Summary
+	min = count ? std::min(min, histogram.min) : histogram.min;
+	max = count ? std::max(max, histogram.max) : histogram.max;
+	count += histogram.count;
+	sum += histogram.sum;
+}
+
+
+void Histogram::Clear()
+{
+	buckets.clear();
+	count = 0;
+	sum = 0;
+	min = 0;
+	max = 0;
+}
+
+
+double Histogram::getPercentile(double percentile) const
+{
+	// Empty histogram
+	if (!count)
+		return 0.0;
+
+	// Rank of the value, and bucket containing it
+	double rank = percentile / 100.0 * count;
+	long long accumulated = 0;
+	for (unsigned i = 0; i < buckets.size(); i++)
+	{
+		if (!buckets[i] || accumulated + buckets[i] < rank)
+		{
+			accumulated += buckets[i];
+			continue;
+		}
+
+		// Interpolate within the bucket
+		double low = std::max(getBucketLow(i), min);
+		double high = std::min(getBucketHigh(i), max);
+		double fraction = (rank - accumulated) / buckets[i];
+		return low + (high - low) * fraction;
+	}
+	return max;
+}
+
+
+void Histogram::DumpJson(JsonWriter &json) const
+{
+	json.BeginObject();
+	json.Member("Count", count);
+	json.Member("Mean", getMean());
+	json.Member("Min", min);
+	json.Member("Max", max);
+	json.Member("P50", getPercentile(50));
+	json.Member("P90", getPercentile(90));
+	json.Member("P99", getPercentile(99));
+
+	// Non-empty buckets
+	json.Key("Buckets");
+	json.BeginArray();
+	for (unsigned i = 0; i < buckets.size(); i++)
+	{
+		if (!buckets[i])
+			continue;
+		json.BeginObject();
+		json.Member("Low", getBucketLow(i));
+		json.Member("High", getBucketHigh(i));
+		json.Member("Count", buckets[i]);
+		json.EndObject();
+	}
+	json.EndArray();
+	json.EndObject();
+}
+
+
+}  // namespace misc
@@ -0,0 +1,116 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_HISTOGRAM_H
+#define LIB_CPP_HISTOGRAM_H
+
+#include <vector>
+
+
+namespace misc
+{
+
+// Forward declarations
+class JsonWriter;
+
+
+/// Histogram of non-negative integer values, such as latencies in cycles,
+/// with buckets of exponentially growing size. Bucket 0 counts value 0, and
+/// bucket i > 0 counts values in the range [2^(i-1), 2^i). Adding a value
+/// takes constant time, so histograms can be updated on every access of a
+/// timing model.
+class Histogram
+{
+	// Number of values in each bucket
+	std::vector<long long> buckets;
+
+	// Number of values
+	long long count = 0;
+
+	// Sum of all values
+	long long sum = 0;
+
+	// Minimum and maximum values
+	long long min = 0;
+	long long max = 0;
+
+public:
+
+	/// Return the index of the bucket for a value
+	static int getBucket(long long value);
+
+	/// Return the lowest value counted in a bucket
+	static long long getBucketLow(int bucket)
+	{
+		return bucket ? 1LL << (bucket - 1) : 0;
+	}
+
+	/// Return the highest value counted in a bucket
+	static long long getBucketHigh(int bucket)
+	{
+		return bucket ? (1LL << bucket) - 1 : 0;
+	}
+
+	/// Add a value. Negative values are counted as 0.
+	void Add(long long value);
+
+	/// Add all values of another histogram
+	void Merge(const Histogram &histogram);
+
+	/// Remove all values
+	void Clear();
+
+	/// Return the number of values
+	long long getCount() const { return count; }
+
+	/// Return the sum of all values
+	long long getSum() const { return sum; }
+
+	/// Return the minimum value, or 0 if the histogram is empty
+	long long getMin() const { return min; }
+
+	/// Return the maximum value, or 0 if the histogram is empty
+	long long getMax() const { return max; }
+
+	/// Return the average value, or 0 if the histogram is empty
+	double getMean() const { return count ? (double) sum / count : 0.0; }
+
+	/// Return the number of buckets, up to the last non-empty one
+	int getNumBuckets() const { return buckets.size(); }
+
+	/// Return the number of values in a bucket
+	long long getBucketCount(int bucket) const
+	{
+		return bucket < (int) buckets.size() ? buckets[bucket] : 0;
+	}
+
+	/// Return an estimate of the given percentile, between 0 and 100. The
+	/// value is interpolated linearly within the bucket containing it, and
+	/// clamped to the minimum and maximum values.
+	double getPercentile(double percentile) const;
+
+	/// Write the histogram as a JSON object with its count, mean, minimum,
+	/// maximum, percentiles 50, 90, and 99, and non-empty buckets.
+	void DumpJson(JsonWriter &json) const;
+};
+
+
+}  // namespace misc
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+
+#include "Error.h"
+#include "Json.h"
+#include "String.h"
+
+
+namespace misc
+{
+
+
+std::string JsonWriter::Escape(const std::string &s)
+{
+	std::string result = "\"";
+	for (char c : s)
+	{
+		switch (c)
+		{
+		case '"': result += "\\\""; break;
+		case '\\': result += "\\\\"; break;
+		case '\n': result += "\\n"; break;
+		case '\r': result += "\\r"; break;
+		case '\t': result += "\\t"; break;
+		default:
+			if ((unsigned char) c < 0x20)
+				result += fmt("\\u%04x", c);
+			else
+				result += c;
+		}
+	}
+	return result + "\"";
+}
+
+
+void JsonWriter::NewLine()
+{
+	os << '\n' << std::string(empty.size(), '\t');
+}
+
+
+void JsonWriter::BeginElement(bool key)
+{
+	// Value of a member
+	if (after_key)
+	{
+		after_key = false;
+		return;
+	}
+
+	// Root value
+	if (empty.empty())
+	{
+		if (key)
+			throw Panic("JSON key written outside of an object");
+		return;
+	}
+
+	// Members of an object need a key, and elements of an array can't
+	// have one
+	bool in_object = closing.back() == '}';
+	if (in_object && !key)
+		throw Panic("JSON value written in an object without a key");
+	if (!in_object && key)
+		throw Panic("JSON key written outside of an object");
+
+	// Element of an object or array
+	if (!empty.back())
+		os << ',';
+	empty.back() = false;
+	NewLine();
+}
+
+
+void JsonWriter::Open(char c)
+{
+	BeginElement();
+	os << (c == '}' ? '{' : '[');
+	empty.push_back(true);
+	closing.push_back(c);
+}
+
+
+void JsonWriter::Close(char c)
+{
+	if (after_key)
+		throw Panic("JSON key written without a value");
+	if (closing.empty() || closing.back() != c)
+		throw Panic(fmt("JSON '%c' does not close an open %s", c,
+				c == '}' ? "object" : "array"));
+	bool was_empty = empty.back();
+	empty.pop_back();
+	closing.pop_back();
+	if (!was_empty)
+		NewLine();
+	os << c;
+}
+
+
+void JsonWriter::BeginObject()
+{
+	Open('}');
+}
+
+
+void JsonWriter::EndObject()
+{
+	Close('}');
+}
+
+
+void JsonWriter::BeginArray()
+{
+	Open(']');
+}
+
+
+void JsonWriter::EndArray()
+{
+	Close(']');
+}
+
+
+void JsonWriter::Key(const std::string &key)
+{
+	if (after_key)
+		throw Panic("JSON key written without a value for the "
+				"previous key");
+	BeginElement(true);
+	os << Escape(key) << ": ";
+	after_key = true;
+}
+
+
+void JsonWriter::Value(const std::string &value)
+{
+	BeginElement();
+	os << Escape(value);
+}
+
+
+void JsonWriter::Value(long long value)
+{
+	BeginElement();
+	os << value;
+}
+
+
+void JsonWriter::Value(double value)
+{
+	BeginElement();
+	if (std::isfinite(value))
+		os << fmt("%.10g", value);
+	else
+		os << "null";
+}
+
+
+void JsonWriter::Value(bool value)
+{
+	BeginElement();
+	os << (value ? "true" : "false");
+}
+
+
+void JsonWriter::Null()
+{
+	BeginElement();
+	os << "null";
+}
+
+
+void JsonWriter::End()
+{
+	if (!empty.empty() || after_key)
+		throw Panic("JSON document finished with open objects");
+	os << '\n';
+}
+
+
+}  // namespace misc
@@ -0,0 +1,129 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_JSON_H
+#define LIB_CPP_JSON_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace misc
+{
+
+
+/// Writer of a JSON document into an output stream. Objects and arrays are
+/// opened and closed with calls to BeginObject(), EndObject(), BeginArray(),
+/// and EndArray(). Members of an object are written with a call to Key()
+/// followed by a value, or with a call to Member(). Separators and
+/// indentation are inserted automatically. Calls producing a malformed
+/// document, such as a value in an object without a key or an unbalanced
+/// closing, throw a misc::Panic.
+class JsonWriter
+{
+	// Output stream
+	std::ostream &os;
+
+	// For each open object or array, whether no element was written yet
+	std::vector<bool> empty;
+
+	// For each open object or array, the character that closes it
+	std::vector<char> closing;
+
+	// Whether a key was just written, and the next value is its value
+	bool after_key = false;
+
+	// Write the separator and indentation before a new element, which is
+	// a key if \a key is true, or a value otherwise
+	void BeginElement(bool key = false);
+
+	// Open an object or array closed with the given character
+	void Open(char c);
+
+	// Write a new line with the indentation of the current nesting level
+	void NewLine();
+
+	// Close the current object or array with the given character
+	void Close(char c);
+
+public:
+
+	/// Constructor
+	JsonWriter(std::ostream &os) : os(os)
+	{
+	}
+
+	/// Return a string with the characters of \a s escaped as a JSON
+	/// string, including the quotes.
+	static std::string Escape(const std::string &s);
+
+	/// Open an object
+	void BeginObject();
+
+	/// Close the current object
+	void EndObject();
+
+	/// Open an array
+	void BeginArray();
+
+	/// Close the current array
+	void EndArray();
+
+	/// Write the key of a member of the current object
+	void Key(const std::string &key);
+
+	/// Write a string value
+	void Value(const std::string &value);
+
+	/// Write a string value
+	void Value(const char *value) { Value(std::string(value)); }
+
+	/// Write an integer value
+	void Value(long long value);
+
+	/// Write an integer value
+	void Value(int value) { Value((long long) value); }
+
+	/// Write a floating-point value. Values that are not finite are
+	/// written as `null`.
+	void Value(double value);
+
+	/// Write a Boolean value
+	void Value(bool value);
+
+	/// Write a `null` value
+	void Null();
+
+	/// Write a member of the current object
+	template<typename T> void Member(const std::string &key, T value)
+	{
+		Key(key);
+		Value(value);
+	}
+
+	/// Finish the document with a new line. All objects and arrays must
+	/// have been closed.
+	void End();
+};
+
+
+}  // namespace misc
+
+#endif
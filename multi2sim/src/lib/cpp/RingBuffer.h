@@ -0,0 +1,210 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_RING_BUFFER_H
+#define LIB_CPP_RING_BUFFER_H
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+
+namespace misc
+{
+
+/// Circular buffer of elements stored contiguously in memory. Elements are
+/// addressed by their position relative to the head of the buffer, with 0
+/// being the oldest element. Insertions and removals at both ends take
+/// constant time. Insertions and removals at arbitrary positions shift the
+/// elements between that position and the closest end of the buffer.
+///
+/// The buffer is created with an initial capacity, typically the size of
+/// the hardware structure it models. If an element is inserted while the
+/// buffer is full, the capacity is doubled.
+template<typename T> class RingBuffer
+{
+	// Storage, with a size that is always a power of 2
+	std::vector<T> elements;
+
+	// Mask applied to physical positions, equal to the storage size - 1
+	int mask = 0;
+
+	// Physical position of the element at the head
+	int head = 0;
+
+	// Number of elements in the buffer
+	int count = 0;
+
+	// Return the physical position of the element at the given index
+	int getPosition(int index) const
+	{
+		return (head + index) & mask;
+	}
+
+	// Resize the storage to the given number of elements, which must be a
+	// power of 2, moving the current content to the beginning of it.
+	void Resize(int new_size)
+	{
+		assert(new_size >= count);
+		assert(!(new_size & (new_size - 1)));
+		std::vector<T> new_elements(new_size);
+		for (int i = 0; i < count; i++)
+			new_elements[i] = std::move(elements[getPosition(i)]);
+		elements.swap(new_elements);
+		mask = new_size - 1;
+		head = 0;
+	}
+
+public:
+
+	/// Constructor
+	///
+	/// \param capacity
+	///	Initial number of elements that the buffer can hold before it
+	///	needs to grow. It is rounded up to the next power of 2.
+	///
+	explicit RingBuffer(int capacity = 16)
+	{
+		Reserve(capacity);
+	}
+
+	/// Make sure that the buffer can hold at least the given number of
+	/// elements without growing.
+	void Reserve(int capacity)
+	{
+		int new_size = 1;
+		while (new_size < capacity)
+			new_size <<= 1;
+		if (new_size > (int) elements.size())
+			Resize(new_size);
+	}
+
+	/// Return the number of elements in the buffer
+	int size() const { return count; }
+
+	/// Return whether the buffer is empty
+	bool empty() const { return count == 0; }
+
+	/// Return the number of elements that the buffer can hold without
+	/// growing.
+	int getCapacity() const { return elements.size(); }
+
+	/// Return the element at the given position, where 0 is the head
+	T &operator[](int index)
+	{
+		assert(index >= 0 && index < count);
+		return elements[getPosition(index)];
+	}
+
+	/// Return the element at the given position, where 0 is the head
+	const T &operator[](int index) const
+	{
+		assert(index >= 0 && index < count);
+		return elements[getPosition(index)];
+	}
+
+	/// Return the element at the head
+	T &front() { return (*this)[0]; }
+
+	/// Return the element at the tail
+	T &back() { return (*this)[count - 1]; }
+
+	/// Insert an element at the tail
+	void PushBack(T element)
+	{
+		if (count == (int) elements.size())
+			Resize(elements.size() * 2);
+		elements[getPosition(count)] = std::move(element);
+		count++;
+	}
+
+	/// Remove the element at the head
+	void PopFront()
+	{
+		assert(count > 0);
+		elements[head] = T();
+		head = (head + 1) & mask;
+		count--;
+	}
+
+	/// Remove the element at the tail
+	void PopBack()
+	{
+		assert(count > 0);
+		count--;
+		elements[getPosition(count)] = T();
+	}
+
+	/// Insert an element so that it takes the given position, shifting
+	/// the elements after it towards the tail.
+	void Insert(int index, T element)
+	{
+		assert(index >= 0 && index <= count);
+		if (count == (int) elements.size())
+			Resize(elements.size() * 2);
+		for (int i = count; i > index; i--)
+			elements[getPosition(i)] = std::move(
+					elements[getPosition(i - 1)]);
+		elements[getPosition(index)] = std::move(element);
+		count++;
+	}
+
+	/// Remove the element at the given position. The elements on the
+	/// shorter side of the position are shifted to fill the gap.
+	void Erase(int index)
+	{
+		assert(index >= 0 && index < count);
+		if (index < count / 2)
+		{
+			for (int i = index; i > 0; i--)
+				elements[getPosition(i)] = std::move(
+						elements[getPosition(i - 1)]);
+			PopFront();
+		}
+		else
+		{
+			for (int i = index; i < count - 1; i++)
+				elements[getPosition(i)] = std::move(
+						elements[getPosition(i + 1)]);
+			PopBack();
+		}
+	}
+
+	/// Return the position of the first element equal to the given value,
+	/// or -1 if it is not present.
+	int Find(const T &element) const
+	{
+		for (int i = 0; i < count; i++)
+			if (elements[getPosition(i)] == element)
+				return i;
+		return -1;
+	}
+
+	/// Remove all elements
+	void Clear()
+	{
+		while (count)
+			PopBack();
+		head = 0;
+	}
+};
+
+}  // namespace misc
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include "SlotPool.h"
+
+
+namespace misc
+{
+
+void SlotPool::Grow()
+{
+	// Allocate chunk
+	assert(slot_size);
+	chunks.emplace_back(new char[slot_size * slots_per_chunk]);
+	char *chunk = chunks.back().get();
+
+	// Chain its slots into the free list
+	for (int i = slots_per_chunk - 1; i >= 0; i--)
+	{
+		SlotHeader *header = reinterpret_cast<SlotHeader *>(
+				chunk + i * slot_size);
+		header->next = free_list;
+		free_list = header;
+	}
+}
+
+
+void *SlotPool::Allocate(size_t size)
+{
+	// The first allocation fixes the slot size
+	if (!object_size)
+	{
+		object_size = size;
+		slot_size = sizeof(SlotHeader) + (size + alignof(SlotHeader) - 1) /
+				alignof(SlotHeader) * alignof(SlotHeader);
+	}
+	assert(size == object_size);
+
+	// Refill free list
+	if (!free_list)
+		Grow();
+
+	// Take slot
+	SlotHeader *header = free_list;
+	free_list = header->next;
+	header->pool = this;
+	num_allocated++;
+	return header + 1;
+}
+
+
+void SlotPool::Free(void *ptr)
+{
+	// Nothing to do for null pointers
+	if (!ptr)
+		return;
+
+	// Return slot to its pool
+	SlotHeader *header = static_cast<SlotHeader *>(ptr) - 1;
+	SlotPool *pool = header->pool;
+	assert(pool && pool->num_allocated > 0);
+	header->next = pool->free_list;
+	pool->free_list = header;
+	pool->num_allocated--;
+}
+
+}  // namespace misc
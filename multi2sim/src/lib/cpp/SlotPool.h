@@ -0,0 +1,133 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_SLOT_POOL_H
+#define LIB_CPP_SLOT_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+namespace misc
+{
+
+/// Arena of fixed-size slots, used by the timing models to allocate their
+/// uops. Slots are carved out of large chunks and recycled through a free
+/// list, so that fetching an instruction does not go through the system
+/// allocator, and objects of the same pool stay close in memory. Every slot
+/// is preceded by a header pointing back to its pool, so an object can be
+/// released without knowing which pool it came from.
+///
+/// Objects are created with New() and destroyed with Delete(). Alternatively,
+/// a class whose objects are always allocated in a pool can declare a
+/// placement operator new taking the pool, which calls Allocate(), and an
+/// operator delete calling Free(). Its objects are then created with
+/// 'new (pool) T(...)' and can be owned by a std::unique_ptr.
+class SlotPool
+{
+	// Header placed in front of each slot
+	union SlotHeader
+	{
+		// Pool that the slot belongs to, while the slot is allocated
+		SlotPool *pool;
+
+		// Next free slot, while the slot is in the free list
+		SlotHeader *next;
+
+		// Force the object following the header to be properly aligned
+		std::max_align_t align;
+	};
+
+	// Size of the objects allocated in the pool, set on first allocation
+	size_t object_size = 0;
+
+	// Size of one slot, including its header
+	size_t slot_size = 0;
+
+	// Number of slots in each chunk of memory
+	int slots_per_chunk;
+
+	// Chunks of memory owned by the pool
+	std::vector<std::unique_ptr<char[]>> chunks;
+
+	// List of free slots
+	SlotHeader *free_list = nullptr;
+
+	// Number of slots currently handed out
+	long long num_allocated = 0;
+
+	// Create a new chunk and add its slots to the free list
+	void Grow();
+
+public:
+
+	/// Constructor
+	///
+	/// \param slots_per_chunk
+	///	Number of slots that the pool reserves every time it runs out of
+	///	free slots. The first chunk is reserved on the first allocation.
+	///
+	explicit SlotPool(int slots_per_chunk = 64) :
+			slots_per_chunk(slots_per_chunk)
+	{
+	}
+
+	/// Pools cannot be copied, since allocated slots point back to them
+	SlotPool(const SlotPool &) = delete;
+	SlotPool &operator=(const SlotPool &) = delete;
+
+	/// Return a slot of memory of the given size. All allocations from the
+	/// same pool must request the same size.
+	void *Allocate(size_t size);
+
+	/// Return a slot previously obtained with Allocate() to the pool that
+	/// it was taken from.
+	static void Free(void *ptr);
+
+	/// Construct an object of type \a T in a new slot, passing the given
+	/// arguments to its constructor.
+	template<typename T, typename... Args> T *New(Args&&... args)
+	{
+		return new (Allocate(sizeof(T))) T(std::forward<Args>(args)...);
+	}
+
+	/// Destroy an object created with New() and return its slot to the
+	/// pool that it was taken from.
+	template<typename T> static void Delete(T *object)
+	{
+		object->~T();
+		Free(object);
+	}
+
+	/// Return the number of slots currently allocated
+	long long getNumAllocated() const { return num_allocated; }
+
+	/// Return the total number of slots reserved by the pool
+	long long getNumSlots() const
+	{
+		return (long long) chunks.size() * slots_per_chunk;
+	}
+};
+
+}  // namespace misc
+
+#endif
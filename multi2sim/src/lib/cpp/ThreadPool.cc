@@ -0,0 +1,144 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ThreadPool.h"
+
+
+namespace misc
+{
+
+
+ThreadPool::ThreadPool(int num_threads) : next_item(0)
+{
+	for (int i = 1; i < num_threads; i++)
+		threads.emplace_back(&ThreadPool::Worker, this);
+}
+
+
+ThreadPool::~ThreadPool()
+{
+	// Wake up workers
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	start_condition.notify_all();
+
+	// Wait for them
+	for (auto &thread : threads)
+		thread.join();
+}
+
+
+void ThreadPool::RunItems()
+{
+	for (;;)
+	{
+		// Take next index
+		int index = next_item++;
+		if (index >= num_items)
+			return;
+
+		// Run it, recording the first exception
+		try
+		{
+			(*function)(index);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!exception)
+				exception = std::current_exception();
+		}
+	}
+}
+
+
+void ThreadPool::Worker()
+{
+	long long last_job_id = 0;
+	for (;;)
+	{
+		// Wait for a new job
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			start_condition.wait(lock, [&] {
+				return stopping || job_id != last_job_id;
+			});
+			if (stopping)
+				return;
+			last_job_id = job_id;
+		}
+
+		// Process it
+		RunItems();
+
+		// Notify caller
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			num_busy_threads--;
+		}
+		done_condition.notify_one();
+	}
+}
+
+
+void ThreadPool::ParallelFor(int count,
+		const std::function<void(int)> &function)
+{
+	// Without workers, this is a plain loop
+	if (threads.empty())
+	{
+		for (int i = 0; i < count; i++)
+			function(i);
+		return;
+	}
+
+	// Post job
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->function = &function;
+		num_items = count;
+		next_item = 0;
+		num_busy_threads = threads.size();
+		exception = nullptr;
+		job_id++;
+	}
+	start_condition.notify_all();
+
+	// Take part in the job
+	RunItems();
+
+	// Wait for all workers to finish
+	std::exception_ptr job_exception;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		done_condition.wait(lock, [&] { return num_busy_threads == 0; });
+		this->function = nullptr;
+		job_exception = exception;
+		exception = nullptr;
+	}
+
+	// Propagate errors
+	if (job_exception)
+		std::rethrow_exception(job_exception);
+}
+
+
+}  // namespace misc
@@ -0,0 +1,106 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_THREAD_POOL_H
+#define LIB_CPP_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace misc
+{
+
+
+/// Fixed set of host threads used to run independent pieces of work in
+/// parallel. The thread invoking ParallelFor() takes part in the work and
+/// only returns once all pieces have been processed, so a call behaves like
+/// a plain loop followed by a barrier.
+class ThreadPool
+{
+	// Worker threads, not including the thread calling ParallelFor()
+	std::vector<std::thread> threads;
+
+	// Mutex protecting the fields below
+	std::mutex mutex;
+
+	// Signaled when a new job is posted or the pool is destroyed
+	std::condition_variable start_condition;
+
+	// Signaled when a worker finishes its part of the current job
+	std::condition_variable done_condition;
+
+	// Function to run for each index of the current job
+	const std::function<void(int)> *function = nullptr;
+
+	// Number of indices in the current job
+	int num_items = 0;
+
+	// Next index to be processed
+	std::atomic<int> next_item;
+
+	// Sequence number of the current job, used by workers to detect that a
+	// new job was posted
+	long long job_id = 0;
+
+	// Number of workers still busy with the current job
+	int num_busy_threads = 0;
+
+	// First exception thrown by the current job, rethrown by the caller
+	std::exception_ptr exception;
+
+	// Set when the pool is being destroyed
+	bool stopping = false;
+
+	// Process indices of the current job until none is left
+	void RunItems();
+
+	// Main loop of a worker thread
+	void Worker();
+
+public:
+
+	/// Create a pool that runs work on \a num_threads host threads in
+	/// total, including the caller of ParallelFor(). A value of 1 or less
+	/// creates no worker threads.
+	explicit ThreadPool(int num_threads);
+
+	/// Stop and join all worker threads
+	~ThreadPool();
+
+	/// Return the number of host threads taking part in each job
+	int getNumThreads() const { return threads.size() + 1; }
+
+	/// Invoke \a function once for each index in [0, \a count), spreading
+	/// the calls among all threads of the pool, and return when all of
+	/// them have finished. The order in which indices are processed is
+	/// unspecified. If any invocation throws an exception, the first one
+	/// caught is rethrown in the calling thread.
+	void ParallelFor(int count, const std::function<void(int)> &function);
+};
+
+
+}  // namespace misc
+
+#endif
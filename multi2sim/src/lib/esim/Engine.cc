@@ -17,7 +17,11 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <chrono>
 #include <csignal>
+#include <fstream>
+#include <map>
 
 #include <lib/cpp/IniFile.h>
 
@@ -106,6 +110,14 @@ bool Engine::Drain(int max_events)
 		heap.pop();
 		current_frame->in_heap = false;
 
+		// Discard cancelled event
+		if (current_frame->cancelled)
+		{
+			current_frame->cancelled = false;
+			current_frame = nullptr;
+			continue;
+		}
+
 		// Debug
 		Event *event = current_frame->event;
 		FrequencyDomain *frequency_domain = event->getFrequencyDomain();
@@ -121,8 +133,7 @@ bool Engine::Drain(int max_events)
 		num_events++;
 
 		// Run event handler
-		EventHandler event_handler = event->getEventHandler();
-		event_handler(event, current_frame.get());
+		RunEventHandler(event);
 
 		// Free frame
 		current_frame = nullptr;
@@ -156,8 +167,7 @@ void Engine::ProcessEndEvents()
 				event->getName().c_str());
 
 		// Run event handler with null frame
-		EventHandler event_handler = event->getEventHandler();
-		event_handler(event, current_frame.get());
+		RunEventHandler(event);
 
 		// Free frame
 		current_frame = nullptr;
@@ -165,6 +175,25 @@ void Engine::ProcessEndEvents()
 }
 
 
+void Engine::RunEventHandler(Event *event)
+{
+	// Run the handler directly if profiling is not active
+	EventHandler event_handler = event->getEventHandler();
+	if (!profile)
+	{
+		event_handler(event, current_frame.get());
+		return;
+	}
+
+	// Measure the host time of the handler
+	auto start = std::chrono::steady_clock::now();
+	event_handler(event, current_frame.get());
+	auto end = std::chrono::steady_clock::now();
+	event->addExecution(std::chrono::duration_cast<
+			std::chrono::nanoseconds>(end - start).count());
+}
+
+
 Engine *Engine::getInstance()
 {
 	// Instance already exists
@@ -225,8 +254,17 @@ void Engine::ProcessEvents()
 		heap.pop();
 		current_frame->in_heap = false;
 
-		// Debug
+		// Discard cancelled event
 		Event *event = current_frame->event;
+		if (current_frame->cancelled)
+		{
+			event->decInFlight();
+			current_frame->cancelled = false;
+			current_frame = nullptr;
+			continue;
+		}
+
+		// Debug
 		FrequencyDomain *frequency_domain = event->getFrequencyDomain();
 		debug << misc::fmt("[%.2fns] Event '%s/%s' triggered\n",
 				(double) current_time / 1000,
@@ -238,8 +276,7 @@ void Engine::ProcessEvents()
 		event->decInFlight();
 
 		// Run event handler
-		EventHandler event_handler = event->getEventHandler();
-		event_handler(event, current_frame.get());
+		RunEventHandler(event);
 
 		// Reschedule if it is periodic
 		int period = current_frame->period;
@@ -439,6 +476,17 @@ void Engine::Call(Event *event,
 }
 
 
+void Engine::Cancel(Frame *frame)
+{
+	// Stop repetitions, also if the event is currently running
+	frame->period = 0;
+
+	// Mark frame as cancelled if an event is scheduled for it
+	if (frame->in_heap)
+		frame->cancelled = true;
+}
+
+
 void Engine::Return(int after)
 {
 	// This function must be invoked within an event handler
@@ -472,6 +520,103 @@ void Engine::EndEvent(Event *event)
 }
 
 
+void Engine::DumpProfile(std::ostream &os) const
+{
+	// Sort event types by host time, and accumulate totals per frequency
+	// domain. Events with no frequency domain are end events or profile
+	// entries of functional emulators.
+	std::vector<const Event *> sorted_events;
+	std::map<std::string, std::pair<long long, long long>> domains;
+	long long num_executions = 0;
+	long long host_time = 0;
+	for (const Event &event : events)
+	{
+		if (!event.getNumExecutions())
+			continue;
+		sorted_events.push_back(&event);
+		FrequencyDomain *frequency_domain = event.getFrequencyDomain();
+		auto &domain = domains[frequency_domain ?
+				frequency_domain->getName() : "-"];
+		domain.first += event.getNumExecutions();
+		domain.second += event.getHostTime();
+		num_executions += event.getNumExecutions();
+		host_time += event.getHostTime();
+	}
+	std::stable_sort(sorted_events.begin(), sorted_events.end(),
+			[](const Event *a, const Event *b)
+			{
+				return a->getHostTime() > b->getHostTime();
+			});
+
+	// Fraction of the host time of the handlers
+	auto fraction = [host_time](long long time)
+	{
+		return host_time ? (double) time / host_time * 100.0 : 0.0;
+	};
+
+	// General information
+	os << "; Host time spent in event handlers and in the simulation loop\n";
+	os << "; of each architecture, per frequency domain and per event type.\n";
+	os << "; Handlers invoked with Execute() are accounted to the event\n";
+	os << "; that invoked them.\n";
+	os << "\n[ General ]\n";
+	os << misc::fmt("RealTime = %.2f [s]\n", timer.getValue() / 1.0e6);
+	os << misc::fmt("ProfiledTime = %.2f [s]\n", host_time / 1.0e9);
+	os << misc::fmt("Events = %lld\n", num_executions);
+	if (shortest_cycle_time)
+		os << misc::fmt("Cycles = %lld\n", getCycle());
+	os << '\n';
+
+	// Frequency domains
+	os << "[ FrequencyDomains ]\n";
+	os << misc::fmt("; %-28s %14s %12s %8s\n", "Domain", "Events",
+			"Time[ms]", "Time[%]");
+	for (auto &it : domains)
+		os << misc::fmt("%-30s %14lld %12.2f %8.2f\n",
+				it.first.c_str(), it.second.first,
+				it.second.second / 1.0e6,
+				fraction(it.second.second));
+	os << '\n';
+
+	// Event types
+	os << "[ Events ]\n";
+	os << misc::fmt("; %-38s %-16s %14s %12s %8s %10s\n", "Event",
+			"Domain", "Events", "Time[ms]", "Time[%]",
+			"ns/Event");
+	for (const Event *event : sorted_events)
+	{
+		FrequencyDomain *frequency_domain = event->getFrequencyDomain();
+		os << misc::fmt("%-40s %-16s %14lld %12.2f %8.2f %10.1f\n",
+				event->getName().c_str(),
+				frequency_domain ?
+				frequency_domain->getName().c_str() : "-",
+				event->getNumExecutions(),
+				event->getHostTime() / 1.0e6,
+				fraction(event->getHostTime()),
+				(double) event->getHostTime() /
+				event->getNumExecutions());
+	}
+	os << '\n';
+}
+
+
+void Engine::DumpProfile() const
+{
+	// Profiling not active
+	if (profile_path.empty())
+		return;
+
+	// Open file
+	std::ofstream f(profile_path);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot open profile file",
+				profile_path.c_str()));
+
+	// Dump profile
+	DumpProfile(f);
+}
+
+
 void Engine::ProcessAllEvents()
 {
 	// Drain event heap. If the maximum number of finalization events was
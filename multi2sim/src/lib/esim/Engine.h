@@ -132,9 +132,20 @@ class Engine
 	// (1M events).
 	const int max_finalization_events = 1000000;
 
+	// File to dump the profile of event handlers into, or empty if
+	// profiling is disabled
+	std::string profile_path;
+
+	// Whether the host time of event handlers is measured
+	bool profile = false;
+
 	// Signals received from the user are captured by this function
 	static void SignalHandler(int sig);
 
+	// Run the handler of the event of the current frame, measuring its
+	// host time if profiling is enabled
+	void RunEventHandler(Event *event);
+
 	// Drain the event heap, with a maximum number of events specified in
 	// the argument. If this number is exceeded, the function returns true.
 	// If the heap is drained successfully, the function returns false.
@@ -288,6 +299,17 @@ public:
 			EventHandler handler,
 			FrequencyDomain *frequency_domain = nullptr);
 
+	/// Register an entry of the profiler for host time spent outside of
+	/// event handlers, such as the simulation loop of an architecture.
+	/// The returned object is never scheduled. The caller records host
+	/// time with Event::addExecution(), and the entry is reported by
+	/// DumpProfile() next to the event handlers.
+	Event *RegisterProfileEntry(const std::string &name,
+			FrequencyDomain *frequency_domain = nullptr)
+	{
+		return RegisterEvent(name, nullptr, frequency_domain);
+	}
+
 	/// Schedule an event. This function is only used internally and should
 	/// not be invoked from outside of this library. Use Call() or Next()
 	/// instead. See Next() for the meaning of the arguments.
@@ -379,6 +401,13 @@ public:
 			int after = 0,
 			int period = 0);
 
+	/// Cancel the event scheduled for \a frame in the event heap, if any,
+	/// together with its future repetitions if it is periodic. The frame
+	/// is discarded when it reaches the top of the heap, so draining the
+	/// heap at the end of the simulation does not advance the simulation
+	/// time to the cancelled event.
+	void Cancel(Frame *frame);
+
 	/// Schedule the return event specified in the last invocation to
 	/// Call() in argument \a return_event, using the frame that was
 	/// active at that time. This function should only be invoked in the
@@ -403,6 +432,28 @@ public:
 		return current_frame->parent_frame.get();
 	}
 
+	/// Activate the profiler of event handlers, which records the number
+	/// of invocations and the host time spent in the handler of each
+	/// event type. The profile is dumped into \a path with a call to
+	/// DumpProfile() at the end of the simulation. Handlers invoked
+	/// synchronously with Execute() are accounted to their caller.
+	void setProfilePath(const std::string &path)
+	{
+		profile_path = path;
+		profile = !path.empty();
+	}
+
+	/// Return whether the profiler of event handlers is active
+	bool isProfiling() const { return profile; }
+
+	/// Dump the profile of event handlers, with a breakdown per
+	/// frequency domain and per event type sorted by host time.
+	void DumpProfile(std::ostream &os) const;
+
+	/// Dump the profile of event handlers into the file given in
+	/// setProfilePath(), if any.
+	void DumpProfile() const;
+
 	/// Activate debug information for the event-driven simulator.
 	///
 	/// \param path
@@ -54,6 +54,13 @@ class Event
 	// Current number of scheduled events of this type
 	int num_in_flight = 0;
 
+	// Number of handler invocations recorded by the profiler
+	long long num_executions = 0;
+
+	// Host time in nanoseconds spent in the handler, recorded by the
+	// profiler
+	long long host_time = 0;
+
 public:
 
 	/// Constructor
@@ -89,6 +96,21 @@ public:
 
 	/// Decrease the number of in-flight events of this type by one.
 	void decInFlight() { num_in_flight--; }
+
+	/// Record an invocation of the event handler that took \a time
+	/// nanoseconds of host time. Invoked by the engine when profiling.
+	void addExecution(long long time)
+	{
+		num_executions++;
+		host_time += time;
+	}
+
+	/// Return the number of handler invocations recorded by the profiler
+	long long getNumExecutions() const { return num_executions; }
+
+	/// Return the host time in nanoseconds spent in the event handler, as
+	/// recorded by the profiler
+	long long getHostTime() const { return host_time; }
 };
 
 }  // namespace esim
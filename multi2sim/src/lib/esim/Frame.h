@@ -63,6 +63,12 @@ class Frame
 	// heap of the simulation engine
 	bool in_heap = false;
 
+	// Flag indicating whether the event scheduled for this frame in the
+	// event heap was cancelled with Engine::Cancel(). Cancelled frames are
+	// discarded when extracted from the heap, without running the handler
+	// or advancing the simulation time.
+	bool cancelled = false;
+
 	// Parent frame is this event was invoked as a call
 	std::shared_ptr<Frame> parent_frame;
 
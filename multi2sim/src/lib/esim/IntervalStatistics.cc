@@ -0,0 +1,222 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
+
+#include "Engine.h"
+#include "IntervalStatistics.h"
+
+
+namespace esim
+{
+
+std::unique_ptr<IntervalStatistics> IntervalStatistics::instance;
+
+
+IntervalStatistics *IntervalStatistics::getInstance()
+{
+	// Instance already exists
+	if (instance.get())
+		return instance.get();
+
+	// Create instance
+	instance.reset(new IntervalStatistics());
+	return instance.get();
+}
+
+
+void IntervalStatistics::setPath(const std::string &path)
+{
+	// Open file
+	f.open(path);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot open interval statistics "
+				"file", path.c_str()));
+
+	// Activate
+	this->path = path;
+	active = true;
+}
+
+
+void IntervalStatistics::setInterval(int interval)
+{
+	// Check value
+	if (interval < 1)
+		throw Error(misc::fmt("Invalid interval for statistics "
+				"(%d cycles)", interval));
+
+	// Save it
+	this->interval = interval;
+}
+
+
+void IntervalStatistics::AddColumn(const std::string &name,
+		ColumnKind kind,
+		std::function<double()> numerator,
+		std::function<double()> denominator)
+{
+	// Columns cannot be added once the header was written
+	if (started)
+		throw misc::Panic(misc::fmt("%s: Interval statistics column "
+				"registered after the simulation started",
+				name.c_str()));
+
+	// Add column with the current values as the start of the first
+	// interval
+	columns.emplace_back();
+	Column &column = columns.back();
+	column.name = name;
+	column.kind = kind;
+	column.numerator = numerator;
+	column.denominator = denominator;
+	if (kind != ColumnGauge)
+		column.last_numerator = numerator();
+	if (kind == ColumnRatio)
+		column.last_denominator = denominator();
+}
+
+
+void IntervalStatistics::RegisterCounter(const std::string &name,
+		std::function<double()> counter)
+{
+	AddColumn(name, ColumnCounter, counter, nullptr);
+}
+
+
+void IntervalStatistics::RegisterRatio(const std::string &name,
+		std::function<double()> numerator,
+		std::function<double()> denominator)
+{
+	AddColumn(name, ColumnRatio, numerator, denominator);
+}
+
+
+void IntervalStatistics::RegisterGauge(const std::string &name,
+		std::function<double()> gauge)
+{
+	AddColumn(name, ColumnGauge, gauge, nullptr);
+}
+
+
+void IntervalStatistics::Start()
+{
+	// Nothing to do if not active, or already started
+	if (!active || started)
+		return;
+	started = true;
+
+	// Header
+	f << "Cycle";
+	for (auto &column : columns)
+		f << ',' << column.name;
+	f << '\n';
+
+	// Nothing to sample if no timing model is active
+	if (columns.empty())
+		return;
+
+	// Sample in a frequency domain as fast as the fastest one, so that
+	// intervals are measured in global cycles
+	Engine *engine = Engine::getInstance();
+	FrequencyDomain *frequency_domain = engine->RegisterFrequencyDomain(
+			"IntervalStatistics", engine->getFrequency());
+	event = engine->RegisterEvent("interval_statistics", SampleHandler,
+			frequency_domain);
+	last_cycle = engine->getCycle() - 1;
+	frame = misc::new_shared<Frame>();
+	engine->Call(event, frame, nullptr, interval, interval);
+}
+
+
+void IntervalStatistics::Sample(long long cycle)
+{
+	// Cycle
+	f << cycle;
+	last_cycle = cycle;
+
+	// Columns
+	for (auto &column : columns)
+	{
+		double value = column.numerator();
+		if (column.kind == ColumnGauge)
+		{
+			f << ',' << misc::fmt("%.6g", value);
+			continue;
+		}
+
+		// Increase of the counter in the interval
+		double delta = value - column.last_numerator;
+		column.last_numerator = value;
+		if (column.kind == ColumnCounter)
+		{
+			f << ',' << misc::fmt("%.6g", delta);
+			continue;
+		}
+
+		// Ratio of the increases
+		double denominator = column.denominator();
+		double delta_denominator = denominator -
+				column.last_denominator;
+		column.last_denominator = denominator;
+		f << ',' << misc::fmt("%.6g", delta_denominator ?
+				delta / delta_denominator : 0.0);
+	}
+	f << '\n';
+}
+
+
+void IntervalStatistics::SampleHandler(Event *event, Frame *frame)
+{
+	// Events drained after the simulation finished are not sampled,
+	// since the simulated time jumps to the time of each event
+	Engine *engine = Engine::getInstance();
+	if (engine->hasFinished())
+		return;
+
+	// Sample the interval ending in the last cycle
+	IntervalStatistics *interval_statistics = getInstance();
+	interval_statistics->Sample(engine->getCycle() - 1);
+}
+
+
+void IntervalStatistics::Finish()
+{
+	// Nothing to do if not started
+	if (!started || !f.is_open())
+		return;
+
+	// Last interval, and cancel the periodic event
+	if (event)
+	{
+		Engine *engine = Engine::getInstance();
+		long long cycle = engine->getCycle() - 1;
+		if (cycle > last_cycle)
+			Sample(cycle);
+		engine->Cancel(frame.get());
+	}
+
+	// Close file
+	f.close();
+}
+
+
+}  // namespace esim
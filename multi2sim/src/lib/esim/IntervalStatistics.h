@@ -0,0 +1,175 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_ESIM_INTERVAL_STATISTICS_H
+#define LIB_CPP_ESIM_INTERVAL_STATISTICS_H
+
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace esim
+{
+
+// Forward declarations
+class Event;
+class Frame;
+
+
+/// Time series of statistics sampled at fixed intervals of simulated cycles.
+/// Timing models register columns while they are created, and a periodic
+/// event samples all columns every interval, writing one line per interval
+/// into a CSV file. The first column of each line is the last cycle of the
+/// interval, in the fastest frequency domain.
+class IntervalStatistics
+{
+	// Kinds of columns
+	enum ColumnKind
+	{
+		ColumnCounter,
+		ColumnRatio,
+		ColumnGauge
+	};
+
+	// Column of the time series
+	struct Column
+	{
+		// Name in the header of the file
+		std::string name;
+
+		// Kind of column
+		ColumnKind kind;
+
+		// Functions returning the current value of the counter or
+		// gauge, or the numerator and denominator of a ratio
+		std::function<double()> numerator;
+		std::function<double()> denominator;
+
+		// Values of the numerator and denominator at the end of the
+		// last interval
+		double last_numerator = 0.0;
+		double last_denominator = 0.0;
+	};
+
+	// Unique instance
+	static std::unique_ptr<IntervalStatistics> instance;
+
+	// Path of the output file
+	std::string path;
+
+	// Flag indicating whether the interval statistics are active
+	bool active = false;
+
+	// Number of cycles in each interval
+	int interval = 10000;
+
+	// Output file
+	std::ofstream f;
+
+	// Registered columns
+	std::vector<Column> columns;
+
+	// Event sampling the columns
+	Event *event = nullptr;
+
+	// Frame of the periodic event, cancelled when the simulation finishes
+	std::shared_ptr<Frame> frame;
+
+	// Whether the header of the file has been written
+	bool started = false;
+
+	// Last cycle of the last interval written
+	long long last_cycle = 0;
+
+	// Add a column
+	void AddColumn(const std::string &name, ColumnKind kind,
+			std::function<double()> numerator,
+			std::function<double()> denominator);
+
+	// Write one line of the time series for the interval ending in the
+	// given cycle
+	void Sample(long long cycle);
+
+	// Event handler sampling the columns
+	static void SampleHandler(Event *event, Frame *frame);
+
+public:
+
+	/// Return the unique instance
+	static IntervalStatistics *getInstance();
+
+	/// Destroy the unique instance, if allocated
+	static void Destroy() { instance = nullptr; }
+
+	/// Activate the interval statistics and set the path of the output
+	/// file.
+	void setPath(const std::string &path);
+
+	/// Set the number of cycles of each interval
+	void setInterval(int interval);
+
+	/// Return the number of cycles of each interval
+	int getInterval() const { return interval; }
+
+	/// Return whether the interval statistics were activated by the user.
+	/// Timing models only register columns if this is the case.
+	bool isActive() const { return active; }
+
+	/// Return the number of registered columns, not counting the cycle
+	int getNumColumns() const { return columns.size(); }
+
+	/// Register a column with the increase of a monotonic counter in each
+	/// interval.
+	void RegisterCounter(const std::string &name,
+			std::function<double()> counter);
+
+	/// Register a column with the ratio between the increases of two
+	/// monotonic counters in each interval, such as the instructions per
+	/// cycle or the miss rate. Intervals where the denominator does not
+	/// increase show a value of 0.
+	void RegisterRatio(const std::string &name,
+			std::function<double()> numerator,
+			std::function<double()> denominator);
+
+	/// Register a column with the value of a quantity at the end of each
+	/// interval, such as an occupancy or a simulation phase.
+	void RegisterGauge(const std::string &name,
+			std::function<double()> gauge);
+
+	/// Write the header of the file, and schedule the periodic event
+	/// sampling the columns. This function must be invoked once all
+	/// timing models have registered their columns and frequency domains,
+	/// before the simulation starts.
+	void Start();
+
+	/// Write the last, possibly shorter, interval, cancel the periodic
+	/// event, and close the file. This function must be invoked when the
+	/// simulation finishes, before the remaining events are drained, so
+	/// that draining does not advance the simulation time to the next
+	/// sampling point.
+	void Finish();
+};
+
+
+}  // namespace esim
+
+#endif
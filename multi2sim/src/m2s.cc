@@ -18,6 +18,7 @@
  */
 
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <sys/time.h>
 
@@ -51,9 +52,11 @@
 #include <lib/cpp/CommandLine.h>
 #include <lib/cpp/Environment.h>
 #include <lib/cpp/IniFile.h>
+#include <lib/cpp/Json.h>
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/Terminal.h>
 #include <lib/esim/Engine.h>
+#include <lib/esim/IntervalStatistics.h>
 #include <lib/esim/Trace.h>
 
 extern "C"
@@ -73,12 +76,24 @@ std::string m2s_cuda_debug;
 // Event-driven simulator debugger
 std::string m2s_debug_esim;
 
+// Profile of event handlers
+std::string m2s_esim_profile;
+
 // Inifile debugger
 std::string m2s_debug_inifile;
 
 // Call stack debugger
 std::string m2s_debug_callstack;
 
+// Interval statistics file
+std::string m2s_interval_stats_file;
+
+// Cycles in each interval of the interval statistics
+int m2s_interval_stats_period = 10000;
+
+// JSON report file
+std::string m2s_json_report;
+
 // Maximum simulation time
 long long m2s_max_time = 0;
 
@@ -193,6 +208,11 @@ void LoadProgram(const std::vector<std::string> &arguments,
 // Load programs from context configuration file
 void LoadPrograms()
 {
+	// Restore x86 checkpoint
+	const std::string &x86_checkpoint = x86::Emulator::getLoadCheckpointFile();
+	if (!x86_checkpoint.empty())
+		x86::Emulator::getInstance()->LoadCheckpoint(x86_checkpoint);
+
 	// Load command-line program
 	misc::CommandLine *command_line = misc::CommandLine::getInstance();
 	LoadProgram(command_line->getArguments());
@@ -285,6 +305,19 @@ void RegisterOptions()
 			m2s_debug_esim,
 			"Dump debug information related with the event-driven "
 			"simulation engine.");
+
+	// Profiler for event-driven simulator
+	command_line->RegisterString("--esim-profile <file>",
+			m2s_esim_profile,
+			"Measure the number of invocations and the host time "
+			"spent in the handler of each event type of the "
+			"event-driven simulation engine, as well as in the "
+			"emulator or timing simulator loop of each "
+			"architecture, and dump a report "
+			"into <file> at the end of the simulation, sorted by "
+			"host time and broken down per frequency domain. Use "
+			"it to find out which timing model a slow simulation "
+			"spends its time in.");
 	
 	// Debugger for Inifile parser
 	command_line->RegisterString("--inifile-debug <file>",
@@ -292,6 +325,39 @@ void RegisterOptions()
 			"Dump debug information about all processed INI files "
 			"into the specified path.");
 	
+	// Interval statistics
+	command_line->RegisterString("--interval-stats <file>",
+			m2s_interval_stats_file,
+			"Sample statistics of the timing models at fixed "
+			"intervals of simulated cycles, and dump them as a "
+			"time series into <file> in CSV format, with one line "
+			"per interval. Columns include the IPC of x86 cores "
+			"and SI compute units, the miss rate of caches, and "
+			"the bandwidth of networks and DRAM controllers. Use "
+			"option '--interval-stats-period' to set the length of "
+			"the intervals.");
+
+	// Interval statistics period
+	command_line->RegisterInt32("--interval-stats-period <cycles> "
+			"(default = 10000)",
+			m2s_interval_stats_period,
+			"Number of cycles of each interval of the statistics "
+			"dumped with option '--interval-stats', in the fastest "
+			"frequency domain.");
+	
+	// JSON report
+	command_line->RegisterString("--json-report <file>",
+			m2s_json_report,
+			"Dump the statistics of all active timing models into "
+			"<file> at the end of the simulation, as a single JSON "
+			"document with sections for the architectures, the "
+			"memory hierarchy, and the networks. Besides the main "
+			"counters of the text reports, it includes histograms "
+			"with logarithmic buckets and percentiles of the "
+			"latency of memory accesses in each module, messages "
+			"in each network, and uops in each Southern Islands "
+			"compute unit.");
+
 	// Maximum simulation time
 	command_line->RegisterInt64("--max-time <time> (default = 0)",
 			m2s_max_time,
@@ -388,6 +454,10 @@ void ProcessOptions()
 	if (!m2s_debug_esim.empty())
 		esim::Engine::setDebugPath(m2s_debug_esim);
 
+	// Event-driven simulator profiler
+	if (!m2s_esim_profile.empty())
+		esim::Engine::getInstance()->setProfilePath(m2s_esim_profile);
+
 	// Inifile debugger
 	if (!m2s_debug_inifile.empty())
 		misc::IniFile::setDebugPath(m2s_debug_inifile);
@@ -404,6 +474,16 @@ void ProcessOptions()
 	if (!m2s_opencl_binary.empty())
 		environment->addVariable("M2S_OPENCL_BINARY", m2s_opencl_binary);
 
+	// Interval statistics. Activate them before the timing models
+	// are created, so that they register their columns.
+	if (!m2s_interval_stats_file.empty())
+	{
+		esim::IntervalStatistics *interval_statistics =
+				esim::IntervalStatistics::getInstance();
+		interval_statistics->setInterval(m2s_interval_stats_period);
+		interval_statistics->setPath(m2s_interval_stats_file);
+	}
+
 	// Trace file
 	if (!m2s_trace_file.empty())
 	{
@@ -496,6 +576,9 @@ void MainLoop()
 			esim->Finish("MaxTime");
 	}
 
+	// Last interval of the interval statistics
+	esim::IntervalStatistics::getInstance()->Finish();
+
 	// Process all remaining events
 	esim->ProcessAllEvents();
 
@@ -548,12 +631,79 @@ void DumpStatisticsSummary(std::ostream &os = std::cerr)
 	misc::Terminal::Reset(os);
 }
 
+void DumpJsonReport()
+{
+	// Ignore if no report file was specified
+	if (m2s_json_report.empty())
+		return;
+
+	// Open file
+	std::ofstream f(m2s_json_report);
+	if (!f)
+		throw misc::Error(misc::fmt("%s: Cannot open JSON report",
+				m2s_json_report.c_str()));
+
+	// Root object
+	misc::JsonWriter json(f);
+	json.BeginObject();
+
+	// General statistics
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	json.Key("General");
+	json.BeginObject();
+	json.Member("Version", VERSION);
+	json.Member("RealTime", (double) esim_engine->getRealTime() / 1.0e6);
+	json.Member("SimEnd", esim_engine->getFinishReason());
+	if (esim_engine->getTime())
+	{
+		json.Member("SimTime", esim_engine->getTime() / 1000.0);
+		json.Member("Frequency", esim_engine->getFrequency());
+		json.Member("Cycles", esim_engine->getCycle());
+	}
+	json.EndObject();
+
+	// Architectures with a timing simulation
+	json.Key("Architectures");
+	json.BeginObject();
+	comm::ArchPool::getInstance()->DumpJsonReports(json);
+	json.EndObject();
+
+	// Memory hierarchy
+	if (mem::System::hasInstance())
+	{
+		json.Key("Memory");
+		json.BeginObject();
+		mem::System::getInstance()->DumpJsonReport(json);
+		json.EndObject();
+	}
+
+	// External networks
+	if (net::System::hasInstance())
+	{
+		json.Key("Networks");
+		json.BeginObject();
+		net::System::getInstance()->DumpJsonReport(json);
+		json.EndObject();
+	}
+
+	// End of document
+	json.EndObject();
+	json.End();
+}
+
+
 void DumpReports()
 {
 	// Reports for all architectures
 	comm::ArchPool *arch_pool = comm::ArchPool::getInstance();
 	arch_pool->DumpReports();
 
+	// Profile of the event-driven simulation
+	esim::Engine::getInstance()->DumpProfile();
+
+	// Statistics of all timing models in JSON format
+	DumpJsonReport();
+
 	// Dumping memory report
 	if (mem::System::hasInstance())
 	{
@@ -659,19 +809,21 @@ int MainProgram(int argc, char **argv)
 
 	// Initialize network system, only if the option --net-sim is used
 	if (net::System::isStandAlone())
-	{
-		net::System *net_system = net::System::getInstance();
-		net_system->ReadConfiguration();
-		net_system->StandAlone();
-	}
+		net::System::getInstance()->ReadConfiguration();
 
 	// Initialize dram system, only if the option --dram-sim is used
 	if (dram::System::isStandAlone())
-	{
-		dram::System *dram_system = dram::System::getInstance();
-		dram_system->ReadConfiguration();
-		dram_system->Run();
-	}
+		dram::System::getInstance()->ReadConfiguration();
+
+	// Start sampling interval statistics, once all timing models have
+	// registered their columns
+	esim::IntervalStatistics::getInstance()->Start();
+
+	// Stand-alone network and dram simulations
+	if (net::System::isStandAlone())
+		net::System::getInstance()->StandAlone();
+	if (dram::System::isStandAlone())
+		dram::System::getInstance()->Run();
 
 	// Register drivers and runtimes
 	RegisterDrivers();
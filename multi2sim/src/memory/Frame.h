@@ -114,6 +114,10 @@ public:
 	/// Type of memory access
 	Module::AccessType access_type = Module::AccessInvalid;
 
+	/// Cycle in the memory frequency domain when the access started in
+	/// the module, used to compute its latency, or -1 if not set yet.
+	long long start_cycle = -1;
+
 	/// If true, this access has been coalesced with another access.
 	bool coalesced = false;
 
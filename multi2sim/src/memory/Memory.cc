@@ -21,6 +21,8 @@
 #include <cassert>
 #include <cstring>
 #include <fstream>
+#include <vector>
+#include <zlib.h>
 
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/String.h>
@@ -160,7 +162,7 @@ char *Memory::getBuffer(unsigned address, unsigned size, AccessType access)
 
 
 void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
-		char *buffer, AccessType access)
+		char *buffer, AccessType access, bool safe)
 {
 	// Find memory page and compute offset.
 	Page *page = getPage(address);
@@ -223,12 +225,27 @@ void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
 void Memory::Access(unsigned address, unsigned size, char *buf,
 			AccessType access)
 {
-	last_address = address;
 	while (size)
 	{
 		unsigned offset = address & (PageSize - 1);
 		int chunksize = std::min(size, PageSize - offset);
-		AccessAtPageBoundary(address, chunksize, buf, access);
+		AccessAtPageBoundary(address, chunksize, buf, access, safe);
+
+		size -= chunksize;
+		buf += chunksize;
+		address += chunksize;
+	}
+}
+
+
+void Memory::AccessUnsafe(unsigned address, unsigned size, char *buf,
+			AccessType access)
+{
+	while (size)
+	{
+		unsigned offset = address & (PageSize - 1);
+		int chunksize = std::min(size, PageSize - offset);
+		AccessAtPageBoundary(address, chunksize, buf, access, false);
 
 		size -= chunksize;
 		buf += chunksize;
@@ -474,6 +491,109 @@ void Memory::Load(const std::string &path, unsigned start)
 }
 
 
+void Memory::SaveCheckpoint(std::ostream &os) const
+{
+	// Sort pages by tag, so that the same image always produces the same
+	// checkpoint
+	std::vector<Page *> sorted_pages;
+	for (auto &it : pages)
+		sorted_pages.push_back(it.second.get());
+	std::sort(sorted_pages.begin(), sorted_pages.end(),
+			[](Page *a, Page *b) { return a->getTag() < b->getTag(); });
+
+	// Header
+	unsigned num_pages = sorted_pages.size();
+	os.write((const char *) &heap_break, sizeof heap_break);
+	os.write((const char *) &num_pages, sizeof num_pages);
+
+	// Pages
+	static const char zero_page[PageSize] = { };
+	uLongf max_size = compressBound(PageSize);
+	auto compressed = misc::new_unique_array<Bytef>(max_size);
+	for (Page *page : sorted_pages)
+	{
+		// Size of the stored content. A size of 0 means that the page
+		// reads as zeros, and a size of PageSize means that the content
+		// is stored uncompressed, since compression did not help.
+		const char *data = page->getData();
+		unsigned size = 0;
+		uLongf compressed_size = max_size;
+		if (data && memcmp(data, zero_page, PageSize))
+		{
+			if (compress2(compressed.get(), &compressed_size,
+					(const Bytef *) data, PageSize,
+					Z_BEST_SPEED) != Z_OK)
+				throw Error(misc::fmt("[0x%x] Cannot compress "
+						"page", page->getTag()));
+			size = std::min((unsigned) compressed_size, PageSize);
+		}
+
+		// Dump page
+		unsigned tag = page->getTag();
+		unsigned perm = page->getPerm();
+		os.write((const char *) &tag, sizeof tag);
+		os.write((const char *) &perm, sizeof perm);
+		os.write((const char *) &size, sizeof size);
+		if (size == PageSize)
+			os.write(data, PageSize);
+		else if (size)
+			os.write((const char *) compressed.get(), size);
+	}
+}
+
+
+const char *Memory::LoadCheckpoint(const char *buffer, const char *end)
+{
+	// Read a 32-bit field from the buffer
+	auto read_field = [&buffer, end]() -> unsigned
+	{
+		unsigned value;
+		if (end - buffer < (long) sizeof value)
+			throw Error("Truncated memory image in checkpoint");
+		memcpy(&value, buffer, sizeof value);
+		buffer += sizeof value;
+		return value;
+	};
+
+	// Header
+	Clear();
+	heap_break = read_field();
+	unsigned num_pages = read_field();
+
+	// Pages
+	for (unsigned i = 0; i < num_pages; i++)
+	{
+		unsigned tag = read_field();
+		unsigned perm = read_field();
+		unsigned size = read_field();
+		if (tag & ~PageMask || size > PageSize
+				|| end - buffer < (long) size)
+			throw Error("Corrupt memory image in checkpoint");
+
+		// Create page. Pages stored without content read as zeros and
+		// are left without data.
+		Page *page = newPage(tag, perm);
+		if (!size)
+			continue;
+
+		// Uncompress content
+		page->AllocateData();
+		uLongf data_size = PageSize;
+		if (size == PageSize)
+			memcpy(page->getData(), buffer, PageSize);
+		else if (uncompress((Bytef *) page->getData(), &data_size,
+				(const Bytef *) buffer, size) != Z_OK
+				|| data_size != PageSize)
+			throw Error(misc::fmt("[0x%x] Corrupt page in checkpoint",
+					tag));
+		buffer += size;
+	}
+
+	// Return position after the image
+	return buffer;
+}
+
+
 void Memory::Clone(const Memory &memory)
 {
 	// Clear destination memory
@@ -20,6 +20,7 @@
 #ifndef MEMORY_MEMORY_H
 #define MEMORY_MEMORY_H
 
+#include <atomic>
 #include <cassert>
 #include <iostream>
 #include <memory>
@@ -77,11 +78,12 @@ public:
 		// in the page.
 		unsigned tag;
 
-		// Page permissions
-		unsigned perm;
+		// Page permissions. Permissions and data are atomic, since
+		// contexts sharing the memory can access the page concurrently.
+		std::atomic<unsigned> perm;
 
-		// The page data
-		std::unique_ptr<char[]> data;
+		// The page data, allocated on first access
+		std::atomic<char *> data{nullptr};
 	
 	public:
 
@@ -93,6 +95,9 @@ public:
 			assert((tag & (PageSize - 1)) == 0);
 		}
 
+		/// Destructor
+		~Page() { delete[] data.load(); }
+
 		/// Return the page tag, equal to the address of the first byte
 		/// contained in the page.
 		unsigned getTag() const { return tag; }
@@ -103,14 +108,20 @@ public:
 
 		/// Return a pointer to the page data, or `nullptr` if the data
 		/// was not allocated.
-		char *getData() { return data.get(); }
+		char *getData() { return data.load(std::memory_order_acquire); }
 
 		/// Allocate the page data. If the data buffer was allocated
 		/// before, this call is ignored.
 		void AllocateData()
 		{
-			if (data == nullptr)
-				data = misc::new_unique_array<char>(PageSize);
+			if (getData())
+				return;
+
+			// Keep the buffer allocated first by a concurrent call
+			char *buffer = new char[PageSize]();
+			char *expected = nullptr;
+			if (!data.compare_exchange_strong(expected, buffer))
+				delete[] buffer;
 		}
 
 		/// Set the page permissions, given as a bitmap of flags of
@@ -119,7 +130,11 @@ public:
 
 		/// Add a flag to the page permissions, given as a bitmap of
 		/// flags of type AccessType.
-		void addPerm(unsigned perm) { this->perm |= perm; }
+		void addPerm(unsigned perm)
+		{
+			if ((this->perm & perm) != perm)
+				this->perm |= perm;
+		}
 	};
 
 private:
@@ -137,16 +152,14 @@ private:
 	/// Heap break for CPU contexts
 	unsigned heap_break = 0;
 
-	/// Last accessed address
-	unsigned last_address = 0;
-
 	/// Create a new page and add it to the page table. The value given in
 	/// \a perm is an *or*'ed bitmap of AccessType flags.
 	Page *newPage(unsigned address, unsigned perm);
 
-	// Access memory without exceeding page boundaries
+	// Access memory without exceeding page boundaries. Permissions are
+	// checked if 'safe' is true.
 	void AccessAtPageBoundary(unsigned address, unsigned size, char *buffer,
-			AccessType access);
+			AccessType access, bool safe);
 
 public:
 
@@ -297,6 +310,12 @@ public:
 	void Access(unsigned address, unsigned size, char *buffer,
 			AccessType access);
 
+	/// Access memory as in Access(), but in unsafe mode regardless of the
+	/// current mode. Unlike a call to setSafe(), this does not affect
+	/// other contexts accessing the memory concurrently.
+	void AccessUnsafe(unsigned address, unsigned size, char *buffer,
+			AccessType access);
+
 	/// Read from memory, with no alignment or size restrictions.
 	///
 	/// \param address
@@ -433,6 +452,31 @@ public:
 	///	A Memory::Error is thrown if file \a path cannot be accessed.
 	void Load(const std::string &path, unsigned start);
 
+	/// Write all pages of the memory image and the heap break into an
+	/// output stream. The content of each page is compressed with zlib.
+	/// Pages without data or filled with zeros are stored without content.
+	///
+	/// \throw
+	///	A Memory::Error is thrown if the page content cannot be
+	///	compressed.
+	void SaveCheckpoint(std::ostream &os) const;
+
+	/// Replace the memory image with one saved with SaveCheckpoint(),
+	/// read from a buffer, typically a memory-mapped checkpoint file.
+	///
+	/// \param buffer
+	///	Position in the buffer where the memory image starts
+	///
+	/// \param end
+	///	Past-the-end position of the buffer
+	///
+	/// \return
+	///	Position in the buffer right after the memory image
+	///
+	/// \throw
+	///	A Memory::Error is thrown if the image is truncated or corrupt.
+	const char *LoadCheckpoint(const char *buffer, const char *end);
+
 	/// Set a new value for the heap break.
 	void setHeapBreak(unsigned heap_break) { this->heap_break = heap_break; }
 
@@ -22,6 +22,9 @@
 #include <iostream>
 #include <iomanip>
 
+#include <lib/cpp/Json.h>
+#include <lib/esim/IntervalStatistics.h>
+
 #include "Frame.h"
 #include "Module.h"
 #include "System.h"
@@ -240,8 +243,9 @@ long long Module::Access(AccessType access_type,
 
 void Module::StartAccess(Frame *frame, AccessType access_type)
 {
-	// Record access type
+	// Record access type and start cycle
 	frame->access_type = access_type;
+	frame->start_cycle = System::getInstance()->getCycle();
 
 	// Insert in access list
 	frame->accesses_iterator = accesses.insert(accesses.end(),
@@ -262,8 +266,18 @@ void Module::StartAccess(Frame *frame, AccessType access_type)
 }
 
 
+void Module::RecordLatency(Frame *frame)
+{
+	access_latency.Add(System::getInstance()->getCycle() -
+			frame->start_cycle);
+}
+
+
 void Module::FinishAccess(Frame *frame)
 {
+	// Record latency
+	RecordLatency(frame);
+
 	// Remove from access list
 	accesses.erase(frame->accesses_iterator);
 	frame->accesses_iterator = accesses.end();
@@ -764,6 +778,22 @@ void Module::Dump(std::ostream &os) const
 }
 
 
+void Module::RegisterIntervalStatistics()
+{
+	// Accesses
+	esim::IntervalStatistics *interval_statistics =
+			esim::IntervalStatistics::getInstance();
+	interval_statistics->RegisterCounter("mem." + name + ".Accesses",
+			[this]() { return (double) num_accesses; });
+
+	// Miss rate
+	interval_statistics->RegisterRatio("mem." + name + ".MissRate",
+			[this]() { return (double) (num_accesses -
+					getNumHits()); },
+			[this]() { return (double) num_accesses; });
+}
+
+
 void Module::DumpReport(std::ostream &os) const
 {
 	// Dumping module's name
@@ -795,8 +825,7 @@ void Module::DumpReport(std::ostream &os) const
 	os << misc::fmt("Evictions = %lld\n", num_evictions);
 
 	// Statistics - Hits and misses
-	long long int num_hits = num_read_hits + num_write_hits 
-			+ num_nc_write_hits;
+	long long int num_hits = getNumHits();
 	os << misc::fmt("Hits = %lld\n", num_hits);
 	os << misc::fmt("Misses = %lld\n", num_accesses - num_hits);
 	os << misc::fmt("HitRatio = %.4g\n", num_accesses ? 
@@ -855,7 +884,42 @@ void Module::DumpReport(std::ostream &os) const
 	os << "\n\n";
 }
 
- 
+void Module::DumpJsonReport(misc::JsonWriter &json) const
+{
+	// Module object
+	json.Key(name);
+	json.BeginObject();
+	json.Member("Type", type == TypeCache ? "Cache" : "MainMemory");
+	json.Member("BlockSize", block_size);
+	json.Member("DataLatency", data_latency);
+
+	// Accesses
+	long long num_hits = getNumHits();
+	json.Member("Accesses", num_accesses);
+	json.Member("CoalescedAccesses", num_coalesced_reads +
+			num_coalesced_writes + num_coalesced_nc_writes);
+	json.Member("RetriedAccesses", num_retry_accesses);
+	json.Member("Evictions", num_evictions);
+	json.Member("Hits", num_hits);
+	json.Member("Misses", num_accesses - num_hits);
+	json.Member("HitRatio", num_accesses ?
+			(double) num_hits / num_accesses : 0.0);
+
+	// Breakdown
+	json.Member("Reads", num_reads);
+	json.Member("ReadHits", num_read_hits);
+	json.Member("Writes", num_writes);
+	json.Member("WriteHits", num_write_hits);
+	json.Member("NCWrites", num_nc_writes);
+	json.Member("NCWriteHits", num_nc_write_hits);
+
+	// Latency
+	json.Key("AccessLatency");
+	access_latency.DumpJson(json);
+	json.EndObject();
+}
+
+
 void Module::DumpInFlightAddresses(std::ostream &os)
 {
 	esim::Engine *engine = esim::Engine::getInstance();
@@ -25,6 +25,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include <lib/cpp/Histogram.h>
 #include <lib/cpp/Misc.h>
 #include <lib/esim/Engine.h>
 #include <lib/esim/Queue.h>
@@ -268,6 +269,12 @@ private:
 
 	long long num_conflict_invalidations = 0;
 
+	// Latency of accesses, in memory cycles. For accesses started in
+	// this module, it goes from their start to their completion. For
+	// requests from a higher-level module, it goes from the moment the
+	// request is sent until the reply is received.
+	misc::Histogram access_latency;
+
 public:
 	
 	// Statistics for up-down accesses
@@ -655,6 +662,10 @@ public:
 	/// handlers of the first NMOESI event for an access.
 	void StartAccess(Frame *frame, AccessType access_type);
 
+	/// Record the latency of an access or request served by this module,
+	/// from the start cycle recorded in \a frame until the current cycle.
+	void RecordLatency(Frame *frame);
+
 	/// Remove the given frame from the list of in-flight accesses. This
 	/// function is invoked internally by the event handler of the last
 	/// NMOESI event for an access.
@@ -689,9 +700,17 @@ public:
 	/// Dump the module information.
 	void Dump(std::ostream &os = std::cout) const;
 
+	/// Register the accesses and the miss rate of the module in the
+	/// interval statistics.
+	void RegisterIntervalStatistics();
+
 	/// Dump the module report.
 	void DumpReport(std::ostream &os = std::cout) const;
 
+	/// Dump the module statistics as a member of the current JSON object,
+	/// including the histogram of access latencies.
+	void DumpJsonReport(misc::JsonWriter &json) const;
+
 	/// Check if an access to a module can be coalesced with another access
 	/// older than 'older_than_frame'. If 'older_than_frame' is nullptr,
 	/// check if it can be coalesced with any in-flight access. If it can,
@@ -795,6 +814,21 @@ public:
 	/// Increment number of accesses
 	void incAccesses() { num_accesses++; }
 
+	/// Return the number of accesses
+	long long getNumAccesses() const { return num_accesses; }
+
+	/// Return the number of read, write, and non-coherent write hits
+	long long getNumHits() const
+	{
+		return num_read_hits + num_write_hits + num_nc_write_hits;
+	}
+
+	/// Return the histogram of access latencies, in memory cycles
+	const misc::Histogram &getAccessLatency() const
+	{
+		return access_latency;
+	}
+
 	/// Increment number of retried accesses
 	void incRetryAccesses() { num_retry_accesses++; }
 
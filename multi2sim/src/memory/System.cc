@@ -403,6 +403,24 @@ void System::DumpReport(std::ostream &os) const
 }
 
 
+void System::DumpJsonReport(misc::JsonWriter &json) const
+{
+	// Modules
+	json.Key("Modules");
+	json.BeginObject();
+	for (auto &module : modules)
+		module->DumpJsonReport(json);
+	json.EndObject();
+
+	// Internal networks
+	json.Key("Networks");
+	json.BeginObject();
+	for (auto &network : networks)
+		network->DumpJsonReport(json);
+	json.EndObject();
+}
+
+
 void System::SanityCheck()
 {
 	//
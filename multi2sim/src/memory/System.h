@@ -29,6 +29,7 @@
 #include <lib/esim/FrequencyDomain.h>
 #include <lib/esim/Trace.h>
 #include <lib/cpp/IniFile.h>
+#include <lib/cpp/Json.h>
 #include <network/Network.h>
 #include <network/Node.h>
 
@@ -289,6 +290,12 @@ public:
 
 	/// Destroy the singleton if allocated.
 	static void Destroy() { instance = nullptr; }
+
+	/// Return the current cycle in the memory frequency domain
+	long long getCycle() const
+	{
+		return frequency_domain->getCycle();
+	}
 	
 
 
@@ -413,6 +420,10 @@ public:
 	/// Dump function for report
 	void DumpReport(std::ostream &os = std::cout) const;
 
+	/// Dump the statistics of all modules and internal networks as
+	/// members `Modules` and `Networks` of the current JSON object.
+	void DumpJsonReport(misc::JsonWriter &json) const;
+
 };
 
 }  // namespace mem
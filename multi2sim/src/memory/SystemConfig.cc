@@ -20,6 +20,7 @@
 #include <arch/common/Arch.h>
 #include <arch/common/Timing.h>
 #include <lib/esim/Engine.h>
+#include <lib/esim/IntervalStatistics.h>
 #include <network/EndNode.h>
 #include <network/Node.h>
 #include <network/Switch.h>
@@ -183,6 +184,8 @@ const std::string System::help_message =
 	"      Size of output buffers for end nodes and switch. \n"
 	"  DefaultBandwidth = <bandwidth>\n"
 	"      Bandwidth for links and switch crossbar in number of bytes per cycle.\n"
+	"  Model = {Detailed|Analytical|Wormhole} (Default = Detailed)\n"
+	"      Timing model of the network, as described in option '--net-help'.\n"
 	"\n"
 	"Section [Entry <name>] creates an entry into the memory system. An entry is\n"
 	"a connection between a CPU core/thread or a GPU compute unit with a module\n"
@@ -205,7 +208,12 @@ const std::string System::help_message =
 	"  ConstantDataModule = <mod>\n"
 	"  InstModule = <mod>\n"
 	"      In architectures supporting separate data/instruction caches, modules\n"
-	"      used to access memory for each particular purpose.\n"
+	"      used to access memory for each particular purpose. For Southern\n"
+	"      Islands, 'InstModule' is optional and can be combined with either\n"
+	"      'Module' or 'DataModule' and 'ConstantDataModule'. Instruction\n"
+	"      fetches only go through the memory hierarchy, and contend with\n"
+	"      other accesses, when it is given. Otherwise, they take a fixed\n"
+	"      latency.\n"
 	"  Module = <mod>\n"
 	"      Module used to access the memory hierarchy. For architectures\n"
 	"      supporting separate data/instruction caches, this variable can be used\n"
@@ -310,6 +318,11 @@ void System::ConfigReadNetworks(misc::IniFile *ini_file)
 		// Add pointer
 		ini_file->WritePointer(section, "ptr", network);
 
+		// Timing model
+		network->setModel((net::Network::Model) ini_file->ReadEnum(
+				section, "Model", net::Network::ModelMap,
+				net::Network::ModelDetailed));
+
 		// Check section integrity
 		ini_file->Enforce(section, "DefaultInputBufferSize");
 		ini_file->Enforce(section, "DefaultOutputBufferSize");
@@ -1180,7 +1193,7 @@ void System::ConfigCreateSwitches(misc::IniFile *ini_file)
 		// Calculate routes
 		net::RoutingTable *routing_table = network->getRoutingTable();
 		routing_table->Initialize();
-		routing_table->FloydWarshall();
+		routing_table->ShortestPaths();
 
 		// Debug
 		debug << '\n';
@@ -1218,10 +1231,10 @@ void System::ConfigCheckRoutes(misc::IniFile *ini_file)
 			// Check that there is a route
 			net::Network *network = module->getLowNetwork();
 			net::RoutingTable *routing_table = network->getRoutingTable();
-			net::RoutingTable::Entry *entry = routing_table->Lookup(
+			net::RoutingTable::Entry entry = routing_table->getRoute(
 					module->getLowNetworkNode(),
 					low_module->getHighNetworkNode());
-			if (!entry->getBuffer())
+			if (!entry.getBuffer())
 				throw Error(misc::fmt("%s: %s: network does not "
 						"connect '%s' with '%s'. %s",
 						ini_file->getPath().c_str(),
@@ -1251,10 +1264,10 @@ void System::ConfigCheckRoutes(misc::IniFile *ini_file)
 			// Check that there is a route
 			net::Network *network = module->getHighNetwork();
 			net::RoutingTable *routing_table = network->getRoutingTable();
-			net::RoutingTable::Entry *entry = routing_table->Lookup(
+			net::RoutingTable::Entry entry = routing_table->getRoute(
 					module->getHighNetworkNode(),
 					high_module->getLowNetworkNode());
-			if (!entry->getBuffer())
+			if (!entry.getBuffer())
 				throw Error(misc::fmt("%s: %s: network does not "
 						"connect '%s' with '%s'. %s",
 						ini_file->getPath().c_str(),
@@ -1551,6 +1564,11 @@ void System::ReadConfiguration(misc::IniFile *ini_file)
 	// Compute cache levels relative to the CPU/GPU entry points
 	ConfigCalculateModuleLevels();
 
+	// Interval statistics
+	if (esim::IntervalStatistics::getInstance()->isActive())
+		for (auto &module : modules)
+			module->RegisterIntervalStatistics();
+
 	// Dump configuration to trace file
 	ConfigTrace();
 }
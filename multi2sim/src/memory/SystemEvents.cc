@@ -1955,6 +1955,11 @@ void System::EventWriteRequestHandler(esim::Event *event,
 				frame->getId(),
 				module->getName().c_str());
 
+		// Record the start cycle, unless the message is being sent
+		// again after the network was busy
+		if (frame->start_cycle < 0)
+			frame->start_cycle = System::getInstance()->getCycle();
+
 		// Default return values
 		parent_frame->error = false;
 
@@ -2493,6 +2498,10 @@ void System::EventWriteRequestHandler(esim::Event *event,
 			node = module->getHighNetworkNode();
 		}
 		network->Receive(node, frame->message);
+
+		// Latency of requests served by the lower-level module
+		if (frame->request_direction == Frame::RequestDirectionUpDown)
+			target_module->RecordLatency(frame);
 		
 		// If the write request was generated from a store, we can
 		// be sure that it will complete at this point and so can
@@ -2539,6 +2548,11 @@ void System::EventReadRequestHandler(esim::Event *event,
 				frame->getId(),
 				module->getName().c_str());
 
+		// Record the start cycle, unless the message is being sent
+		// again after the network was busy
+		if (frame->start_cycle < 0)
+			frame->start_cycle = System::getInstance()->getCycle();
+
 		// Default return values
 		parent_frame->shared = false;
 		parent_frame->error = false;
@@ -3260,6 +3274,10 @@ void System::EventReadRequestHandler(esim::Event *event,
 		}
 		network->Receive(node, frame->message);
 
+		// Latency of requests served by the lower-level module
+		if (frame->request_direction == Frame::RequestDirectionUpDown)
+			target_module->RecordLatency(frame);
+
 		// Return
 		esim_engine->Return();
 		return;
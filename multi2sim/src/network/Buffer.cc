@@ -33,7 +33,8 @@ Buffer::Buffer(const std::string &name,
 		name(name),
 		index(index),
 		size(size),
-		connection(connection)
+		connection(connection),
+		packets(std::max(size / MinPacketSize, 1))
 {
 }
 
@@ -51,7 +52,7 @@ void Buffer::InsertPacket(Packet *packet)
 	UpdateOccupancyInformation();
 
 	// Insert the packet into buffer
-	packets.push_back(packet);
+	packets.PushBack(packet);
 
 	// Debug
 	Message *message = packet->getMessage();
@@ -68,7 +69,8 @@ void Buffer::InsertPacket(Packet *packet)
 void Buffer::RemovePacket(Packet *packet)
 {
 	// Check if the packet is in the buffer
-	if (std::find(packets.begin(), packets.end(), packet) == packets.end())
+	int index = packets.Find(packet);
+	if (index < 0)
 		throw misc::Panic("Trying to remove a packet that is not in"
 				" current buffer");
 
@@ -76,7 +78,7 @@ void Buffer::RemovePacket(Packet *packet)
 	count -= packet->getSize();
 
 	// Remove the packet
-	packets.remove(packet);
+	packets.Erase(index);
 
 	// Wake up the buffer event queue
 	if (!event_queue.isEmpty())
@@ -112,7 +114,7 @@ void Buffer::ExtractPacket()
 	Packet *packet = packets.front();
 
 	// Remove the packet from the queue
-	packets.pop_front();
+	packets.PopFront();
 
 	// Updating the statistics
 	UpdateOccupancyInformation();
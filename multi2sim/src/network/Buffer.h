@@ -20,6 +20,7 @@
 #ifndef NETWORK_BUFFER_H
 #define NETWORK_BUFFER_H
 
+#include <lib/cpp/RingBuffer.h>
 #include <lib/esim/Engine.h>
 #include <lib/esim/Event.h>
 #include <lib/esim/Queue.h>
@@ -34,6 +35,9 @@ class Packet;
 
 class Buffer
 {
+	// Smallest packet expected in a buffer, used to size the packet queue
+	// so that it does not need to grow in the common case
+	static const int MinPacketSize = 8;
 
 	// Node that the buffer belongs to
 	Node *node;
@@ -65,8 +69,8 @@ class Buffer
 	// or a bus.
 	Buffer *scheduled_buffer = nullptr;
 
-	// A list of packets in the buffer
-	std::list<Packet *> packets;
+	// Packets in the buffer, in arrival order
+	misc::RingBuffer<Packet *> packets;
 
 
 
@@ -129,9 +129,9 @@ void Bus::TransferPacket(Packet *packet)
 	// Get the next entry in the routing table
 	RoutingTable *routing_table = network->getRoutingTable();
 	Node *destination_node = message->getDestinationNode();
-	RoutingTable::Entry *entry =
-			routing_table->Lookup(node, destination_node);
-	if (!entry)
+	RoutingTable::Entry entry =
+			routing_table->getRoute(node, destination_node);
+	if (!entry.getNextNode())
 		throw misc::Panic(misc::fmt("%s: no route from %s to %s.",
 				network->getName().c_str(),
 				node->getName().c_str(),
@@ -141,7 +141,7 @@ void Bus::TransferPacket(Packet *packet)
 	Buffer *destination_buffer = nullptr;
 	for (Buffer *buffer : destination_buffers)
 	{
-		if (entry->getNextNode() == buffer->getNode())
+		if (entry.getNextNode() == buffer->getNode())
 		{
 			destination_buffer = buffer;
 			break;
@@ -248,6 +248,26 @@ void Bus::TransferPacket(Packet *packet)
 }
 
 
+void Bus::RecordTransfer(Node *source_node, Node *destination_node,
+		int packet_size, int num_packets)
+{
+	// Least used lane
+	Lane *lane = lanes[0].get();
+	for (auto &candidate : lanes)
+		if (candidate->busy_cycles < lane->busy_cycles)
+			lane = candidate.get();
+
+	// Statistics
+	lane->busy_cycles += getTransferLatency(packet_size) * num_packets;
+	lane->transferred_bytes += packet_size * num_packets;
+	lane->transferred_packets += num_packets;
+	source_node->incSentBytes(packet_size * num_packets);
+	source_node->incSentPackets(num_packets);
+	destination_node->incReceivedBytes(packet_size * num_packets);
+	destination_node->incReceivedPackets(num_packets);
+}
+
+
 Buffer *Bus::LaneArbitration(Lane *lane)
 {
 	// Get the current cycle
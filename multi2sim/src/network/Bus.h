@@ -133,6 +133,18 @@ public:
 	/// Transfer the packet from an output buffer
 	void TransferPacket(Packet *packet);
 
+	/// Return the number of cycles a lane of the bus takes to transfer a
+	/// packet
+	int getTransferLatency(int size) const
+	{
+		return (size - 1) / lanes[0]->getBandwidth() + 1;
+	}
+
+	/// Record the transfer of packets estimated by the analytical model,
+	/// assigning them to the least used lane
+	void RecordTransfer(Node *source_node, Node *destination_node,
+			int packet_size, int num_packets);
+
 
 
 
@@ -17,6 +17,9 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "Connection.h"
 #include "Network.h"
 #include "Buffer.h"
@@ -42,5 +45,38 @@ void Connection::addDestinationBuffer(Buffer* buffer)
 	this->destination_buffers.emplace_back(buffer);
 }
 
+
+int Connection::EstimateQueueingDelay(long long cycle, int service_cycles)
+{
+	// Start a new window. The previous window only counts if it ended
+	// right before the new one.
+	long long elapsed = cycle - load_window_start;
+	if (elapsed >= LoadWindowSize)
+	{
+		bool consecutive = elapsed < 2 * LoadWindowSize;
+		load_previous_busy = consecutive ? load_window_busy : 0;
+		load_previous_transfers = consecutive ?
+				load_window_transfers : 0;
+		load_window_start = cycle - elapsed % LoadWindowSize;
+		load_window_busy = 0;
+		load_window_transfers = 0;
+		elapsed = cycle - load_window_start;
+	}
+
+	// Utilization and mean service time
+	long long busy = load_previous_busy + load_window_busy;
+	long long transfers = load_previous_transfers + load_window_transfers;
+	double utilization = std::min(MaxUtilization,
+			(double) busy / (LoadWindowSize + elapsed));
+	double service_time = transfers ? (double) busy / transfers :
+			service_cycles;
+
+	// Add transfer to the load
+	load_window_busy += service_cycles;
+	load_window_transfers++;
+
+	// Waiting time of an M/D/1 queue
+	return lround(utilization * service_time / (2 * (1 - utilization)));
 }
 
+}
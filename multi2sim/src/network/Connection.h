@@ -27,6 +27,7 @@ namespace net
 class Packet;
 class Network;
 class Buffer;
+class Node;
 
 class Connection
 {
@@ -47,8 +48,34 @@ protected:
 	// List of the destination buffers connected to the bus
 	std::vector<Buffer *> destination_buffers;
 
+
+
+
+	//
+	// Load estimation for the analytical network model
+	//
+
+	// First cycle of the current load window
+	long long load_window_start = 0;
+
+	// Busy cycles and transfers in the current window
+	long long load_window_busy = 0;
+	long long load_window_transfers = 0;
+
+	// Busy cycles and transfers in the previous window
+	long long load_previous_busy = 0;
+	long long load_previous_transfers = 0;
+
 public:
 
+	/// Number of cycles of the windows used to estimate the utilization
+	/// of the connection in the analytical network model
+	static const int LoadWindowSize = 1000;
+
+	/// Maximum utilization used in the queueing delay estimate, which
+	/// bounds the delay of a saturated connection
+	static constexpr double MaxUtilization = 0.95;
+
 	/// Constructor
 	Connection(const std::string &name, Network *network);
 
@@ -84,6 +111,23 @@ public:
 
 	/// Transfer the packet 
 	virtual void TransferPacket(Packet *packet) = 0;
+
+	/// Return the number of cycles the connection takes to transfer a
+	/// packet of the given size
+	virtual int getTransferLatency(int size) const = 0;
+
+	/// Record in the statistics of the connection and the given nodes
+	/// the transfer of a number of packets of the given size, as
+	/// estimated by the analytical network model.
+	virtual void RecordTransfer(Node *source_node, Node *destination_node,
+			int packet_size, int num_packets) = 0;
+
+	/// Return the queueing delay estimated for a transfer that occupies
+	/// the connection during `service_cycles` cycles, and add the
+	/// transfer to the load of the connection. The delay is the waiting
+	/// time of an M/D/1 queue, with the utilization and mean service
+	/// time measured over the current and previous load windows.
+	int EstimateQueueingDelay(long long cycle, int service_cycles);
 };
 }
 
@@ -256,7 +256,7 @@ void Link::TransferPacket(Packet *packet)
 	}
 
 	// Calculate latency and occupied resources
-	int latency = (packet->getSize() - 1) / bandwidth + 1;
+	int latency = getTransferLatency(packet->getSize());
 	source_buffer->read_busy = cycle + latency - 1;
 	busy = cycle + latency - 1;
 	destination_buffer->write_busy = cycle + latency - 1;
@@ -303,6 +303,19 @@ void Link::TransferPacket(Packet *packet)
 	esim_engine->Next(System::event_input_buffer, latency);
 }
 
+void Link::RecordTransfer(Node *source_node, Node *destination_node,
+		int packet_size, int num_packets)
+{
+	busy_cycles += getTransferLatency(packet_size) * num_packets;
+	transferred_bytes += packet_size * num_packets;
+	transferred_packets += num_packets;
+	source_node->incSentBytes(packet_size * num_packets);
+	source_node->incSentPackets(num_packets);
+	destination_node->incReceivedBytes(packet_size * num_packets);
+	destination_node->incReceivedPackets(num_packets);
+}
+
+
 Buffer *Link::VirtualChannelArbitration()
 {
 	// Get the current cycle and current event
@@ -132,6 +132,16 @@ public:
 	/// Transfer the packet from an output buffer 
 	void TransferPacket(Packet *packet);
 
+	/// Return the number of cycles the link takes to transfer a packet
+	int getTransferLatency(int size) const
+	{
+		return (size - 1) / bandwidth + 1;
+	}
+
+	/// Record the transfer of packets estimated by the analytical model
+	void RecordTransfer(Node *source_node, Node *destination_node,
+			int packet_size, int num_packets);
+
 	/// This function returns the buffer that is scheduled to transmit
 	/// a packet on the link on the current cycle. The arbitration
 	/// is in round-robin fashion.
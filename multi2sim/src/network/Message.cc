@@ -31,58 +31,61 @@
 namespace net
 {
 
-Message::Message(long long id, 
-		Network *network,
-		Node *source_node, 
-		Node *destination_node, 
-		int size,
-		long long cycle) :
-		id(id),
+Message::Message(Network *network, int slot) :
 		network(network),
-		source_node(source_node),
-		destination_node(destination_node),
-		size(size),
-		send_cycle(cycle)
+		slot(slot)
 {
 }
 
 
+void Message::Initialize(long long id,
+		Node *source_node,
+		Node *destination_node,
+		int size,
+		long long cycle)
+{
+	this->id = id;
+	this->source_node = source_node;
+	this->destination_node = destination_node;
+	this->size = size;
+	send_cycle = cycle;
+
+	// Discard packets of the previous message, keeping the storage
+	packets.clear();
+	received_packets.clear();
+	num_received_packets = 0;
+}
+
+
 void Message::Packetize(int packet_size)
 {
+	// Packets are constructed in place. Their addresses are only taken
+	// once the message has been packetized, so the vector can still grow.
 	int packet_count = (size - 1) / packet_size + 1;
+	packets.reserve(packet_count);
 	for (int i = 0; i < packet_count; i++)
-	{
-		auto packet = misc::new_unique<Packet>(this, packet_size);
-		this->packets.push_back(std::move(packet));
-	}
+		packets.emplace_back(this, i, packet_size);
+	received_packets.assign(packet_count, false);
 }
 
 
 bool Message::Assemble(Packet *packet)
 {
 	// Check if the packet belongs to this message
-	bool is_packet_belongs_to_message = false;
-	for (auto &message_packet : packets)
-	{
-		if (message_packet.get() == packet)
-		{
-			is_packet_belongs_to_message = true;
-			break;
-		}
-	}
-	if (!is_packet_belongs_to_message)
+	int index = packet->getId();
+	if (packet->getMessage() != this || index < 0 ||
+			index >= (int) packets.size() ||
+			&packets[index] != packet)
 		throw misc::Panic("Cannot assemble the message from a packet"
 				"that does not belongs this message.");
 
 	// Check if the packet has been assembled before
-	for (auto &received_packet : received_packets)
-	{
-		if (received_packet == packet)
-			throw misc::Panic("Packets have been assembled twice");
-	}
+	if (received_packets[index])
+		throw misc::Panic("Packets have been assembled twice");
 
 	// Mark the packet has been received
-	received_packets.push_back(packet);
+	received_packets[index] = true;
+	num_received_packets++;
 
 	// Update the trace with the position of the packet, the depacketizer
 	net::System::trace << misc::fmt("net.packet net=\"%s\" "
@@ -92,7 +95,7 @@ bool Message::Assemble(Packet *packet)
 			packet->getNode()->getName().c_str());
 
 	// Check if all the packets of the message received
-	if (received_packets.size() == packets.size())
+	if (num_received_packets == (int) packets.size())
 	{
 		return true;
 	}
@@ -21,7 +21,6 @@
 #define NETWORK_MESSAGE_H
 
 #include <vector>
-#include <memory>
 
 #include "Packet.h"
 
@@ -34,34 +33,47 @@ class Message
 {
 
 	// Id of the message
-	long long id;
+	long long id = 0;
 
 	// Network that this message belongs to 
 	Network *network;
 
+	// Entry of the message in the message table of the network
+	int slot;
+
 	// Source node
-	Node *source_node;
+	Node *source_node = nullptr;
 
 	// Destination node
-	Node *destination_node;
+	Node *destination_node = nullptr;
 
 	// Size of the message
-	int size;
+	int size = 0;
+
+	// Packets of the message. The vector keeps its capacity when the
+	// message object is recycled for another message.
+	std::vector<Packet> packets;
 
-	// A list of packet
-	std::vector<std::unique_ptr<Packet>> packets;
+	// Flags indicating which packets have been received, indexed by
+	// packet id
+	std::vector<bool> received_packets;
 
-	// A list of received packets
-	std::vector<Packet *> received_packets;
+	// Number of packets received
+	int num_received_packets = 0;
 
 	// Cycle when the message was sent
-	long long send_cycle;
+	long long send_cycle = 0;
 
 public:
 
-	/// Constructor
-	Message(long long id, Network *network, 
-			Node *source_node, Node *destination_node,
+	/// Constructor of a message object owned by the message table of
+	/// \a network, in entry \a slot. The object can be reused for several
+	/// messages, each one set up with a call to Initialize().
+	Message(Network *network, int slot);
+
+	/// Set up the message object for a new message, discarding the
+	/// packets of the previous one.
+	void Initialize(long long id, Node *source_node, Node *destination_node,
 			int size, long long cycle);
 
 	/// Packetize
@@ -83,6 +95,9 @@ public:
 	/// Get the network
 	Network *getNetwork() const { return network; }
 
+	/// Get the entry of the message in the message table of the network
+	int getSlot() const { return slot; }
+
 	/// Get source node
 	Node *getSourceNode() const { return source_node; }
 
@@ -99,7 +114,7 @@ public:
 	int getNumPackets() const { return packets.size(); }
 
 	/// Get packet by index
-	Packet *getPacket(int index) const { return packets[index].get(); }
+	Packet *getPacket(int index) { return &packets[index]; }
 };
 
 }  // namespace net
@@ -17,11 +17,14 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include <cstring>
 #include <csignal>
 #include <fstream>
 
+#include <lib/cpp/Json.h>
 #include <lib/esim/Engine.h>
+#include <lib/esim/IntervalStatistics.h>
 
 #include "Buffer.h"
 #include "Bus.h"
@@ -41,10 +44,43 @@ static const char *err_cycle_detected =
 	"for the network. Routing cycles can cause deadlocks in simulations,"
 	"that can in turn make the simulation stall with no output.";
 
+misc::StringMap Network::ModelMap =
+{
+	{ "Detailed", ModelDetailed },
+	{ "Analytical", ModelAnalytical },
+	{ "Wormhole", ModelWormhole }
+};
+
+
 Network::Network(const std::string &name) :
 				name(name),
 				routing_table(this)
 {
+	// Interval statistics
+	if (esim::IntervalStatistics::getInstance()->isActive())
+		RegisterIntervalStatistics();
+}
+
+
+void Network::RegisterIntervalStatistics()
+{
+	// Bytes received per cycle
+	esim::IntervalStatistics *interval_statistics =
+			esim::IntervalStatistics::getInstance();
+	std::string prefix = "net." + name + ".";
+	interval_statistics->RegisterRatio(prefix + "Bandwidth",
+			[this]() { return (double) accumulated_bytes; },
+			[]() { return (double) System::getInstance()->
+					getCycle(); });
+
+	// Average latency of the messages received
+	interval_statistics->RegisterRatio(prefix + "Latency",
+			[this]() { return (double) accumulated_latency; },
+			[this]() { return (double) transfers; });
+
+	// Messages in flight
+	interval_statistics->RegisterGauge(prefix + "InFlight",
+			[this]() { return (double) getNumMessagesInFlight(); });
 }
 
 
@@ -77,6 +113,27 @@ void Network::ParseConfiguration(misc::IniFile *config,
 		fix_latency = 1;
 	}
 
+	// Timing model
+	model = (Model) config->ReadEnum(section, "Model", ModelMap,
+			ModelDetailed);
+	if (model != ModelDetailed && fix_latency)
+		throw Error(misc::fmt("%s: Network %s: the %s model "
+				"cannot be used in an ideal network or a "
+				"network with a fix latency",
+				config->getPath().c_str(),
+				name.c_str(), ModelMap[model]));
+
+	// Flit-level model
+	flit_size = config->ReadInt(section, "FlitSize", 0);
+	flit_buffer_size = config->ReadInt(section, "FlitBufferSize", 0);
+	virtual_cut_through = config->ReadBool(section, "VirtualCutThrough",
+			false);
+	if (flit_size < 0 || flit_buffer_size < 0)
+		throw Error(misc::fmt("%s: Network %s: invalid flit size or "
+				"flit buffer size",
+				config->getPath().c_str(),
+				name.c_str()));
+
 	// Throw an error if fix latency is not correct
 	// otherwise throw a warning saying a lot of components are
 	// ineffective
@@ -119,6 +176,9 @@ void Network::ParseConfiguration(misc::IniFile *config,
 				"negative.\n%s", config->getPath().c_str(),
 				name.c_str(), System::err_config_note));
 
+	// Generate the nodes and links of a built-in topology, if any
+	bool generated = ParseConfigurationForTopology(config, section);
+
 	// Parse the configure file for nodes
 	ParseConfigurationForNodes(config);
 
@@ -131,12 +191,43 @@ void Network::ParseConfiguration(misc::IniFile *config,
 	// Parse the configuration file for Bus ports
 	ParseConfigurationForBusPorts(config);
 
-	// Time to create the initial routing table
-	routing_table.Initialize();
+	// Routing algorithm, dimension-order by default for generated meshes
+	// and tori
+	std::string routing = config->ReadString(section, "Routing",
+			generated ? "DimensionOrder" : "ShortestPath");
+	if (!strcasecmp(routing.c_str(), "DimensionOrder") ||
+			!strcasecmp(routing.c_str(), "WestFirst"))
+	{
+		// Routes are computed on lookup, and manual routes cannot be
+		// given on top of them
+		if (!strcasecmp(routing.c_str(), "WestFirst"))
+			routing_table.WestFirst();
+		else
+			routing_table.DimensionOrder();
+		if (ParseConfigurationForRoutes(config))
+			throw Error(misc::fmt("%s: Network %s: manual routes "
+					"cannot be used with '%s' routing",
+					config->getPath().c_str(),
+					name.c_str(),
+					routing.c_str()));
+	}
+	else if (!strcasecmp(routing.c_str(), "ShortestPath"))
+	{
+		// Time to create the initial routing table
+		routing_table.Initialize();
 
-	// Parse the routing elements, for manual routing.
-	if (!ParseConfigurationForRoutes(config))
-		routing_table.FloydWarshall();
+		// Parse the routing elements, for manual routing.
+		if (!ParseConfigurationForRoutes(config))
+			routing_table.ShortestPaths();
+	}
+	else
+	{
+		throw Error(misc::fmt("%s: Network %s: invalid value for "
+				"'Routing'\n%s",
+				config->getPath().c_str(),
+				name.c_str(),
+				System::err_config_note));
+	}
 
 	// If the network with current routing contains a cycle, warn
 	if (routing_table.hasCycle())
@@ -146,6 +237,160 @@ void Network::ParseConfiguration(misc::IniFile *config,
 }
 
 
+int Network::getRequiredEndNodeBufferSize() const
+{
+	if (packet_size != 0)
+		return ((System::getMessageSize() - 1) / packet_size + 1) *
+				packet_size;
+	return System::getMessageSize();
+}
+
+
+bool Network::ParseConfigurationForTopology(misc::IniFile *config,
+		const std::string &section)
+{
+	// Custom topology, given node by node and link by link
+	std::string topology = config->ReadString(section, "Topology",
+			"Custom");
+	if (!strcasecmp(topology.c_str(), "Custom"))
+		return false;
+
+	// Topology type
+	bool torus;
+	if (!strcasecmp(topology.c_str(), "Mesh2D"))
+		torus = false;
+	else if (!strcasecmp(topology.c_str(), "Torus2D"))
+		torus = true;
+	else
+		throw Error(misc::fmt("%s: Network %s: Topology '%s' is not "
+				"supported.\n%s",
+				config->getPath().c_str(),
+				name.c_str(),
+				topology.c_str(),
+				System::err_config_note));
+
+	// Dimensions
+	std::string dimensions = config->ReadString(section, "Dimensions");
+	std::vector<std::string> values;
+	misc::StringTokenize(dimensions, values);
+	misc::StringError error_x = misc::StringErrorOK;
+	misc::StringError error_y = misc::StringErrorOK;
+	int size_x = values.size() == 2 ? misc::StringToInt(values[0],
+			error_x) : 0;
+	int size_y = values.size() == 2 ? misc::StringToInt(values[1],
+			error_y) : 0;
+	if (error_x || error_y || size_x < 1 || size_y < 1)
+		throw Error(misc::fmt("%s: Network %s: Topology '%s' requires "
+				"'Dimensions = <x> <y>' with positive values."
+				"\n%s",
+				config->getPath().c_str(),
+				name.c_str(),
+				topology.c_str(),
+				System::err_config_note));
+
+	// Other parameters
+	int concentration = config->ReadInt(section, "Concentration", 1);
+	int link_bandwidth = config->ReadInt(section, "LinkBandwidth",
+			default_bandwidth);
+	int num_virtual_channels = config->ReadInt(section, "VC", 1);
+	if (concentration < 1 || link_bandwidth < 1 ||
+			num_virtual_channels < 1)
+		throw Error(misc::fmt("%s: Network %s: 'Concentration', "
+				"'LinkBandwidth', and 'VC' must be greater "
+				"than 0.\n%s",
+				config->getPath().c_str(),
+				name.c_str(),
+				System::err_config_note));
+
+	// End nodes should be able to contain an entire message
+	int required_buffer_size = getRequiredEndNodeBufferSize();
+	if (default_input_buffer_size < required_buffer_size ||
+			default_output_buffer_size < required_buffer_size)
+		throw Error(misc::fmt("%s: Buffer size on the "
+				"end node should be able to "
+				"fit at least a whole message, "
+				"or all the packets of the "
+				"message",
+				config->getPath().c_str()));
+
+	// Generate
+	addMesh2D(size_x, size_y, torus, concentration, link_bandwidth,
+			num_virtual_channels);
+	return true;
+}
+
+
+void Network::addMesh2D(int size_x, int size_y, bool torus,
+		int concentration, int bandwidth, int num_virtual_channels)
+{
+	// Switches, named 's<i>' for switch i = y * size_x + x
+	std::vector<Switch *> switches;
+	for (int y = 0; y < size_y; y++)
+	{
+		for (int x = 0; x < size_x; x++)
+		{
+			Switch *node = addSwitch(default_input_buffer_size,
+					default_output_buffer_size,
+					default_bandwidth,
+					misc::fmt("s%d", (int) switches.size()));
+			node->setCoordinates(x, y);
+			switches.push_back(node);
+		}
+	}
+
+	// End nodes, named 'n<j>' for the end nodes j = i * concentration
+	// to (i + 1) * concentration - 1 attached to switch i
+	int end_node_id = 0;
+	for (Switch *node : switches)
+	{
+		for (int k = 0; k < concentration; k++)
+		{
+			EndNode *end_node = addEndNode(
+					default_input_buffer_size,
+					default_output_buffer_size,
+					misc::fmt("n%d", end_node_id++),
+					nullptr);
+			addBidirectionalLink(end_node->getName() + "-" +
+					node->getName(),
+					end_node,
+					node,
+					bandwidth,
+					default_output_buffer_size,
+					default_input_buffer_size,
+					1);
+		}
+	}
+
+	// Links between neighbor switches. Tori add wrap-around links in
+	// the dimensions with more than two switches.
+	for (int y = 0; y < size_y; y++)
+	{
+		for (int x = 0; x < size_x; x++)
+		{
+			Switch *node = switches[y * size_x + x];
+			Switch *neighbors[2] = { nullptr, nullptr };
+			if (x < size_x - 1 || (torus && size_x > 2))
+				neighbors[0] = switches[y * size_x +
+						(x + 1) % size_x];
+			if (y < size_y - 1 || (torus && size_y > 2))
+				neighbors[1] = switches[((y + 1) % size_y) *
+						size_x + x];
+			for (Switch *neighbor : neighbors)
+				if (neighbor)
+					addBidirectionalLink(node->getName() +
+							"-" +
+							neighbor->getName(),
+							node,
+							neighbor,
+							bandwidth,
+							default_output_buffer_size,
+							default_input_buffer_size,
+							num_virtual_channels);
+		}
+	}
+}
+
+
 void Network::ParseConfigurationForNodes(misc::IniFile *config)
 {
 	for (int i = 0; i < config->getNumSections(); i++)
@@ -201,17 +446,8 @@ void Network::ParseConfigurationForNodes(misc::IniFile *config)
 		{
 			// End-node should be able to contain an entire msg
 			// or equivalent number of packets for that message.
-			int required_buffer_size = 0;
-
-			if (packet_size != 0)
-				required_buffer_size =
-						(((System::getMessageSize() - 1) 
-						/ packet_size + 1) *
-						packet_size);
-			else
-				required_buffer_size =
-						System::getMessageSize();
-
+			int required_buffer_size =
+					getRequiredEndNodeBufferSize();
 			if (input_buffer_size < required_buffer_size ||
 					output_buffer_size < required_buffer_size)
 				throw Error(misc::fmt("%s: Buffer size on the " 
@@ -227,8 +463,31 @@ void Network::ParseConfigurationForNodes(misc::IniFile *config)
 		}
 		else if (!strcasecmp(type.c_str(), "Switch"))
 		{
-			addSwitch(input_buffer_size, output_buffer_size,
-					bandwidth, node_name);
+			Switch *node = addSwitch(input_buffer_size,
+					output_buffer_size, bandwidth,
+					node_name);
+
+			// Coordinates in a mesh or torus
+			std::string coordinates = config->ReadString(section,
+					"Coordinates");
+			if (!coordinates.empty())
+			{
+				std::vector<std::string> values;
+				misc::StringTokenize(coordinates, values);
+				misc::StringError error_x = misc::StringErrorOK;
+				misc::StringError error_y = misc::StringErrorOK;
+				int x = values.size() == 2 ? misc::StringToInt(
+						values[0], error_x) : -1;
+				int y = values.size() == 2 ? misc::StringToInt(
+						values[1], error_y) : -1;
+				if (error_x || error_y || x < 0 || y < 0)
+					throw Error(misc::fmt("%s: Node '%s': "
+							"invalid coordinates\n%s",
+							config->getPath().c_str(),
+							node_name.c_str(),
+							System::err_config_note));
+				node->setCoordinates(x, y);
+			}
 		}
 		else
 		{
@@ -819,6 +1078,46 @@ void Network::DumpReport(std::ostream &os) const
 }
 
 
+void Network::DumpJsonReport(misc::JsonWriter &json) const
+{
+	// Network object
+	json.Key(name);
+	json.BeginObject();
+	json.Member("Transfers", transfers);
+	json.Member("TransferredBytes", accumulated_bytes);
+	json.Member("AverageMessageSize", transfers ?
+			(double) accumulated_bytes / transfers : 0.0);
+	json.Member("AverageLatency", transfers ?
+			(double) accumulated_latency / transfers : 0.0);
+	long long cycle = System::getInstance()->getCycle();
+	json.Member("Cycles", cycle);
+
+	// Latency
+	json.Key("MessageLatency");
+	message_latency.DumpJson(json);
+
+	// Links
+	json.Key("Links");
+	json.BeginObject();
+	for (auto &connection : connections)
+	{
+		Link *link = dynamic_cast<Link *>(connection.get());
+		if (!link)
+			continue;
+		json.Key(link->getName());
+		json.BeginObject();
+		json.Member("TransferredBytes", link->getTransferredBytes());
+		json.Member("BusyCycles", link->getBusyCycle());
+		json.Member("Utilization", cycle ? (double) link->
+				getTransferredBytes() / (cycle *
+				link->getBandwidth()) : 0.0);
+		json.EndObject();
+	}
+	json.EndObject();
+	json.EndObject();
+}
+
+
 Message *Network::newMessage(EndNode *source_node, EndNode *destination_node,
 		int size)
 {
@@ -826,13 +1125,23 @@ Message *Network::newMessage(EndNode *source_node, EndNode *destination_node,
 	System *system = System::getInstance();
 	long long cycle = system->getCycle();
 
-	// Insert the created message into the hashtable
-	message_table.emplace(message_id_counter, misc::new_unique<Message>(
-			message_id_counter, this, source_node,
-			destination_node, size, cycle));
+	// Take a free slot of the message table, or add a new one
+	int slot;
+	if (free_message_slots.empty())
+	{
+		slot = message_table.size();
+		message_table.emplace_back(misc::new_unique<Message>(this, slot));
+	}
+	else
+	{
+		slot = free_message_slots.back();
+		free_message_slots.pop_back();
+	}
 
-	// Get the pointer to the newly created messag
-	Message *message = message_table[message_id_counter].get();
+	// Set up the message object
+	Message *message = message_table[slot].get();
+	message->Initialize(message_id_counter, source_node,
+			destination_node, size, cycle);
 
 	// Increase message id counter
 	message_id_counter++;
@@ -852,14 +1161,18 @@ bool Network::CanSend(EndNode *source_node,
 	assert(!retry_event || esim_engine->getCurrentEvent());
 
 	// Get output buffer
-	RoutingTable::Entry *entry = routing_table.Lookup(source_node, 
+	RoutingTable::Entry entry = routing_table.getRoute(source_node, 
 			destination_node);
-	Buffer *output_buffer = entry->getBuffer();
+	Buffer *output_buffer = entry.getBuffer();
 
 	// If there is no route, return
 	if (!output_buffer)
 		return false;
 
+	// Messages do not occupy buffers in the analytical model
+	if (model == ModelAnalytical)
+		return true;
+
 	// Get current cycle
 	System *system = System::getInstance();
 	long long cycle = system->getCycle();
@@ -914,8 +1227,10 @@ Message *Network::Send(EndNode *source_node,
 			name.c_str(), message->getId(),
 			message->getSize(), source_node->getName().c_str());
 
-	// Packetize message
-	if (packet_size == 0)
+	// Packetize message. In the analytical model, the message travels
+	// as one packet, whose latency accounts for the packets it would be
+	// split into.
+	if (packet_size == 0 || model == ModelAnalytical)
 		message->Packetize(size);
 	else 
 		message->Packetize(packet_size);
@@ -982,9 +1297,9 @@ Message *Network::TrySend(EndNode *source_node,
 		esim::Event *retry_event)
 {
 	// Get output buffer
-	RoutingTable::Entry *entry = routing_table.Lookup(source_node, 
+	RoutingTable::Entry entry = routing_table.getRoute(source_node, 
 			destination_node);
-	Buffer *output_buffer = entry->getBuffer();
+	Buffer *output_buffer = entry.getBuffer();
 	
 	// Check if route exist
 	if (!output_buffer)
@@ -1020,6 +1335,7 @@ void Network::Receive(EndNode *node, Message *message)
 	transfers++;
 	accumulated_bytes += message->getSize();
 	accumulated_latency += cycle - message->getSendCycle();
+	message_latency.Add(cycle - message->getSendCycle());
 
 	// Remove packets from their buffer
 	for (int i = 0; i < message->getNumPackets(); i++)
@@ -1030,7 +1346,7 @@ void Network::Receive(EndNode *node, Message *message)
 		// In the case the network is fixed, there are no
 		// buffer insertion and extraction. Otherwise, extract
 		// from buffer and report in trace
-		if (!hasConstantLatency())
+		if (!hasConstantLatency() && model != ModelAnalytical)
 		{
 			// Remove the packet from buffer
 			buffer->RemovePacket(packet);
@@ -1065,8 +1381,71 @@ void Network::Receive(EndNode *node, Message *message)
 	System::trace << misc::fmt("net.end_msg net=\"%s\" name=\"M-%lld\"\n",
 			name.c_str(), message->getId());
 
-	// Destroy the message
-	message_table.erase(message->getId());
+	// Release the message, whose object is recycled for a later message
+	free_message_slots.push_back(message->getSlot());
+}
+
+
+int Network::getAnalyticalLatency(Message *message)
+{
+	// Packets the message is split into
+	int size = message->getSize();
+	int packet_size = this->packet_size ? this->packet_size : size;
+	int num_packets = (size - 1) / packet_size + 1;
+
+	// Traverse the route. The first packet pays the latency of every
+	// link and switch, and the rest follow in a pipeline paced by the
+	// slowest stage. Insertion into the source buffer takes one cycle.
+	long long cycle = System::getInstance()->getCycle();
+	Node *node = message->getSourceNode();
+	Node *destination_node = message->getDestinationNode();
+	int latency = 1;
+	int max_stage_latency = 1;
+	for (int hop = 0; node != destination_node; hop++)
+	{
+		// Next hop
+		RoutingTable::Entry entry = routing_table.getRoute(node,
+				destination_node);
+		Buffer *buffer = entry.getBuffer();
+		if (!buffer || hop == (int) nodes.size())
+			throw misc::Panic(misc::fmt("%s: no route from %s "
+					"to %s", name.c_str(),
+					message->getSourceNode()->
+					getName().c_str(),
+					destination_node->getName().c_str()));
+
+		// Link or bus, with the queueing delay of its load
+		Connection *connection = buffer->getConnection();
+		int stage_latency = connection->getTransferLatency(packet_size);
+		latency += stage_latency + connection->EstimateQueueingDelay(
+				cycle, stage_latency * num_packets);
+		max_stage_latency = std::max(max_stage_latency, stage_latency);
+		connection->RecordTransfer(node, entry.getNextNode(),
+				packet_size, num_packets);
+
+		// Switch crossbar
+		node = entry.getNextNode();
+		if (Switch *next_switch = dynamic_cast<Switch *>(node))
+		{
+			stage_latency = next_switch->getTransferLatency(
+					packet_size);
+			latency += stage_latency;
+			max_stage_latency = std::max(max_stage_latency,
+					stage_latency);
+		}
+	}
+
+	// Remaining packets
+	return latency + (num_packets - 1) * max_stage_latency;
+}
+
+
+Wormhole *Network::getWormhole()
+{
+	// Create the model once the topology is complete
+	if (!wormhole)
+		wormhole = misc::new_unique<Wormhole>(this);
+	return wormhole.get();
 }
 
 
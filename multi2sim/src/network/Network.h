@@ -20,6 +20,7 @@
 #ifndef NETWORK_NETWORK_H
 #define NETWORK_NETWORK_H
 
+#include <lib/cpp/Histogram.h>
 #include <lib/cpp/IniFile.h>
 #include <lib/cpp/String.h>
 #include <lib/esim/Event.h>
@@ -33,6 +34,7 @@
 #include "Node.h"
 #include "RoutingTable.h"
 #include "System.h"
+#include "Wormhole.h"
 
 namespace net
 {
@@ -44,6 +46,30 @@ class Graph;
 
 class Network
 {
+public:
+
+	/// Timing models of the network
+	enum Model
+	{
+		ModelInvalid = 0,
+
+		// Packets move hop by hop through links, switches, and
+		// buffers
+		ModelDetailed,
+
+		// Delivery time is computed when the message is sent, from
+		// the route and the estimated link contention
+		ModelAnalytical,
+
+		// Packets are split into flits that move through the virtual
+		// channels of pipelined routers with credit-based flow control
+		ModelWormhole
+	};
+
+	/// String map for values of type Model
+	static misc::StringMap ModelMap;
+
+private:
 
 	// Network name
 	std::string name;
@@ -51,8 +77,12 @@ class Network
 	// Message ID counter
 	long long message_id_counter = 0;
 
-	// A hashtable of messages in flight
-	std::unordered_map<long long, std::unique_ptr<Message>> message_table;
+	// Message objects, indexed by their slot. Objects of received
+	// messages are kept and recycled for new messages.
+	std::vector<std::unique_ptr<Message>> message_table;
+
+	// Slots of the message table not holding a message in flight
+	std::vector<int> free_message_slots;
 
 	// List of nodes in the network
 	std::vector<std::unique_ptr<Node>> nodes;
@@ -72,6 +102,15 @@ class Network
 	// Routing table
 	RoutingTable routing_table;
 
+	// Return the minimum size of the buffers of an end node, which must
+	// fit an entire message or all its packets
+	int getRequiredEndNodeBufferSize() const;
+
+	// Parse the topology given in the network section, and generate its
+	// nodes and links. Return true if a built-in topology was generated.
+	bool ParseConfigurationForTopology(misc::IniFile *ini_file,
+			const std::string &section);
+
 	// Parse the config file to add all the nodes belongs to the network
 	void ParseConfigurationForNodes(misc::IniFile *ini_file);
 
@@ -106,6 +145,24 @@ class Network
 	// Defaule packet size - zero means no packeting
 	int packet_size = 0;
 
+	// Timing model
+	Model model = ModelDetailed;
+
+	// Flit size in bytes for the flit-level model, or zero to use the
+	// bandwidth of the narrowest link
+	int flit_size = 0;
+
+	// Size in flits of the virtual channel buffers of switches in the
+	// flit-level model, or zero to derive it from the input buffer size
+	int flit_buffer_size = 0;
+
+	// Use virtual cut-through instead of wormhole switching in the
+	// flit-level model
+	bool virtual_cut_through = false;
+
+	// Flit-level model, created on first use
+	std::unique_ptr<Wormhole> wormhole;
+
 	// fix latency of the network. If activated
 	// the network sends the messages with a fixed latency
 	// regardless of the topology.
@@ -128,6 +185,14 @@ class Network
 	// Accumulation of size of all messages in the network
 	long long accumulated_bytes = 0;
 
+	// Latency of all messages received, from their injection in the
+	// source node to their arrival to the destination node
+	misc::Histogram message_latency;
+
+	// Register the bandwidth, average latency, and messages in flight
+	// in the interval statistics
+	void RegisterIntervalStatistics();
+
 
 
 
@@ -182,6 +247,42 @@ public:
 	/// Get the fix delay of the network
 	int getFixLatency() const {return fix_latency; }
 
+	/// Set the timing model of the network
+	void setModel(Model model) { this->model = model; }
+
+	/// Return the timing model of the network
+	Model getModel() const { return model; }
+
+	/// Return whether the network uses the analytical timing model
+	bool isAnalytical() const { return model == ModelAnalytical; }
+
+	/// Return the latency of a message in the analytical model, and
+	/// record its transfer in the statistics of the connections and
+	/// nodes in its route. The latency adds the transfer latencies of
+	/// the links and switches in the route, pipelining the packets of
+	/// the message, and the queueing delay estimated for each link from
+	/// its recent utilization.
+	int getAnalyticalLatency(Message *message);
+
+	/// Return whether the network uses the flit-level timing model
+	bool isWormhole() const { return model == ModelWormhole; }
+
+	/// Return the flit size given in the configuration, or zero if not
+	/// given
+	int getFlitSize() const { return flit_size; }
+
+	/// Return the virtual channel buffer size in flits given in the
+	/// configuration, or zero if not given
+	int getFlitBufferSize() const { return flit_buffer_size; }
+
+	/// Return whether the flit-level model uses virtual cut-through
+	/// switching
+	bool isVirtualCutThrough() const { return virtual_cut_through; }
+
+	/// Return the flit-level model, creating it for the current nodes and
+	/// links the first time it is requested.
+	Wormhole *getWormhole();
+
 	/// Create a message to be transfered in the network. The network 
 	/// keeps the ownership of the message. Message is destoried when it 
 	/// is received by the \a destination node.
@@ -380,6 +481,35 @@ public:
 			int dest_buffer_size,
 			int num_virtual_channels);
 
+	/// Add the switches, end nodes, and links of a 2D mesh or torus to
+	/// the network. Switches are named 's<i>' for i = y * size_x + x,
+	/// and have their coordinates set for dimension-order routing. End
+	/// nodes are named 'n<j>', and the end nodes from j = i *
+	/// concentration to (i + 1) * concentration - 1 are linked to
+	/// switch i. Nodes and buffers use the default network values.
+	///
+	/// \param size_x
+	///	Number of switches in the X dimension
+	///
+	/// \param size_y
+	///	Number of switches in the Y dimension
+	///
+	/// \param torus
+	///	Add wrap-around links in the dimensions with more than two
+	///	switches
+	///
+	/// \param concentration
+	///	Number of end nodes linked to each switch
+	///
+	/// \param bandwidth
+	///	Bandwidth of all links
+	///
+	/// \param num_virtual_channels
+	///	Number of virtual channels of the links between switches
+	///
+	void addMesh2D(int size_x, int size_y, bool torus, int concentration,
+			int bandwidth, int num_virtual_channels);
+
 
 
 
@@ -414,8 +544,41 @@ public:
 	/// Dump the network information.
 	void DumpReport(std::ostream &os = std::cout) const;
 
+	/// Dump the network statistics as a member of the current JSON object,
+	/// including the histogram of message latencies and the utilization
+	/// of each link.
+	void DumpJsonReport(misc::JsonWriter &json) const;
+
 	/// Generating the static graph file
 	void StaticGraph(const std::string &path);
+
+
+
+
+	//
+	// Statistics
+	//
+
+	/// Return the number of messages in flight
+	int getNumMessagesInFlight() const
+	{
+		return message_table.size() - free_message_slots.size();
+	}
+
+	/// Return the number of messages received so far
+	long long getTransfers() const { return transfers; }
+
+	/// Return the accumulated latency of the messages received so far
+	long long getAccumulatedLatency() const { return accumulated_latency; }
+
+	/// Return the accumulated size of the messages received so far
+	long long getAccumulatedBytes() const { return accumulated_bytes; }
+
+	/// Return the histogram of latencies of the messages received so far
+	const misc::Histogram &getMessageLatency() const
+	{
+		return message_latency;
+	}
 };
 
 
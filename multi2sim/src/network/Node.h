@@ -148,7 +148,7 @@ public:
 	void incSentBytes(long long bytes) { sent_bytes += bytes; }
 
 	/// Increase the number of packets sent
-	void incSentPackets() { sent_packets++; }
+	void incSentPackets(int count = 1) { sent_packets += count; }
 
 	/// Return the incoming traffic into this node in number of bytes, as
 	/// the sum of the bytes received through all its input links.
@@ -161,7 +161,7 @@ public:
 	}
 
 	/// Increase the number of packets received
-	void incReceivedPackets() { received_packets++; }
+	void incReceivedPackets(int count = 1) { received_packets += count; }
 
 	/// Update trace header with node detailed information
 	void TraceHeader();
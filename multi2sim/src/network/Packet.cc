@@ -18,17 +18,15 @@
  */
 
 #include "Packet.h"
-#include "Message.h"
 
 namespace net
 {
 
-Packet::Packet(Message *message, int size) :
+Packet::Packet(Message *message, int id, int size) :
 		message(message),
-		size(size)
+		size(size),
+		id(id)
 {
-	// Assigning the packet's id
-	id = message->getNumPackets();
 }
 
 }  // namespace net
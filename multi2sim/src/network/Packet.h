@@ -46,11 +46,15 @@ class Packet
 	// Current position in the network, which buffer it is at
 	Buffer *buffer;
 
+	// Output buffer selected for the packet in the switch it is at
+	Buffer *route_buffer = nullptr;
+
 
 public:
 
-	/// Constructor
-	Packet(Message *message, int size);
+	/// Constructor of the packet with index \a id in \a message, with
+	/// \a size bytes
+	Packet(Message *message, int id, int size);
 
 	/// Get session id
 	int getId() const { return id; }
@@ -73,6 +77,15 @@ public:
 	/// Get buffer
 	Buffer *getBuffer() const { return buffer; }
 
+	/// Set the output buffer selected for the packet in a switch
+	void setRouteBuffer(Buffer *route_buffer)
+	{
+		this->route_buffer = route_buffer;
+	}
+
+	/// Get the output buffer selected for the packet in a switch
+	Buffer *getRouteBuffer() const { return route_buffer; }
+
 	/// Update the cycle until which the packet is in transit
 	void setBusy(long long busy) { this->busy = busy; }
 
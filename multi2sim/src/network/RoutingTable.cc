@@ -17,16 +17,20 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include <climits>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <set>
 
 #include <lib/cpp/Error.h>
 
 #include "Node.h"
 #include "Network.h"
 #include "RoutingTable.h"
+#include "Switch.h"
 
 namespace net
 {
@@ -52,15 +56,11 @@ void RoutingTable::Initialize()
 	dimension = network->getNumNodes();
 
 	// Initiate table with infinite costs
+	entries.reserve(dimension * dimension);
 	for (int i = 0; i < dimension; i++)
-	{
 		for (int j = 0; j < dimension; j++)
-		{
-			entries.emplace_back(misc::new_unique<Entry>(
-					i == j ? 0 : dimension, 
-					nullptr, nullptr));
-		}
-	}
+			entries.emplace_back(i == j ? 0 : dimension,
+					nullptr, nullptr);
 
 	// Set 1-hop connections
 	for (int i = 0; i < dimension; i++)
@@ -179,6 +179,468 @@ void RoutingTable::FloydWarshall()
 }
 
 
+void RoutingTable::ShortestPaths()
+{
+	// Neighbors of each node, as given by the 1-hop entries
+	std::vector<std::vector<int>> neighbors(dimension);
+	for (int i = 0; i < dimension; i++)
+		for (int j = 0; j < dimension; j++)
+			if (i != j && entries[i * dimension + j].cost == 1)
+				neighbors[i].push_back(j);
+
+	// Floyd-Warshall keeps, for each pair of nodes, the path found with
+	// the lowest bound on the index of its intermediate nodes, and takes
+	// the first hop from the path to the intermediate node with the
+	// highest index in it. The search below tracks that intermediate
+	// node for each destination, so that ties are broken the same way.
+	std::vector<int> distance(dimension);
+	std::vector<int> max_intermediate(dimension);
+	std::vector<int> first_hop(dimension);
+	std::vector<Buffer *> first_buffer(dimension);
+	std::vector<int> queue;
+	queue.reserve(dimension);
+	for (int i = 0; i < dimension; i++)
+	{
+		// Breadth-first search from node i
+		std::fill(distance.begin(), distance.end(), -1);
+		distance[i] = 0;
+		queue.clear();
+		queue.push_back(i);
+		for (unsigned head = 0; head < queue.size(); head++)
+		{
+			int node_id = queue[head];
+			int intermediate = node_id == i ? -1 :
+					std::max(max_intermediate[node_id],
+					node_id);
+			for (int neighbor_id : neighbors[node_id])
+			{
+				if (distance[neighbor_id] < 0)
+				{
+					distance[neighbor_id] = distance[node_id] + 1;
+					max_intermediate[neighbor_id] = intermediate;
+					queue.push_back(neighbor_id);
+				}
+				else if (distance[neighbor_id] ==
+						distance[node_id] + 1 &&
+						intermediate <
+						max_intermediate[neighbor_id])
+				{
+					max_intermediate[neighbor_id] = intermediate;
+				}
+			}
+		}
+
+		// First output buffer of node i reaching each neighbor
+		Node *node_i = network->getNode(i);
+		std::fill(first_buffer.begin(), first_buffer.end(), nullptr);
+		for (int k = node_i->getNumOutputBuffers() - 1; k >= 0; k--)
+		{
+			Buffer *buffer = node_i->getOutputBuffer(k);
+			Connection *connection = buffer->getConnection();
+			for (int m = 0; m < connection->getNumDestinationBuffers();
+					m++)
+			{
+				Node *receive_node = connection->
+						getDestinationBuffer(m)->getNode();
+				first_buffer[receive_node->getIndex()] = buffer;
+			}
+		}
+
+		// Set the entries in the order in which nodes were reached, so
+		// that the first hop toward the intermediate node is known
+		for (unsigned head = 1; head < queue.size(); head++)
+		{
+			int j = queue[head];
+			first_hop[j] = distance[j] == 1 ? j :
+					first_hop[max_intermediate[j]];
+			Entry &entry = entries[i * dimension + j];
+			entry.cost = distance[j];
+			entry.setNextNode(network->getNode(first_hop[j]));
+			entry.setBuffer(first_buffer[first_hop[j]]);
+		}
+	}
+}
+
+
+int RoutingTable::getDistance(int from, int to, int size, bool wrap)
+{
+	int distance = std::abs(to - from);
+	if (wrap)
+		distance = std::min(distance, size - distance);
+	return distance;
+}
+
+
+RoutingTable::Direction RoutingTable::getDirection(int from, int to,
+		int size, bool wrap, Direction increase, Direction decrease)
+{
+	// Mesh
+	if (!wrap)
+		return to > from ? increase : decrease;
+
+	// Torus, taking the shorter way around, or the increasing direction
+	// if both are equally long
+	int forward = (to - from + size) % size;
+	return forward <= size - forward ? increase : decrease;
+}
+
+
+void RoutingTable::DimensionOrder()
+{
+	// Reset state
+	algorithm = AlgorithmDimensionOrder;
+	dimension = network->getNumNodes();
+	entries.clear();
+	home_switches.assign(dimension, nullptr);
+	up_buffers.assign(dimension, nullptr);
+	down_buffers.assign(dimension, nullptr);
+	direction_links.assign(dimension * DirectionCount, nullptr);
+
+	// Size of the mesh
+	size_x = 0;
+	size_y = 0;
+	for (int i = 0; i < dimension; i++)
+	{
+		Switch *node = dynamic_cast<Switch *>(network->getNode(i));
+		if (!node)
+			continue;
+		if (!node->hasCoordinates())
+			throw Error(misc::fmt("Network %s: dimension-order "
+					"routing requires coordinates for "
+					"switch '%s'",
+					network->getName().c_str(),
+					node->getName().c_str()));
+		size_x = std::max(size_x, node->getX() + 1);
+		size_y = std::max(size_y, node->getY() + 1);
+		home_switches[i] = node;
+	}
+
+	// Place switches in the grid
+	grid.assign(size_x * size_y, nullptr);
+	for (int i = 0; i < dimension; i++)
+	{
+		Switch *node = home_switches[i];
+		if (!node)
+			continue;
+		Switch *&position = grid[node->getY() * size_x + node->getX()];
+		if (position)
+			throw Error(misc::fmt("Network %s: switches '%s' and "
+					"'%s' have the same coordinates",
+					network->getName().c_str(),
+					position->getName().c_str(),
+					node->getName().c_str()));
+		position = node;
+	}
+	for (int i = 0; i < size_x * size_y; i++)
+		if (!grid[i])
+			throw Error(misc::fmt("Network %s: no switch at "
+					"coordinates (%d, %d) of the %dx%d mesh",
+					network->getName().c_str(),
+					i % size_x, i / size_x,
+					size_x, size_y));
+
+	// Classify the links of each node
+	wrap_x = false;
+	wrap_y = false;
+	for (int i = 0; i < dimension; i++)
+	{
+		Node *node = network->getNode(i);
+		Switch *switch_node = dynamic_cast<Switch *>(node);
+		for (int k = 0; k < node->getNumOutputBuffers(); k++)
+		{
+			Buffer *buffer = node->getOutputBuffer(k);
+			Link *link = dynamic_cast<Link *>(buffer->getConnection());
+			if (!link)
+				throw Error(misc::fmt("Network %s: dimension-order "
+						"routing does not support buses",
+						network->getName().c_str()));
+			Node *destination = link->getDestinationNode();
+			Switch *destination_switch =
+					dynamic_cast<Switch *>(destination);
+
+			// End node to switch
+			if (!switch_node)
+			{
+				if (!destination_switch)
+					throw Error(misc::fmt("Network %s: end "
+							"nodes '%s' and '%s' cannot be "
+							"linked directly in dimension-"
+							"order routing",
+							network->getName().c_str(),
+							node->getName().c_str(),
+							destination->getName().c_str()));
+				if (home_switches[i] &&
+						home_switches[i] != destination_switch)
+					throw Error(misc::fmt("Network %s: end "
+							"node '%s' must be linked to "
+							"only one switch in dimension-"
+							"order routing",
+							network->getName().c_str(),
+							node->getName().c_str()));
+				home_switches[i] = destination_switch;
+				if (!up_buffers[i])
+					up_buffers[i] = buffer;
+				continue;
+			}
+
+			// Switch to end node
+			if (!destination_switch)
+			{
+				int index = destination->getIndex();
+				if (!down_buffers[index])
+					down_buffers[index] = buffer;
+				continue;
+			}
+
+			// Switch to switch, which must be a neighbor in one of
+			// the dimensions
+			int dx = destination_switch->getX() - switch_node->getX();
+			int dy = destination_switch->getY() - switch_node->getY();
+			Direction direction;
+			if (dy == 0 && dx == 1)
+				direction = DirectionEast;
+			else if (dy == 0 && dx == -1)
+				direction = DirectionWest;
+			else if (dx == 0 && dy == 1)
+				direction = DirectionNorth;
+			else if (dx == 0 && dy == -1)
+				direction = DirectionSouth;
+			else if (dy == 0 && dx == 1 - size_x)
+				direction = DirectionEast, wrap_x = true;
+			else if (dy == 0 && dx == size_x - 1)
+				direction = DirectionWest, wrap_x = true;
+			else if (dx == 0 && dy == 1 - size_y)
+				direction = DirectionNorth, wrap_y = true;
+			else if (dx == 0 && dy == size_y - 1)
+				direction = DirectionSouth, wrap_y = true;
+			else
+				throw Error(misc::fmt("Network %s: link '%s' "
+						"does not connect neighbor "
+						"switches of a mesh or torus",
+						network->getName().c_str(),
+						link->getName().c_str()));
+			Link *&direction_link = direction_links[i *
+					DirectionCount + direction];
+			if (!direction_link)
+				direction_link = link;
+		}
+	}
+
+	// Every switch must be linked to its neighbors in all directions,
+	// including wrap-around links in the dimensions forming a ring
+	for (Switch *node : grid)
+	{
+		int x = node->getX();
+		int y = node->getY();
+		bool needed[DirectionCount] =
+		{
+			wrap_x || x < size_x - 1,
+			wrap_x || x > 0,
+			wrap_y || y < size_y - 1,
+			wrap_y || y > 0
+		};
+		for (int direction = 0; direction < DirectionCount; direction++)
+			if (needed[direction] && !direction_links[
+					node->getIndex() * DirectionCount +
+					direction])
+				throw Error(misc::fmt("Network %s: switch '%s' "
+						"is missing links to form a "
+						"mesh or torus",
+						network->getName().c_str(),
+						node->getName().c_str()));
+	}
+
+	// Rings use two virtual channel classes if all their links have at
+	// least two virtual channels
+	num_vc_classes_x = wrap_x ? 2 : 1;
+	num_vc_classes_y = wrap_y ? 2 : 1;
+	for (int i = 0; i < dimension * DirectionCount; i++)
+	{
+		Link *link = direction_links[i];
+		if (!link || link->getNumVirtualChannels() >= 2)
+			continue;
+		if (i % DirectionCount <= DirectionWest)
+			num_vc_classes_x = 1;
+		else
+			num_vc_classes_y = 1;
+	}
+
+	// Every end node must be linked in both directions to a switch
+	for (int i = 0; i < dimension; i++)
+		if (!home_switches[i] || (!dynamic_cast<Switch *>(
+				network->getNode(i)) &&
+				(!up_buffers[i] || !down_buffers[i])))
+			throw Error(misc::fmt("Network %s: end node '%s' must "
+					"be linked to a switch in both directions "
+					"in dimension-order routing",
+					network->getName().c_str(),
+					network->getNode(i)->getName().c_str()));
+}
+
+
+RoutingTable::Entry RoutingTable::getDimensionOrderRoute(Node *source,
+		Node *destination) const
+{
+	// Same node
+	if (source == destination)
+		return Entry(0, nullptr, nullptr);
+
+	// Number of hops
+	int source_id = source->getIndex();
+	int destination_id = destination->getIndex();
+	Switch *source_switch = home_switches[source_id];
+	Switch *destination_switch = home_switches[destination_id];
+	int cost = getDistance(source_switch->getX(),
+			destination_switch->getX(), size_x, wrap_x) +
+			getDistance(source_switch->getY(),
+			destination_switch->getY(), size_y, wrap_y);
+	if (source != source_switch)
+		cost++;
+	if (destination != destination_switch)
+		cost++;
+
+	// From an end node, go up to its switch
+	if (source != source_switch)
+		return Entry(cost, source_switch, up_buffers[source_id]);
+
+	// Down to the destination end node
+	if (source_switch == destination_switch)
+		return Entry(cost, destination, down_buffers[destination_id]);
+
+	// Route along X first, then along Y, using the first virtual
+	// channel of the class
+	int x = source_switch->getX();
+	int y = source_switch->getY();
+	int destination_x = destination_switch->getX();
+	int destination_y = destination_switch->getY();
+	Direction direction;
+	int vc_class;
+	int num_vc_classes;
+	if (x != destination_x)
+	{
+		direction = getDirection(x, destination_x, size_x, wrap_x,
+				DirectionEast, DirectionWest);
+		num_vc_classes = num_vc_classes_x;
+		vc_class = getVirtualChannelClass(x, destination_x,
+				num_vc_classes, direction == DirectionEast);
+		x = (x + (direction == DirectionEast ? 1 : -1) + size_x) %
+				size_x;
+	}
+	else
+	{
+		direction = getDirection(y, destination_y, size_y, wrap_y,
+				DirectionNorth, DirectionSouth);
+		num_vc_classes = num_vc_classes_y;
+		vc_class = getVirtualChannelClass(y, destination_y,
+				num_vc_classes, direction == DirectionNorth);
+		y = (y + (direction == DirectionNorth ? 1 : -1) + size_y) %
+				size_y;
+	}
+	Link *link = direction_links[source_id * DirectionCount + direction];
+	return Entry(cost, grid[y * size_x + x], link->getSourceBuffer(
+			vc_class * link->getNumVirtualChannels() /
+			num_vc_classes));
+}
+
+
+int RoutingTable::getVirtualChannelClass(int from, int to,
+		int num_vc_classes, bool increase)
+{
+	// Single class
+	if (num_vc_classes == 1)
+		return 0;
+
+	// Upper class until the wrap-around link is crossed
+	return (increase ? from > to : from < to) ? 1 : 0;
+}
+
+
+void RoutingTable::addDirectionBuffers(Switch *node, Direction direction,
+		int vc_class, int num_vc_classes,
+		std::vector<Buffer *> &buffers) const
+{
+	Link *link = direction_links[node->getIndex() * DirectionCount +
+			direction];
+	int num_virtual_channels = link->getNumVirtualChannels();
+	for (int vc = vc_class * num_virtual_channels / num_vc_classes;
+			vc < (vc_class + 1) * num_virtual_channels /
+			num_vc_classes; vc++)
+		buffers.push_back(link->getSourceBuffer(vc));
+}
+
+
+void RoutingTable::WestFirst()
+{
+	// Same requirements as dimension-order routing, on a mesh
+	DimensionOrder();
+	if (wrap_x || wrap_y)
+		throw Error(misc::fmt("Network %s: west-first routing "
+				"does not support tori",
+				network->getName().c_str()));
+	algorithm = AlgorithmWestFirst;
+}
+
+
+void RoutingTable::getCandidateBuffers(Node *node, Node *destination,
+		std::vector<Buffer *> &buffers) const
+{
+	// Table-based routing and single-hop routes offer one buffer
+	Switch *current = hasCoordinateRouting() ?
+			dynamic_cast<Switch *>(node) : nullptr;
+	Switch *destination_switch = current ?
+			home_switches[destination->getIndex()] : nullptr;
+	if (!current || current == destination_switch)
+	{
+		Buffer *buffer = getRoute(node, destination).getBuffer();
+		if (buffer)
+			buffers.push_back(buffer);
+		return;
+	}
+
+	// Offsets to the destination
+	int x = current->getX();
+	int y = current->getY();
+	int destination_x = destination_switch->getX();
+	int destination_y = destination_switch->getY();
+
+	// West-first routing takes any productive direction, unless the
+	// destination is to the west
+	if (algorithm == AlgorithmWestFirst && destination_x >= x)
+	{
+		if (destination_x > x)
+			addDirectionBuffers(current, DirectionEast, 0, 1,
+					buffers);
+		if (destination_y > y)
+			addDirectionBuffers(current, DirectionNorth, 0, 1,
+					buffers);
+		else if (destination_y < y)
+			addDirectionBuffers(current, DirectionSouth, 0, 1,
+					buffers);
+		return;
+	}
+
+	// Dimension-order routing, with all virtual channels of the class
+	if (x != destination_x)
+	{
+		Direction direction = getDirection(x, destination_x, size_x,
+				wrap_x, DirectionEast, DirectionWest);
+		addDirectionBuffers(current, direction,
+				getVirtualChannelClass(x, destination_x,
+				num_vc_classes_x, direction == DirectionEast),
+				num_vc_classes_x, buffers);
+	}
+	else
+	{
+		Direction direction = getDirection(y, destination_y, size_y,
+				wrap_y, DirectionNorth, DirectionSouth);
+		addDirectionBuffers(current, direction,
+				getVirtualChannelClass(y, destination_y,
+				num_vc_classes_y, direction == DirectionNorth),
+				num_vc_classes_y, buffers);
+	}
+}
+
+
 bool RoutingTable::hasCycle()
 {
 	// First create an empty graph
@@ -188,6 +650,10 @@ bool RoutingTable::hasCycle()
 	// the graph
 	std::unordered_map<Buffer *, misc::Vertex *> buffer_to_vertex;
 
+	// Edges added to the graph, to avoid a linear search with
+	// Graph::findEdge() for each pair of nodes
+	std::set<std::pair<misc::Vertex *, misc::Vertex *>> edges;
+
 	// For every output buffer that plays a role in routing table
 	for (int node_id = 0; node_id < dimension; node_id++)
 	{
@@ -213,11 +679,11 @@ bool RoutingTable::hasCycle()
 					destination_node_id);
 
 				// Look up the routing table
-				Entry *entry = Lookup(node, destination_node);
+				Entry entry = getRoute(node, destination_node);
 
 				// Check if the current output buffer is the 
 				// path between the two nodes
-				if (output_buffer == entry->getBuffer())
+				if (output_buffer == entry.getBuffer())
 				{
 					// This means the buffer is involved 
 					// in the graph and might be part of 
@@ -267,24 +733,24 @@ bool RoutingTable::hasCycle()
 				continue;
 
 			// Find the entry in the routing table
-			Entry *entry = Lookup(source_node, destination_node);
+			Entry entry = getRoute(source_node, destination_node);
 
 			// Get the associated output buffer for the entry
-			Buffer *source_vertex_buffer = entry->getBuffer();
+			Buffer *source_vertex_buffer = entry.getBuffer();
 			if (source_vertex_buffer)
 			{
 				// Get the next node of the entry
-				Node *next_node = entry->getNextNode();
+				Node *next_node = entry.getNextNode();
 
 				// Based on the next node perform another 
 				// lookup in the routing table to retrieve the 
 				// next output buffer (next_node, destination)
-				Entry *next_entry = Lookup(next_node, 
+				Entry next_entry = getRoute(next_node, 
 						destination_node);
 
 				// Get the associated output buffer for the
 				// next entry if any
-				Buffer *destination_vertex_buffer = next_entry->
+				Buffer *destination_vertex_buffer = next_entry.
 						getBuffer();
 				if (destination_vertex_buffer)
 				{
@@ -307,8 +773,8 @@ bool RoutingTable::hasCycle()
 							buffer_to_vertex.end());
 
 					// First see if the edge exists
-					if (!graph->findEdge(source_vertex_it->second,
-						destination_vertex_it->second))
+					if (edges.emplace(source_vertex_it->second,
+						destination_vertex_it->second).second)
 					{
 						// Add an edge to the graph based 
 						// on the source and the destination 
@@ -339,14 +805,34 @@ bool RoutingTable::hasCycle()
 
 
 RoutingTable::Entry *RoutingTable::Lookup(Node *source,
-		Node *destination) const
+		Node *destination)
 {
 	int i = source->getIndex();
 	int j = destination->getIndex();
 	assert((dimension > 0) && (i < dimension) && (j < dimension));
 
+	// Coordinate-based routes are not stored in the table
+	if (hasCoordinateRouting())
+		throw misc::Panic("Routing table not materialized for "
+				"dimension-order routing");
+
 	int location = i * dimension + j;
-	return entries.at(location).get();
+	return &entries.at(location);
+}
+
+
+RoutingTable::Entry RoutingTable::getRoute(Node *source,
+		Node *destination) const
+{
+	// Coordinate-based routing
+	if (hasCoordinateRouting())
+		return getDimensionOrderRoute(source, destination);
+
+	// Table entry
+	int i = source->getIndex();
+	int j = destination->getIndex();
+	assert((dimension > 0) && (i < dimension) && (j < dimension));
+	return entries[i * dimension + j];
 }
 
 
@@ -370,23 +856,23 @@ void RoutingTable::Dump(std::ostream &os) const
 			unsigned int entry_text_size = 0;
 
 			// Get the entry of the table
-			Entry *entry = Lookup(node_i, network->getNode(j));
+			Entry entry = getRoute(node_i, network->getNode(j));
 
 			// Get the string size of the members that
 			// will be printed, and add them up
 			// Starting with the cost
-			entry_text_size += std::to_string(entry->cost).length();
+			entry_text_size += std::to_string(entry.cost).length();
 
 			// Then add 2 for the separator, followed by the
 			// name of the next_node
-			Node *next = entry->getNextNode();
+			Node *next = entry.getNextNode();
 			if (next)
 				entry_text_size += next->getName().length();
 			entry_text_size += 2;
 
 			// Another separator (+2) followed by the name of
 			// the buffer
-			Buffer *buffer = entry->getBuffer();
+			Buffer *buffer = entry.getBuffer();
 			if (buffer)
 				entry_text_size += buffer->getName().length();
 			entry_text_size += 2;
@@ -457,24 +943,24 @@ void RoutingTable::Dump(std::ostream &os) const
 		for (int j = 0; j < dimension; j++)
 		{
 			Node *node_j = network->getNode(j);
-			Entry *entry = Lookup(node_i,node_j);
+			Entry entry = getRoute(node_i, node_j);
 
 			// First we have to create the string that will be
 			// printed for each element:
 			// Node:Buffer (Cost), or
 			// Empty
-			if (entry->getNextNode())	
+			if (entry.getNextNode())	
 			{
 				// In case there is a next node
-				Node *next = entry->getNextNode();
+				Node *next = entry.getNextNode();
 				std::string element = next->getName() + ':'; 
 
 				// Make sure the buffer exists, and add it to
 				// the string
-				if (entry->getBuffer())
-					element = element + entry->getBuffer()->
+				if (entry.getBuffer())
+					element = element + entry.getBuffer()->
 							getName();
-				element = element + ' ' + '(' + std::to_string(entry->cost)
+				element = element + ' ' + '(' + std::to_string(entry.cost)
 							+ ')';
 
 				// Printing the entry out
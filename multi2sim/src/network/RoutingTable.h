@@ -29,6 +29,8 @@ namespace net
 class Network;
 class Node;
 class Buffer;
+class Link;
+class Switch;
   
 class RoutingTable
 {
@@ -74,16 +76,102 @@ public:
 		void setBuffer(Buffer *buffer) { this->buffer = buffer; }
 	};
 
+	/// Routing algorithms
+	enum Algorithm
+	{
+		AlgorithmShortestPath = 0,
+		AlgorithmDimensionOrder,
+		AlgorithmWestFirst
+	};
+
 private:
 
+	// Directions of a switch in a mesh or torus
+	enum Direction
+	{
+		DirectionEast = 0,
+		DirectionWest,
+		DirectionNorth,
+		DirectionSouth,
+		DirectionCount
+	};
+
 	// Associated network
 	Network *network;
 
 	// Dimension
 	int dimension = 0;
 
-	// Entries
-	std::vector<std::unique_ptr<Entry>> entries;
+	// Entries, stored as a flat dimension x dimension table
+	std::vector<Entry> entries;
+
+	// Routing algorithm
+	Algorithm algorithm = AlgorithmShortestPath;
+
+
+
+	//
+	// Dimension-order routing
+	//
+
+	// Size of the mesh or torus in each dimension
+	int size_x = 0;
+	int size_y = 0;
+
+	// Whether wrap-around links are present in each dimension
+	bool wrap_x = false;
+	bool wrap_y = false;
+
+	// Number of virtual channel classes in each dimension. Tori whose
+	// links have at least two virtual channels use two classes to break
+	// the cycles of the rings.
+	int num_vc_classes_x = 1;
+	int num_vc_classes_y = 1;
+
+	// Switches of the mesh, indexed by y * size_x + x
+	std::vector<Switch *> grid;
+
+	// Switch each node is attached to, indexed by node index. A switch
+	// is its own home switch.
+	std::vector<Switch *> home_switches;
+
+	// Output buffer of each end node toward its home switch, indexed by
+	// node index
+	std::vector<Buffer *> up_buffers;
+
+	// Output buffer of the home switch toward each end node, indexed by
+	// node index
+	std::vector<Buffer *> down_buffers;
+
+	// Link of each switch toward its neighbor in each direction,
+	// indexed by node index * DirectionCount + direction
+	std::vector<Link *> direction_links;
+
+	// Return the number of hops between two coordinates in a dimension
+	static int getDistance(int from, int to, int size, bool wrap);
+
+	// Return the direction to follow in a dimension to reach coordinate
+	// 'to' from coordinate 'from'. The first of the two given directions
+	// is the one increasing the coordinate.
+	static Direction getDirection(int from, int to, int size, bool wrap,
+			Direction increase, Direction decrease);
+
+	// Return the virtual channel class used in a dimension by a packet
+	// at coordinate 'from' moving toward coordinate 'to' in the given
+	// direction. With two classes, the upper class is used while the
+	// packet still has to cross the wrap-around link, and the lower
+	// class afterwards.
+	static int getVirtualChannelClass(int from, int to,
+			int num_vc_classes, bool increase);
+
+	// Add the output buffers of the virtual channels of a class in the
+	// link of a switch toward the given direction
+	void addDirectionBuffers(Switch *node, Direction direction,
+			int vc_class, int num_vc_classes,
+			std::vector<Buffer *> &buffers) const;
+
+	// Compute a route for dimension-order routing
+	Entry getDimensionOrderRoute(Node *source, Node *destination) const;
 
 public:
 
@@ -98,11 +186,61 @@ public:
 	/// the table structures.
 	void Initialize();
 
-	/// Perform a Floyd-Warshall to find the best routes
+	/// Return the routing algorithm
+	Algorithm getAlgorithm() const { return algorithm; }
+
+	/// Perform a Floyd-Warshall to find the best routes. This is the
+	/// reference implementation of ShortestPaths(), with a cost of
+	/// O(n^3) in the number of nodes.
 	void FloydWarshall();
 
-	/// Look up the entry from a certain node to a certain node
-	Entry *Lookup(Node *source, Node *destination) const;
+	/// Find the best routes with a breadth-first search from each node,
+	/// with a cost of O(n * (n + e)) for n nodes and e connections. The
+	/// resulting routes, including the choice among paths of equal cost,
+	/// are the same as those produced by FloydWarshall().
+	void ShortestPaths();
+
+	/// Set up dimension-order routing for a network whose switches form
+	/// a 2D mesh or torus, as given by their coordinates. Each end node
+	/// must be linked to exactly one switch. Routes are computed
+	/// arithmetically on each lookup with getRoute(), and the table of
+	/// entries is not materialized. In tori whose links have at least
+	/// two virtual channels, the virtual channels are split in two
+	/// classes to avoid deadlocks in the rings. An exception is thrown
+	/// if the topology is not a mesh or torus.
+	void DimensionOrder();
+
+	/// Set up west-first adaptive routing for a network whose switches
+	/// form a 2D mesh. Packets whose destination is to the west are
+	/// routed west first, and then adaptively among the directions
+	/// getting closer to the destination. The requirements are the same
+	/// as for DimensionOrder(), and tori are not supported.
+	void WestFirst();
+
+	/// Return whether routes are computed from the coordinates of the
+	/// switches instead of stored in the table
+	bool hasCoordinateRouting() const
+	{
+		return algorithm != AlgorithmShortestPath;
+	}
+
+	/// Look up the entry from a certain node to a certain node. This
+	/// function is only valid for routing tables that are materialized,
+	/// that is, not using dimension-order routing.
+	Entry *Lookup(Node *source, Node *destination);
+
+	/// Return the route from a certain node to a certain node, for any
+	/// routing algorithm. For adaptive algorithms, this is the route
+	/// followed in the absence of congestion.
+	Entry getRoute(Node *source, Node *destination) const;
+
+	/// Add to a vector all output buffers of a node that a packet can
+	/// take toward a destination. Table-based routing provides only the
+	/// buffer of the table entry, while coordinate-based routing
+	/// provides every virtual channel allowed by the virtual channel
+	/// classes, and every direction allowed by the adaptive algorithm.
+	void getCandidateBuffers(Node *node, Node *destination,
+			std::vector<Buffer *> &buffers) const;
 
 	/// Generating the route file
 	void DumpRoutes(const std::string &path);
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <climits>
+
 #include "Packet.h"
 #include "Switch.h"
 
@@ -44,6 +46,10 @@ void Switch::Dump(std::ostream &os) const
 	os << misc::fmt("ReceivedPackets = %lld\n", received_packets);
 	os << misc::fmt("ReceiveRate = %0.4f\n", cycle ?
 			(double) received_bytes / cycle : 0.0 );
+	if (network->getRoutingTable()->hasCoordinateRouting())
+		os << misc::fmt("AdaptiveHops = %lld\n", num_adaptive_hops);
+	if (network->isWormhole())
+		network->getWormhole()->DumpRouter(this, os);
 
 	// Dumping input buffers' information
 	for (auto &buffer : input_buffers)
@@ -95,18 +101,16 @@ void Switch::Forward(Packet *packet)
 		return;
 	}
 
-	// Look up the routing table for next output buffer
+	// Select the output buffer toward the destination
 	RoutingTable *routing_table = network->getRoutingTable();
 	Node *destination_node = message->getDestinationNode();
-	RoutingTable::Entry *entry = 
-			routing_table->Lookup(node, destination_node);
-	if (!entry) 
+	Buffer *output_buffer = SelectOutputBuffer(packet);
+	if (!output_buffer) 
 		throw misc::Panic(misc::fmt("%s: no route from %s "
 				"to %s.",
 				network->getName().c_str(), 
 				node->getName().c_str(), 
 				destination_node->getName().c_str()));
-	Buffer *output_buffer = entry->getBuffer();
 
 	// Check if the output buffer is busy
 	if (output_buffer->write_busy >= cycle)
@@ -192,8 +196,14 @@ void Switch::Forward(Packet *packet)
 		return;
 	}
 
+	// Record hops that deviate from the congestion-free route
+	if (routing_table->hasCoordinateRouting() && output_buffer !=
+			routing_table->getRoute(this, destination_node).
+			getBuffer())
+		num_adaptive_hops++;
+
 	// Calculate latency and occupy resources
-	int latency = (packet->getSize() - 1) / bandwidth + 1;
+	int latency = getTransferLatency(packet->getSize());
 	input_buffer->read_busy = cycle + latency - 1;
 	output_buffer->write_busy = cycle + latency - 1;
 
@@ -227,6 +237,43 @@ void Switch::Forward(Packet *packet)
 }
 
 
+Buffer *Switch::SelectOutputBuffer(Packet *packet)
+{
+	// Table-based routing offers a single output buffer
+	Message *message = packet->getMessage();
+	Node *destination_node = message->getDestinationNode();
+	RoutingTable *routing_table = message->getNetwork()->getRoutingTable();
+	if (!routing_table->hasCoordinateRouting())
+		return routing_table->getRoute(this, destination_node).
+				getBuffer();
+
+	// Candidate output buffers
+	candidate_buffers.clear();
+	routing_table->getCandidateBuffers(this, destination_node,
+			candidate_buffers);
+
+	// Select the candidate with most free space, counting busy buffers
+	// as full. The first candidate wins ties, which follows the
+	// congestion-free route.
+	long long cycle = System::getInstance()->getCycle();
+	Buffer *selected = nullptr;
+	int selected_space = INT_MIN;
+	for (Buffer *buffer : candidate_buffers)
+	{
+		int space = buffer->getSize() - buffer->getCount();
+		if (buffer->write_busy >= cycle)
+			space -= buffer->getSize();
+		if (space > selected_space)
+		{
+			selected = buffer;
+			selected_space = space;
+		}
+	}
+	packet->setRouteBuffer(selected);
+	return selected;
+}
+
+
 Buffer *Switch::Schedule(Buffer *output_buffer) 
 {
 	// Checks if the scheduler is an output buffer
@@ -287,20 +334,19 @@ Buffer *Switch::Schedule(Buffer *output_buffer)
 			continue;
 
 		// Skip the buffer whose first packet is not to be forwarded
-		// to the output buffer
+		// to the output buffer. A packet keeps the output buffer
+		// selected for it in this switch, if any.
 		Packet *packet = input_buffer->getBufferHead();
 		Message *message = packet->getMessage();
 		Node *destination_node = message->getDestinationNode();
-		Network *network = message->getNetwork();
-		RoutingTable *routingTable = network->getRoutingTable();
-		RoutingTable::Entry *entry = routingTable->Lookup(this, 
-				destination_node);
-		if (!entry) 
+		Buffer *next_buffer = packet->getRouteBuffer();
+		if (!next_buffer || next_buffer->getNode() != this)
+			next_buffer = SelectOutputBuffer(packet);
+		if (!next_buffer) 
 			throw misc::Panic(misc::fmt("No route found from "
 					"node %s to node %s", 
 					this->getName().c_str(),
 					destination_node->getName().c_str()));
-		Buffer *next_buffer = entry->getBuffer();
 		if (next_buffer != output_buffer)
 			continue;
 	
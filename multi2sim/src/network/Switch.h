@@ -20,17 +20,38 @@
 #ifndef NETWORK_SWITCH_H
 #define NETWORK_SWITCH_H
 
+#include <vector>
+
 #include "Node.h"
 
 namespace net
 {
 
+class Packet;
+
 // A switch is a node that passes packets to next link
 class Switch : public Node
 {
 	// Bandwidth of the switch
 	int bandwidth;
 
+	// Coordinates of the switch in a mesh or torus, or -1 if not given
+	int x = -1;
+	int y = -1;
+
+	// Candidate output buffers, kept to avoid allocations
+	std::vector<Buffer *> candidate_buffers;
+
+	// Number of packets forwarded through an output buffer other than
+	// the one of the congestion-free route
+	long long num_adaptive_hops = 0;
+
+	// Select the output buffer for a packet at the head of an input
+	// buffer. With adaptive routing, the selection favors output
+	// buffers that are not busy and have more free space, and is
+	// recorded in the packet.
+	Buffer *SelectOutputBuffer(Packet *packet);
+
 public:
 
 	/// Constructor
@@ -53,6 +74,30 @@ public:
 	/// Dump node information
 	void Dump(std::ostream &os) const;
 
+	/// Set the coordinates of the switch in a mesh or torus, used by
+	/// dimension-order routing.
+	void setCoordinates(int x, int y)
+	{
+		this->x = x;
+		this->y = y;
+	}
+
+	/// Return whether coordinates were given for the switch
+	bool hasCoordinates() const { return x >= 0 && y >= 0; }
+
+	/// Return the X coordinate of the switch
+	int getX() const { return x; }
+
+	/// Return the Y coordinate of the switch
+	int getY() const { return y; }
+
+	/// Return the number of cycles the crossbar takes to forward a packet
+	/// of the given size
+	int getTransferLatency(int size) const
+	{
+		return (size - 1) / bandwidth + 1;
+	}
+
 	/// Forward the packet to next hop
 	/// 
 	/// This function would at first assert the packet is in an input 
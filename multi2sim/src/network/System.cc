@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <fstream>
+
 #include <lib/cpp/CommandLine.h>
 #include <lib/esim/Engine.h>
 #include <lib/cpp/Misc.h>
@@ -53,6 +55,24 @@ double System::injection_rate = 0.001;
 
 bool System::stand_alone = false;
 
+Traffic::Pattern System::traffic_pattern = Traffic::PatternUniform;
+
+std::string System::hotspot_name;
+
+double System::hotspot_fraction = 0.1;
+
+std::string System::message_size_distribution_spec;
+
+SizeDistribution System::message_size_distribution;
+
+std::string System::traffic_trace_file;
+
+std::string System::sweep_file;
+
+double System::sweep_step = 0.0;
+
+double System::sweep_max = 1.0;
+
 bool System::help = false;
 
 int System::frequency = 1000;
@@ -75,14 +95,6 @@ System *System::getInstance()
 }
 
 
-double System::RandomExponential(double lambda)
-{
-	double x = (double) random() / RAND_MAX;
-	double ret = log(1 - x) / -lambda;
-	return ret;
-}
-
-
 System::System()
 {
 	// Create frequency domain
@@ -100,6 +112,8 @@ System::System()
 			frequency_domain);
 	event_receive = esim_engine->RegisterEvent("receive", 
 			EventTypeReceiveHandler, frequency_domain);
+	event_wormhole = esim_engine->RegisterEvent("wormhole",
+			EventTypeWormholeHandler, frequency_domain);
 
 
 }
@@ -158,6 +172,76 @@ void System::RegisterOptions()
 			"in the network configuration file (option "
 			"'--net-config')");
 
+	// Traffic pattern for stand-alone simulator
+	command_line->RegisterEnum("--net-traffic {uniform|transpose|bitcomp|"
+			"hotspot|neighbor} (default = uniform)",
+			(int &) traffic_pattern, Traffic::PatternMap,
+			"For network simulation, destination of the packets "
+			"injected by each end node. With 'uniform', any other "
+			"end node is picked at random. The 'transpose', "
+			"'bitcomp', and 'neighbor' patterns number the end "
+			"nodes in the order they are defined, and send from "
+			"node i to the node with the row and column of i "
+			"swapped in a square, to the node with all bits of i "
+			"complemented, and to node i + 1, respectively. With "
+			"'hotspot', a fraction of the packets goes to one end "
+			"node (options '--net-hotspot' and "
+			"'--net-hotspot-fraction') and the rest is uniform.");
+
+	// Hotspot node
+	command_line->RegisterString("--net-hotspot <node> (default = first "
+			"end node)", hotspot_name,
+			"Destination end node for '--net-traffic hotspot'.");
+
+	// Hotspot fraction
+	command_line->RegisterDouble("--net-hotspot-fraction <number> "
+			"(default = 0.1)", hotspot_fraction,
+			"Fraction of the packets sent to the hotspot node for "
+			"'--net-traffic hotspot'.");
+
+	// Message size distribution
+	command_line->RegisterString("--net-msg-size-dist <size>:<weight>[,...]",
+			message_size_distribution_spec,
+			"For network simulation, distribution of packet sizes "
+			"in bytes, given as a comma-separated list of sizes "
+			"with relative weights (e.g., '8:0.8,72:0.2' for 80% "
+			"control packets and 20% data packets). The largest "
+			"size replaces the one given with '--net-msg-size'.");
+
+	// Trace replay
+	command_line->RegisterString("--net-trace-replay <file>",
+			traffic_trace_file,
+			"For network simulation, inject the packets listed in "
+			"<file> instead of synthetic traffic. Each line has the "
+			"format '<cycle> <source> <destination> [<size>]', with "
+			"source and destination given as end node names, and "
+			"cycles in increasing order. Packets that do not fit in "
+			"the source node wait instead of being dropped. The "
+			"simulation finishes once all packets are delivered.");
+
+	// Injection rate sweep
+	command_line->RegisterString("--net-sweep <file>", sweep_file,
+			"For network simulation, run a sequence of simulations "
+			"on the network, starting at the rate given with "
+			"'--net-injection-rate' and increasing it by "
+			"'--net-sweep-step' until the network saturates or the "
+			"rate reaches '--net-sweep-max'. Each simulation runs "
+			"for '--net-max-cycles' cycles, the first 20% of them "
+			"being warmup. The offered and accepted throughput and "
+			"the average latency of each rate are dumped into "
+			"<file>, as well as the saturation point.");
+
+	// Sweep step
+	command_line->RegisterDouble("--net-sweep-step <number> "
+			"(default = initial rate)", sweep_step,
+			"Injection rate increment between the simulations of "
+			"option '--net-sweep'.");
+
+	// Sweep maximum
+	command_line->RegisterDouble("--net-sweep-max <number> (default = 1)",
+			sweep_max,
+			"Maximum injection rate for option '--net-sweep'.");
+
 	// Help message for network configuration
 	command_line->RegisterBool("--net-help",
 			help,
@@ -208,6 +292,27 @@ void System::ProcessOptions()
 	if (stand_alone && config_file.empty())
 		throw Error(misc::fmt("Option --net-sim requires "
 				" --net-config option "));
+
+	// Message size distribution. The largest size must fit in the end
+	// node buffers, which is checked when parsing the configuration.
+	message_size_distribution.Parse(message_size_distribution_spec);
+	if (!message_size_distribution.isEmpty())
+		message_size = message_size_distribution.getMaxSize();
+
+	// Injection rate sweep
+	if (!sweep_file.empty())
+	{
+		if (!traffic_trace_file.empty())
+			throw Error("Options --net-sweep and --net-trace-replay "
+					"are incompatible");
+		if (injection_rate <= 0.0 || sweep_step < 0.0 ||
+				sweep_max < injection_rate)
+			throw Error("Invalid injection rates for option "
+					"--net-sweep");
+		if (max_cycles < 10)
+			throw Error("Option --net-sweep requires at least 10 "
+					"cycles per simulation");
+	}
 }
 
 
@@ -243,79 +348,162 @@ void System::TraceHeader()
 }
 
 
-void System::UniformTrafficSimulation(Network *network)
+void System::TrafficSimulation(Network *network, Traffic *traffic,
+		long long end_cycle)
 {
-	// Initiate a list of double for injection time
-	auto inject_time = misc::new_unique_array<double>(network->getNumNodes());
-
-	// Loop from the beginning to the end the simulation
+	// Loop until the end cycle
+	esim::Engine *esim_engine = esim::Engine::getInstance();
 	while (1)
 	{
-		// Get current cycle and check max cycles
-		esim::Engine *esim_engine = esim::Engine::getInstance();
-		long long cycle = System::getInstance()->getCycle();
-		if (cycle >= max_cycles)
+		// Get current cycle and check end cycle
+		long long cycle = getCycle();
+		if (cycle >= end_cycle)
 			break;
 
-		// Traverse all nodes to check if some nodes need injection
-		for (int i = 0; i < network->getNumNodes(); i++)
-		{
-			// Get end node
-			EndNode *node = dynamic_cast<EndNode *>(
-					network->getNode(i));
-			if (!node)
-				continue;
-
-			// Check turn for next injection
-			if (inject_time[i] > cycle)
-				continue;
-
-			// Get a random destination node
-			EndNode *destination_node = nullptr;
-			while (1)
-			{
-				int num_nodes = network->getNumNodes();
-				int index = random() % num_nodes;
-				destination_node = dynamic_cast<EndNode *>(
-						network->getNode(index));
-				if (destination_node && destination_node != 
-						node)
-					break;
-			}
-
-			// Inject
-			while (inject_time[i] < cycle)
-			{
-				// Schedule next injection
-				inject_time[i] += RandomExponential(
-						injection_rate);
-
-				// Send the packet
-				if (network->CanSend(node, destination_node,
-					System::message_size))
-					network->Send(node, destination_node,
-							System::message_size);
-			}
-		}
+		// A replayed trace finishes when all its messages arrived
+		if (traffic->hasTrace() && traffic->isTraceDone() &&
+				!network->getNumMessagesInFlight())
+			break;
+
+		// Inject messages due in this cycle
+		traffic->Inject(cycle);
 
 		// Next cycle
-		debug << misc::fmt("___ cycle %lld ___\n", cycle);	
+		debug << misc::fmt("___ cycle %lld ___\n", cycle);
 		esim_engine->ProcessEvents();
 	}
 }
 
+
+void System::SweepSimulation(Network *network, Traffic *traffic)
+{
+	// Open output file
+	std::ofstream f(sweep_file);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot open sweep file",
+				sweep_file.c_str()));
+
+	// Simulation length of each injection rate
+	long long warmup_cycles = max_cycles / 5;
+	long long measured_cycles = max_cycles - warmup_cycles;
+	double step = sweep_step > 0.0 ? sweep_step : injection_rate;
+	double num_end_nodes = network->getNumEndNodes();
+
+	// Header
+	f << misc::fmt("# Network '%s', %s traffic, %.4g bytes per message "
+			"on average\n", network->getName().c_str(),
+			Traffic::PatternMap[traffic->getPattern()],
+			traffic->getAverageMessageSize());
+	f << "# Throughput in bytes per cycle and end node, latency in "
+			"cycles\n";
+	f << misc::fmt("# %-12s %-12s %-12s %-12s %-12s\n", "InjRate",
+			"Offered", "Accepted", "Latency", "DropRatio");
+
+	// Sweep
+	double zero_load_latency = 0.0;
+	double max_accepted = 0.0;
+	double saturation_rate = 0.0;
+	for (int point = 0; ; point++)
+	{
+		// Injection rate, stopping when it exceeds the maximum with
+		// some tolerance for rounding errors
+		double rate = injection_rate + point * step;
+		if (rate > sweep_max * (1.0 + 1e-9))
+			break;
+		traffic->setInjectionRate(rate);
+
+		// Warmup
+		TrafficSimulation(network, traffic, getCycle() + warmup_cycles);
+
+		// Measure
+		long long transfers = network->getTransfers();
+		long long latency = network->getAccumulatedLatency();
+		long long bytes = network->getAccumulatedBytes();
+		long long offered_messages = traffic->getNumOfferedMessages();
+		long long offered_bytes = traffic->getNumOfferedBytes();
+		long long dropped_messages = traffic->getNumDroppedMessages();
+		TrafficSimulation(network, traffic,
+				getCycle() + measured_cycles);
+		transfers = network->getTransfers() - transfers;
+		latency = network->getAccumulatedLatency() - latency;
+		bytes = network->getAccumulatedBytes() - bytes;
+		offered_messages = traffic->getNumOfferedMessages() -
+				offered_messages;
+		offered_bytes = traffic->getNumOfferedBytes() - offered_bytes;
+		dropped_messages = traffic->getNumDroppedMessages() -
+				dropped_messages;
+
+		// Results
+		double offered = offered_bytes /
+				(num_end_nodes * measured_cycles);
+		double accepted = bytes / (num_end_nodes * measured_cycles);
+		double average_latency = transfers ?
+				(double) latency / transfers : 0.0;
+		double drop_ratio = offered_messages ?
+				(double) dropped_messages / offered_messages :
+				0.0;
+		f << misc::fmt("  %-12.6g %-12.6g %-12.6g %-12.6g %-12.6g\n",
+				rate, offered, accepted, average_latency,
+				drop_ratio);
+		max_accepted = std::max(max_accepted, accepted);
+
+		// The network saturates when the latency grows beyond three
+		// times the zero-load latency, or when it accepts less than
+		// 90% of the offered traffic
+		if (point == 0)
+			zero_load_latency = average_latency;
+		if (!transfers || average_latency > 3.0 * zero_load_latency ||
+				accepted < 0.9 * offered)
+		{
+			saturation_rate = rate;
+			break;
+		}
+	}
+
+	// Saturation point
+	if (saturation_rate > 0.0)
+		f << misc::fmt("# Saturation injection rate = %.6g\n",
+				saturation_rate);
+	else
+		f << misc::fmt("# No saturation up to injection rate %.6g\n",
+				sweep_max);
+	f << misc::fmt("# Saturation throughput = %.6g\n", max_accepted);
+}
+
+
 void System::StandAlone()
 {
-	// Generate a uniform traffic pattern on the network.
-	// Later, this function can be easily extended (via a switch)
-	// to support other traffic patterns, hence the stand-alone
-	// function is not combined with the uniform traffic function.
+	// Network
 	Network *network = getNetworkByName(sim_net_name);
 	if (!network)
 		throw Error(misc::fmt("%s: The network does not exist for "
 				"stand-alone simulation\n",
 				config_file.c_str()));
-	UniformTrafficSimulation(network);
+
+	// Traffic generator
+	Traffic traffic(network, traffic_pattern);
+	traffic.setInjectionRate(injection_rate);
+	traffic.setMessageSize(message_size);
+	traffic.setSizeDistribution(message_size_distribution);
+	if (traffic_pattern == Traffic::PatternHotspot)
+	{
+		EndNode *hotspot_node = traffic.getHotspot();
+		if (!hotspot_name.empty())
+			hotspot_node = dynamic_cast<EndNode *>(
+					network->getNodeByName(hotspot_name));
+		if (!hotspot_node)
+			throw Error(misc::fmt("%s: Invalid hotspot end node",
+					hotspot_name.c_str()));
+		traffic.setHotspot(hotspot_node, hotspot_fraction);
+	}
+	if (!traffic_trace_file.empty())
+		traffic.LoadTrace(traffic_trace_file);
+
+	// Simulate
+	if (sweep_file.empty())
+		TrafficSimulation(network, &traffic, max_cycles);
+	else
+		SweepSimulation(network, &traffic);
 }
 
 
@@ -330,6 +518,13 @@ void System::DumpReport()
 }
 
 
+void System::DumpJsonReport(misc::JsonWriter &json) const
+{
+	for (auto &network : networks)
+		network->DumpJsonReport(json);
+}
+
+
 void System::StaticGraph()
 {
 	// Dumping the graph file for each network
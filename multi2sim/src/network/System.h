@@ -26,11 +26,14 @@
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/Error.h>
 #include <lib/cpp/IniFile.h>
+#include <lib/cpp/Json.h>
 #include <lib/esim/Engine.h>
 #include <lib/esim/Event.h>
 #include <lib/esim/Trace.h>
 
 #include "Network.h"
+#include "Traffic.h"
+
 namespace net
 {
 
@@ -91,6 +94,32 @@ class System
 	// Stand-alone simulator instantiator
 	static bool stand_alone;
 
+	// Traffic pattern for stand-alone simulation
+	static Traffic::Pattern traffic_pattern;
+
+	// Name of the destination end node of hotspot traffic
+	static std::string hotspot_name;
+
+	// Fraction of the messages sent to the hotspot
+	static double hotspot_fraction;
+
+	// Message size distribution for stand-alone simulation, as given by
+	// the user, and parsed
+	static std::string message_size_distribution_spec;
+	static SizeDistribution message_size_distribution;
+
+	// Trace file with messages to replay in stand-alone simulation
+	static std::string traffic_trace_file;
+
+	// Output file of the injection rate sweep
+	static std::string sweep_file;
+
+	// Injection rate increment between sweep points
+	static double sweep_step;
+
+	// Maximum injection rate of the sweep
+	static double sweep_max;
+
 	// Unique instance of singleton
 	static std::unique_ptr<System> instance;
 
@@ -104,9 +133,6 @@ class System
 	static const int trace_version_major;
 	static const int trace_version_minor;
 
-	// Get a exponential random valueclass Network;
-	static double RandomExponential(double lambda);
-
 
 
 
@@ -120,6 +146,7 @@ class System
 	static void EventTypeOutputBufferHandler(esim::Event *, esim::Frame *);
 	static void EventTypeInputBufferHandler(esim::Event *, esim::Frame *);
 	static void EventTypeReceiveHandler(esim::Event *, esim::Frame *);
+	static void EventTypeWormholeHandler(esim::Event *, esim::Frame *);
 
 
 
@@ -163,6 +190,7 @@ public:
 	static esim::Event *event_output_buffer;
 	static esim::Event *event_input_buffer;
 	static esim::Event *event_receive;
+	static esim::Event *event_wormhole;
 
 	/// Network system trace
 	static esim::Trace trace;
@@ -229,6 +257,10 @@ public:
 	/// Output the report file
 	void DumpReport();
 
+	/// Dump the statistics of all networks as members of the current
+	/// JSON object, one per network.
+	void DumpJsonReport(misc::JsonWriter &json) const;
+
 	/// Output the route file
 	void DumpRoutes();
 
@@ -242,8 +274,18 @@ public:
 	// file passed with '--net-config' by the user.
 	void ReadConfiguration();
 
-	// Uniform traffic simulation
-	void UniformTrafficSimulation(Network *network);
+	/// Run a stand-alone simulation injecting the synthetic traffic
+	/// generated by `traffic` until the network cycle reaches `end_cycle`.
+	/// If the traffic is replayed from a trace, the simulation finishes
+	/// earlier once the whole trace is delivered.
+	void TrafficSimulation(Network *network, Traffic *traffic,
+			long long end_cycle);
+
+	/// Run a sequence of stand-alone simulations with an increasing
+	/// injection rate, and dump the latency and throughput of each of
+	/// them into the file given with option '--net-sweep'. The sweep
+	/// finishes at the first injection rate that saturates the network.
+	void SweepSimulation(Network *network, Traffic *traffic);
 
 	// Stand-Alone simulation
 	void StandAlone();
@@ -70,6 +70,62 @@ const std::string System::help_message =
 		"      packetizing, with the fix_latency, regardless of\n"
 		"      the network topology. The ideal option still requires a\n"
 		"      network to connect the end-nodes to each other\n"
+		"  Model = {Detailed|Analytical|Wormhole} (Default = Detailed)\n"
+		"      Timing model of the network. With 'Detailed', packets move\n"
+		"      hop by hop through links, switches, and buffers. With\n"
+		"      'Analytical', the delivery time of a message is computed\n"
+		"      when it is sent, adding the latencies of the links and\n"
+		"      switches in its route and a queueing delay estimated from\n"
+		"      the recent utilization of each link. Messages do not\n"
+		"      occupy buffers, and only two events are simulated for\n"
+		"      each message. With 'Wormhole', packets are split into\n"
+		"      flits that move through the virtual channels of the links\n"
+		"      with credit-based flow control, and switches are routers\n"
+		"      with a pipeline of route computation, virtual channel\n"
+		"      allocation, switch allocation, and switch traversal\n"
+		"      stages, of one cycle each. Buses are not supported.\n"
+		"  FlitSize = <bytes> (Default = bandwidth of the narrowest link)\n"
+		"      Flit size for the 'Wormhole' model. A link takes one flit\n"
+		"      every size / bandwidth cycles.\n"
+		"  FlitBufferSize = <flits> (Default = input buffer size / FlitSize)\n"
+		"      Size of the buffer of each virtual channel in the switches\n"
+		"      for the 'Wormhole' model.\n"
+		"  VirtualCutThrough = <true/false> (Default = false)\n"
+		"      Use virtual cut-through instead of wormhole switching in\n"
+		"      the 'Wormhole' model, allocating a virtual channel to a\n"
+		"      packet only when the whole packet fits in its buffer.\n"
+		"  Topology = {Custom|Mesh2D|Torus2D} (Default = Custom)\n"
+		"      With 'Custom', the nodes and links of the network are\n"
+		"      given in the sections below. 'Mesh2D' and 'Torus2D'\n"
+		"      generate a grid of switches named 's<i>', with i = y * X\n"
+		"      + x, and end nodes named 'n<j>', with the end nodes from\n"
+		"      j = i * Concentration linked to switch i. Additional nodes\n"
+		"      and links can still be given in the sections below.\n"
+		"  Dimensions = <x> <y> (Required for Mesh2D and Torus2D)\n"
+		"      Number of switches in each dimension.\n"
+		"  Concentration = <num> (Default = 1)\n"
+		"      Number of end nodes linked to each generated switch.\n"
+		"  LinkBandwidth = <bandwidth> (Default = DefaultBandwidth)\n"
+		"      Bandwidth of the generated links.\n"
+		"  VC = <num> (Default = 1)\n"
+		"      Number of virtual channels of the generated links between\n"
+		"      switches.\n"
+		"  Routing = {ShortestPath|DimensionOrder|WestFirst}\n"
+		"          (Default = ShortestPath, or DimensionOrder for Mesh2D and\n"
+		"          Torus2D)\n"
+		"      Routing algorithm. With 'ShortestPath', a routing table is\n"
+		"      built with the shortest paths between all nodes, unless\n"
+		"      manual routes are given. With 'DimensionOrder', switches\n"
+		"      must form a 2D mesh or torus given by their coordinates,\n"
+		"      each end node must be linked to one switch, and routes\n"
+		"      follow the X dimension first and then the Y dimension,\n"
+		"      without building a routing table. In tori whose links have\n"
+		"      two or more virtual channels, these are split in two classes\n"
+		"      to avoid deadlocks. 'WestFirst' has the same requirements on\n"
+		"      a mesh, and lets packets not heading west choose adaptively\n"
+		"      among the directions approaching their destination. With\n"
+		"      both, switches pick the least occupied virtual channel and\n"
+		"      direction allowed.\n"
 		"\n"
 		"Sections '[ Network.<network>.Node.<node> ]' are used to \n"
 		"define nodes in network '<network>'.\n"
@@ -86,6 +142,9 @@ const std::string System::help_message =
 		"      For switches, bandwidth of internal crossbar communicating\n"
 		"       input with output buffers. For end nodes, this variable\n"
 		"       is ignored.\n"
+		"  Coordinates = <x> <y> (Optional)\n"
+		"      For switches, position in a 2D mesh or torus, used by\n"
+		"      dimension-order routing.\n"
 		"\n"
 		"Sections '[ Network.<network>.Link.<link> ]' are used to define \n"
 		"links in network <network>. A link connects an output buffer of\n"
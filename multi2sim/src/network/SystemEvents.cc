@@ -35,6 +35,7 @@ esim::Event *System::event_send;
 esim::Event *System::event_output_buffer;
 esim::Event *System::event_input_buffer;
 esim::Event *System::event_receive;
+esim::Event *System::event_wormhole;
 
 
 void System::EventTypeSendHandler(esim::Event *event,
@@ -73,12 +74,33 @@ void System::EventTypeSendHandler(esim::Event *event,
 		return;
 	}
 
+	// For the analytical model, skip to the receive event. The message
+	// travels as a single packet.
+	if (network->isAnalytical())
+	{
+		// Delivery time, updating link and node statistics
+		int latency = network->getAnalyticalLatency(message);
+
+		// Debug Information
+		debug << misc::fmt("net: %s - M-%lld:%d - "
+				"analytical_lat=%d\n",
+				network->getName().c_str(),
+				message->getId(),
+				packet->getId(),
+				latency);
+
+		// Schedule reception
+		packet->setNode(destination_node);
+		esim_engine->Next(event_receive, latency);
+		return;
+	}
+
 	// Lookup route from routing table
 	RoutingTable *routing_table = network->getRoutingTable();
-	RoutingTable::Entry *entry = routing_table->Lookup(
+	RoutingTable::Entry entry = routing_table->getRoute(
 			source_node,
 			destination_node);
-	Buffer *output_buffer = entry->getBuffer();
+	Buffer *output_buffer = entry.getBuffer();
 	if (!output_buffer)
 		throw misc::Panic(misc::fmt("%s: no route from "
 				"%s to %s.",
@@ -116,6 +138,14 @@ void System::EventTypeSendHandler(esim::Event *event,
 			message->getId(), packet->getId(),
 			output_buffer->getOccupancyInBytes());
 
+	// In the flit-level model, wait until the tail flit of the packet
+	// reaches the destination
+	if (network->isWormhole())
+	{
+		network->getWormhole()->Inject(packet, event_receive);
+		return;
+	}
+
 	// Schedule next event
 	esim_engine->Next(event_output_buffer, 1);
 }
@@ -231,5 +261,20 @@ void System::EventTypeReceiveHandler(esim::Event *event,
 	}
 }
 
+
+void System::EventTypeWormholeHandler(esim::Event *event,
+		esim::Frame *frame)
+{
+	// Cast event frame type
+	Wormhole::Frame *wormhole_frame = misc::cast<Wormhole::Frame *>(frame);
+	Wormhole *wormhole = wormhole_frame->getWormhole();
+
+	// Advance the flit-level model, and keep doing it every cycle while
+	// there are packets in the network
+	wormhole->Tick();
+	if (wormhole->isActive())
+		esim::Engine::getInstance()->Next(event, 1);
+}
+
 }
 
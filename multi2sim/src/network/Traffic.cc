@@ -0,0 +1,421 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+
+#include <lib/cpp/Misc.h>
+
+#include "EndNode.h"
+#include "Network.h"
+#include "Traffic.h"
+
+
+namespace net
+{
+
+const misc::StringMap Traffic::PatternMap =
+{
+	{ "uniform", PatternUniform },
+	{ "transpose", PatternTranspose },
+	{ "bitcomp", PatternBitComplement },
+	{ "hotspot", PatternHotspot },
+	{ "neighbor", PatternNeighbor }
+};
+
+
+void SizeDistribution::Parse(const std::string &spec)
+{
+	// Reset
+	sizes.clear();
+	cumulative_weights.clear();
+
+	// Read elements
+	std::vector<std::string> elements;
+	misc::StringTokenize(spec, elements, ", ");
+	double total_weight = 0.0;
+	for (auto &element : elements)
+	{
+		// Size
+		size_t colon = element.find(':');
+		misc::StringError error;
+		int size = misc::StringToInt(element.substr(0, colon), error);
+		if (error || size < 1)
+			throw Traffic::Error(misc::fmt("%s: Invalid message size "
+					"in size distribution",
+					element.c_str()));
+
+		// Weight
+		double weight = 1.0;
+		if (colon != std::string::npos)
+		{
+			std::string text = element.substr(colon + 1);
+			char *end;
+			weight = strtod(text.c_str(), &end);
+			if (text.empty() || *end || !(weight > 0.0))
+				throw Traffic::Error(misc::fmt("%s: Invalid weight "
+						"in size distribution",
+						element.c_str()));
+		}
+
+		// Add
+		total_weight += weight;
+		sizes.push_back(size);
+		cumulative_weights.push_back(total_weight);
+	}
+
+	// Normalize
+	for (double &weight : cumulative_weights)
+		weight /= total_weight;
+}
+
+
+int SizeDistribution::getMaxSize() const
+{
+	int max_size = 0;
+	for (int size : sizes)
+		max_size = std::max(max_size, size);
+	return max_size;
+}
+
+
+double SizeDistribution::getAverageSize() const
+{
+	double average = 0.0;
+	double previous_weight = 0.0;
+	for (unsigned i = 0; i < sizes.size(); i++)
+	{
+		average += sizes[i] * (cumulative_weights[i] - previous_weight);
+		previous_weight = cumulative_weights[i];
+	}
+	return average;
+}
+
+
+int SizeDistribution::Sample() const
+{
+	assert(!sizes.empty());
+	double x = (double) random() / RAND_MAX;
+	for (unsigned i = 0; i < sizes.size() - 1; i++)
+		if (x < cumulative_weights[i])
+			return sizes[i];
+	return sizes.back();
+}
+
+
+Traffic::Traffic(Network *network, Pattern pattern) :
+		network(network),
+		pattern(pattern)
+{
+	// Collect end nodes
+	for (int i = 0; i < network->getNumNodes(); i++)
+	{
+		EndNode *node = dynamic_cast<EndNode *>(network->getNode(i));
+		if (node)
+			end_nodes.push_back(node);
+	}
+	int num_end_nodes = end_nodes.size();
+	if (num_end_nodes < 2)
+		throw Error(misc::fmt("%s: Synthetic traffic requires at "
+				"least two end nodes",
+				network->getName().c_str()));
+	inject_time.resize(num_end_nodes);
+
+	// Default hotspot
+	setHotspot(end_nodes[0], 0.1);
+
+	// Check that the pattern fits the number of end nodes
+	switch (pattern)
+	{
+
+	case PatternTranspose:
+
+		transpose_side = lround(sqrt(num_end_nodes));
+		if (transpose_side * transpose_side != num_end_nodes)
+			throw Error(misc::fmt("%s: Transpose traffic requires "
+					"a square number of end nodes (%d "
+					"given)", network->getName().c_str(),
+					num_end_nodes));
+		break;
+
+	case PatternBitComplement:
+
+		if (num_end_nodes & (num_end_nodes - 1))
+			throw Error(misc::fmt("%s: Bit-complement traffic "
+					"requires a power of 2 number of end "
+					"nodes (%d given)",
+					network->getName().c_str(),
+					num_end_nodes));
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+double Traffic::RandomExponential(double lambda)
+{
+	double x = (double) random() / RAND_MAX;
+	double ret = log(1 - x) / -lambda;
+	return ret;
+}
+
+
+int Traffic::getEndNodeIndex(EndNode *node) const
+{
+	for (unsigned i = 0; i < end_nodes.size(); i++)
+		if (end_nodes[i] == node)
+			return i;
+	throw misc::Panic("End node not in network");
+}
+
+
+void Traffic::setHotspot(EndNode *node, double fraction)
+{
+	if (fraction < 0.0 || fraction > 1.0)
+		throw Error(misc::fmt("Invalid hotspot fraction (%g)",
+				fraction));
+	hotspot_node = node;
+	hotspot_fraction = fraction;
+}
+
+
+int Traffic::getMessageSize() const
+{
+	if (size_distribution.isEmpty())
+		return message_size;
+	return size_distribution.Sample();
+}
+
+
+double Traffic::getAverageMessageSize() const
+{
+	if (size_distribution.isEmpty())
+		return message_size;
+	return size_distribution.getAverageSize();
+}
+
+
+EndNode *Traffic::getDestination(EndNode *node)
+{
+	int num_end_nodes = end_nodes.size();
+	switch (pattern)
+	{
+
+	case PatternHotspot:
+
+		// Hotspot messages
+		if (node != hotspot_node && (double) random() / RAND_MAX <
+				hotspot_fraction)
+			return hotspot_node;
+
+		// Fall through to uniform traffic for the rest
+
+	case PatternUniform:
+	{
+		// Random end node other than the source
+		while (1)
+		{
+			int num_nodes = network->getNumNodes();
+			int index = random() % num_nodes;
+			EndNode *destination_node = dynamic_cast<EndNode *>(
+					network->getNode(index));
+			if (destination_node && destination_node != node)
+				return destination_node;
+		}
+	}
+
+	case PatternTranspose:
+	{
+		// Swap row and column of the end node in the square. Nodes
+		// on the diagonal do not inject.
+		int index = getEndNodeIndex(node);
+		int row = index / transpose_side;
+		int column = index % transpose_side;
+		if (row == column)
+			return nullptr;
+		return end_nodes[column * transpose_side + row];
+	}
+
+	case PatternBitComplement:
+
+		return end_nodes[~getEndNodeIndex(node) & (num_end_nodes - 1)];
+
+	case PatternNeighbor:
+
+		return end_nodes[(getEndNodeIndex(node) + 1) % num_end_nodes];
+
+	default:
+
+		throw misc::Panic("Invalid traffic pattern");
+	}
+}
+
+
+void Traffic::LoadTrace(std::istream &is, const std::string &path)
+{
+	// Reset
+	trace.clear();
+	trace.resize(end_nodes.size());
+	num_pending_records = 0;
+
+	// Read lines
+	std::string line;
+	long long last_cycle = 0;
+	for (int line_num = 1; std::getline(is, line); line_num++)
+	{
+		// Skip empty lines and comments
+		std::vector<std::string> tokens;
+		misc::StringTokenize(line, tokens);
+		if (tokens.empty() || tokens[0][0] == '#')
+			continue;
+
+		// Fields
+		std::string where = misc::fmt("%s:%d", path.c_str(), line_num);
+		if (tokens.size() < 3 || tokens.size() > 4)
+			throw Error(misc::fmt("%s: Invalid format, expected "
+					"'<cycle> <source> <destination> "
+					"[<size>]'", where.c_str()));
+
+		// Cycle
+		misc::StringError error;
+		TraceRecord record;
+		record.cycle = misc::StringToInt64(tokens[0], error);
+		if (error || record.cycle < last_cycle)
+			throw Error(misc::fmt("%s: Invalid cycle, or cycle "
+					"smaller than in a previous line",
+					where.c_str()));
+		last_cycle = record.cycle;
+
+		// Source and destination
+		EndNode *source_node = dynamic_cast<EndNode *>(
+				network->getNodeByName(tokens[1]));
+		record.destination_node = dynamic_cast<EndNode *>(
+				network->getNodeByName(tokens[2]));
+		if (!source_node || !record.destination_node)
+			throw Error(misc::fmt("%s: Source or destination is "
+					"not an end node of network '%s'",
+					where.c_str(),
+					network->getName().c_str()));
+		if (source_node == record.destination_node)
+			throw Error(misc::fmt("%s: Source and destination "
+					"are the same node", where.c_str()));
+
+		// Size
+		record.size = message_size;
+		if (tokens.size() == 4)
+		{
+			record.size = misc::StringToInt(tokens[3], error);
+			if (error || record.size < 1)
+				throw Error(misc::fmt("%s: Invalid message size",
+						where.c_str()));
+		}
+		if (record.size > message_size)
+			throw Error(misc::fmt("%s: Message size larger than "
+					"the maximum message size (%d). Use "
+					"option '--net-msg-size' to increase "
+					"it.", where.c_str(), message_size));
+
+		// Add record
+		trace[getEndNodeIndex(source_node)].push_back(record);
+		num_pending_records++;
+	}
+}
+
+
+void Traffic::LoadTrace(const std::string &path)
+{
+	std::ifstream f(path);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot open trace file",
+				path.c_str()));
+	LoadTrace(f, path);
+}
+
+
+void Traffic::InjectTrace(long long cycle)
+{
+	for (unsigned i = 0; i < end_nodes.size(); i++)
+	{
+		// Messages of each source are injected in order, so a message
+		// that does not fit delays the following ones
+		EndNode *node = end_nodes[i];
+		std::deque<TraceRecord> &records = trace[i];
+		while (!records.empty() && records.front().cycle <= cycle)
+		{
+			TraceRecord &record = records.front();
+			if (!network->CanSend(node, record.destination_node,
+					record.size))
+				break;
+			network->Send(node, record.destination_node,
+					record.size);
+			num_offered_messages++;
+			num_offered_bytes += record.size;
+			num_pending_records--;
+			records.pop_front();
+		}
+	}
+}
+
+
+void Traffic::Inject(long long cycle)
+{
+	// Trace replay
+	if (hasTrace())
+	{
+		InjectTrace(cycle);
+		return;
+	}
+
+	// Traverse all end nodes to check if some nodes need injection
+	for (unsigned i = 0; i < end_nodes.size(); i++)
+	{
+		// Check turn for next injection
+		if (inject_time[i] > cycle)
+			continue;
+
+		// Get destination node
+		EndNode *node = end_nodes[i];
+		EndNode *destination_node = getDestination(node);
+		if (!destination_node)
+			continue;
+
+		// Inject
+		while (inject_time[i] < cycle)
+		{
+			// Schedule next injection
+			inject_time[i] += RandomExponential(injection_rate);
+
+			// Send the message, or drop it if it does not fit
+			int size = getMessageSize();
+			num_offered_messages++;
+			num_offered_bytes += size;
+			if (network->CanSend(node, destination_node, size))
+				network->Send(node, destination_node, size);
+			else
+				num_dropped_messages++;
+		}
+	}
+}
+
+}  // namespace net
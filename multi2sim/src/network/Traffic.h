@@ -0,0 +1,261 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NETWORK_TRAFFIC_H
+#define NETWORK_TRAFFIC_H
+
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/String.h>
+
+
+namespace net
+{
+
+class EndNode;
+class Network;
+
+
+/// Distribution of message sizes for synthetic traffic, given as a list of
+/// sizes with relative weights.
+class SizeDistribution
+{
+	// Message sizes
+	std::vector<int> sizes;
+
+	// Cumulative weights of the sizes, normalized to 1
+	std::vector<double> cumulative_weights;
+
+public:
+
+	/// Parse a distribution given as a comma-separated list of elements
+	/// with format '<size>:<weight>', or '<size>' for a weight of 1. An
+	/// empty string gives an empty distribution. Throw an exception of
+	/// type net::Traffic::Error if the format is invalid.
+	void Parse(const std::string &spec);
+
+	/// Return whether the distribution has no sizes
+	bool isEmpty() const { return sizes.empty(); }
+
+	/// Return the largest size in the distribution
+	int getMaxSize() const;
+
+	/// Return the average size in the distribution
+	double getAverageSize() const;
+
+	/// Return a random size following the distribution
+	int Sample() const;
+};
+
+
+/// Synthetic traffic generator for stand-alone network simulation. The
+/// generator injects messages between the end nodes of a network following
+/// a traffic pattern, at a given injection rate, or replays the messages
+/// listed in a trace file.
+class Traffic
+{
+public:
+
+	/// Traffic patterns. Patterns other than uniform and hotspot are
+	/// permutations of the end nodes, identified by their position in
+	/// the order they were added to the network.
+	enum Pattern
+	{
+		PatternInvalid = 0,
+		PatternUniform,
+		PatternTranspose,
+		PatternBitComplement,
+		PatternHotspot,
+		PatternNeighbor
+	};
+
+	/// String map for values of type Pattern
+	static const misc::StringMap PatternMap;
+
+	/// Exception for the network traffic generator
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("Network traffic");
+		}
+	};
+
+private:
+
+	// Message read from a trace file
+	struct TraceRecord
+	{
+		// Cycle when the message is injected
+		long long cycle;
+
+		// Destination end node
+		EndNode *destination_node;
+
+		// Message size
+		int size;
+	};
+
+	// Network
+	Network *network;
+
+	// Traffic pattern
+	Pattern pattern;
+
+	// End nodes of the network, in the order they were added
+	std::vector<EndNode *> end_nodes;
+
+	// Side of the end node square for the transpose pattern
+	int transpose_side = 0;
+
+	// Destination of hotspot traffic
+	EndNode *hotspot_node = nullptr;
+
+	// Fraction of the messages sent to the hotspot
+	double hotspot_fraction = 0.0;
+
+	// Message size when no size distribution is given
+	int message_size = 1;
+
+	// Message size distribution
+	SizeDistribution size_distribution;
+
+	// Injection rate in messages per cycle and end node
+	double injection_rate = 0.0;
+
+	// Time of the next injection for each end node
+	std::vector<double> inject_time;
+
+	// Pending messages of the trace, for each source end node
+	std::vector<std::deque<TraceRecord>> trace;
+
+	// Number of trace records not injected yet
+	long long num_pending_records = 0;
+
+	// Return a random number from an exponential distribution
+	static double RandomExponential(double lambda);
+
+	// Return the position of an end node in vector 'end_nodes'
+	int getEndNodeIndex(EndNode *node) const;
+
+	// Inject the messages of the trace up to the given cycle
+	void InjectTrace(long long cycle);
+
+
+
+	//
+	// Statistics
+	//
+
+	// Number of messages offered to the network
+	long long num_offered_messages = 0;
+
+	// Number of bytes offered to the network
+	long long num_offered_bytes = 0;
+
+	// Number of offered messages dropped for lack of buffer space
+	long long num_dropped_messages = 0;
+
+public:
+
+	/// Constructor
+	Traffic(Network *network, Pattern pattern);
+
+	/// Return the traffic pattern
+	Pattern getPattern() const { return pattern; }
+
+	/// Set the destination of hotspot traffic and the fraction of
+	/// messages sent to it. The rest of the messages follow a uniform
+	/// pattern.
+	void setHotspot(EndNode *node, double fraction);
+
+	/// Return the destination of hotspot traffic, which is the first end
+	/// node unless set with setHotspot()
+	EndNode *getHotspot() const { return hotspot_node; }
+
+	/// Set the size of all messages
+	void setMessageSize(int size) { message_size = size; }
+
+	/// Set the message size distribution, replacing the fixed message
+	/// size
+	void setSizeDistribution(const SizeDistribution &distribution)
+	{
+		size_distribution = distribution;
+	}
+
+	/// Return the size of the next message
+	int getMessageSize() const;
+
+	/// Return the average message size
+	double getAverageMessageSize() const;
+
+	/// Set the injection rate in messages per cycle and end node
+	void setInjectionRate(double rate) { injection_rate = rate; }
+
+	/// Return the injection rate
+	double getInjectionRate() const { return injection_rate; }
+
+	/// Return the destination of a message injected by the given end
+	/// node following the traffic pattern, or `nullptr` if the end node
+	/// does not inject messages in this pattern.
+	EndNode *getDestination(EndNode *node);
+
+	/// Read the messages to replay from a trace file. Each line of the
+	/// file has the format '<cycle> <source> <destination> [<size>]',
+	/// where the source and destination are end node names, and the size
+	/// defaults to the configured message size. Empty lines and lines
+	/// starting with '#' are ignored, and cycles must not decrease. Once
+	/// a trace is loaded, messages are injected from the trace instead
+	/// of the traffic pattern.
+	void LoadTrace(std::istream &is, const std::string &path = "");
+
+	/// Same as LoadTrace(), reading the trace from a file
+	void LoadTrace(const std::string &path);
+
+	/// Return whether messages are replayed from a trace
+	bool hasTrace() const { return !trace.empty(); }
+
+	/// Return whether all messages of the trace have been injected
+	bool isTraceDone() const { return num_pending_records == 0; }
+
+	/// Inject the messages of all end nodes due in the given cycle. With
+	/// a traffic pattern, messages that do not fit in the source buffer
+	/// are dropped. Messages from a trace wait until they fit.
+	void Inject(long long cycle);
+
+	/// Return the number of messages offered to the network
+	long long getNumOfferedMessages() const { return num_offered_messages; }
+
+	/// Return the number of bytes offered to the network
+	long long getNumOfferedBytes() const { return num_offered_bytes; }
+
+	/// Return the number of offered messages that were dropped
+	long long getNumDroppedMessages() const { return num_dropped_messages; }
+};
+
+
+}  // namespace net
+
+#endif
@@ -0,0 +1,525 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include <lib/cpp/Misc.h>
+#include <lib/esim/Engine.h>
+
+#include "Buffer.h"
+#include "Link.h"
+#include "Message.h"
+#include "Network.h"
+#include "Packet.h"
+#include "Switch.h"
+#include "System.h"
+#include "Wormhole.h"
+
+
+namespace net
+{
+
+Wormhole::Wormhole(Network *network) :
+		network(network),
+		flit_size(network->getFlitSize()),
+		virtual_cut_through(network->isVirtualCutThrough())
+{
+	// Only links are supported, and the flit size defaults to the
+	// bandwidth of the narrowest link
+	int min_bandwidth = 0;
+	for (int i = 0; i < network->getNumConnections(); i++)
+	{
+		Link *link = dynamic_cast<Link *>(network->getConnection(i));
+		if (!link)
+			throw Error(misc::fmt("%s: Buses are not supported by "
+					"the flit-level model",
+					network->getName().c_str()));
+		if (!min_bandwidth || link->getBandwidth() < min_bandwidth)
+			min_bandwidth = link->getBandwidth();
+	}
+	if (!flit_size)
+		flit_size = std::max(min_bandwidth, 1);
+
+	// Routers
+	for (int i = 0; i < network->getNumNodes(); i++)
+	{
+		Switch *node = dynamic_cast<Switch *>(network->getNode(i));
+		if (!node)
+			continue;
+		routers.emplace_back(misc::new_unique<Router>());
+		Router *router = routers.back().get();
+		router->node = node;
+		router_map[node] = router;
+	}
+
+	// Virtual channels of the links
+	for (int i = 0; i < network->getNumConnections(); i++)
+	{
+		// Physical channel
+		Link *link = misc::cast<Link *>(network->getConnection(i));
+		ports.emplace_back(misc::new_unique<Port>());
+		Port *port = ports.back().get();
+		port->link = link;
+		port->latency = link->getTransferLatency(flit_size);
+
+		// Routers at both ends of the link
+		auto it = router_map.find(dynamic_cast<Switch *>(
+				link->getSourceNode()));
+		Router *source_router = it == router_map.end() ?
+				nullptr : it->second;
+		it = router_map.find(dynamic_cast<Switch *>(
+				link->getDestinationNode()));
+		Router *destination_router = it == router_map.end() ?
+				nullptr : it->second;
+		if (source_router)
+			source_router->num_output_ports++;
+		if (destination_router)
+			destination_router->num_input_ports++;
+
+		// Virtual channels
+		for (int j = 0; j < link->getNumSourceBuffers(); j++)
+		{
+			// Output virtual channel
+			Buffer *buffer = link->getSourceBuffer(j);
+			auto output = misc::new_unique<OutputChannel>();
+			output->buffer = buffer;
+			output->destination_buffer = link->
+					getDestinationBufferfromSource(buffer);
+			output->port = port;
+
+			// Input virtual channel at the destination switch
+			if (destination_router)
+			{
+				auto input = misc::new_unique<InputChannel>();
+				input->buffer = output->destination_buffer;
+				input->router = destination_router;
+				input->capacity = network->getFlitBufferSize();
+				if (!input->capacity)
+					input->capacity = std::max(1, input->
+							buffer->getSize() /
+							flit_size);
+				input->upstream = output.get();
+				output->downstream = input.get();
+				output->credits = input->capacity;
+				destination_router->inputs.push_back(input.get());
+				input_channels.emplace_back(std::move(input));
+			}
+
+			// Injection from an end node, through the only output
+			// virtual channel its packets can take
+			if (!source_router)
+			{
+				auto input = misc::new_unique<InputChannel>();
+				input->buffer = buffer;
+				input->candidates.push_back(output.get());
+				injection_map[buffer] = input.get();
+				injection_channels.emplace_back(std::move(input));
+			}
+
+			// Add output virtual channel
+			output_channels[buffer] = std::move(output);
+		}
+	}
+}
+
+
+int Wormhole::getNumFlits(Packet *packet) const
+{
+	return (packet->getSize() - 1) / flit_size + 1;
+}
+
+
+bool Wormhole::CanAllocateChannel(InputChannel *input,
+		OutputChannel *output) const
+{
+	// Virtual channel held by another packet
+	if (output->owner)
+		return false;
+
+	// Ejection into an end node, which must have room for the packet
+	Packet *packet = input->flits.front().packet;
+	if (!output->downstream)
+	{
+		Buffer *buffer = output->destination_buffer;
+		return buffer->getCount() + packet->getSize() <=
+				buffer->getSize();
+	}
+
+	// With virtual cut-through, the whole packet must fit
+	if (virtual_cut_through)
+	{
+		int num_flits = getNumFlits(packet);
+		if (num_flits > output->downstream->capacity)
+			throw Error(misc::fmt("%s: Packets of %d flits do not "
+					"fit in the %d-flit virtual channels "
+					"of buffer '%s' with virtual "
+					"cut-through switching",
+					network->getName().c_str(),
+					num_flits,
+					output->downstream->capacity,
+					output->destination_buffer->
+					getName().c_str()));
+		return output->credits >= num_flits;
+	}
+
+	// With wormhole switching, an idle virtual channel is enough
+	return true;
+}
+
+
+void Wormhole::AllocateChannel(InputChannel *input, OutputChannel *output,
+		long long cycle)
+{
+	// Reserve space for the packet in the destination end node
+	Packet *packet = input->flits.front().packet;
+	if (!output->downstream)
+		output->destination_buffer->InsertPacket(packet);
+
+	// Allocate
+	output->owner = input;
+	input->output = output;
+	input->state = StateActive;
+	input->state_cycle = cycle;
+}
+
+
+void Wormhole::SendFlit(InputChannel *input, long long cycle)
+{
+	// Extract flit
+	Flit flit = input->flits.front();
+	input->flits.pop_front();
+	OutputChannel *output = input->output;
+	Port *port = output->port;
+
+	// Consume a credit of the next virtual channel, and return one to
+	// the previous virtual channel in the next cycle
+	if (output->downstream)
+		output->credits--;
+	if (input->upstream)
+		credits.emplace_back(cycle + 1, input->upstream);
+
+	// Traverse the crossbar in the next cycle for switches, and then
+	// the link
+	port->grant_cycle = cycle;
+	port->free_cycle = cycle + port->latency;
+	FlitInFlight flit_in_flight;
+	flit_in_flight.cycle = cycle + port->latency + (input->router ? 2 : 1);
+	flit_in_flight.id = flit_id_counter++;
+	flit_in_flight.flit = flit;
+	flit_in_flight.channel = output;
+	flits_in_flight.push(flit_in_flight);
+
+	// Link statistics, once per packet
+	Packet *packet = flit.packet;
+	if (flit.head)
+		port->link->RecordTransfer(port->link->getSourceNode(),
+				port->link->getDestinationNode(),
+				packet->getSize(), 1);
+
+	// The tail flit releases the output virtual channel, and the output
+	// buffer of the end node injecting the packet
+	if (flit.tail)
+	{
+		output->owner = nullptr;
+		input->output = nullptr;
+		input->state = StateIdle;
+		input->state_cycle = cycle;
+		if (!input->router)
+			input->buffer->ExtractPacket();
+	}
+}
+
+
+void Wormhole::ReceiveFlit(FlitInFlight &flit_in_flight)
+{
+	// Write the flit into the input virtual channel of a switch
+	Flit &flit = flit_in_flight.flit;
+	OutputChannel *channel = flit_in_flight.channel;
+	if (channel->downstream)
+	{
+		flit.cycle = flit_in_flight.cycle;
+		channel->downstream->flits.push_back(flit);
+		return;
+	}
+
+	// The packet is ejected with its tail flit
+	if (!flit.tail)
+		return;
+	Packet *packet = flit.packet;
+	Buffer *buffer = channel->destination_buffer;
+	packet->setNode(buffer->getNode());
+	packet->setBuffer(buffer);
+	packet->setBusy(flit_in_flight.cycle);
+
+	// Debug
+	Message *message = packet->getMessage();
+	System::debug << misc::fmt("net: %s - M-%lld:%d - "
+			"flit_eject: %s:%s\n",
+			network->getName().c_str(),
+			message->getId(),
+			packet->getId(),
+			buffer->getNode()->getName().c_str(),
+			buffer->getName().c_str());
+
+	// Resume the event chain of the packet
+	auto it = packets.find(packet);
+	assert(it != packets.end());
+	std::unique_ptr<esim::Queue> queue = std::move(it->second);
+	packets.erase(it);
+	queue->WakeupOne();
+}
+
+
+void Wormhole::AdvanceRouter(Router *router, long long cycle)
+{
+	// Nothing to do for switches without inputs
+	int num_inputs = router->inputs.size();
+	if (!num_inputs)
+		return;
+
+	// Switch allocation. Each input port and each output port take at
+	// most one flit per cycle, with round-robin priority among the
+	// input virtual channels. Body flits are ready two cycles after
+	// being written, the time the head flit takes in RC and VA.
+	for (int i = 0; i < num_inputs; i++)
+	{
+		InputChannel *input = router->inputs[(router->sa_position + i) %
+				num_inputs];
+		if (input->state != StateActive || input->state_cycle >= cycle ||
+				input->flits.empty() ||
+				input->flits.front().cycle + 2 > cycle)
+			continue;
+
+		// Check crossbar ports and credits
+		OutputChannel *output = input->output;
+		Port *input_port = input->upstream->port;
+		if (input_port->read_cycle == cycle ||
+				output->port->grant_cycle == cycle ||
+				output->port->free_cycle > cycle ||
+				(output->downstream && !output->credits))
+		{
+			router->num_switch_allocation_stalls++;
+			continue;
+		}
+
+		// Grant
+		input_port->read_cycle = cycle;
+		router->num_switch_allocations++;
+		SendFlit(input, cycle);
+	}
+	router->sa_position = (router->sa_position + 1) % num_inputs;
+
+	// Virtual channel allocation, choosing among the candidate output
+	// virtual channels the one with most credits
+	for (int i = 0; i < num_inputs; i++)
+	{
+		InputChannel *input = router->inputs[(router->va_position + i) %
+				num_inputs];
+		if (input->state != StateRouted || input->state_cycle >= cycle)
+			continue;
+		OutputChannel *output = nullptr;
+		for (OutputChannel *candidate : input->candidates)
+			if (CanAllocateChannel(input, candidate) && (!output ||
+					candidate->credits > output->credits))
+				output = candidate;
+		if (!output)
+		{
+			router->num_vc_allocation_stalls++;
+			continue;
+		}
+		router->num_vc_allocations++;
+		AllocateChannel(input, output, cycle);
+	}
+	router->va_position = (router->va_position + 1) % num_inputs;
+
+	// Route computation for head flits, which can happen in the same
+	// cycle the tail flit of the previous packet leaves
+	RoutingTable *routing_table = network->getRoutingTable();
+	for (InputChannel *input : router->inputs)
+	{
+		if (input->state != StateIdle || input->flits.empty() ||
+				input->flits.front().cycle > cycle)
+			continue;
+		Flit &flit = input->flits.front();
+		assert(flit.head);
+
+		// Candidate output virtual channels
+		Node *destination_node = flit.packet->getMessage()->
+				getDestinationNode();
+		candidate_buffers.clear();
+		routing_table->getCandidateBuffers(router->node,
+				destination_node, candidate_buffers);
+		if (candidate_buffers.empty())
+			throw misc::Panic(misc::fmt("%s: no route from %s to %s",
+					network->getName().c_str(),
+					router->node->getName().c_str(),
+					destination_node->getName().c_str()));
+		input->candidates.clear();
+		for (Buffer *buffer : candidate_buffers)
+			input->candidates.push_back(
+					output_channels.at(buffer).get());
+
+		// Next stage
+		router->num_route_computations++;
+		input->state = StateRouted;
+		input->state_cycle = cycle;
+	}
+}
+
+
+void Wormhole::AdvanceInjection(long long cycle)
+{
+	for (auto &input : injection_channels)
+	{
+		// Packets take one cycle to be inserted in the output buffer
+		if (input->flits.empty() || input->flits.front().cycle >= cycle)
+			continue;
+
+		// Allocate the virtual channel of the link for the head flit
+		OutputChannel *output = input->candidates[0];
+		if (input->state != StateActive)
+		{
+			if (!CanAllocateChannel(input.get(), output))
+				continue;
+			AllocateChannel(input.get(), output, cycle);
+		}
+
+		// Send a flit if the link is free and there are credits
+		if (output->port->grant_cycle == cycle ||
+				output->port->free_cycle > cycle ||
+				(output->downstream && !output->credits))
+			continue;
+		SendFlit(input.get(), cycle);
+	}
+}
+
+
+void Wormhole::Inject(Packet *packet, esim::Event *event)
+{
+	// Find injection channel
+	auto it = injection_map.find(packet->getBuffer());
+	if (it == injection_map.end())
+		throw misc::Panic(misc::fmt("%s: packet not in an output "
+				"buffer of an end node",
+				network->getName().c_str()));
+	InputChannel *input = it->second;
+
+	// Split the packet into flits
+	long long cycle = System::getInstance()->getCycle();
+	int num_flits = getNumFlits(packet);
+	for (int i = 0; i < num_flits; i++)
+	{
+		Flit flit;
+		flit.packet = packet;
+		flit.head = i == 0;
+		flit.tail = i == num_flits - 1;
+		flit.cycle = cycle;
+		input->flits.push_back(flit);
+	}
+
+	// Suspend the current event chain until the packet is ejected
+	auto queue = misc::new_unique<esim::Queue>();
+	queue->Wait(event);
+	packets[packet] = std::move(queue);
+
+	// Advance the model from the next cycle
+	if (!active)
+	{
+		active = true;
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		esim_engine->Call(System::event_wormhole,
+				misc::new_shared<Frame>(this),
+				nullptr, 1);
+	}
+}
+
+
+void Wormhole::Tick()
+{
+	// Credits returned in this cycle
+	long long cycle = System::getInstance()->getCycle();
+	while (!credits.empty() && credits.front().first <= cycle)
+	{
+		credits.front().second->credits++;
+		credits.pop_front();
+	}
+
+	// Flits reaching the end of a link
+	while (!flits_in_flight.empty() && flits_in_flight.top().cycle <= cycle)
+	{
+		FlitInFlight flit_in_flight = flits_in_flight.top();
+		flits_in_flight.pop();
+		ReceiveFlit(flit_in_flight);
+	}
+
+	// Router pipelines
+	for (auto &router : routers)
+		AdvanceRouter(router.get(), cycle);
+
+	// Injection
+	AdvanceInjection(cycle);
+
+	// Keep advancing while there are packets in the network
+	active = !packets.empty();
+}
+
+
+void Wormhole::DumpRouter(const Switch *node, std::ostream &os) const
+{
+	// Find router
+	auto it = router_map.find(node);
+	if (it == router_map.end())
+		return;
+	Router *router = it->second;
+
+	// Port cycles
+	long long cycle = System::getInstance()->getCycle();
+	double input_port_cycles = (double) cycle * router->num_input_ports;
+	double output_port_cycles = (double) cycle * router->num_output_ports;
+
+	// Pipeline stages
+	os << misc::fmt("FlitSize = %d\n", flit_size);
+	os << misc::fmt("RouteComputations = %lld\n",
+			router->num_route_computations);
+	os << misc::fmt("RouteComputationUtilization = %0.4f\n",
+			input_port_cycles ? router->num_route_computations /
+			input_port_cycles : 0.0);
+	os << misc::fmt("VCAllocations = %lld\n",
+			router->num_vc_allocations);
+	os << misc::fmt("VCAllocationStalls = %lld\n",
+			router->num_vc_allocation_stalls);
+	os << misc::fmt("VCAllocationUtilization = %0.4f\n",
+			input_port_cycles ? router->num_vc_allocations /
+			input_port_cycles : 0.0);
+	os << misc::fmt("SwitchAllocations = %lld\n",
+			router->num_switch_allocations);
+	os << misc::fmt("SwitchAllocationStalls = %lld\n",
+			router->num_switch_allocation_stalls);
+	os << misc::fmt("SwitchAllocationUtilization = %0.4f\n",
+			input_port_cycles ? router->num_switch_allocations /
+			input_port_cycles : 0.0);
+	os << misc::fmt("SwitchTraversals = %lld\n",
+			router->num_switch_allocations);
+	os << misc::fmt("SwitchTraversalUtilization = %0.4f\n",
+			output_port_cycles ? router->num_switch_allocations /
+			output_port_cycles : 0.0);
+}
+
+
+}  // namespace net
@@ -0,0 +1,371 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NETWORK_WORMHOLE_H
+#define NETWORK_WORMHOLE_H
+
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <lib/esim/Event.h>
+#include <lib/esim/Queue.h>
+
+
+namespace net
+{
+
+class Buffer;
+class Link;
+class Network;
+class Node;
+class Packet;
+class Switch;
+
+
+/// Flit-level timing model of a network. Packets are split into flits of a
+/// fixed size, which move through the virtual channels of the links with
+/// credit-based flow control. Switches are input-buffered routers with a
+/// four-stage pipeline: route computation (RC), virtual channel allocation
+/// (VA), switch allocation (SA), and switch traversal (ST), followed by
+/// link traversal.
+///
+/// Each virtual channel of a link has a buffer of flits at its destination
+/// switch. With wormhole switching, a packet acquires a virtual channel as
+/// soon as it is idle, and its flits advance while there are credits. With
+/// virtual cut-through, the virtual channel is only acquired if it has
+/// room for the whole packet. Packets are injected from the output buffers
+/// of the source end node, and are ejected into the input buffers of the
+/// destination end node, where space for the whole packet is reserved
+/// before its head flit leaves the last switch.
+class Wormhole
+{
+public:
+
+	/// Event frame of the event advancing the model one cycle
+	class Frame : public esim::Frame
+	{
+		// Flit-level model
+		Wormhole *wormhole;
+
+	public:
+
+		/// Constructor
+		Frame(Wormhole *wormhole) : wormhole(wormhole)
+		{
+		}
+
+		/// Return the flit-level model
+		Wormhole *getWormhole() const { return wormhole; }
+	};
+
+private:
+
+	struct Port;
+	struct OutputChannel;
+	struct Router;
+
+	// Flit of a packet
+	struct Flit
+	{
+		// Packet the flit belongs to
+		Packet *packet;
+
+		// First and last flit of the packet
+		bool head;
+		bool tail;
+
+		// Cycle when the flit was written into its current buffer
+		long long cycle;
+	};
+
+	// Flit traversing a link
+	struct FlitInFlight
+	{
+		// Cycle when the flit arrives at the end of the link
+		long long cycle;
+
+		// Order of the flit among those traversing links, used to
+		// break ties in the cycle
+		long long id;
+
+		// Flit
+		Flit flit;
+
+		// Virtual channel the flit is traversing
+		OutputChannel *channel;
+
+		// Order for the priority queue, giving the earliest flit first
+		bool operator<(const FlitInFlight &other) const
+		{
+			return cycle > other.cycle || (cycle == other.cycle &&
+					id > other.id);
+		}
+	};
+
+	// States of the packet at the head of an input virtual channel
+	enum State
+	{
+		// Waiting for the head flit of a packet
+		StateIdle,
+
+		// Route computed, waiting for an output virtual channel
+		StateRouted,
+
+		// Output virtual channel allocated, sending flits
+		StateActive
+	};
+
+	// Virtual channel of a switch input port, or output buffer of an end
+	// node injecting flits into the network
+	struct InputChannel
+	{
+		// Buffer of the link's virtual channel
+		Buffer *buffer;
+
+		// Router of the switch, or `nullptr` for an end node
+		Router *router = nullptr;
+
+		// Flits in the buffer
+		std::deque<Flit> flits;
+
+		// Capacity in flits
+		int capacity = 0;
+
+		// Virtual channel feeding this one with flits, holding its
+		// credits, or `nullptr` for an end node
+		OutputChannel *upstream = nullptr;
+
+		// State of the packet at the head
+		State state = StateIdle;
+
+		// Cycle when the packet at the head reached its state
+		long long state_cycle = 0;
+
+		// Output virtual channels the packet at the head can take,
+		// computed in the RC stage
+		std::vector<OutputChannel *> candidates;
+
+		// Output virtual channel allocated to the packet at the head
+		OutputChannel *output = nullptr;
+	};
+
+	// Virtual channel of a link, seen from its source node
+	struct OutputChannel
+	{
+		// Output buffer of the link's virtual channel
+		Buffer *buffer;
+
+		// Input buffer of the link's virtual channel
+		Buffer *destination_buffer;
+
+		// Physical channel of the link
+		Port *port;
+
+		// Input virtual channel at the destination switch, or
+		// `nullptr` if the link ejects into an end node
+		InputChannel *downstream = nullptr;
+
+		// Free flit slots in the downstream virtual channel
+		int credits = 0;
+
+		// Input virtual channel holding this virtual channel
+		InputChannel *owner = nullptr;
+	};
+
+	// Physical channel of a link
+	struct Port
+	{
+		// Link
+		Link *link;
+
+		// Number of cycles to transfer a flit
+		int latency;
+
+		// First cycle when the link can take a new flit
+		long long free_cycle = 0;
+
+		// Last cycle a flit was granted to the link
+		long long grant_cycle = -1;
+
+		// Last cycle a flit was read from the virtual channels of the
+		// link at its destination switch
+		long long read_cycle = -1;
+	};
+
+	// Router of a switch
+	struct Router
+	{
+		// Switch
+		Switch *node;
+
+		// Input virtual channels
+		std::vector<InputChannel *> inputs;
+
+		// Number of input and output ports
+		int num_input_ports = 0;
+		int num_output_ports = 0;
+
+		// Position of the first input virtual channel considered
+		// in the next allocation, for round-robin arbitration
+		unsigned va_position = 0;
+		unsigned sa_position = 0;
+
+		// Operations of each pipeline stage
+		long long num_route_computations = 0;
+		long long num_vc_allocations = 0;
+		long long num_switch_allocations = 0;
+
+		// Cycles that input virtual channels waited for an output
+		// virtual channel or a crossbar grant
+		long long num_vc_allocation_stalls = 0;
+		long long num_switch_allocation_stalls = 0;
+	};
+
+	// Network
+	Network *network;
+
+	// Flit size in bytes
+	int flit_size;
+
+	// Acquire virtual channels only with space for the whole packet
+	bool virtual_cut_through;
+
+	// Physical channels of the links
+	std::vector<std::unique_ptr<Port>> ports;
+
+	// Input virtual channels of the switches
+	std::vector<std::unique_ptr<InputChannel>> input_channels;
+
+	// Output buffers of the end nodes
+	std::vector<std::unique_ptr<InputChannel>> injection_channels;
+
+	// Output virtual channels, indexed by their output buffer
+	std::unordered_map<Buffer *, std::unique_ptr<OutputChannel>>
+			output_channels;
+
+	// Routers, one per switch
+	std::vector<std::unique_ptr<Router>> routers;
+
+	// Routers indexed by their switch
+	std::unordered_map<const Switch *, Router *> router_map;
+
+	// Injection channels indexed by their output buffer
+	std::unordered_map<Buffer *, InputChannel *> injection_map;
+
+	// Flits traversing links
+	std::priority_queue<FlitInFlight> flits_in_flight;
+
+	// Counter for flit identifiers in 'flits_in_flight'
+	long long flit_id_counter = 0;
+
+	// Credits returned to an output virtual channel, with the cycle
+	// when they arrive
+	std::deque<std::pair<long long, OutputChannel *>> credits;
+
+	// Event chains of the packets in the network, waiting for the tail
+	// flit to be ejected
+	std::unordered_map<Packet *, std::unique_ptr<esim::Queue>> packets;
+
+	// Whether the event advancing the model is scheduled
+	bool active = false;
+
+	// Candidate output buffers, kept to avoid allocations
+	std::vector<Buffer *> candidate_buffers;
+
+	// Return the number of flits of a packet
+	int getNumFlits(Packet *packet) const;
+
+	// Return whether an output virtual channel can be allocated to the
+	// packet at the head of an input virtual channel
+	bool CanAllocateChannel(InputChannel *input,
+			OutputChannel *output) const;
+
+	// Allocate an output virtual channel to the packet at the head of an
+	// input virtual channel
+	void AllocateChannel(InputChannel *input, OutputChannel *output,
+			long long cycle);
+
+	// Send the flit at the head of an input virtual channel through its
+	// allocated output virtual channel
+	void SendFlit(InputChannel *input, long long cycle);
+
+	// Process a flit arriving at the end of a link
+	void ReceiveFlit(FlitInFlight &flit_in_flight);
+
+	// Advance the pipeline of a router one cycle
+	void AdvanceRouter(Router *router, long long cycle);
+
+	// Inject flits from the output buffers of the end nodes
+	void AdvanceInjection(long long cycle);
+
+public:
+
+	/// Exception for the flit-level model
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("Network flit model");
+		}
+	};
+
+	/// Constructor, creating the virtual channels, routers, and
+	/// injection channels for the current nodes and links of the network.
+	/// Buses are not supported.
+	Wormhole(Network *network);
+
+	/// Return the flit size in bytes
+	int getFlitSize() const { return flit_size; }
+
+	/// Return whether the model uses virtual cut-through switching
+	bool isVirtualCutThrough() const { return virtual_cut_through; }
+
+	/// Start injecting a packet inserted in an output buffer of its
+	/// source end node, and suspend the current event chain until the
+	/// tail flit of the packet is ejected into the destination end node,
+	/// when `event` is scheduled. This function must be invoked within
+	/// an event handler.
+	void Inject(Packet *packet, esim::Event *event);
+
+	/// Return the number of packets in the network
+	int getNumPackets() const { return packets.size(); }
+
+	/// Advance the model one cycle. This function is invoked in the
+	/// handler of event System::event_wormhole, which is scheduled every
+	/// cycle while there are packets in the network.
+	void Tick();
+
+	/// Return whether the model needs to be advanced in the next cycle
+	bool isActive() const { return active; }
+
+	/// Dump the statistics of the router of a switch
+	void DumpRouter(const Switch *node, std::ostream &os) const;
+};
+
+
+}  // namespace net
+
+#endif
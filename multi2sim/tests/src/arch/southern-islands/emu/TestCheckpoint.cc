@@ -0,0 +1,167 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <arch/southern-islands/emulator/StoreBuffer.h>
+#include <arch/southern-islands/emulator/Wavefront.h>
+#include <arch/southern-islands/emulator/WorkGroup.h>
+#include <arch/southern-islands/emulator/WorkItem.h>
+#include <lib/cpp/Misc.h>
+
+
+namespace SI
+{
+
+// Reads performed while stores are buffered see the buffered data, and
+// memory is only updated on commit.
+TEST(TestCheckpoint, store_buffer_forwarding)
+{
+	mem::Memory memory;
+	memory.setSafe(false);
+	unsigned value = 0x11111111;
+	memory.Write(0x100, 4, (char *) &value);
+
+	// Buffer a partial overwrite
+	StoreBuffer store_buffer;
+	unsigned short half = 0x2222;
+	store_buffer.Write(&memory, 0x102, 2, (char *) &half);
+	EXPECT_EQ(1, store_buffer.getNumWords());
+
+	// Forwarded read
+	unsigned result;
+	store_buffer.Read(&memory, 0x100, 4, (char *) &result);
+	EXPECT_EQ(0x22221111u, result);
+
+	// Memory is unchanged
+	memory.Read(0x100, 4, (char *) &result);
+	EXPECT_EQ(0x11111111u, result);
+
+	// Commit
+	store_buffer.Commit();
+	EXPECT_TRUE(store_buffer.isEmpty());
+	memory.Read(0x100, 4, (char *) &result);
+	EXPECT_EQ(0x22221111u, result);
+}
+
+
+// The youngest store to each byte reaches memory on commit, and stores are
+// dropped when the buffer is cleared.
+TEST(TestCheckpoint, store_buffer_order)
+{
+	mem::Memory memory;
+	memory.setSafe(false);
+
+	StoreBuffer store_buffer;
+	unsigned first = 1;
+	unsigned second = 2;
+	store_buffer.Write(&memory, 0x200, 4, (char *) &first);
+	store_buffer.Write(&memory, 0x200, 4, (char *) &second);
+	store_buffer.Commit();
+
+	unsigned result;
+	memory.Read(0x200, 4, (char *) &result);
+	EXPECT_EQ(2u, result);
+
+	// Cleared stores never reach memory
+	store_buffer.Write(&memory, 0x200, 4, (char *) &first);
+	store_buffer.Clear();
+	memory.Read(0x200, 4, (char *) &result);
+	EXPECT_EQ(2u, result);
+}
+
+
+// Stores not aligned to words are split across the words they touch, and
+// only the bytes written are forwarded and committed.
+TEST(TestCheckpoint, store_buffer_unaligned)
+{
+	mem::Memory memory;
+	memory.setSafe(false);
+	unsigned long long value = 0x1111111111111111ull;
+	memory.Write(0x300, 8, (char *) &value);
+
+	// Buffer a write crossing a word boundary
+	StoreBuffer store_buffer;
+	unsigned word = 0x55443322;
+	store_buffer.Write(&memory, 0x301, 4, (char *) &word);
+	EXPECT_EQ(2, store_buffer.getNumWords());
+
+	// Forwarded reads
+	unsigned long long result;
+	store_buffer.Read(&memory, 0x300, 8, (char *) &result);
+	EXPECT_EQ(0x1111115544332211ull, result);
+	unsigned short half;
+	store_buffer.Read(&memory, 0x304, 2, (char *) &half);
+	EXPECT_EQ(0x1155u, half);
+
+	// Commit
+	store_buffer.Commit();
+	memory.Read(0x300, 8, (char *) &result);
+	EXPECT_EQ(0x1111115544332211ull, result);
+}
+
+
+// Rolling back a checkpoint restores scalar and vector registers and the
+// program counter, while committing it keeps the new values.
+TEST(TestCheckpoint, wavefront_rollback_and_commit)
+{
+	// Create a work-group with one full wavefront
+	NDRange ndrange;
+	unsigned global_size[1] = {64};
+	unsigned local_size[1] = {64};
+	ndrange.SetupSize(global_size, local_size, 1);
+	WorkGroup work_group(&ndrange, 0);
+	Wavefront *wavefront = work_group.getWavefrontsBegin()->get();
+	WorkItem *work_item = wavefront->getWorkItem(5);
+
+	// Initial state
+	work_item->WriteSReg(2, 10);
+	work_item->WriteVReg(3, 20);
+	wavefront->setPC(8);
+
+	// Speculate and roll back
+	wavefront->Checkpoint();
+	EXPECT_TRUE(wavefront->hasCheckpoint());
+	work_item->WriteSReg(2, 11);
+	work_item->WriteVReg(3, 21);
+	work_item->WriteVReg(3, 22);
+	wavefront->setPC(16);
+	wavefront->RollbackCheckpoint();
+	EXPECT_FALSE(wavefront->hasCheckpoint());
+	EXPECT_EQ(10u, work_item->ReadSReg(2));
+	EXPECT_EQ(20u, work_item->ReadVReg(3));
+	EXPECT_EQ(8u, wavefront->getPC());
+
+	// Speculate and commit
+	wavefront->Checkpoint();
+	work_item->WriteSReg(2, 12);
+	work_item->WriteVReg(3, 23);
+	wavefront->CommitCheckpoint();
+	EXPECT_EQ(12u, work_item->ReadSReg(2));
+	EXPECT_EQ(23u, work_item->ReadVReg(3));
+
+	// A later rollback goes back to the committed state only
+	wavefront->Checkpoint();
+	work_item->WriteVReg(3, 24);
+	wavefront->RollbackCheckpoint();
+	EXPECT_EQ(23u, work_item->ReadVReg(3));
+}
+
+}  // namespace SI
@@ -0,0 +1,277 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include <arch/common/Arch.h>
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <arch/southern-islands/timing/ComputeUnit.h>
+#include <arch/southern-islands/timing/Gpu.h>
+#include <arch/southern-islands/timing/Timing.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/esim/Engine.h>
+#include <memory/Memory.h>
+#include <memory/Mmu.h>
+#include <memory/System.h>
+#include <network/System.h>
+
+namespace SI
+{
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+	net::System::Destroy();
+	mem::System::Destroy();
+	Timing::Destroy();
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// Kernel running a scalar loop with one vector addition per iteration:
+//
+//	s_mov_b32 s0, 16
+// loop:
+//	s_sub_i32 s0, s0, 1
+//	v_add_i32 v1, vcc, v0, v1
+//	s_cmp_gt_i32 s0, 0
+//	s_cbranch_scc1 loop
+//	s_mov_b32 s1, vcc_lo	(x4)
+//	s_endpgm
+//
+// The scalar moves give the last vector addition time to complete, since a
+// work-group is only released if s_endpgm is its last in-flight instruction.
+static const unsigned kernel[] =
+{
+	0xbe800390,
+	0x81808100,
+	0x4a020300,
+	0xbf028000,
+	0xbf85fffc,
+	0xbe81036a,
+	0xbe81036a,
+	0xbe81036a,
+	0xbe81036a,
+	0xbf810000
+};
+
+
+// Kernel loading a value from memory and waiting for it before running the
+// same loop:
+//
+//	s_mov_b32 s0, 0
+//	s_mov_b32 s1, 0
+//	s_load_dwordx2 s[8:9], s[0:1], 0x0
+//	s_waitcnt lgkmcnt(0)
+//	s_mov_b32 s2, 16
+// loop:
+//	s_sub_i32 s2, s2, 1
+//	v_add_i32 v1, vcc, v0, v1
+//	s_cmp_gt_i32 s2, 0
+//	s_cbranch_scc1 loop
+//	s_mov_b32 s1, vcc_lo	(x4)
+//	s_endpgm
+static const unsigned memory_wait_kernel[] =
+{
+	0xbe800380,
+	0xbe810380,
+	0xc0440100,
+	0xbf8c007f,
+	0xbe820390,
+	0x81828102,
+	0x4a020300,
+	0xbf028002,
+	0xbf85fffc,
+	0xbe81036a,
+	0xbe81036a,
+	0xbe81036a,
+	0xbe81036a,
+	0xbf810000
+};
+
+
+// Statistics of a simulation
+struct Result
+{
+	long long cycles = 0;
+	long long instructions = 0;
+	std::vector<long long> compute_unit_instructions;
+	std::vector<long long> compute_unit_complete_cycles;
+	long long speculation_modes = 0;
+	long long pre_execution_squashes = 0;
+};
+
+
+// Run a kernel on a GPU with 4 compute units, advanced by the given number
+// of host threads, until all work-groups finish. If hints are given, the
+// wavefronts pre-execute instructions while waiting for memory.
+static Result RunKernel(const unsigned *kernel, unsigned kernel_size,
+		int num_threads,
+		const std::map<int, Timing::hint_format> *hints = nullptr)
+{
+	Cleanup();
+
+	// GPU configuration
+	misc::IniFile ini_file;
+	ini_file.LoadFromString("[ Device ]\n"
+			"NumComputeUnits = 4\n");
+	Timing::ParseConfiguration(&ini_file);
+	Gpu::num_threads = num_threads;
+	Timing *timing = Timing::getInstance();
+	if (hints)
+	{
+		Timing::setHintFile("hints");
+		timing->instruction_hint.insert(hints->begin(), hints->end());
+	}
+
+	// Default memory hierarchy
+	misc::IniFile ini_file_mem;
+	timing->WriteMemoryConfiguration(&ini_file_mem);
+	mem::System::getInstance()->ReadConfiguration(&ini_file_mem);
+
+	// ND-Range with 32 work-groups of 128 work-items
+	Emulator *emulator = Emulator::getInstance();
+	NDRange *ndrange = emulator->addNDRange();
+	ndrange->SetupInstructionMemory((const char *) kernel, kernel_size,
+			0);
+	ndrange->setNumSgprUsed(8);
+	ndrange->setNumVgprUsed(4);
+	ndrange->setWgIdSgpr(4);
+	unsigned global_size[1] = { 32 * 128 };
+	unsigned local_size[1] = { 128 };
+	ndrange->SetupSize(global_size, local_size, 1);
+	Gpu *gpu = timing->getGpu();
+	gpu->MapNDRange(ndrange);
+	ndrange->address_space = gpu->getMmu()->newSpace("Southern Islands");
+	ndrange->instruction_address_space = gpu->getMmu()->newSpace(
+			"Southern Islands Instructions");
+	emulator->getGlobalMemory()->Map(0, 1 << 12, mem::Memory::AccessRead);
+	for (int i = 0; i < 32; i++)
+		ndrange->AddWorkgroupIdToWaitingList(i);
+	ndrange->setLastWorkgroupSent(true);
+
+	// Simulate
+	esim::Engine *engine = esim::Engine::getInstance();
+	while (!ndrange->isWaitingWorkGroupsEmpty() ||
+			!ndrange->isRunningWorkGroupsEmpty())
+	{
+		timing->Run();
+		engine->ProcessEvents();
+		if (timing->getCycle() > 1000000)
+			break;
+	}
+
+	// Statistics
+	Result result;
+	result.cycles = timing->getCycle();
+	result.instructions = emulator->getNumInstructions();
+	for (auto it = gpu->getComputeUnitsBegin(),
+			e = gpu->getComputeUnitsEnd(); it != e; ++it)
+	{
+		ComputeUnit *compute_unit = it->get();
+		result.compute_unit_instructions.push_back(
+				compute_unit->num_total_instructions);
+		result.compute_unit_complete_cycles.push_back(
+				compute_unit->last_complete_cycle);
+		result.speculation_modes +=
+				compute_unit->num_total_speculation_mode;
+		result.pre_execution_squashes +=
+				compute_unit->num_pre_execution_squashes;
+	}
+
+	// Restore defaults for other tests
+	Gpu::num_threads = 1;
+	Timing::setHintFile("");
+	return result;
+}
+
+
+// Advancing compute units on several host threads gives the same timing and
+// statistics as advancing them sequentially.
+TEST(TestGpu, threads_determinism)
+{
+	Result sequential = RunKernel(kernel, sizeof kernel, 1);
+	ASSERT_LT(sequential.cycles, 1000000);
+
+	// Each of the 64 wavefronts runs 6 + 4 * 16 instructions
+	EXPECT_EQ(64 * 70, sequential.instructions);
+	ASSERT_EQ(4u, sequential.compute_unit_instructions.size());
+	for (long long instructions : sequential.compute_unit_instructions)
+		EXPECT_GT(instructions, 0);
+
+	// Parallel
+	Result parallel = RunKernel(kernel, sizeof kernel, 4);
+	EXPECT_EQ(sequential.cycles, parallel.cycles);
+	EXPECT_EQ(sequential.instructions, parallel.instructions);
+	EXPECT_EQ(sequential.compute_unit_instructions,
+			parallel.compute_unit_instructions);
+	EXPECT_EQ(sequential.compute_unit_complete_cycles,
+			parallel.compute_unit_complete_cycles);
+	Cleanup();
+}
+
+
+
+// Wavefronts pre-execute the loop while waiting for the load, following
+// the hints, and their checkpoints are committed when the wait finishes.
+TEST(TestGpu, pre_execution_commit)
+{
+	Result normal = RunKernel(memory_wait_kernel,
+			sizeof memory_wait_kernel, 1);
+	ASSERT_LT(normal.cycles, 1000000);
+	EXPECT_EQ(0, normal.speculation_modes);
+
+	// After the s_waitcnt at 12, fetch the vector addition at 24
+	std::map<int, Timing::hint_format> hints;
+	hints[12] = { 0, 0, 12, 0 };
+	Result speculation = RunKernel(memory_wait_kernel,
+			sizeof memory_wait_kernel, 1, &hints);
+	ASSERT_LT(speculation.cycles, 1000000);
+	EXPECT_GT(speculation.speculation_modes, 0);
+	EXPECT_EQ(0, speculation.pre_execution_squashes);
+	EXPECT_EQ(normal.instructions, speculation.instructions);
+	Cleanup();
+}
+
+
+// A hint that the pre-executed path never reaches squashes the
+// pre-execution, and the wavefronts run the same instructions again from
+// their checkpoints.
+TEST(TestGpu, pre_execution_squash)
+{
+	Result normal = RunKernel(memory_wait_kernel,
+			sizeof memory_wait_kernel, 1);
+	ASSERT_LT(normal.cycles, 1000000);
+
+	// Target in the middle of an instruction
+	std::map<int, Timing::hint_format> hints;
+	hints[12] = { 0, 0, 14, 0 };
+	Result squash = RunKernel(memory_wait_kernel,
+			sizeof memory_wait_kernel, 1, &hints);
+	ASSERT_LT(squash.cycles, 1000000);
+	EXPECT_GT(squash.pre_execution_squashes, 0);
+	EXPECT_GT(squash.instructions, normal.instructions);
+	Cleanup();
+}
+
+}  // namespace SI
@@ -0,0 +1,106 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/southern-islands/timing/LdsUnit.h>
+
+namespace SI
+{
+
+// Consecutive 4-byte words map to different banks and do not conflict
+TEST(TestLdsUnit, bank_conflict_degree_consecutive)
+{
+	std::vector<unsigned> addresses;
+	for (unsigned i = 0; i < 32; i++)
+		addresses.push_back(i * 4);
+	EXPECT_EQ(1, LdsUnit::getBankConflictDegree(addresses));
+}
+
+
+// All work-items reading the same word are served by a broadcast
+TEST(TestLdsUnit, bank_conflict_degree_broadcast)
+{
+	std::vector<unsigned> addresses(64, 0x100);
+	EXPECT_EQ(1, LdsUnit::getBankConflictDegree(addresses));
+}
+
+
+// A stride of 2 words makes pairs of work-items share a bank
+TEST(TestLdsUnit, bank_conflict_degree_stride_2)
+{
+	std::vector<unsigned> addresses;
+	for (unsigned i = 0; i < 32; i++)
+		addresses.push_back(i * 8);
+	EXPECT_EQ(2, LdsUnit::getBankConflictDegree(addresses));
+}
+
+
+// A stride equal to the number of banks, as in a column access of a 32x32
+// matrix transpose, serializes all work-items
+TEST(TestLdsUnit, bank_conflict_degree_column)
+{
+	std::vector<unsigned> addresses;
+	for (unsigned i = 0; i < 32; i++)
+		addresses.push_back(i * 32 * 4);
+	EXPECT_EQ(32, LdsUnit::getBankConflictDegree(addresses));
+}
+
+
+// No accesses
+TEST(TestLdsUnit, bank_conflict_degree_empty)
+{
+	std::vector<unsigned> addresses;
+	EXPECT_EQ(0, LdsUnit::getBankConflictDegree(addresses));
+}
+
+
+
+// A full wavefront with unit stride is served as two conflict-free
+// half-wavefronts
+TEST(TestLdsUnit, wavefront_bank_conflict_degree_consecutive)
+{
+	std::vector<int> lanes;
+	std::vector<unsigned> addresses;
+	for (unsigned i = 0; i < 64; i++)
+	{
+		lanes.push_back(i);
+		addresses.push_back(i * 4);
+	}
+	EXPECT_EQ(2, LdsUnit::getBankConflictDegree(addresses));
+	EXPECT_EQ(1, LdsUnit::getWavefrontBankConflictDegree(lanes,
+			addresses));
+}
+
+
+// Conflicts are only counted among work-items of the same half-wavefront
+TEST(TestLdsUnit, wavefront_bank_conflict_degree_halves)
+{
+	// Lanes 0 and 1 access 2 words of bank 0 in the first half, and lanes
+	// 32, 33, and 40 access 3 words of bank 0 in the second half
+	std::vector<int> lanes = { 0, 1, 32, 33, 40 };
+	std::vector<unsigned> addresses = { 0, 128, 0, 128, 256 };
+	EXPECT_EQ(3, LdsUnit::getWavefrontBankConflictDegree(lanes,
+			addresses));
+
+	// No accesses
+	EXPECT_EQ(0, LdsUnit::getWavefrontBankConflictDegree({}, {}));
+}
+
+}  // namespace SI
@@ -0,0 +1,259 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sstream>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <arch/common/Arch.h>
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Timing.h>
+#include <lib/cpp/Error.h>
+
+
+namespace x86
+{
+
+static void Cleanup()
+{
+	Timing::Destroy();
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// Create a temporary file with some content, returning its path
+static std::string CreateFile(const std::string &content)
+{
+	char path[] = "/tmp/m2s-x86-checkpoint-XXXXXX";
+	int fd = mkstemp(path);
+	EXPECT_GE(fd, 0);
+	EXPECT_EQ((ssize_t) content.size(),
+			write(fd, content.data(), content.size()));
+	close(fd);
+	return path;
+}
+
+
+// Give a context some non-default state: registers, a memory page, an open
+// file at a non-zero offset, and signal masks and handlers.
+static void InitializeContext(Context *context, const std::string &path)
+{
+	context->Initialize();
+
+	// Registers
+	Regs &regs = context->getRegs();
+	regs.setEax(0x11111111);
+	regs.setEbx(0x22222222);
+	regs.setEsp(0xbfff0000);
+	regs.setEip(0x8048000);
+	regs.setEflags(0x246);
+
+	// Memory
+	mem::Memory *memory = context->getMemory();
+	memory->Map(0x8048000, mem::Memory::PageSize, mem::Memory::AccessRead
+			| mem::Memory::AccessWrite | mem::Memory::AccessExec);
+	const char code[] = { (char) 0xb8, 0x01, 0x00, 0x00, 0x00,
+			(char) 0xcd, (char) 0x80 };
+	memory->Write(0x8048000, sizeof code, code);
+
+	// Open file, with its host offset advanced
+	int host_index = open(path.c_str(), O_RDONLY);
+	ASSERT_GE(host_index, 0);
+	ASSERT_EQ(5, lseek(host_index, 5, SEEK_SET));
+	context->getFileTable()->newFileDescriptor(
+			comm::FileDescriptor::TypeRegular, 3, host_index,
+			path, O_RDONLY);
+
+	// Signal masks
+	SignalMaskTable &signal_mask_table = context->getSignalMaskTable();
+	signal_mask_table.getPending().Add(10);
+	SignalSet blocked;
+	blocked.Add(2);
+	blocked.Add(64);
+	signal_mask_table.setBlocked(blocked);
+	signal_mask_table.setRetCodePtr(0xbfffff00);
+	Regs backup_regs;
+	backup_regs.setEax(0x33333333);
+	signal_mask_table.setRegs(backup_regs);
+
+	// Signal handler
+	SignalHandler *handler = context->getSignalHandlerTable()->
+			getSignalHandler(11);
+	handler->set(0x8048100, 0x4000000, 0x8048200);
+	handler->getMask().Add(3);
+}
+
+
+// Check that a context restored from a checkpoint has the state given by
+// InitializeContext().
+static void CheckContext(Context *context, const std::string &path)
+{
+	// Registers
+	Regs &regs = context->getRegs();
+	EXPECT_EQ(0x11111111u, regs.getEax());
+	EXPECT_EQ(0x22222222u, regs.getEbx());
+	EXPECT_EQ(0xbfff0000u, regs.getEsp());
+	EXPECT_EQ(0x8048000u, regs.getEip());
+	EXPECT_EQ(0x246u, regs.getEflags());
+
+	// Memory
+	char code[7];
+	context->getMemory()->Read(0x8048000, sizeof code, code);
+	EXPECT_EQ((char) 0xb8, code[0]);
+	EXPECT_EQ(0x01, code[1]);
+	EXPECT_EQ((char) 0x80, code[6]);
+
+	// Open file, reopened at the same offset
+	comm::FileDescriptor *desc = context->getFileTable()->
+			getFileDescriptor(3);
+	ASSERT_TRUE(desc != nullptr);
+	EXPECT_EQ(comm::FileDescriptor::TypeRegular, desc->getType());
+	EXPECT_EQ(path, desc->getPath());
+	EXPECT_EQ(O_RDONLY, desc->getFlags());
+	char c;
+	ASSERT_EQ(1, read(desc->getHostIndex(), &c, 1));
+	EXPECT_EQ('5', c);
+
+	// Standard descriptors
+	for (int index = 0; index < 3; index++)
+	{
+		desc = context->getFileTable()->getFileDescriptor(index);
+		ASSERT_TRUE(desc != nullptr);
+		EXPECT_EQ(comm::FileDescriptor::TypeStandard, desc->getType());
+		EXPECT_EQ(index, desc->getHostIndex());
+	}
+
+	// Signal masks
+	SignalMaskTable &signal_mask_table = context->getSignalMaskTable();
+	EXPECT_TRUE(signal_mask_table.getPending().isMember(10));
+	EXPECT_FALSE(signal_mask_table.getPending().isMember(2));
+	EXPECT_TRUE(signal_mask_table.getBlocked().isMember(2));
+	EXPECT_TRUE(signal_mask_table.getBlocked().isMember(64));
+	EXPECT_FALSE(signal_mask_table.getBlocked().isMember(10));
+	EXPECT_EQ(0xbfffff00u, signal_mask_table.getRetCodePtr());
+	ASSERT_TRUE(signal_mask_table.hasRegs());
+	EXPECT_EQ(0x33333333u, signal_mask_table.getRegs().getEax());
+
+	// Signal handlers
+	SignalHandler *handler = context->getSignalHandlerTable()->
+			getSignalHandler(11);
+	EXPECT_EQ(0x8048100u, handler->getHandler());
+	EXPECT_EQ(0x4000000u, handler->getFlags());
+	EXPECT_EQ(0x8048200u, handler->getRestorer());
+	EXPECT_TRUE(handler->getMask().isMember(3));
+	EXPECT_FALSE(handler->getMask().isMember(4));
+	handler = context->getSignalHandlerTable()->getSignalHandler(12);
+	EXPECT_EQ(0u, handler->getHandler());
+}
+
+
+TEST(TestX86EmulatorCheckpoint, context_roundtrip)
+{
+	Cleanup();
+	std::string path = CreateFile("0123456789");
+
+	// Save a context
+	Emulator *emulator = Emulator::getInstance();
+	Context *context = emulator->newContext();
+	InitializeContext(context, path);
+	std::ostringstream os;
+	context->SaveCheckpoint(os);
+
+	// Restore it in a new context, consuming the whole checkpoint
+	std::string checkpoint = os.str();
+	const char *end = checkpoint.data() + checkpoint.size();
+	Context *restored = emulator->newContext();
+	EXPECT_EQ(end, restored->LoadCheckpoint(checkpoint.data(), end));
+
+	// Saving the restored context gives the same checkpoint
+	std::ostringstream os2;
+	restored->SaveCheckpoint(os2);
+	EXPECT_TRUE(checkpoint == os2.str());
+	CheckContext(restored, path);
+
+	// A context cannot be restored twice
+	EXPECT_THROW(restored->LoadCheckpoint(checkpoint.data(), end),
+			misc::Panic);
+
+	unlink(path.c_str());
+	Cleanup();
+}
+
+
+TEST(TestX86EmulatorCheckpoint, context_truncated)
+{
+	Cleanup();
+	std::string path = CreateFile("0123456789");
+
+	Emulator *emulator = Emulator::getInstance();
+	Context *context = emulator->newContext();
+	InitializeContext(context, path);
+	std::ostringstream os;
+	context->SaveCheckpoint(os);
+
+	// Cut the checkpoint in the middle of the register file
+	std::string checkpoint = os.str();
+	Context *restored = emulator->newContext();
+	EXPECT_THROW(restored->LoadCheckpoint(checkpoint.data(),
+			checkpoint.data() + sizeof(Regs) / 2), Error);
+
+	unlink(path.c_str());
+	Cleanup();
+}
+
+
+TEST(TestX86EmulatorCheckpoint, emulator_roundtrip)
+{
+	Cleanup();
+	std::string path = CreateFile("0123456789");
+	std::string checkpoint_path = CreateFile("");
+
+	// Save from an emulator with one context
+	Emulator *emulator = Emulator::getInstance();
+	InitializeContext(emulator->newContext(), path);
+	emulator->SaveCheckpoint(checkpoint_path);
+
+	// Saving with more than one context is not supported
+	emulator->newContext()->Initialize();
+	EXPECT_THROW(emulator->SaveCheckpoint(checkpoint_path), Error);
+
+	// Restore in a new emulator
+	Cleanup();
+	emulator = Emulator::getInstance();
+	emulator->LoadCheckpoint(checkpoint_path);
+	ASSERT_EQ(1, emulator->getNumContexts());
+	CheckContext(emulator->getContextsBegin()->get(), path);
+
+	// Files that are not checkpoints are rejected
+	Cleanup();
+	emulator = Emulator::getInstance();
+	EXPECT_THROW(emulator->LoadCheckpoint(path), Error);
+	EXPECT_EQ(0, emulator->getNumContexts());
+
+	unlink(path.c_str());
+	unlink(checkpoint_path.c_str());
+	Cleanup();
+}
+
+}  // namespace x86
@@ -0,0 +1,217 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <arch/common/Arch.h>
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Timing.h>
+
+
+namespace x86
+{
+
+static void Cleanup()
+{
+	Timing::Destroy();
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// Guest addresses
+static const unsigned code_address = 0x10000;
+static const unsigned data_address = 0x20000;
+static const unsigned counter_address = data_address;
+static const unsigned lock_address = data_address + 4;
+static const unsigned shared_address = data_address + 8;
+
+// Number of iterations run by each context, and number of contexts
+static const unsigned num_iterations = 500;
+static const int num_contexts = 4;
+
+
+// Append a 32-bit little-endian value to the code
+static void AppendWord(std::vector<unsigned char> &code, unsigned value)
+{
+	for (int i = 0; i < 4; i++)
+		code.push_back(value >> (i * 8));
+}
+
+
+// Return the code run by all contexts. Each iteration increments a counter
+// with a locked instruction, and a shared variable inside a critical section
+// protected by a spin lock acquired with 'xchg'.
+//
+//	mov ecx, num_iterations
+// loop:
+//	lock inc dword [counter]
+// spin:
+//	mov eax, 1
+//	xchg [lock], eax
+//	test eax, eax
+//	jnz spin
+//	mov edx, [shared]
+//	inc edx
+//	mov [shared], edx
+//	mov dword [lock], 0
+//	inc esi
+//	dec ecx
+//	jnz loop
+// done:
+//	jmp done
+//
+static std::vector<unsigned char> getCode(unsigned &done_address)
+{
+	std::vector<unsigned char> code;
+	code.push_back(0xb9);
+	AppendWord(code, num_iterations);
+	code.insert(code.end(), { 0xf0, 0xff, 0x05 });
+	AppendWord(code, counter_address);
+	code.insert(code.end(), { 0xb8, 0x01, 0x00, 0x00, 0x00 });
+	code.insert(code.end(), { 0x87, 0x05 });
+	AppendWord(code, lock_address);
+	code.insert(code.end(), { 0x85, 0xc0 });
+	code.insert(code.end(), { 0x75, 0xf1 });
+	code.insert(code.end(), { 0x8b, 0x15 });
+	AppendWord(code, shared_address);
+	code.push_back(0x42);
+	code.insert(code.end(), { 0x89, 0x15 });
+	AppendWord(code, shared_address);
+	code.insert(code.end(), { 0xc7, 0x05 });
+	AppendWord(code, lock_address);
+	AppendWord(code, 0);
+	code.push_back(0x46);
+	code.push_back(0x49);
+	code.insert(code.end(), { 0x75, 0xcf });
+	done_address = code_address + code.size();
+	code.insert(code.end(), { 0xeb, 0xfe });
+	return code;
+}
+
+
+// State observed after running all contexts to the end of the loop
+struct Result
+{
+	unsigned counter;
+	unsigned shared;
+	unsigned esi[num_contexts];
+	unsigned ecx[num_contexts];
+	long long num_instructions;
+};
+
+
+// Run the code on 'num_contexts' contexts sharing their memory, using the
+// given number of host threads.
+static Result RunContexts(int num_threads)
+{
+	Cleanup();
+	Emulator::setNumThreads(num_threads, 100);
+	Emulator *emulator = Emulator::getInstance();
+
+	// Parent context, with code and data
+	unsigned done_address;
+	std::vector<unsigned char> code = getCode(done_address);
+	Context *parent = emulator->newContext();
+	parent->Initialize();
+	mem::Memory *memory = parent->getMemory();
+	memory->Map(code_address, mem::Memory::PageSize,
+			mem::Memory::AccessInit | mem::Memory::AccessRead |
+			mem::Memory::AccessExec);
+	memory->Map(data_address, mem::Memory::PageSize,
+			mem::Memory::AccessRead | mem::Memory::AccessWrite);
+	memory->Init(code_address, code.size(), (const char *) code.data());
+	parent->getRegs().setEip(code_address);
+
+	// Threads sharing the memory image
+	std::vector<Context *> contexts = { parent };
+	for (int i = 1; i < num_contexts; i++)
+	{
+		Context *context = emulator->newContext();
+		context->Clone(parent);
+		contexts.push_back(context);
+	}
+
+	// Run until all contexts are done
+	for (int iteration = 0; iteration < 1000000; iteration++)
+	{
+		bool done = true;
+		for (Context *context : contexts)
+			if (context->getRegs().getEip() != done_address)
+				done = false;
+		if (done)
+			break;
+		emulator->Run(0);
+	}
+
+	// Collect results
+	Result result;
+	memory->Read(counter_address, 4, (char *) &result.counter);
+	memory->Read(shared_address, 4, (char *) &result.shared);
+	for (int i = 0; i < num_contexts; i++)
+	{
+		result.esi[i] = contexts[i]->getRegs().getEsi();
+		result.ecx[i] = contexts[i]->getRegs().getEcx();
+	}
+	result.num_instructions = emulator->getNumInstructions();
+
+	// Restore defaults
+	Emulator::setNumThreads(1, 1000);
+	Cleanup();
+	return result;
+}
+
+
+// Contexts run concurrently on host threads give the same results as when
+// they run sequentially. Instructions with a lock prefix and 'xchg' with
+// memory stay atomic, and concurrent runs are reproducible.
+TEST(TestX86EmulatorConcurrency, atomics)
+{
+	Result serial = RunContexts(1);
+	Result concurrent = RunContexts(4);
+	Result concurrent2 = RunContexts(2);
+
+	// Sequential run
+	EXPECT_EQ(num_iterations * num_contexts, serial.counter);
+	EXPECT_EQ(num_iterations * num_contexts, serial.shared);
+	for (int i = 0; i < num_contexts; i++)
+	{
+		EXPECT_EQ(num_iterations, serial.esi[i]);
+		EXPECT_EQ(0u, serial.ecx[i]);
+	}
+
+	// Concurrent run gives the same final state
+	EXPECT_EQ(serial.counter, concurrent.counter);
+	EXPECT_EQ(serial.shared, concurrent.shared);
+	for (int i = 0; i < num_contexts; i++)
+	{
+		EXPECT_EQ(serial.esi[i], concurrent.esi[i]);
+		EXPECT_EQ(serial.ecx[i], concurrent.ecx[i]);
+	}
+
+	// Concurrent runs do not depend on the number of host threads
+	EXPECT_EQ(concurrent.counter, concurrent2.counter);
+	EXPECT_EQ(concurrent.shared, concurrent2.shared);
+	EXPECT_EQ(concurrent.num_instructions, concurrent2.num_instructions);
+}
+
+}  // namespace x86
@@ -163,15 +163,15 @@ TEST(TestBranchPredictor, test_bimodal_branch_predictor_1)
 	{
 		// Look up predictor and verify prediction
 		branch_predictor.Lookup(uops[i].get());
-		pred = uops[i]->prediction;
+		pred = uops[i]->branch.prediction;
 		EXPECT_EQ(pred_result[i], pred);
 
 		// Verify the bimodal index
-		EXPECT_EQ(bimod_index[i], uops[i]->bimod_index);
+		EXPECT_EQ(bimod_index[i], uops[i]->branch.bimod_index);
 
 		// Update predictor and verify the bimodal status
 		branch_predictor.Update(uops[i].get());
-		bimod_status = branch_predictor.getBimodStatus(uops[i]->bimod_index);
+		bimod_status = branch_predictor.getBimodStatus(uops[i]->branch.bimod_index);
 		EXPECT_EQ(bimod_status_trace[i], (int) bimod_status);
 	}
 }
@@ -332,19 +332,19 @@ TEST(TestBranchPredictor, test_two_level_branch_predictor_1)
 	{
 		// Look up predictor and verify prediction
 		branch_predictor.Lookup(uops[i].get());
-		pred = uops[i]->prediction;
+		pred = uops[i]->branch.prediction;
 		EXPECT_EQ(pred_result[i], pred);
 
 		// Verify the BHT index and PHT row colomn
-		EXPECT_EQ(bht_index, uops[i]->two_level_bht_index);
-		EXPECT_EQ(pht_row[i], uops[i]->two_level_pht_row);
-		EXPECT_EQ(pht_col[i], uops[i]->two_level_pht_col);
+		EXPECT_EQ(bht_index, uops[i]->branch.two_level_bht_index);
+		EXPECT_EQ(pht_row[i], uops[i]->branch.two_level_pht_row);
+		EXPECT_EQ(pht_col[i], uops[i]->branch.two_level_pht_col);
 
 		// Update predictor and verify the two-level branch predictor status
 		branch_predictor.Update(uops[i].get());
-		bht_status = branch_predictor.getTwoLevelBhtStatus(uops[i]->two_level_bht_index);
-		pht_status = branch_predictor.getTwoLevelPhtStatus(uops[i]->two_level_pht_row,
-				uops[i]->two_level_pht_col);
+		bht_status = branch_predictor.getTwoLevelBhtStatus(uops[i]->branch.two_level_bht_index);
+		pht_status = branch_predictor.getTwoLevelPhtStatus(uops[i]->branch.two_level_pht_row,
+				uops[i]->branch.two_level_pht_col);
 		EXPECT_EQ(bht_status_trace[i], bht_status);
 		EXPECT_EQ(pht_status_trace[i], (int)pht_status);
 	}
@@ -571,20 +571,20 @@ TEST(TestBranchPredictor, test_combined_branch_predictor_1)
 	{
 		// Look up predictor and verify prediction
 		branch_predictor.Lookup(uops[i].get());
-		two_level_pred = uops[i]->two_level_prediction;
-		bimodal_pred = uops[i]->bimod_prediction;
-		pred = uops[i]->prediction;
+		two_level_pred = uops[i]->branch.two_level_prediction;
+		bimodal_pred = uops[i]->branch.bimod_prediction;
+		pred = uops[i]->branch.prediction;
 		EXPECT_EQ(two_level_pred_result[i], two_level_pred);
 		EXPECT_EQ(bimodal_pred_result[i], bimodal_pred);
 		EXPECT_EQ(choice_pred_result[i], pred);
 
 		// Update predictor and verify the two-level branch predictor status
 		branch_predictor.Update(uops[i].get());
-		bht_status = branch_predictor.getTwoLevelBhtStatus(uops[i]->two_level_bht_index);
-		pht_status = branch_predictor.getTwoLevelPhtStatus(uops[i]->two_level_pht_row,
-				uops[i]->two_level_pht_col);
-		bimodal_status = branch_predictor.getBimodStatus(uops[i]->bimod_index);
-		choice_status = branch_predictor.getChoiceStatus(uops[i]->choice_index);
+		bht_status = branch_predictor.getTwoLevelBhtStatus(uops[i]->branch.two_level_bht_index);
+		pht_status = branch_predictor.getTwoLevelPhtStatus(uops[i]->branch.two_level_pht_row,
+				uops[i]->branch.two_level_pht_col);
+		bimodal_status = branch_predictor.getBimodStatus(uops[i]->branch.bimod_index);
+		choice_status = branch_predictor.getChoiceStatus(uops[i]->branch.choice_index);
 		EXPECT_EQ(bht_status_trace[i], bht_status);
 		EXPECT_EQ(pht_status_trace[i], (int)pht_status);
 		EXPECT_EQ(bimodal_status_trace[i], bimodal_status);
@@ -593,8 +593,123 @@ TEST(TestBranchPredictor, test_combined_branch_predictor_1)
 }
 
 
+// Run a conditional branch through the predictor, returning whether it was
+// predicted correctly.
+static bool RunBranch(BranchPredictor &branch_predictor, unsigned eip,
+		bool taken)
+{
+	ObjectPool *object_pool = ObjectPool::getInstance();
+	auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeBranch);
+	Uop uop(object_pool->getThread(), object_pool->getContext(), uinst);
+	uop.eip = eip;
+	uop.mop_size = 4;
+	uop.neip = taken ? eip + 16 : eip + 4;
+	branch_predictor.Lookup(&uop);
+	uop.predicted_neip = uop.branch.prediction == BranchPredictor::PredictionTaken ?
+			eip + 16 : eip + 4;
+	branch_predictor.Update(&uop);
+	return uop.predicted_neip == uop.neip;
+}
+
+
+TEST(TestBranchPredictor, test_tage_branch_predictor_1)
+{
+	// Setup configuration file for branch predictor
+	std::string config =
+			"[ BranchPredictor ]\n"
+			"Kind = TAGE\n"
+			"TAGE.NumTables = 4\n"
+			"TAGE.MinHistory = 4\n"
+			"TAGE.MaxHistory = 32";
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	BranchPredictor::ParseConfiguration(&ini_file);
+
+	// History lengths form an increasing series between both limits
+	EXPECT_EQ(4, BranchPredictor::getTageHistoryLength(0));
+	EXPECT_EQ(8, BranchPredictor::getTageHistoryLength(1));
+	EXPECT_EQ(16, BranchPredictor::getTageHistoryLength(2));
+	EXPECT_EQ(32, BranchPredictor::getTageHistoryLength(3));
+
+	// Branch with pattern taken-taken-not taken, which the bimodal base
+	// predictor always mispredicts in its third instance
+	BranchPredictor branch_predictor;
+	for (int i = 0; i < 300; i++)
+		RunBranch(branch_predictor, 0x1000, i % 3 != 2);
+
+	// After training, the pattern is predicted by the tagged tables
+	int hits = 0;
+	for (int i = 0; i < 30; i++)
+		hits += RunBranch(branch_predictor, 0x1000, i % 3 != 2);
+	EXPECT_EQ(30, hits);
+	EXPECT_LT(0, branch_predictor.getProviderPredictions(
+			BranchPredictor::ProviderTage));
+}
+
+
+TEST(TestBranchPredictor, test_loop_predictor_1)
+{
+	// Bimodal predictor, which always mispredicts the exit of a loop
+	std::string config =
+			"[ BranchPredictor ]\n"
+			"Kind = Bimodal\n"
+			"Loop.Present = t\n"
+			"Loop.Size = 16";
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	BranchPredictor::ParseConfiguration(&ini_file);
+
+	// Train with several runs of a loop with 20 iterations
+	BranchPredictor branch_predictor;
+	for (int run = 0; run < 8; run++)
+		for (int i = 0; i < 20; i++)
+			RunBranch(branch_predictor, 0x2000, i < 19);
+
+	// The loop predictor now predicts the exit
+	for (int i = 0; i < 20; i++)
+		EXPECT_TRUE(RunBranch(branch_predictor, 0x2000, i < 19));
+	EXPECT_LT(0, branch_predictor.getProviderPredictions(
+			BranchPredictor::ProviderLoop));
 }
 
 
 
+// Warming up the predictor with branches executed outside of the pipeline
+// trains it without counting them in the statistics.
+TEST(TestBranchPredictor, warm)
+{
+	// Bimodal predictor
+	std::string config =
+			"[ BranchPredictor ]\n"
+			"Kind = Bimodal";
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	BranchPredictor::ParseConfiguration(&ini_file);
+
+	// Warm with an always taken branch
+	BranchPredictor branch_predictor;
+	Uinst uinst(Uinst::OpcodeBranch);
+	for (int i = 0; i < 4; i++)
+	{
+		BranchPredictor::Branch branch;
+		branch.uinst = &uinst;
+		branch.eip = 0x3000;
+		branch.mop_size = 4;
+		branch.neip = 0x3010;
+		branch.predicted_neip = 0x3004;
+		branch_predictor.Warm(branch);
+	}
+	EXPECT_EQ(0, branch_predictor.getNumAccesses());
+	EXPECT_EQ(0, branch_predictor.getNumHits());
+	EXPECT_EQ(0, branch_predictor.getProviderPredictions(
+			BranchPredictor::ProviderBase));
+	EXPECT_EQ(3, branch_predictor.getBimodStatus(0x3000 &
+			(BranchPredictor::getBimodSize() - 1)));
+
+	// The branch is now predicted taken, and counted
+	EXPECT_TRUE(RunBranch(branch_predictor, 0x3000, true));
+	EXPECT_EQ(1, branch_predictor.getNumAccesses());
+	EXPECT_EQ(1, branch_predictor.getNumHits());
+}
 
+}
@@ -0,0 +1,262 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/Error.h>
+#include <lib/esim/Engine.h>
+#include <memory/System.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Timing.h>
+#include <arch/x86/timing/Core.h>
+#include <arch/x86/timing/Cpu.h>
+#include <arch/x86/timing/Thread.h>
+
+namespace x86
+{
+
+static void Cleanup()
+{
+	Timing::Destroy();
+	Emulator::Destroy();
+	mem::System::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// Guest addresses
+static const unsigned code_address = 0x10000;
+static const unsigned data_address = 0x20000;
+
+// Number of loop iterations
+static const int num_iterations = 200;
+
+// Reorder buffer size
+static const int reorder_buffer_size = 8;
+
+
+// Statistics of a run of the fusion test program
+struct Result
+{
+	bool finished;
+	long long num_committed_instructions;
+	long long num_committed_uinsts;
+	long long num_macro_fused_uinsts;
+	long long num_micro_fused_uinsts;
+	long long num_uop_cache_hits;
+	int max_reorder_buffer_uops;
+	int max_reorder_buffer_occupancy;
+	bool occupancy_consistent;
+};
+
+
+// Run a loop with one load consumed by an addition, which qualifies for
+// micro-fusion, and a subtraction followed by a conditional branch, which
+// qualifies for macro-fusion. The context exits after the loop.
+static Result RunLoop(bool fusion, const std::string &uop_cache_config = "")
+{
+	Cleanup();
+
+	// CPU configuration, with a small reorder buffer
+	misc::IniFile config_ini;
+	config_ini.LoadFromString(misc::fmt(
+			"[ General ]\n"
+			"[ Pipeline ]\n"
+			"MacroFusion = %s\n"
+			"MicroFusion = %s\n"
+			"[ Queues ]\n"
+			"RobSize = %d\n"
+			"[ TraceCache ]\n"
+			"Present = f\n%s",
+			fusion ? "t" : "f",
+			fusion ? "t" : "f",
+			reorder_buffer_size,
+			uop_cache_config.c_str()));
+	Timing::ParseConfiguration(&config_ini);
+	Emulator *emulator = Emulator::getInstance();
+	Timing *timing = Timing::getInstance();
+
+	// Memory configuration, with a slow main memory that makes the reorder
+	// buffer fill up
+	misc::IniFile mem_config_ini;
+	mem_config_ini.LoadFromString(
+			"[ General ]\n"
+			"[ Module mod-mm ]\n"
+			"Type = MainMemory\n"
+			"Latency = 50\n"
+			"BlockSize = 64\n"
+			"[ Entry core-0 ]\n"
+			"Arch = x86\n"
+			"Core = 0\n"
+			"Thread = 0\n"
+			"Module = mod-mm\n");
+	mem::System::getInstance()->ReadConfiguration(&mem_config_ini);
+
+	// Code to execute
+	//	mov ecx, num_iterations
+	// loop:
+	//	add eax, [data_address]
+	//	sub ecx, 1
+	//	jnz loop
+	//	mov eax, 1
+	//	xor ebx, ebx
+	//	int 0x80
+	const unsigned char code[] =
+	{
+		0xb9, num_iterations, 0x00, 0x00, 0x00,
+		0x03, 0x05, 0x00, 0x00, 0x02, 0x00,
+		0x83, 0xe9, 0x01,
+		0x75, 0xf5,
+		0xb8, 0x01, 0x00, 0x00, 0x00,
+		0x31, 0xdb,
+		0xcd, 0x80
+	};
+
+	// Create context
+	Context *context = emulator->newContext();
+	context->Initialize();
+	mem::Memory *memory = context->getMemory();
+	memory->Map(code_address, mem::Memory::PageSize,
+			mem::Memory::AccessInit | mem::Memory::AccessRead |
+			mem::Memory::AccessExec);
+	memory->Map(data_address, mem::Memory::PageSize,
+			mem::Memory::AccessRead | mem::Memory::AccessWrite);
+	memory->Init(code_address, sizeof code, (const char *) code);
+	context->setUinstActive(true);
+	context->setState(Context::StateRunning);
+	context->getRegs().setEip(code_address);
+
+	// Map the context
+	Cpu *cpu = timing->getCpu();
+	Core *core = cpu->getCore(0);
+	Thread *thread = cpu->getThread(0, 0);
+	thread->MapContext(context);
+	thread->Schedule();
+	thread->setFetchNeip(code_address);
+
+	// Run until the context exits
+	Result result = { };
+	result.occupancy_consistent = true;
+	esim::Engine *engine = esim::Engine::getInstance();
+	for (int cycle = 0; cycle < 100000; cycle++)
+	{
+		if (!timing->Run())
+		{
+			result.finished = true;
+			break;
+		}
+		engine->ProcessEvents();
+
+		// Fused uops do not take an entry of their own in the
+		// reorder buffer
+		int num_uops = thread->getReorderBufferSize();
+		int occupancy = core->getReorderBufferOccupancy();
+		result.max_reorder_buffer_uops = std::max(
+				result.max_reorder_buffer_uops, num_uops);
+		result.max_reorder_buffer_occupancy = std::max(
+				result.max_reorder_buffer_occupancy, occupancy);
+		if (occupancy != num_uops -
+				thread->getNumFusedUopsInReorderBuffer())
+			result.occupancy_consistent = false;
+	}
+
+	// Statistics
+	result.num_committed_instructions = cpu->getNumCommittedInstructions();
+	result.num_committed_uinsts = cpu->getNumCommittedUinsts();
+	result.num_macro_fused_uinsts = cpu->getNumMacroFusedUinsts();
+	result.num_micro_fused_uinsts = cpu->getNumMicroFusedUinsts();
+	if (thread->getUopCache())
+		result.num_uop_cache_hits = thread->getUopCache()->getNumHits();
+
+	// Restore default configuration for other tests
+	misc::IniFile default_ini;
+	Cleanup();
+	Timing::ParseConfiguration(&default_ini);
+	return result;
+}
+
+
+TEST(TestX86TimingFusion, commit)
+{
+	Result result = RunLoop(false);
+	Result fused_result = RunLoop(true);
+	ASSERT_TRUE(result.finished);
+	ASSERT_TRUE(fused_result.finished);
+
+	// No fusion by default
+	EXPECT_EQ(0, result.num_macro_fused_uinsts);
+	EXPECT_EQ(0, result.num_micro_fused_uinsts);
+
+	// Every iteration fuses the branch with the subtraction, and the load
+	// with the addition
+	EXPECT_EQ(num_iterations, fused_result.num_macro_fused_uinsts);
+	EXPECT_EQ(num_iterations, fused_result.num_micro_fused_uinsts);
+
+	// Fusion does not change the committed instructions and uops
+	EXPECT_EQ(result.num_committed_instructions,
+			fused_result.num_committed_instructions);
+	EXPECT_EQ(result.num_committed_uinsts,
+			fused_result.num_committed_uinsts);
+}
+
+
+TEST(TestX86TimingFusion, reorder_buffer_occupancy)
+{
+	Result result = RunLoop(false);
+	Result fused_result = RunLoop(true);
+
+	// Occupancy counts every uop without fusion
+	EXPECT_TRUE(result.occupancy_consistent);
+	EXPECT_EQ(reorder_buffer_size, result.max_reorder_buffer_uops);
+	EXPECT_EQ(reorder_buffer_size, result.max_reorder_buffer_occupancy);
+
+	// Fused uops share an entry, so more uops fit in the reorder buffer
+	// while the occupancy stays within its size
+	EXPECT_TRUE(fused_result.occupancy_consistent);
+	EXPECT_GT(fused_result.max_reorder_buffer_uops, reorder_buffer_size);
+	EXPECT_EQ(reorder_buffer_size,
+			fused_result.max_reorder_buffer_occupancy);
+}
+
+
+TEST(TestX86TimingFusion, uop_cache)
+{
+	// The loop body is delivered by the uop cache after the first
+	// iteration, with the same results
+	Result result = RunLoop(true);
+	Result cached_result = RunLoop(true,
+			"[ UopCache ]\n"
+			"Present = t\n");
+	ASSERT_TRUE(cached_result.finished);
+	EXPECT_EQ(0, result.num_uop_cache_hits);
+	EXPECT_GT(cached_result.num_uop_cache_hits, 0);
+	EXPECT_EQ(result.num_committed_instructions,
+			cached_result.num_committed_instructions);
+	EXPECT_EQ(result.num_committed_uinsts,
+			cached_result.num_committed_uinsts);
+	EXPECT_EQ(result.num_macro_fused_uinsts,
+			cached_result.num_macro_fused_uinsts);
+	EXPECT_EQ(result.num_micro_fused_uinsts,
+			cached_result.num_micro_fused_uinsts);
+}
+
+}  // namespace x86
@@ -0,0 +1,208 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/Error.h>
+#include <lib/esim/Engine.h>
+#include <memory/Manager.h>
+#include <memory/System.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Timing.h>
+#include <arch/x86/timing/Cpu.h>
+#include <arch/x86/timing/Thread.h>
+
+namespace x86
+{
+
+static void Cleanup()
+{
+	Timing::Destroy();
+	Emulator::Destroy();
+	mem::System::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// State observed after running two cores for a fixed number of cycles
+struct Result
+{
+	long long num_committed_instructions;
+	long long num_squashed_uinsts;
+	long long num_branches;
+	long long num_mispredicted_branches;
+	unsigned ecx[2];
+	unsigned edx[2];
+	unsigned esi[2];
+};
+
+
+// Run a loop with data-dependent branches on two cores, with the given number
+// of host threads.
+static Result RunCores(int num_host_threads)
+{
+	Cleanup();
+
+	// CPU configuration
+	misc::IniFile config_ini;
+	config_ini.LoadFromString(
+			"[ General ]\n"
+			"Cores = 2\n"
+			"[ TraceCache ]\n"
+			"Present = f");
+	Timing::ParseConfiguration(&config_ini);
+	Cpu::num_host_threads = num_host_threads;
+	Emulator *emulator = Emulator::getInstance();
+	Timing *timing = Timing::getInstance();
+
+	// Memory configuration
+	misc::IniFile mem_config_ini;
+	mem_config_ini.LoadFromString(
+			"[ General ]\n"
+			"[ Module mod-mm ]\n"
+			"Type = MainMemory\n"
+			"Latency = 10\n"
+			"BlockSize = 64\n"
+			"[ Entry core-0 ]\n"
+			"Arch = x86\n"
+			"Core = 0\n"
+			"Thread = 0\n"
+			"Module = mod-mm\n"
+			"[ Entry core-1 ]\n"
+			"Arch = x86\n"
+			"Core = 1\n"
+			"Thread = 0\n"
+			"Module = mod-mm\n");
+	mem::System::getInstance()->ReadConfiguration(&mem_config_ini);
+
+	// Code to execute
+	//	mov ecx, 0x1000
+	//	xor esi, esi
+	// loop:
+	//	lea edx, [edx + edx * 4 + 1]
+	//	test dh, 4
+	//	jz skip
+	//	inc esi
+	// skip:
+	//	dec ecx
+	//	jnz loop
+	//	jmp $
+	const unsigned char code[] =
+	{
+		0xb9, 0x00, 0x10, 0x00, 0x00,
+		0x31, 0xf6,
+		0x8d, 0x54, 0x92, 0x01,
+		0xf6, 0xc6, 0x04,
+		0x74, 0x01,
+		0x46,
+		0x49,
+		0x75, 0xf3,
+		0xeb, 0xfe
+	};
+
+	// One context per core, with a different seed in 'edx'
+	Cpu *cpu = timing->getCpu();
+	Context *contexts[2];
+	for (int core = 0; core < 2; core++)
+	{
+		Context *context = emulator->newContext();
+		context->Initialize();
+		mem::Memory *memory = context->getMemory();
+		memory->setHeapBreak(misc::RoundUp(memory->getHeapBreak(),
+				mem::Memory::PageSize));
+		mem::Manager manager(memory);
+		unsigned eip = manager.Allocate(sizeof code, 128);
+		memory->Write(eip, sizeof code, (const char *) code);
+
+		context->setUinstActive(true);
+		context->setState(Context::StateRunning);
+		context->getRegs().setEip(eip);
+		context->getRegs().setEdx(core + 1);
+
+		Thread *thread = cpu->getThread(core, 0);
+		thread->MapContext(context);
+		thread->Schedule();
+		thread->setFetchNeip(eip);
+		contexts[core] = context;
+	}
+
+	// Run
+	esim::Engine *engine = esim::Engine::getInstance();
+	for (int cycle = 0; cycle < 3000; cycle++)
+	{
+		timing->Run();
+		engine->ProcessEvents();
+	}
+
+	// Collect results
+	Result result;
+	result.num_committed_instructions = cpu->getNumCommittedInstructions();
+	result.num_squashed_uinsts = cpu->getNumSquashedUinsts();
+	result.num_branches = cpu->getNumBranches();
+	result.num_mispredicted_branches = cpu->getNumMispredictedBranches();
+	for (int core = 0; core < 2; core++)
+	{
+		Regs &regs = contexts[core]->getRegs();
+		result.ecx[core] = regs.getEcx();
+		result.edx[core] = regs.getEdx();
+		result.esi[core] = regs.getEsi();
+	}
+
+	// Restore default configuration for other tests
+	Cpu::num_host_threads = 1;
+	misc::IniFile default_ini;
+	default_ini.LoadFromString(
+			"[ General ]\n"
+			"Cores = 1");
+	Cleanup();
+	Timing::ParseConfiguration(&default_ini);
+	return result;
+}
+
+
+// Advancing the cores on several host threads gives the same results as the
+// sequential mode, including recoveries from branch mispredictions in the
+// commit stage, which runs concurrently in all cores.
+TEST(TestX86TimingHostThreads, determinism)
+{
+	Result serial = RunCores(1);
+	Result parallel = RunCores(4);
+
+	// Mispredictions and recoveries occurred
+	EXPECT_GT(serial.num_committed_instructions, 0);
+	EXPECT_GT(serial.num_mispredicted_branches, 0);
+	EXPECT_GT(serial.num_squashed_uinsts, 0);
+
+	// Same results
+	EXPECT_EQ(serial.num_committed_instructions,
+			parallel.num_committed_instructions);
+	EXPECT_EQ(serial.num_squashed_uinsts, parallel.num_squashed_uinsts);
+	EXPECT_EQ(serial.num_branches, parallel.num_branches);
+	EXPECT_EQ(serial.num_mispredicted_branches,
+			parallel.num_mispredicted_branches);
+	for (int core = 0; core < 2; core++)
+	{
+		EXPECT_EQ(serial.ecx[core], parallel.ecx[core]);
+		EXPECT_EQ(serial.edx[core], parallel.edx[core]);
+		EXPECT_EQ(serial.esi[core], parallel.esi[core]);
+	}
+}
+
+}  // namespace x86
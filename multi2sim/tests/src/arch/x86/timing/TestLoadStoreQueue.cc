@@ -0,0 +1,228 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/Error.h>
+#include <lib/esim/Engine.h>
+#include <memory/System.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Timing.h>
+#include <arch/x86/timing/Cpu.h>
+#include <arch/x86/timing/Thread.h>
+
+namespace x86
+{
+
+static void Cleanup()
+{
+	Timing::Destroy();
+	Emulator::Destroy();
+	mem::System::Destroy();
+	comm::ArchPool::Destroy();
+	esim::Engine::Destroy();
+}
+
+
+// Guest addresses
+static const unsigned code_address = 0x10000;
+static const unsigned data_address = 0x20000;
+
+// Number of loop iterations
+static const int num_iterations = 200;
+
+
+// Statistics of a run of the load-store queue test program
+struct Result
+{
+	bool finished;
+	long long num_cycles;
+	long long num_committed_instructions;
+	long long num_forwarded_loads;
+	long long num_memory_order_violations;
+};
+
+
+// Run a loop where each iteration stores a register into memory and loads
+// it back right away, so that the load can get its data forwarded from the
+// store. The context exits after the loop.
+static Result RunLoop(const std::string &config)
+{
+	Cleanup();
+
+	// CPU configuration
+	misc::IniFile config_ini;
+	config_ini.LoadFromString("[ General ]\n"
+			"[ TraceCache ]\n"
+			"Present = f\n" + config);
+	Timing::ParseConfiguration(&config_ini);
+	Emulator *emulator = Emulator::getInstance();
+	Timing *timing = Timing::getInstance();
+
+	// Memory configuration, with a slow main memory so that forwarded
+	// loads are faster than loads accessing memory
+	misc::IniFile mem_config_ini;
+	mem_config_ini.LoadFromString(
+			"[ General ]\n"
+			"[ Module mod-mm ]\n"
+			"Type = MainMemory\n"
+			"Latency = 50\n"
+			"BlockSize = 64\n"
+			"[ Entry core-0 ]\n"
+			"Arch = x86\n"
+			"Core = 0\n"
+			"Thread = 0\n"
+			"Module = mod-mm\n");
+	mem::System::getInstance()->ReadConfiguration(&mem_config_ini);
+
+	// Code to execute
+	//	mov ecx, num_iterations
+	// loop:
+	//	mov [data_address], ecx
+	//	mov eax, [data_address]
+	//	sub ecx, 1
+	//	jnz loop
+	//	mov eax, 1
+	//	xor ebx, ebx
+	//	int 0x80
+	const unsigned char code[] =
+	{
+		0xb9, num_iterations, 0x00, 0x00, 0x00,
+		0x89, 0x0d, 0x00, 0x00, 0x02, 0x00,
+		0x8b, 0x05, 0x00, 0x00, 0x02, 0x00,
+		0x83, 0xe9, 0x01,
+		0x75, 0xef,
+		0xb8, 0x01, 0x00, 0x00, 0x00,
+		0x31, 0xdb,
+		0xcd, 0x80
+	};
+
+	// Create context
+	Context *context = emulator->newContext();
+	context->Initialize();
+	mem::Memory *memory = context->getMemory();
+	memory->Map(code_address, mem::Memory::PageSize,
+			mem::Memory::AccessInit | mem::Memory::AccessRead |
+			mem::Memory::AccessExec);
+	memory->Map(data_address, mem::Memory::PageSize,
+			mem::Memory::AccessRead | mem::Memory::AccessWrite);
+	memory->Init(code_address, sizeof code, (const char *) code);
+	context->setUinstActive(true);
+	context->setState(Context::StateRunning);
+	context->getRegs().setEip(code_address);
+
+	// Map the context
+	Cpu *cpu = timing->getCpu();
+	Thread *thread = cpu->getThread(0, 0);
+	thread->MapContext(context);
+	thread->Schedule();
+	thread->setFetchNeip(code_address);
+
+	// Run until the context exits
+	Result result = { };
+	esim::Engine *engine = esim::Engine::getInstance();
+	for (int cycle = 0; cycle < 100000; cycle++)
+	{
+		if (!timing->Run())
+		{
+			result.finished = true;
+			break;
+		}
+		engine->ProcessEvents();
+		result.num_cycles++;
+	}
+
+	// Statistics
+	result.num_committed_instructions = cpu->getNumCommittedInstructions();
+	result.num_forwarded_loads = thread->getNumForwardedLoads();
+	result.num_memory_order_violations =
+			thread->getNumMemoryOrderViolations();
+
+	// Restore default configuration for other tests
+	misc::IniFile default_ini;
+	Cleanup();
+	Timing::ParseConfiguration(&default_ini);
+	return result;
+}
+
+
+// Number of instructions of the test program
+static const long long num_instructions = 4 * num_iterations + 4;
+
+
+// By default, memory dependences are not modeled, and every load accesses
+// memory
+TEST(TestX86TimingLoadStoreQueue, no_forwarding)
+{
+	Result result = RunLoop("");
+	EXPECT_TRUE(result.finished);
+	EXPECT_EQ(num_instructions, result.num_committed_instructions);
+	EXPECT_EQ(0, result.num_forwarded_loads);
+	EXPECT_EQ(0, result.num_memory_order_violations);
+}
+
+
+// Loads get their data forwarded from the older store without a store set
+// predictor, with a latency that can be configured
+TEST(TestX86TimingLoadStoreQueue, forwarding_without_predictor)
+{
+	Result baseline = RunLoop("");
+	Result fast = RunLoop("[ Queues ]\n"
+			"StoreForwarding = t\n"
+			"StoreForwardLatency = 1\n");
+	Result slow = RunLoop("[ Queues ]\n"
+			"StoreForwarding = t\n"
+			"StoreForwardLatency = 40\n");
+	for (Result *result : { &fast, &slow })
+	{
+		EXPECT_TRUE(result->finished);
+		EXPECT_EQ(num_instructions, result->num_committed_instructions);
+		EXPECT_GT(result->num_forwarded_loads, num_iterations / 2);
+	}
+	EXPECT_EQ(fast.num_forwarded_loads, slow.num_forwarded_loads);
+	EXPECT_LT(fast.num_cycles, slow.num_cycles);
+	EXPECT_LT(fast.num_cycles, baseline.num_cycles);
+}
+
+
+// The store set predictor can be added on top of store forwarding, but it
+// is rejected without it
+TEST(TestX86TimingLoadStoreQueue, forwarding_with_predictor)
+{
+	Result result = RunLoop("[ Queues ]\n"
+			"StoreForwarding = t\n"
+			"[ StoreSetPredictor ]\n"
+			"Present = t\n");
+	EXPECT_TRUE(result.finished);
+	EXPECT_EQ(num_instructions, result.num_committed_instructions);
+	EXPECT_GT(result.num_forwarded_loads, num_iterations / 2);
+
+	// Predictor without store forwarding
+	Cleanup();
+	misc::IniFile config_ini;
+	config_ini.LoadFromString("[ General ]\n"
+			"[ StoreSetPredictor ]\n"
+			"Present = t\n");
+	EXPECT_THROW(Timing::ParseConfiguration(&config_ini), Timing::Error);
+	misc::IniFile default_ini;
+	Timing::ParseConfiguration(&default_ini);
+}
+
+}
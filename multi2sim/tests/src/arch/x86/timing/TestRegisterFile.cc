@@ -822,6 +822,180 @@ TEST(TestRegisterFile, write_uop_0)
 }
 
 
+// Tests that renaming a uop records its pending inputs, and that writing back
+// the producer wakes it up.
+TEST(TestRegisterFile, write_uop_wakeup)
+{
+	// Cleanup singleton instances
+	ObjectPool::Destroy();
+
+	// Default register file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(default_config);
+	Timing::ParseConfiguration(&ini_file);
+
+	// Get object pool instance
+	ObjectPool *object_pool = ObjectPool::getInstance();
+
+	// Create uinsts, where uop_1 produces two of the inputs of uop_0
+	auto uinst_0 = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	auto uinst_1 = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	uinst_0->setIDep(0, 1);
+	uinst_0->setIDep(1, 2);
+	uinst_0->setIDep(2, 3);
+	uinst_1->setODep(0, 1);
+	uinst_1->setODep(1, 2);
+
+	// Create uops
+	auto uop_0 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_0);
+	auto uop_1 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_1);
+
+	// Rename producer, then consumer
+	auto register_file = object_pool->getThread()->getRegisterFile();
+	register_file->Rename(uop_1.get());
+	register_file->Rename(uop_0.get());
+	EXPECT_EQ(2, uop_0->num_pending_inputs);
+	EXPECT_FALSE(uop_0->ready);
+
+	// Writing back the producer wakes up the consumer
+	register_file->WriteUop(uop_1.get());
+	EXPECT_EQ(0, uop_0->num_pending_inputs);
+	EXPECT_TRUE(uop_0->ready);
+}
+
+
+// Tests that a squashed consumer stops waiting for its producer.
+TEST(TestRegisterFile, remove_consumer)
+{
+	// Cleanup singleton instances
+	ObjectPool::Destroy();
+
+	// Default register file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(default_config);
+	Timing::ParseConfiguration(&ini_file);
+
+	// Get object pool instance
+	ObjectPool *object_pool = ObjectPool::getInstance();
+
+	// Create uinsts, where uop_1 produces the input of uop_0
+	auto uinst_0 = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	auto uinst_1 = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	uinst_0->setIDep(0, 1);
+	uinst_1->setODep(0, 1);
+
+	// Create uops
+	auto uop_0 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_0);
+	auto uop_1 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_1);
+
+	// Rename both and squash the consumer
+	auto register_file = object_pool->getThread()->getRegisterFile();
+	register_file->Rename(uop_1.get());
+	register_file->Rename(uop_0.get());
+	EXPECT_EQ(1, uop_0->num_pending_inputs);
+	register_file->RemoveConsumer(uop_0.get());
+	EXPECT_EQ(0, uop_0->num_pending_inputs);
+
+	// The consumer is not woken up anymore
+	register_file->WriteUop(uop_1.get());
+	EXPECT_FALSE(uop_0->ready);
+}
+
+
+// Tests that the address of a store is known as soon as the effective address
+// is written back, while its data is still pending.
+TEST(TestRegisterFile, store_address_ready)
+{
+	// Cleanup singleton instances
+	ObjectPool::Destroy();
+
+	// Default register file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(default_config);
+	Timing::ParseConfiguration(&ini_file);
+
+	// Get object pool instance
+	ObjectPool *object_pool = ObjectPool::getInstance();
+
+	// Create uinsts, where uop_1 computes the effective address of the
+	// store in uop_0, and uop_2 computes its data
+	auto uinst_0 = misc::new_shared<Uinst>(Uinst::OpcodeStore);
+	auto uinst_1 = misc::new_shared<Uinst>(Uinst::OpcodeEffaddr);
+	auto uinst_2 = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	uinst_0->setIDep(0, Uinst::DepEbx);
+	uinst_0->setIDep(1, Uinst::DepEa);
+	uinst_1->setODep(0, Uinst::DepEa);
+	uinst_2->setODep(0, Uinst::DepEbx);
+
+	// Create uops
+	auto uop_0 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_0);
+	auto uop_1 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_1);
+	auto uop_2 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_2);
+	EXPECT_FALSE(uop_0->isStoreAddressInput(0));
+	EXPECT_TRUE(uop_0->isStoreAddressInput(1));
+
+	// Rename producers, then the store
+	auto register_file = object_pool->getThread()->getRegisterFile();
+	register_file->Rename(uop_1.get());
+	register_file->Rename(uop_2.get());
+	register_file->Rename(uop_0.get());
+	EXPECT_EQ(2, uop_0->num_pending_inputs);
+	EXPECT_FALSE(register_file->isStoreAddressReady(uop_0.get()));
+
+	// Address is known before the data
+	register_file->WriteUop(uop_1.get());
+	EXPECT_TRUE(register_file->isStoreAddressReady(uop_0.get()));
+	EXPECT_EQ(1, uop_0->num_pending_inputs);
+	EXPECT_FALSE(uop_0->ready);
+
+	// Data
+	register_file->WriteUop(uop_2.get());
+	EXPECT_TRUE(uop_0->ready);
+}
+
+
+// Tests that stores without an effective address take their address from
+// their first input.
+TEST(TestRegisterFile, store_address_first_input)
+{
+	// Cleanup singleton instances
+	ObjectPool::Destroy();
+
+	// Default register file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(default_config);
+	Timing::ParseConfiguration(&ini_file);
+
+	// Get object pool instance
+	ObjectPool *object_pool = ObjectPool::getInstance();
+
+	// Store of a pushed value, with the address in the first input
+	auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeStore);
+	uinst->setIDep(0, Uinst::DepAux);
+	uinst->setIDep(1, Uinst::DepEax);
+	auto uop = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst);
+	EXPECT_TRUE(uop->isStoreAddressInput(0));
+	EXPECT_FALSE(uop->isStoreAddressInput(1));
+	EXPECT_FALSE(uop->isStoreAddressInput(2));
+}
+
+
 
 
 //
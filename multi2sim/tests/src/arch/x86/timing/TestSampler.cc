@@ -0,0 +1,123 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include <lib/cpp/IniFile.h>
+#include <arch/x86/timing/Sampler.h>
+
+namespace x86
+{
+
+TEST(TestSampler, read_configuration)
+{
+	// Sampling disabled by default
+	misc::IniFile ini_file;
+	Sampler::ParseConfiguration(&ini_file);
+	EXPECT_FALSE(Sampler::isEnabled());
+
+	// Period shorter than warm-up plus window
+	misc::IniFile ini_file_2;
+	ini_file_2.LoadFromString(
+			"[ Sampling ]\n"
+			"Period = 1000\n"
+			"Warmup = 800\n"
+			"Window = 400");
+	EXPECT_THROW(Sampler::ParseConfiguration(&ini_file_2), Sampler::Error);
+
+	// Valid configuration
+	misc::IniFile ini_file_3;
+	ini_file_3.LoadFromString(
+			"[ Sampling ]\n"
+			"Period = 100000\n"
+			"Confidence = 0.95");
+	Sampler::ParseConfiguration(&ini_file_3);
+	EXPECT_TRUE(Sampler::isEnabled());
+	EXPECT_EQ(100000, Sampler::getPeriod());
+	EXPECT_EQ(2000, Sampler::getWarmupLength());
+	EXPECT_EQ(1000, Sampler::getWindowLength());
+
+	// Restore default configuration for other tests
+	Sampler::ParseConfiguration(&ini_file);
+}
+
+
+TEST(TestSampler, confidence_interval)
+{
+	// Quantiles of the standard normal distribution
+	EXPECT_NEAR(1.960, Sampler::getZScore(0.95), 1e-3);
+	EXPECT_NEAR(2.968, Sampler::getZScore(0.997), 1e-3);
+
+	// Windows with a CPI of 0.5 and 1.5
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(
+			"[ Sampling ]\n"
+			"Period = 100000\n"
+			"Confidence = 0.95");
+	Sampler::ParseConfiguration(&ini_file);
+	Sampler sampler(nullptr);
+	sampler.AddUnit(1000, 500);
+	sampler.AddUnit(1000, 1500);
+	sampler.AddUnit(1000, 500);
+	sampler.AddUnit(1000, 1500);
+	EXPECT_EQ(4, sampler.getNumUnits());
+	EXPECT_DOUBLE_EQ(1.0, sampler.getMeanCpi());
+	EXPECT_NEAR(0.57735, sampler.getCpiStdDev(), 1e-5);
+	EXPECT_NEAR(1.960 * 0.57735 / 2, sampler.getCpiError(), 1e-3);
+
+	// Restore default configuration for other tests
+	misc::IniFile default_ini_file;
+	Sampler::ParseConfiguration(&default_ini_file);
+}
+
+
+TEST(TestSampler, simpoints)
+{
+	// Simulation points in SimPoint format, out of order
+	std::istringstream simpoints("14 0\n3 1\n\n9 2\n");
+	std::istringstream weights("0.5 0\n0.25 1\n0.25 2\n");
+	Sampler::ReadSimPoints(simpoints, weights);
+	EXPECT_TRUE(Sampler::isEnabled());
+	const std::vector<Sampler::SimPoint> &points = Sampler::getSimPoints();
+	ASSERT_EQ(3u, points.size());
+	EXPECT_EQ(3, points[0].interval);
+	EXPECT_EQ(9, points[1].interval);
+	EXPECT_EQ(14, points[2].interval);
+	EXPECT_DOUBLE_EQ(0.5, points[2].weight);
+
+	// Cluster without weight
+	std::istringstream simpoints_2("4 3\n");
+	std::istringstream weights_2("1.0 0\n");
+	EXPECT_THROW(Sampler::ReadSimPoints(simpoints_2, weights_2),
+			Sampler::Error);
+
+	// Weighted CPI
+	Sampler sampler(nullptr);
+	sampler.AddUnit(1000, 500, 0.75);
+	sampler.AddUnit(1000, 2500, 0.25);
+	EXPECT_DOUBLE_EQ(1.0, sampler.getMeanCpi());
+
+	// Restore default configuration for other tests
+	Sampler::ClearSimPoints();
+	EXPECT_FALSE(Sampler::isEnabled());
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Spencer Hance (hance.s@husky.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include <lib/cpp/IniFile.h>
+#include <arch/x86/timing/StoreSetPredictor.h>
+
+namespace x86
+{
+
+// Tests that a load only waits for a store after a violation placed both
+// instructions in the same store set, and only until the store address is
+// known.
+TEST(TestStoreSetPredictor, train_and_lookup)
+{
+	// Default configuration
+	misc::IniFile ini_file;
+	StoreSetPredictor::ParseConfiguration(&ini_file);
+	StoreSetPredictor predictor;
+
+	// No dependence predicted before training
+	predictor.DispatchStore(0x8010, 10);
+	EXPECT_EQ(0, predictor.LookupLoad(0x8030));
+	EXPECT_EQ(-1, predictor.getStoreSet(0x8010));
+
+	// Violation between load and store
+	predictor.Update(0x8030, 0x8010);
+	EXPECT_GE(predictor.getStoreSet(0x8010), 0);
+	EXPECT_EQ(predictor.getStoreSet(0x8010), predictor.getStoreSet(0x8030));
+
+	// Next instance of the load waits for the last dispatched store
+	predictor.DispatchStore(0x8010, 20);
+	predictor.DispatchStore(0x8010, 30);
+	EXPECT_EQ(30, predictor.LookupLoad(0x8030));
+
+	// Resolving an older store keeps the entry
+	predictor.ResolveStore(0x8010, 20);
+	EXPECT_EQ(30, predictor.LookupLoad(0x8030));
+
+	// Resolving the last store clears it
+	predictor.ResolveStore(0x8010, 30);
+	EXPECT_EQ(0, predictor.LookupLoad(0x8030));
+}
+
+
+// Tests that store sets of two instructions are merged when they conflict
+TEST(TestStoreSetPredictor, merge_store_sets)
+{
+	// Default configuration
+	misc::IniFile ini_file;
+	StoreSetPredictor::ParseConfiguration(&ini_file);
+	StoreSetPredictor predictor;
+
+	// Two independent store sets
+	predictor.Update(0x8030, 0x8010);
+	predictor.Update(0x8040, 0x8020);
+	int first = predictor.getStoreSet(0x8010);
+	int second = predictor.getStoreSet(0x8020);
+	EXPECT_NE(first, second);
+
+	// Load of the second set conflicts with the first store
+	predictor.Update(0x8040, 0x8010);
+	EXPECT_EQ(std::min(first, second), predictor.getStoreSet(0x8040));
+	EXPECT_EQ(predictor.getStoreSet(0x8040), predictor.getStoreSet(0x8010));
+
+	// A new load joins an existing store set
+	predictor.Update(0x8050, 0x8020);
+	EXPECT_EQ(second, predictor.getStoreSet(0x8050));
+}
+
+}
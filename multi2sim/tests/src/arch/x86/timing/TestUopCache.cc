@@ -0,0 +1,142 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <lib/cpp/IniFile.h>
+#include <arch/x86/timing/UopCache.h>
+
+namespace x86
+{
+
+TEST(TestUopCache, read_configuration)
+{
+	// Absent by default
+	misc::IniFile ini_file;
+	UopCache::ParseConfiguration(&ini_file);
+	EXPECT_FALSE(UopCache::isPresent());
+
+	// Window size must be a power of 2
+	misc::IniFile ini_file_2;
+	ini_file_2.LoadFromString(
+			"[ UopCache ]\n"
+			"Present = t\n"
+			"WindowSize = 24");
+	EXPECT_THROW(UopCache::ParseConfiguration(&ini_file_2),
+			UopCache::Error);
+
+	// Restore default configuration for other tests
+	UopCache::ParseConfiguration(&ini_file);
+}
+
+
+TEST(TestUopCache, lookup_insert)
+{
+	// One set with two ways of 32-byte windows holding up to 4 uops
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(
+			"[ UopCache ]\n"
+			"Present = t\n"
+			"Sets = 1\n"
+			"Assoc = 2\n"
+			"MaxUops = 4");
+	UopCache::ParseConfiguration(&ini_file);
+	UopCache uop_cache;
+	EXPECT_EQ(0x1000u, UopCache::getWindowAddress(0x101f));
+
+	// Instructions hit only after being decoded
+	EXPECT_FALSE(uop_cache.Lookup(0x1000));
+	uop_cache.Insert(0x1000, 1);
+	uop_cache.Insert(0x1004, 2);
+	EXPECT_TRUE(uop_cache.Lookup(0x1000));
+	EXPECT_TRUE(uop_cache.Contains(0x1004));
+	EXPECT_FALSE(uop_cache.Contains(0x1008));
+	EXPECT_EQ(2, uop_cache.getNumLookups());
+	EXPECT_EQ(1, uop_cache.getNumHits());
+
+	// Least recently used window is replaced
+	uop_cache.Insert(0x2000, 1);
+	uop_cache.Lookup(0x1000);
+	uop_cache.Insert(0x3000, 1);
+	EXPECT_TRUE(uop_cache.Contains(0x1000));
+	EXPECT_FALSE(uop_cache.Contains(0x2000));
+	EXPECT_TRUE(uop_cache.Contains(0x3000));
+	EXPECT_EQ(1, uop_cache.getNumEvictions());
+
+	// Restore default configuration for other tests
+	misc::IniFile default_ini_file;
+	UopCache::ParseConfiguration(&default_ini_file);
+}
+
+
+
+TEST(TestUopCache, overflow)
+{
+	// One set with two ways of 32-byte windows holding up to 4 uops
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(
+			"[ UopCache ]\n"
+			"Present = t\n"
+			"Sets = 1\n"
+			"Assoc = 2\n"
+			"MaxUops = 4");
+	UopCache::ParseConfiguration(&ini_file);
+	UopCache uop_cache;
+	uop_cache.Insert(0x1000, 2);
+	uop_cache.Insert(0x2000, 2);
+
+	// An instruction that does not fit in an entry by itself is not
+	// cached, and does not replace any window
+	uop_cache.Insert(0x3000, 5);
+	EXPECT_FALSE(uop_cache.Contains(0x3000));
+	EXPECT_TRUE(uop_cache.Contains(0x1000));
+	EXPECT_TRUE(uop_cache.Contains(0x2000));
+	EXPECT_EQ(0, uop_cache.getNumEvictions());
+	EXPECT_EQ(1, uop_cache.getNumOverflows());
+
+	// A window exceeding the maximum number of uops drops its
+	// instructions, and stays non-cacheable
+	uop_cache.Insert(0x1004, 3);
+	EXPECT_FALSE(uop_cache.Contains(0x1000));
+	EXPECT_FALSE(uop_cache.Contains(0x1004));
+	EXPECT_EQ(2, uop_cache.getNumOverflows());
+	uop_cache.Insert(0x1000, 2);
+	EXPECT_FALSE(uop_cache.Lookup(0x1000));
+	EXPECT_EQ(0, uop_cache.getNumEvictions());
+
+	// The non-cacheable window is replaced as any other window. It is
+	// the least recently used after accessing the other one.
+	uop_cache.Lookup(0x2000);
+	uop_cache.Insert(0x4000, 1);
+	EXPECT_TRUE(uop_cache.Contains(0x2000));
+	EXPECT_TRUE(uop_cache.Contains(0x4000));
+	EXPECT_EQ(1, uop_cache.getNumEvictions());
+
+	// Once replaced, the window can be cached again
+	uop_cache.Insert(0x1000, 2);
+	EXPECT_TRUE(uop_cache.Contains(0x1000));
+	EXPECT_FALSE(uop_cache.Contains(0x2000));
+	EXPECT_EQ(2, uop_cache.getNumEvictions());
+
+	// Restore default configuration for other tests
+	misc::IniFile default_ini_file;
+	UopCache::ParseConfiguration(&default_ini_file);
+}
+
+}
@@ -0,0 +1,116 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Spencer Hance (hance.s@husky.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/RingBuffer.h>
+#include <lib/cpp/SlotPool.h>
+#include <arch/x86/emulator/Uinst.h>
+#include <arch/x86/timing/Timing.h>
+
+#include "ObjectPool.h"
+
+namespace x86
+{
+
+// Tests that slots of freed uops are reused, and that the pool grows when
+// all of its slots are taken.
+TEST(TestUopPool, allocate_and_free)
+{
+	// Cleanup singleton instances
+	ObjectPool::Destroy();
+
+	// Default configuration
+	misc::IniFile ini_file;
+	Timing::ParseConfiguration(&ini_file);
+	ObjectPool *object_pool = ObjectPool::getInstance();
+
+	// Create more uops than fit in one chunk
+	misc::SlotPool pool(4);
+	EXPECT_EQ(0, pool.getNumSlots());
+	std::vector<Uop *> uops;
+	for (int i = 0; i < 6; i++)
+		uops.push_back(pool.New<Uop>(object_pool->getThread(),
+				object_pool->getContext(),
+				misc::new_shared<Uinst>(Uinst::OpcodeAdd)));
+	EXPECT_EQ(6, pool.getNumAllocated());
+	EXPECT_EQ(8, pool.getNumSlots());
+	EXPECT_EQ(Uinst::OpcodeAdd, uops[5]->getOpcode());
+
+	// A freed slot is handed out again
+	Uop *freed = uops[2];
+	misc::SlotPool::Delete(freed);
+	EXPECT_EQ(5, pool.getNumAllocated());
+	uops[2] = pool.New<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			misc::new_shared<Uinst>(Uinst::OpcodeSub));
+	EXPECT_EQ(freed, uops[2]);
+	EXPECT_EQ(Uinst::OpcodeSub, uops[2]->getOpcode());
+	EXPECT_EQ(8, pool.getNumSlots());
+
+	// Release all
+	for (Uop *uop : uops)
+		misc::SlotPool::Delete(uop);
+	EXPECT_EQ(0, pool.getNumAllocated());
+}
+
+
+// Tests that the ring buffers used for the pipeline queues keep program
+// order across wrap-around, removals in the middle, and growth.
+TEST(TestUopPool, ring_buffer_order)
+{
+	// Fill and wrap around
+	misc::RingBuffer<int> buffer(4);
+	for (int i = 0; i < 4; i++)
+		buffer.PushBack(i);
+	buffer.PopFront();
+	buffer.PopFront();
+	buffer.PushBack(4);
+	buffer.PushBack(5);
+	EXPECT_EQ(4, buffer.getCapacity());
+	ASSERT_EQ(4, buffer.size());
+	EXPECT_EQ(2, buffer.front());
+	EXPECT_EQ(5, buffer.back());
+
+	// Remove close to the head and close to the tail
+	buffer.Erase(1);
+	buffer.Erase(2);
+	ASSERT_EQ(2, buffer.size());
+	EXPECT_EQ(2, buffer[0]);
+	EXPECT_EQ(4, buffer[1]);
+
+	// Insert in the middle and grow
+	buffer.Insert(1, 3);
+	buffer.PushBack(5);
+	buffer.PushBack(6);
+	EXPECT_EQ(8, buffer.getCapacity());
+	ASSERT_EQ(5, buffer.size());
+	for (int i = 0; i < buffer.size(); i++)
+		EXPECT_EQ(i + 2, buffer[i]);
+	EXPECT_EQ(2, buffer.Find(4));
+	EXPECT_EQ(-1, buffer.Find(7));
+
+	// Empty it from the tail
+	buffer.PopBack();
+	buffer.Clear();
+	EXPECT_TRUE(buffer.empty());
+}
+
+}
@@ -0,0 +1,153 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <lib/cpp/Histogram.h>
+#include <lib/cpp/Json.h>
+
+namespace misc
+{
+
+// Bucket 0 holds value 0, and bucket i > 0 the range [2^(i-1), 2^i)
+TEST(TestHistogram, bucket_boundaries)
+{
+	EXPECT_EQ(0, Histogram::getBucket(0));
+	EXPECT_EQ(1, Histogram::getBucket(1));
+	EXPECT_EQ(2, Histogram::getBucket(2));
+	EXPECT_EQ(2, Histogram::getBucket(3));
+	EXPECT_EQ(3, Histogram::getBucket(4));
+	EXPECT_EQ(10, Histogram::getBucket(1023));
+	EXPECT_EQ(11, Histogram::getBucket(1024));
+	for (int i = 0; i < 62; i++)
+	{
+		EXPECT_EQ(i, Histogram::getBucket(Histogram::getBucketLow(i)));
+		EXPECT_EQ(i, Histogram::getBucket(Histogram::getBucketHigh(i)));
+		EXPECT_EQ(Histogram::getBucketHigh(i) + 1,
+				Histogram::getBucketLow(i + 1));
+	}
+
+	// Values land in their buckets, and negative values count as 0
+	Histogram histogram;
+	for (long long value : { -5, 0, 1, 2, 3, 4, 7, 8 })
+		histogram.Add(value);
+	EXPECT_EQ(5, histogram.getNumBuckets());
+	EXPECT_EQ(2, histogram.getBucketCount(0));
+	EXPECT_EQ(1, histogram.getBucketCount(1));
+	EXPECT_EQ(2, histogram.getBucketCount(2));
+	EXPECT_EQ(2, histogram.getBucketCount(3));
+	EXPECT_EQ(1, histogram.getBucketCount(4));
+	EXPECT_EQ(0, histogram.getBucketCount(5));
+	EXPECT_EQ(8, histogram.getCount());
+	EXPECT_EQ(25, histogram.getSum());
+	EXPECT_EQ(0, histogram.getMin());
+	EXPECT_EQ(8, histogram.getMax());
+
+	// Clear
+	histogram.Clear();
+	EXPECT_EQ(0, histogram.getCount());
+	EXPECT_EQ(0, histogram.getNumBuckets());
+	EXPECT_EQ(0.0, histogram.getMean());
+}
+
+
+// Merging adds the buckets and combines the summary values, also into or
+// from an empty histogram
+TEST(TestHistogram, merge)
+{
+	Histogram a;
+	for (long long value : { 5, 6, 100 })
+		a.Add(value);
+	Histogram b;
+	for (long long value : { 1, 6 })
+		b.Add(value);
+
+	// Merge an empty histogram
+	Histogram empty;
+	a.Merge(empty);
+	EXPECT_EQ(3, a.getCount());
+	EXPECT_EQ(5, a.getMin());
+
+	// Merge into an empty histogram
+	empty.Merge(b);
+	EXPECT_EQ(2, empty.getCount());
+	EXPECT_EQ(1, empty.getMin());
+	EXPECT_EQ(6, empty.getMax());
+
+	// Merge two histograms with different number of buckets
+	b.Merge(a);
+	EXPECT_EQ(5, b.getCount());
+	EXPECT_EQ(118, b.getSum());
+	EXPECT_EQ(1, b.getMin());
+	EXPECT_EQ(100, b.getMax());
+	EXPECT_EQ(8, b.getNumBuckets());
+	EXPECT_EQ(1, b.getBucketCount(1));
+	EXPECT_EQ(3, b.getBucketCount(3));
+	EXPECT_EQ(1, b.getBucketCount(7));
+}
+
+
+// Percentiles are interpolated linearly within their bucket, clamped to the
+// minimum and maximum values
+TEST(TestHistogram, percentile)
+{
+	// Empty histogram
+	Histogram histogram;
+	EXPECT_EQ(0.0, histogram.getPercentile(50));
+
+	// Four values in bucket [4, 7]
+	for (long long value : { 4, 5, 6, 7 })
+		histogram.Add(value);
+	EXPECT_DOUBLE_EQ(4.0, histogram.getPercentile(0));
+	EXPECT_DOUBLE_EQ(4.75, histogram.getPercentile(25));
+	EXPECT_DOUBLE_EQ(5.5, histogram.getPercentile(50));
+	EXPECT_DOUBLE_EQ(7.0, histogram.getPercentile(100));
+
+	// Two values of 1 and two of 10, in bucket [8, 15] clamped to [8, 10]
+	histogram.Clear();
+	for (long long value : { 1, 1, 10, 10 })
+		histogram.Add(value);
+	EXPECT_DOUBLE_EQ(1.0, histogram.getPercentile(50));
+	EXPECT_DOUBLE_EQ(9.0, histogram.getPercentile(75));
+	EXPECT_DOUBLE_EQ(10.0, histogram.getPercentile(100));
+	EXPECT_DOUBLE_EQ(5.5, histogram.getMean());
+}
+
+
+// The JSON dump contains the summary and the non-empty buckets
+TEST(TestHistogram, dump_json)
+{
+	Histogram histogram;
+	histogram.Add(0);
+	histogram.Add(3);
+	std::ostringstream os;
+	JsonWriter json(os);
+	histogram.DumpJson(json);
+	json.End();
+	std::string report = os.str();
+	EXPECT_NE(std::string::npos, report.find("\"Count\": 2,"));
+	EXPECT_NE(std::string::npos, report.find("\"Mean\": 1.5,"));
+	EXPECT_NE(std::string::npos, report.find("\"Max\": 3,"));
+	EXPECT_NE(std::string::npos, report.find(
+			"\"Low\": 2,\n\t\t\t\"High\": 3,\n\t\t\t\"Count\": 1"));
+	EXPECT_EQ(std::string::npos, report.find("\"Low\": 1,"));
+}
+
+}
@@ -0,0 +1,129 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <sstream>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/Json.h>
+
+namespace misc
+{
+
+// Quotes, backslashes, and control characters are escaped, and all other
+// characters are copied as they are
+TEST(TestJson, escape)
+{
+	EXPECT_EQ("\"\"", JsonWriter::Escape(""));
+	EXPECT_EQ("\"plain text\"", JsonWriter::Escape("plain text"));
+	EXPECT_EQ("\"a\\\"b\\\\c\"", JsonWriter::Escape("a\"b\\c"));
+	EXPECT_EQ("\"\\n\\r\\t\"", JsonWriter::Escape("\n\r\t"));
+	EXPECT_EQ("\"\\u0001\\u001f\"", JsonWriter::Escape("\x01\x1f"));
+	EXPECT_EQ("\"\xc3\xa9~\"", JsonWriter::Escape("\xc3\xa9~"));
+}
+
+
+// Nested objects and arrays are separated and indented, and empty ones are
+// written on a single line
+TEST(TestJson, nesting)
+{
+	std::ostringstream os;
+	JsonWriter json(os);
+	json.BeginObject();
+	json.Member("Name", "x86");
+	json.Member("Cores", 2);
+	json.Member("IPC", 1.5);
+	json.Member("Active", true);
+	json.Member("Ratio", std::nan(""));
+	json.Key("Empty");
+	json.BeginArray();
+	json.EndArray();
+	json.Key("List");
+	json.BeginArray();
+	json.Value(1);
+	json.BeginObject();
+	json.Member("Key", "Value");
+	json.EndObject();
+	json.Null();
+	json.EndArray();
+	json.Key("Object");
+	json.BeginObject();
+	json.EndObject();
+	json.EndObject();
+	json.End();
+	EXPECT_EQ("{\n"
+			"\t\"Name\": \"x86\",\n"
+			"\t\"Cores\": 2,\n"
+			"\t\"IPC\": 1.5,\n"
+			"\t\"Active\": true,\n"
+			"\t\"Ratio\": null,\n"
+			"\t\"Empty\": [],\n"
+			"\t\"List\": [\n"
+			"\t\t1,\n"
+			"\t\t{\n"
+			"\t\t\t\"Key\": \"Value\"\n"
+			"\t\t},\n"
+			"\t\tnull\n"
+			"\t],\n"
+			"\t\"Object\": {}\n"
+			"}\n", os.str());
+}
+
+
+// Calls producing a malformed document panic
+TEST(TestJson, malformed)
+{
+	std::ostringstream os;
+
+	// Key at the root, and in an array
+	JsonWriter root(os);
+	EXPECT_THROW(root.Key("Key"), Panic);
+	JsonWriter array(os);
+	array.BeginArray();
+	EXPECT_THROW(array.Key("Key"), Panic);
+
+	// Value without a key, and two keys in a row
+	JsonWriter object(os);
+	object.BeginObject();
+	EXPECT_THROW(object.Value(1), Panic);
+	EXPECT_THROW(object.BeginArray(), Panic);
+	object.Key("Key");
+	EXPECT_THROW(object.Key("Other"), Panic);
+
+	// Object closed after a key without a value
+	EXPECT_THROW(object.EndObject(), Panic);
+	object.Value(1);
+	object.EndObject();
+
+	// Unbalanced and mismatched closings
+	EXPECT_THROW(object.EndObject(), Panic);
+	EXPECT_THROW(array.EndObject(), Panic);
+	array.EndArray();
+	EXPECT_THROW(array.EndArray(), Panic);
+
+	// Document finished with open objects
+	JsonWriter open(os);
+	open.BeginObject();
+	EXPECT_THROW(open.End(), Panic);
+	open.EndObject();
+	open.End();
+}
+
+}
@@ -0,0 +1,101 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/ThreadPool.h>
+
+namespace misc
+{
+
+// Every index is processed exactly once, for several consecutive jobs of
+// different sizes, including jobs with fewer indices than threads.
+TEST(TestThreadPool, parallel_for_coverage)
+{
+	ThreadPool thread_pool(4);
+	EXPECT_EQ(4, thread_pool.getNumThreads());
+	for (int count : { 1000, 3, 1, 0, 257 })
+	{
+		std::unique_ptr<std::atomic<int>[]> calls(
+				new std::atomic<int>[count + 1]);
+		for (int i = 0; i < count; i++)
+			calls[i] = 0;
+		thread_pool.ParallelFor(count, [&](int index)
+		{
+			ASSERT_GE(index, 0);
+			ASSERT_LT(index, count);
+			calls[index]++;
+		});
+		for (int i = 0; i < count; i++)
+			EXPECT_EQ(1, calls[i]) << "count " << count << ", index "
+					<< i;
+	}
+}
+
+
+// A pool with one thread runs the loop in the caller, in order
+TEST(TestThreadPool, single_thread)
+{
+	ThreadPool thread_pool(1);
+	EXPECT_EQ(1, thread_pool.getNumThreads());
+	std::vector<int> order;
+	thread_pool.ParallelFor(5, [&](int index) { order.push_back(index); });
+	EXPECT_EQ(std::vector<int>({ 0, 1, 2, 3, 4 }), order);
+}
+
+
+// An exception thrown by any index is rethrown in the caller once all
+// threads have finished, and the pool can be used again afterwards.
+TEST(TestThreadPool, exception_propagation)
+{
+	ThreadPool thread_pool(4);
+	std::atomic<int> num_calls(0);
+	EXPECT_THROW(thread_pool.ParallelFor(100, [&](int index)
+	{
+		num_calls++;
+		if (index == 37)
+			throw Error("Index 37");
+	}), Error);
+	EXPECT_EQ(100, num_calls);
+
+	// Message of the exception
+	try
+	{
+		thread_pool.ParallelFor(10, [](int index)
+		{
+			if (index == 3)
+				throw Error("Index 3");
+		});
+		FAIL() << "No exception thrown";
+	}
+	catch (Error &error)
+	{
+		EXPECT_EQ("Index 3", error.getMessage());
+	}
+
+	// Later jobs run normally
+	num_calls = 0;
+	thread_pool.ParallelFor(50, [&](int index) { num_calls++; });
+	EXPECT_EQ(50, num_calls);
+}
+
+}  // namespace misc
@@ -19,10 +19,15 @@
 
 #include "gtest/gtest.h"
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/Error.h>
 #include <lib/esim/Engine.h>
 #include <lib/esim/Event.h>
+#include <lib/esim/IntervalStatistics.h>
 #include <lib/esim/Queue.h>
 
 
@@ -516,6 +521,233 @@ TEST(TestEngine, test_event_queue_priority)
 	}
 }
 
+
+
+
+//
+// Test 5
+//
+
+// Create test handler, keeping the event chain alive for 3 invocations
+int handler_calls_5 = 0;
+void testHandler_5(Event *event, Frame *frame)
+{
+	if (++handler_calls_5 < 3)
+		Engine::getInstance()->Next(event, 1);
+}
+
+// Tests the profiler of event handlers
+TEST(TestEngine, test_profile)
+{
+	try
+	{
+		// Cleanup pointers to singleton instances
+		Cleanup();
+
+		// Set up esim engine with the profiler active
+		Engine *engine = Engine::getInstance();
+		engine->setProfilePath("profile");
+		EXPECT_TRUE(engine->isProfiling());
+
+		// Set up frequency domains
+		FrequencyDomain *fast_domain = engine->RegisterFrequencyDomain(
+				"fast domain", 2000);
+		FrequencyDomain *slow_domain = engine->RegisterFrequencyDomain(
+				"slow domain", 1000);
+
+		// Register events
+		Event *fast_event = engine->RegisterEvent("fast event",
+				testHandler_5, fast_domain);
+		Event *slow_event = engine->RegisterEvent("slow event",
+				testHandler_0, slow_domain);
+
+		// Register profile entry for a simulation loop
+		Event *loop_entry = engine->RegisterProfileEntry("loop entry",
+				slow_domain);
+
+		// Schedule events and run simulation
+		engine->Call(fast_event, misc::new_shared<Frame>());
+		engine->Call(slow_event, misc::new_shared<Frame>());
+		for (int i = 0; i < 10; i++)
+		{
+			engine->ProcessEvents();
+			loop_entry->addExecution(1000000);
+		}
+
+		// Check number of invocations
+		EXPECT_EQ(3, fast_event->getNumExecutions());
+		EXPECT_EQ(1, slow_event->getNumExecutions());
+		EXPECT_EQ(10, loop_entry->getNumExecutions());
+		EXPECT_EQ(10000000, loop_entry->getHostTime());
+		EXPECT_GE(fast_event->getHostTime(), 0);
+
+		// Check report
+		std::ostringstream os;
+		engine->DumpProfile(os);
+		std::string report = os.str();
+		EXPECT_NE(std::string::npos, report.find("Events = 14\n"));
+		EXPECT_NE(std::string::npos, report.find("fast domain"));
+		EXPECT_NE(std::string::npos, report.find("slow event"));
+		EXPECT_NE(std::string::npos, report.find("loop entry"));
+		EXPECT_EQ(std::string::npos, report.find("Null event"));
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+
+
+//
+// Test 6
+//
+
+// Counter incremented by an event every cycle
+long long counter_6 = 0;
+void testHandler_6(Event *event, Frame *frame)
+{
+	counter_6 += 2;
+}
+
+// Tests the interval statistics
+TEST(TestEngine, test_interval_statistics)
+{
+	try
+	{
+		// Cleanup pointers to singleton instances
+		Cleanup();
+		IntervalStatistics::Destroy();
+
+		// Set up esim engine
+		Engine *engine = Engine::getInstance();
+		FrequencyDomain *domain = engine->RegisterFrequencyDomain(
+				"domain", 1000);
+		Event *event = engine->RegisterEvent("event", testHandler_6,
+				domain);
+
+		// Activate interval statistics
+		std::string path = "test_interval_statistics.csv";
+		IntervalStatistics *interval_statistics =
+				IntervalStatistics::getInstance();
+		interval_statistics->setInterval(10);
+		EXPECT_THROW(interval_statistics->setInterval(0), Error);
+		interval_statistics->setPath(path);
+		interval_statistics->RegisterCounter("Counter",
+				[]() { return (double) counter_6; });
+		interval_statistics->RegisterRatio("Ratio",
+				[]() { return (double) counter_6; },
+				[domain]() { return (double) domain->getCycle(); });
+		interval_statistics->RegisterGauge("Gauge",
+				[]() { return 7.0; });
+		interval_statistics->Start();
+		EXPECT_THROW(interval_statistics->RegisterGauge("Late",
+				[]() { return 0.0; }), misc::Panic);
+
+		// Run 25 cycles, with the event running every cycle
+		engine->Call(event, nullptr, nullptr, 0, 1);
+		for (int i = 0; i < 25; i++)
+			engine->ProcessEvents();
+		interval_statistics->Finish();
+
+		// Check time series, with two full intervals and a shorter one
+		std::ifstream f(path);
+		std::stringstream ss;
+		ss << f.rdbuf();
+		EXPECT_EQ("Cycle,Counter,Ratio,Gauge\n"
+				"10,20,2,7\n"
+				"20,20,2,7\n"
+				"25,10,2,7\n", ss.str());
+		remove(path.c_str());
+
+		// Cleanup
+		IntervalStatistics::Destroy();
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+
+
+//
+// Test 7
+//
+
+// Number of remaining cycles in which the event reschedules itself
+int counter_7 = 0;
+void testHandler_7(Event *event, Frame *frame)
+{
+	if (--counter_7 > 0)
+		Engine::getInstance()->Next(event, 1);
+}
+
+// Run a simulation of 25 cycles, draining the event heap at the end as done
+// in the main simulation loop, and return the final cycle
+static long long runSimulation_7(bool interval_statistics_active)
+{
+	// Cleanup pointers to singleton instances
+	Cleanup();
+	IntervalStatistics::Destroy();
+
+	// Set up esim engine
+	Engine *engine = Engine::getInstance();
+	FrequencyDomain *domain = engine->RegisterFrequencyDomain(
+			"domain", 1000);
+	Event *event = engine->RegisterEvent("event", testHandler_7,
+			domain);
+
+	// Activate interval statistics, with a sampling point after the end
+	// of the simulation
+	std::string path = "test_interval_statistics_end.csv";
+	IntervalStatistics *interval_statistics =
+			IntervalStatistics::getInstance();
+	if (interval_statistics_active)
+	{
+		interval_statistics->setInterval(20);
+		interval_statistics->setPath(path);
+		interval_statistics->RegisterGauge("Gauge",
+				[]() { return (double) counter_7; });
+	}
+	interval_statistics->Start();
+
+	// Run until the event stops rescheduling itself
+	counter_7 = 25;
+	engine->Call(event);
+	while (counter_7 > 0)
+		engine->ProcessEvents();
+	engine->Finish("Test");
+	interval_statistics->Finish();
+	engine->ProcessAllEvents();
+
+	// Cleanup
+	remove(path.c_str());
+	IntervalStatistics::Destroy();
+	return engine->getCycle();
+}
+
+// Tests that the periodic event of the interval statistics does not extend
+// the simulation when the remaining events are drained
+TEST(TestEngine, test_interval_statistics_end)
+{
+	try
+	{
+		long long cycle = runSimulation_7(false);
+		EXPECT_EQ(cycle, runSimulation_7(true));
+		EXPECT_LT(cycle, 40);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
 }
 
 
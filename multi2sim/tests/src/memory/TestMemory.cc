@@ -0,0 +1,117 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <memory/Memory.h>
+
+namespace mem
+{
+
+TEST(TestMemory, checkpoint_round_trip)
+{
+	// Memory with one page of text, one zero page, and one page with
+	// a data pattern spanning into the next page
+	Memory memory;
+	memory.Map(0x1000, Memory::PageSize, Memory::AccessRead |
+			Memory::AccessExec);
+	memory.Map(0x8000, 3 * Memory::PageSize, Memory::AccessRead |
+			Memory::AccessWrite);
+	memory.setSafe(false);
+	memory.WriteString(0x1010, "checkpoint");
+	for (unsigned i = 0; i < 1000; i++)
+		memory.Write(0x9000 + i * 5, 4, (const char *) &i);
+	memory.setSafe(true);
+	memory.setHeapBreak(0xb000);
+
+	// Save and restore
+	std::ostringstream os;
+	memory.SaveCheckpoint(os);
+	std::string image = os.str();
+	Memory restored;
+	const char *end = restored.LoadCheckpoint(image.data(),
+			image.data() + image.size());
+	EXPECT_EQ(image.data() + image.size(), end);
+
+	// Compressed image is smaller than the raw pages
+	EXPECT_LT(image.size(), 2 * Memory::PageSize);
+
+	// Check content and attributes
+	EXPECT_EQ(0xb000u, restored.getHeapBreak());
+	EXPECT_EQ("checkpoint", restored.ReadString(0x1010));
+	for (unsigned i = 0; i < 1000; i++)
+	{
+		unsigned value;
+		restored.Read(0x9000 + i * 5, 4, (char *) &value);
+		EXPECT_EQ(i, value);
+	}
+	ASSERT_TRUE(restored.getPage(0x8000) != nullptr);
+	EXPECT_EQ(nullptr, restored.getPage(0x8000)->getData());
+	EXPECT_EQ(nullptr, restored.getPage(0x2000));
+	EXPECT_EQ(memory.getPage(0x1000)->getPerm(),
+			restored.getPage(0x1000)->getPerm());
+	EXPECT_EQ(memory.getPage(0xa000)->getPerm(),
+			restored.getPage(0xa000)->getPerm());
+
+	// Truncated image
+	Memory truncated;
+	EXPECT_THROW(truncated.LoadCheckpoint(image.data(),
+			image.data() + image.size() - 1), Memory::Error);
+}
+
+
+TEST(TestMemory, concurrent_access)
+{
+	// Threads write interleaved words into pages without data, which are
+	// allocated by whichever thread touches them first
+	Memory memory;
+	const unsigned num_pages = 16;
+	const unsigned num_threads = 4;
+	memory.Map(0x10000, num_pages * Memory::PageSize,
+			Memory::AccessRead | Memory::AccessWrite);
+	std::vector<std::thread> threads;
+	for (unsigned id = 0; id < num_threads; id++)
+		threads.emplace_back([&memory, id]()
+		{
+			for (unsigned address = 0x10000 + id * 4;
+					address < 0x10000 + num_pages *
+					Memory::PageSize;
+					address += num_threads * 4)
+				memory.Write(address, 4, (const char *) &address);
+		});
+	for (auto &thread : threads)
+		thread.join();
+
+	// No write was lost
+	for (unsigned address = 0x10000; address < 0x10000 + num_pages *
+			Memory::PageSize; address += 4)
+	{
+		unsigned value;
+		memory.Read(address, 4, (char *) &value);
+		ASSERT_EQ(address, value);
+	}
+	EXPECT_TRUE(memory.getPage(0x10000)->getPerm() &
+			Memory::AccessModified);
+}
+
+}
@@ -24,6 +24,7 @@
 #include <exception>
 #include <network/EndNode.h>
 #include <network/RoutingTable.h>
+#include <network/Switch.h>
 #include <network/System.h>
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/Error.h>
@@ -2463,4 +2464,130 @@ TEST(TestSystemConfiguration, thorough_manual_routing)
 	}
 }
 
+
+TEST(TestSystemConfiguration, section_network_topology_torus)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Setup configuration file
+	std::string config =
+			"[ General ]\n"
+			"Frequency = 1000\n"
+			"[ Network.net0 ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n"
+			"Topology = Torus2D\n"
+			"Dimensions = 4 3\n"
+			"Concentration = 2\n"
+			"LinkBandwidth = 8\n"
+			"VC = 2\n"
+			"[ Network.net0.Node.extra ]\n"
+			"Type = EndNode\n"
+			"[ Network.net0.Link.extra-s5 ]\n"
+			"Type = Bidirectional\n"
+			"Source = extra\n"
+			"Dest = s5\n";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Set up network instance
+	System *system = System::getInstance();
+	EXPECT_TRUE(system != nullptr);
+
+	// Test body
+	try
+	{
+		// Parse the configuration file
+		system->ParseConfiguration(&ini_file);
+		Network *network = system->getNetworkByName("net0");
+		ASSERT_TRUE(network != nullptr);
+
+		// 12 switches, 24 generated end nodes, and the extra node
+		EXPECT_EQ(37, network->getNumNodes());
+		EXPECT_EQ(25, network->getNumEndNodes());
+
+		// Links in both directions: 24 + 1 to end nodes, 12 in X with
+		// wrap-around, and 12 in Y with wrap-around
+		EXPECT_EQ(2 * (25 + 12 + 12), network->getNumConnections());
+
+		// Node names and coordinates
+		Switch *s6 = dynamic_cast<Switch *>(network->getNodeByName("s6"));
+		ASSERT_TRUE(s6 != nullptr);
+		EXPECT_EQ(2, s6->getX());
+		EXPECT_EQ(1, s6->getY());
+		EXPECT_TRUE(dynamic_cast<EndNode *>(network->getNodeByName(
+				"n23")) != nullptr);
+
+		// Generated links, including wrap-around links
+		Link *link = dynamic_cast<Link *>(network->getConnectionByName(
+				"link_s3_s0"));
+		ASSERT_TRUE(link != nullptr);
+		EXPECT_EQ(8, link->getBandwidth());
+		EXPECT_EQ(2, link->getNumVirtualChannels());
+		link = dynamic_cast<Link *>(network->getConnectionByName(
+				"link_n13_s6"));
+		ASSERT_TRUE(link != nullptr);
+		EXPECT_EQ(1, link->getNumVirtualChannels());
+
+		// Dimension-order routing by default
+		RoutingTable *table = network->getRoutingTable();
+		EXPECT_EQ(RoutingTable::AlgorithmDimensionOrder,
+				table->getAlgorithm());
+		RoutingTable::Entry entry = table->getRoute(
+				network->getNodeByName("s0"),
+				network->getNodeByName("extra"));
+		EXPECT_EQ(3, entry.cost);
+		EXPECT_EQ(network->getNodeByName("s1"), entry.getNextNode());
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemConfiguration, section_network_topology_dimensions)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Setup configuration file
+	std::string config =
+			"[ General ]\n"
+			"Frequency = 1000\n"
+			"[ Network.net0 ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n"
+			"Topology = Mesh2D\n"
+			"Dimensions = 4\n";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Set up network instance
+	System *system = System::getInstance();
+	EXPECT_TRUE(system != nullptr);
+
+	// Test body
+	std::string message;
+	try
+	{
+		system->ParseConfiguration(&ini_file);
+	}
+	catch (misc::Error &error)
+	{
+		message = error.getMessage();
+	}
+	EXPECT_REGEX_MATCH(misc::fmt(".*%s: Network net0: Topology 'Mesh2D' "
+			"requires 'Dimensions = <x> <y>'.*\n.*",
+			ini_file.getPath().c_str()).c_str(),
+			message.c_str());
+}
+
 }
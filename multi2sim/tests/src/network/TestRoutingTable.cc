@@ -0,0 +1,365 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <network/Network.h>
+#include <network/RoutingTable.h>
+#include <network/System.h>
+#include <lib/cpp/Misc.h>
+#include <lib/cpp/Error.h>
+#include <lib/esim/Engine.h>
+
+namespace net
+{
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+
+	System::Destroy();
+}
+
+
+// Return the configuration of a network 'test' with the given sections,
+// adding the general section and the default values
+static std::string NetworkConfig(const std::string &sections,
+		const std::string &routing = "")
+{
+	return "[ General ]\n"
+			"Frequency = 1000\n"
+			"[ Network.test ]\n"
+			"DefaultInputBufferSize = 16\n"
+			"DefaultOutputBufferSize = 16\n"
+			"DefaultBandwidth = 1\n" +
+			routing + sections;
+}
+
+
+// Return the sections for a mesh of switches 's<x>_<y>' with one end node
+// 'n<x>_<y>' linked to each switch
+static std::string MeshSections(int size_x, int size_y, bool torus,
+		int num_virtual_channels = 1)
+{
+	std::string vc = misc::fmt("VC = %d\n", num_virtual_channels);
+	std::string sections;
+	for (int x = 0; x < size_x; x++)
+	{
+		for (int y = 0; y < size_y; y++)
+		{
+			std::string id = misc::fmt("%d_%d", x, y);
+			sections += "[ Network.test.Node.s" + id + " ]\n"
+					"Type = Switch\n" +
+					misc::fmt("Coordinates = %d %d\n", x, y) +
+					"[ Network.test.Node.n" + id + " ]\n"
+					"Type = EndNode\n"
+					"[ Network.test.Link.n" + id + " ]\n"
+					"Type = Bidirectional\n"
+					"Source = n" + id + "\n"
+					"Dest = s" + id + "\n";
+			if (x < size_x - 1 || (torus && size_x > 2))
+				sections += "[ Network.test.Link.x" + id + " ]\n"
+						"Type = Bidirectional\n"
+						"Source = s" + id + "\n" +
+						misc::fmt("Dest = s%d_%d\n",
+						(x + 1) % size_x, y) + vc;
+			if (y < size_y - 1 || (torus && size_y > 2))
+				sections += "[ Network.test.Link.y" + id + " ]\n"
+						"Type = Bidirectional\n"
+						"Source = s" + id + "\n" +
+						misc::fmt("Dest = s%d_%d\n",
+						x, (y + 1) % size_y) + vc;
+		}
+	}
+	return sections;
+}
+
+
+TEST(TestRoutingTable, shortest_paths_match_floyd_warshall)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// A mesh with extra unidirectional links creating paths of equal
+	// cost, and an isolated end node
+	std::string config = NetworkConfig(MeshSections(4, 3, false) +
+			"[ Network.test.Link.d0 ]\n"
+			"Type = Unidirectional\n"
+			"Source = s0_0\n"
+			"Dest = s2_2\n"
+			"[ Network.test.Link.d1 ]\n"
+			"Type = Unidirectional\n"
+			"Source = s3_0\n"
+			"Dest = s1_1\n"
+			"VC = 2\n"
+			"[ Network.test.Link.d2 ]\n"
+			"Type = Unidirectional\n"
+			"Source = n1_2\n"
+			"Dest = s3_2\n"
+			"[ Network.test.Node.isolated ]\n"
+			"Type = EndNode\n");
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	System *system = System::getInstance();
+	system->ParseConfiguration(&ini_file);
+	Network *network = system->getNetworkByName("test");
+	ASSERT_TRUE(network != nullptr);
+
+	// Reference table
+	RoutingTable reference(network);
+	reference.FloydWarshall();
+
+	// Compare all entries
+	RoutingTable *table = network->getRoutingTable();
+	for (int i = 0; i < network->getNumNodes(); i++)
+	{
+		for (int j = 0; j < network->getNumNodes(); j++)
+		{
+			Node *source = network->getNode(i);
+			Node *destination = network->getNode(j);
+			RoutingTable::Entry *expected = reference.Lookup(source,
+					destination);
+			RoutingTable::Entry *entry = table->Lookup(source,
+					destination);
+			EXPECT_EQ(expected->cost, entry->cost);
+			EXPECT_EQ(expected->getNextNode(), entry->getNextNode());
+			EXPECT_EQ(expected->getBuffer(), entry->getBuffer());
+		}
+	}
+}
+
+
+TEST(TestRoutingTable, dimension_order_mesh)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// 4x3 mesh
+	std::string config = NetworkConfig(MeshSections(4, 3, false),
+			"Routing = DimensionOrder\n");
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	System *system = System::getInstance();
+	system->ParseConfiguration(&ini_file);
+	Network *network = system->getNetworkByName("test");
+	ASSERT_TRUE(network != nullptr);
+	RoutingTable *table = network->getRoutingTable();
+	EXPECT_EQ(RoutingTable::AlgorithmDimensionOrder,
+			table->getAlgorithm());
+
+	// Follow the route from n0_2 to n3_0, along X first
+	const char *path[] = { "n0_2", "s0_2", "s1_2", "s2_2", "s3_2",
+			"s3_1", "s3_0", "n3_0" };
+	Node *destination = network->getNodeByName("n3_0");
+	RoutingTable::Entry entry = table->getRoute(
+			network->getNodeByName("n0_2"), destination);
+	EXPECT_EQ(7, entry.cost);
+	for (unsigned i = 1; i < sizeof path / sizeof path[0]; i++)
+	{
+		Node *node = network->getNodeByName(path[i - 1]);
+		entry = table->getRoute(node, destination);
+		ASSERT_EQ(network->getNodeByName(path[i]),
+				entry.getNextNode());
+		ASSERT_TRUE(entry.getBuffer() != nullptr);
+		EXPECT_EQ(node, entry.getBuffer()->getNode());
+	}
+
+	// Costs match the shortest paths in a mesh
+	RoutingTable reference(network);
+	reference.ShortestPaths();
+	for (int i = 0; i < network->getNumNodes(); i++)
+		for (int j = 0; j < network->getNumNodes(); j++)
+			EXPECT_EQ(reference.Lookup(network->getNode(i),
+					network->getNode(j))->cost,
+					table->getRoute(network->getNode(i),
+					network->getNode(j)).cost);
+
+	// The table is not materialized
+	EXPECT_THROW(table->Lookup(network->getNode(0),
+			network->getNode(1)), misc::Panic);
+}
+
+
+TEST(TestRoutingTable, dimension_order_torus)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// 5x4 torus
+	std::string config = NetworkConfig(MeshSections(5, 4, true),
+			"Routing = DimensionOrder\n");
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	System *system = System::getInstance();
+	system->ParseConfiguration(&ini_file);
+	Network *network = system->getNetworkByName("test");
+	ASSERT_TRUE(network != nullptr);
+	RoutingTable *table = network->getRoutingTable();
+
+	// Wrap-around links are taken when shorter
+	Node *destination = network->getNodeByName("n4_3");
+	RoutingTable::Entry entry = table->getRoute(
+			network->getNodeByName("s0_0"), destination);
+	EXPECT_EQ(3, entry.cost);
+	EXPECT_EQ(network->getNodeByName("s4_0"), entry.getNextNode());
+	entry = table->getRoute(network->getNodeByName("s4_0"), destination);
+	EXPECT_EQ(network->getNodeByName("s4_3"), entry.getNextNode());
+
+	// Costs match the shortest paths in a torus
+	RoutingTable reference(network);
+	reference.ShortestPaths();
+	for (int i = 0; i < network->getNumNodes(); i++)
+		for (int j = 0; j < network->getNumNodes(); j++)
+			EXPECT_EQ(reference.Lookup(network->getNode(i),
+					network->getNode(j))->cost,
+					table->getRoute(network->getNode(i),
+					network->getNode(j)).cost);
+}
+
+
+TEST(TestRoutingTable, dimension_order_not_a_mesh)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Link between switches that are not neighbors
+	std::string config = NetworkConfig(MeshSections(3, 3, false) +
+			"[ Network.test.Link.diagonal ]\n"
+			"Type = Bidirectional\n"
+			"Source = s0_0\n"
+			"Dest = s1_1\n",
+			"Routing = DimensionOrder\n");
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	System *system = System::getInstance();
+	std::string message;
+	try
+	{
+		system->ParseConfiguration(&ini_file);
+	}
+	catch (misc::Error &error)
+	{
+		message = error.getMessage();
+	}
+	EXPECT_REGEX_MATCH(".*does not connect neighbor switches.*",
+			message.c_str());
+}
+
+
+
+TEST(TestRoutingTable, dimension_order_torus_virtual_channel_classes)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// 5x4 torus with two virtual channels per link
+	std::string config = NetworkConfig(MeshSections(5, 4, true, 2),
+			"Routing = DimensionOrder\n");
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	System *system = System::getInstance();
+	system->ParseConfiguration(&ini_file);
+	Network *network = system->getNetworkByName("test");
+	ASSERT_TRUE(network != nullptr);
+	RoutingTable *table = network->getRoutingTable();
+
+	// Packets that still have to cross a wrap-around link use the
+	// upper virtual channel
+	Node *s0_0 = network->getNodeByName("s0_0");
+	Node *s4_0 = network->getNodeByName("s4_0");
+	Link *link = dynamic_cast<Link *>(network->getConnectionByName(
+			"link_s0_0_s4_0"));
+	ASSERT_TRUE(link != nullptr);
+	RoutingTable::Entry entry = table->getRoute(s0_0,
+			network->getNodeByName("n4_3"));
+	EXPECT_EQ(s4_0, entry.getNextNode());
+	EXPECT_EQ(link->getSourceBuffer(1), entry.getBuffer());
+
+	// And the lower one afterwards, or if they never cross it
+	link = dynamic_cast<Link *>(network->getConnectionByName(
+			"link_s0_0_s1_0"));
+	ASSERT_TRUE(link != nullptr);
+	entry = table->getRoute(s0_0, network->getNodeByName("n1_0"));
+	EXPECT_EQ(link->getSourceBuffer(0), entry.getBuffer());
+
+	// Candidates are the virtual channels of the class
+	std::vector<Buffer *> buffers;
+	table->getCandidateBuffers(s0_0, network->getNodeByName("n1_0"),
+			buffers);
+	ASSERT_EQ(1u, buffers.size());
+	EXPECT_EQ(link->getSourceBuffer(0), buffers[0]);
+
+	// The classes break the cycles of the rings
+	EXPECT_FALSE(table->hasCycle());
+}
+
+
+TEST(TestRoutingTable, west_first_candidates)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// 4x3 mesh with two virtual channels per link
+	std::string config = NetworkConfig(MeshSections(4, 3, false, 2),
+			"Routing = WestFirst\n");
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	System *system = System::getInstance();
+	system->ParseConfiguration(&ini_file);
+	Network *network = system->getNetworkByName("test");
+	ASSERT_TRUE(network != nullptr);
+	RoutingTable *table = network->getRoutingTable();
+	EXPECT_EQ(RoutingTable::AlgorithmWestFirst, table->getAlgorithm());
+
+	// Toward the north-east, both directions and all virtual channels
+	// are allowed, starting with the dimension-order route
+	Node *s1_1 = network->getNodeByName("s1_1");
+	std::vector<Buffer *> buffers;
+	table->getCandidateBuffers(s1_1, network->getNodeByName("n3_2"),
+			buffers);
+	ASSERT_EQ(4u, buffers.size());
+	EXPECT_EQ(table->getRoute(s1_1, network->getNodeByName("n3_2")).
+			getBuffer(), buffers[0]);
+	EXPECT_EQ(network->getNodeByName("s2_1"), dynamic_cast<Link *>(
+			buffers[1]->getConnection())->getDestinationNode());
+	EXPECT_EQ(network->getNodeByName("s1_2"), dynamic_cast<Link *>(
+			buffers[2]->getConnection())->getDestinationNode());
+
+	// Toward the north-west, west first
+	buffers.clear();
+	table->getCandidateBuffers(s1_1, network->getNodeByName("n0_2"),
+			buffers);
+	ASSERT_EQ(2u, buffers.size());
+	for (Buffer *buffer : buffers)
+		EXPECT_EQ(network->getNodeByName("s0_1"), dynamic_cast<Link *>(
+				buffer->getConnection())->getDestinationNode());
+
+	// Tori are not supported
+	Cleanup();
+	config = NetworkConfig(MeshSections(4, 3, true),
+			"Routing = WestFirst\n");
+	misc::IniFile torus_ini_file;
+	torus_ini_file.LoadFromString(config);
+	system = System::getInstance();
+	EXPECT_THROW(system->ParseConfiguration(&torus_ini_file),
+			misc::Error);
+}
+
+}
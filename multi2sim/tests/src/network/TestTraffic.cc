@@ -0,0 +1,315 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include <network/EndNode.h>
+#include <network/Network.h>
+#include <network/System.h>
+#include <network/Traffic.h>
+#include <lib/cpp/Histogram.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/Json.h>
+#include <lib/cpp/Misc.h>
+#include <lib/esim/Engine.h>
+
+namespace net
+{
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+
+	System::Destroy();
+}
+
+
+// Parse a network 'test' with a generated mesh of the given size and one
+// end node per switch, adding the given variables to the network section,
+// and return it
+static Network *ParseMesh(int size_x, int size_y,
+		const std::string &variables = "")
+{
+	misc::IniFile ini_file;
+	ini_file.LoadFromString("[ General ]\n"
+			"Frequency = 1000\n"
+			"[ Network.test ]\n"
+			"DefaultInputBufferSize = 16\n"
+			"DefaultOutputBufferSize = 16\n"
+			"DefaultBandwidth = 1\n"
+			"Topology = Mesh2D\n" +
+			misc::fmt("Dimensions = %d %d\n", size_x, size_y) +
+			variables);
+	System *system = System::getInstance();
+	system->ParseConfiguration(&ini_file);
+	return system->getNetworkByName("test");
+}
+
+
+// Return end node 'n<index>' of the network
+static EndNode *getEndNode(Network *network, int index)
+{
+	return dynamic_cast<EndNode *>(network->getNodeByName(
+			misc::fmt("n%d", index)));
+}
+
+
+TEST(TestTraffic, patterns)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// 4x4 mesh
+	Network *network = ParseMesh(4, 4);
+	ASSERT_TRUE(network != nullptr);
+
+	// Transpose
+	Traffic transpose(network, Traffic::PatternTranspose);
+	EXPECT_EQ(getEndNode(network, 4), transpose.getDestination(
+			getEndNode(network, 1)));
+	EXPECT_EQ(getEndNode(network, 14), transpose.getDestination(
+			getEndNode(network, 11)));
+	EXPECT_EQ(nullptr, transpose.getDestination(getEndNode(network, 5)));
+
+	// Bit complement
+	Traffic bitcomp(network, Traffic::PatternBitComplement);
+	EXPECT_EQ(getEndNode(network, 15), bitcomp.getDestination(
+			getEndNode(network, 0)));
+	EXPECT_EQ(getEndNode(network, 9), bitcomp.getDestination(
+			getEndNode(network, 6)));
+
+	// Neighbor
+	Traffic neighbor(network, Traffic::PatternNeighbor);
+	EXPECT_EQ(getEndNode(network, 8), neighbor.getDestination(
+			getEndNode(network, 7)));
+	EXPECT_EQ(getEndNode(network, 0), neighbor.getDestination(
+			getEndNode(network, 15)));
+
+	// Hotspot receiving all messages, except its own
+	Traffic hotspot(network, Traffic::PatternHotspot);
+	EXPECT_EQ(getEndNode(network, 0), hotspot.getHotspot());
+	hotspot.setHotspot(getEndNode(network, 3), 1.0);
+	for (int i = 0; i < 16; i++)
+	{
+		EndNode *node = getEndNode(network, i);
+		EndNode *destination_node = hotspot.getDestination(node);
+		EXPECT_NE(node, destination_node);
+		if (i != 3)
+			EXPECT_EQ(getEndNode(network, 3), destination_node);
+	}
+
+	// Permutations that do not fit the number of end nodes
+	Cleanup();
+	network = ParseMesh(4, 2);
+	ASSERT_TRUE(network != nullptr);
+	EXPECT_THROW(Traffic(network, Traffic::PatternTranspose),
+			Traffic::Error);
+	Traffic bitcomp_8(network, Traffic::PatternBitComplement);
+	Cleanup();
+	network = ParseMesh(3, 2);
+	ASSERT_TRUE(network != nullptr);
+	EXPECT_THROW(Traffic(network, Traffic::PatternBitComplement),
+			Traffic::Error);
+}
+
+
+TEST(TestTraffic, size_distribution)
+{
+	SizeDistribution distribution;
+	distribution.Parse("8:3,72:1");
+	EXPECT_EQ(72, distribution.getMaxSize());
+	EXPECT_DOUBLE_EQ(24.0, distribution.getAverageSize());
+	for (int i = 0; i < 100; i++)
+	{
+		int size = distribution.Sample();
+		EXPECT_TRUE(size == 8 || size == 72);
+	}
+
+	// Sizes without weights
+	distribution.Parse("16, 32");
+	EXPECT_DOUBLE_EQ(24.0, distribution.getAverageSize());
+
+	// Invalid formats
+	EXPECT_THROW(distribution.Parse("0:1"), Traffic::Error);
+	EXPECT_THROW(distribution.Parse("8:x"), Traffic::Error);
+	EXPECT_THROW(distribution.Parse("8:-1"), Traffic::Error);
+	distribution.Parse("");
+	EXPECT_TRUE(distribution.isEmpty());
+}
+
+
+TEST(TestTraffic, trace_replay)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// 2x2 mesh
+	Network *network = ParseMesh(2, 2);
+	ASSERT_TRUE(network != nullptr);
+	Traffic traffic(network, Traffic::PatternUniform);
+	traffic.setMessageSize(4);
+
+	// Invalid traces
+	std::istringstream reversed("10 n0 n1\n5 n1 n2\n");
+	EXPECT_THROW(traffic.LoadTrace(reversed), Traffic::Error);
+	std::istringstream unknown("10 n0 s1\n");
+	EXPECT_THROW(traffic.LoadTrace(unknown), Traffic::Error);
+	std::istringstream large("10 n0 n1 8\n");
+	EXPECT_THROW(traffic.LoadTrace(large), Traffic::Error);
+
+	// More messages than fit in the source buffer at once, which must
+	// wait instead of being dropped
+	std::string text = "# cycle source destination size\n";
+	for (int i = 0; i < 10; i++)
+		text += misc::fmt("%d n0 n3\n", i);
+	text += "\n20 n2 n1 2\n";
+	std::istringstream is(text);
+	traffic.LoadTrace(is);
+	EXPECT_TRUE(traffic.hasTrace());
+
+	// The simulation finishes once all messages are delivered
+	System *system = System::getInstance();
+	system->TrafficSimulation(network, &traffic, 100000);
+	EXPECT_TRUE(traffic.isTraceDone());
+	EXPECT_LT(system->getCycle(), 100000);
+	EXPECT_EQ(11, network->getTransfers());
+	EXPECT_EQ(42, network->getAccumulatedBytes());
+	EXPECT_EQ(0, traffic.getNumDroppedMessages());
+
+	// Latency histogram
+	const misc::Histogram &latency = network->getMessageLatency();
+	EXPECT_EQ(11, latency.getCount());
+	EXPECT_EQ(network->getAccumulatedLatency(), latency.getSum());
+
+	// JSON report
+	std::ostringstream os;
+	misc::JsonWriter json(os);
+	json.BeginObject();
+	network->DumpJsonReport(json);
+	json.EndObject();
+	json.End();
+	std::string report = os.str();
+	EXPECT_NE(std::string::npos, report.find("\"test\": {"));
+	EXPECT_NE(std::string::npos, report.find("\"Transfers\": 11,"));
+	EXPECT_NE(std::string::npos, report.find("\"MessageLatency\": {"));
+	EXPECT_NE(std::string::npos, report.find("\"Count\": 11,"));
+	EXPECT_EQ("}\n", report.substr(report.size() - 2));
+
+	// All messages are released, and their objects recycled
+	EXPECT_EQ(0, network->getNumMessagesInFlight());
+	Message *message = network->newMessage(getEndNode(network, 0),
+			getEndNode(network, 1), 4);
+	EXPECT_EQ(11, message->getId());
+	EXPECT_LT(message->getSlot(), 11);
+	EXPECT_EQ(1, network->getNumMessagesInFlight());
+}
+
+
+TEST(TestTraffic, analytical_model_zero_load)
+{
+	// Messages spaced enough not to contend, of one and several packets
+	std::string trace = "0 n0 n1 8\n"
+			"100 n0 n15 8\n"
+			"200 n5 n10 16\n";
+
+	// Average latency of the detailed and analytical models
+	double latency[2];
+	for (int analytical = 0; analytical < 2; analytical++)
+	{
+		Cleanup();
+		Network *network = ParseMesh(4, 4, analytical ?
+				"DefaultPacketSize = 8\nModel = Analytical\n" :
+				"DefaultPacketSize = 8\n");
+		ASSERT_TRUE(network != nullptr);
+		EXPECT_EQ(analytical, network->isAnalytical());
+		Traffic traffic(network, Traffic::PatternUniform);
+		traffic.setMessageSize(16);
+		std::istringstream is(trace);
+		traffic.LoadTrace(is);
+		System::getInstance()->TrafficSimulation(network, &traffic,
+				100000);
+		EXPECT_EQ(3, network->getTransfers());
+		latency[analytical] = (double) network->
+				getAccumulatedLatency() / network->getTransfers();
+
+		// Link statistics
+		Link *link = misc::cast<Link *>(network->getConnectionByName(
+				"link_n5_s5"));
+		EXPECT_EQ(16, link->getTransferredBytes());
+		EXPECT_EQ(16, link->getBusyCycle());
+	}
+	EXPECT_DOUBLE_EQ(latency[0], latency[1]);
+
+	// Analytical model in an ideal network
+	Cleanup();
+	EXPECT_THROW(ParseMesh(2, 2, "Ideal = True\nModel = Analytical\n"),
+			misc::Error);
+}
+
+
+TEST(TestTraffic, wormhole_model_zero_load)
+{
+	// Messages of 8-flit packets spaced enough not to contend
+	std::string trace = "0 n0 n1 8\n"
+			"100 n0 n15 8\n"
+			"200 n5 n10 16\n";
+	Cleanup();
+	Network *network = ParseMesh(4, 4, "DefaultPacketSize = 8\n"
+			"Model = Wormhole\n");
+	ASSERT_TRUE(network != nullptr);
+	EXPECT_TRUE(network->isWormhole());
+	Traffic traffic(network, Traffic::PatternUniform);
+	traffic.setMessageSize(16);
+	std::istringstream is(trace);
+	traffic.LoadTrace(is);
+	System::getInstance()->TrafficSimulation(network, &traffic, 100000);
+	EXPECT_EQ(3, network->getTransfers());
+	EXPECT_EQ(1, network->getWormhole()->getFlitSize());
+
+	// The head flit takes 3 cycles to reach the first switch, and 5
+	// cycles for each switch (RC, VA, SA, ST, and link traversal), with
+	// the tail 7 flits behind. The second packet of the last message
+	// loses one cycle behind the first one in the first switch.
+	EXPECT_EQ((3 + 5 * 2 + 7) + (3 + 5 * 7 + 7) + (3 + 5 * 3 + 7 + 9),
+			network->getAccumulatedLatency());
+
+	// Link statistics
+	Link *link = misc::cast<Link *>(network->getConnectionByName(
+			"link_n5_s5"));
+	EXPECT_EQ(16, link->getTransferredBytes());
+	EXPECT_EQ(16, link->getBusyCycle());
+
+	// Virtual cut-through with virtual channels smaller than a packet
+	Cleanup();
+	network = ParseMesh(4, 4, "DefaultPacketSize = 8\n"
+			"Model = Wormhole\n"
+			"VirtualCutThrough = True\n"
+			"FlitBufferSize = 4\n");
+	ASSERT_TRUE(network != nullptr);
+	Traffic traffic_cut_through(network, Traffic::PatternUniform);
+	traffic_cut_through.setMessageSize(16);
+	std::istringstream is_cut_through(trace);
+	traffic_cut_through.LoadTrace(is_cut_through);
+	EXPECT_THROW(System::getInstance()->TrafficSimulation(network,
+			&traffic_cut_through, 100000), Wormhole::Error);
+}
+
+}